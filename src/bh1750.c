@@ -44,6 +44,13 @@
 #define BH1750_DEFAULT_MEAS_TIME_THREE_MSB 0x2U // bin: 010
 #define BH1750_DEFAULT_MEAS_TIME_FIVE_LSB 0x5U  // bin: 00101
 
+/** Which change notification threshold was crossed last. */
+typedef enum {
+    BH1750_NOTIFY_LEVEL_UNKNOWN = 0,
+    BH1750_NOTIFY_LEVEL_LOW,
+    BH1750_NOTIFY_LEVEL_HIGH,
+} BH1750NotifyLevel;
+
 /**
  * @brief Check if I2C address is a valid BH1750 I2C address.
  *
@@ -110,6 +117,54 @@ static bool is_valid_meas_time(uint8_t meas_time)
     return ((meas_time >= BH1750_MIN_MEAS_TIME) && (meas_time <= BH1750_MAX_MEAS_TIME));
 }
 
+/**
+ * @brief Check whether decimator type is valid.
+ *
+ * @param[in] type Decimator type.
+ *
+ * @retval true Decimator type is valid.
+ * @retval false Decimator type is invalid.
+ */
+static bool is_valid_decimator_type(uint8_t type)
+{
+    return (type == BH1750_DECIMATOR_TYPE_BOXCAR) || (type == BH1750_DECIMATOR_TYPE_MEDIAN);
+}
+
+/**
+ * @brief Check whether startup profile is valid.
+ *
+ * @param[in] profile Startup profile.
+ *
+ * @retval true Startup profile is valid.
+ * @retval false Startup profile is invalid.
+ */
+static bool is_valid_startup_profile(const BH1750StartupProfile *const profile)
+{
+    if (!is_valid_meas_time(profile->meas_time)) {
+        return false;
+    }
+    /* Measurement mode is only used if continuous measurement is started */
+    return !profile->start_continuous_meas || is_valid_meas_mode(profile->meas_mode);
+}
+
+/**
+ * @brief Check whether a state snapshot can be restored with bh1750_attach.
+ *
+ * @param[in] snapshot State snapshot.
+ *
+ * @retval true State snapshot is valid.
+ * @retval false State snapshot is invalid.
+ */
+static bool is_valid_state_snapshot(const BH1750StateSnapshot *const snapshot)
+{
+    if (!snapshot->initialized || !is_valid_meas_time(snapshot->meas_time)) {
+        return false;
+    }
+    /* Measurement mode is only relevant if continuous measurement is ongoing. Otherwise, it is set by the next
+     * measurement sequence. */
+    return !snapshot->cont_meas_ongoing || is_valid_meas_mode(snapshot->meas_mode);
+}
+
 /**
  * @brief Convert two bytes in big endian to an integer of type uint16_t.
  *
@@ -251,6 +306,53 @@ static void execute_complete_cb(BH1750 self, uint8_t rc)
     }
 }
 
+/**
+ * @brief Interpret self->seq_cb as BH1750ReadCb and execute it, if present.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] rc Result code to pass to the read cb.
+ * @param[in] meas Measurement to pass to the read cb. Should be NULL if @p rc is not BH1750_RESULT_CODE_OK.
+ */
+static void execute_read_cb(BH1750 self, uint8_t rc, const BH1750Measurement *meas)
+{
+    end_sequence(self);
+    BH1750ReadCb cb = (BH1750ReadCb)self->seq_cb;
+    if (cb) {
+        cb(rc, meas, self->seq_cb_user_data);
+    }
+}
+
+/**
+ * @brief Interpret self->seq_cb as BH1750BurstCb and execute it, if present.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] rc Result code to pass to the burst cb.
+ */
+static void execute_burst_cb(BH1750 self, uint8_t rc)
+{
+    end_sequence(self);
+    self->is_burst_seq = false;
+    BH1750BurstCb cb = (BH1750BurstCb)self->seq_cb;
+    if (cb) {
+        cb(rc, self->burst_num_done, self->seq_cb_user_data);
+    }
+}
+
+/**
+ * @brief End a read sequence with an error, executing the callback type of the sequence.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] rc Result code to pass to the callback.
+ */
+static void execute_read_err_cb(BH1750 self, uint8_t rc)
+{
+    if (self->is_burst_seq) {
+        execute_burst_cb(self, rc);
+    } else {
+        execute_read_cb(self, rc, NULL);
+    }
+}
+
 /**
  * @brief I2C callback to execute when the last I2C transaction in the sequence is complete.
  *
@@ -271,6 +373,76 @@ static void generic_i2c_complete_cb(uint8_t result_code, void *user_data)
     execute_complete_cb(self, rc);
 }
 
+static uint32_t get_time_ms(BH1750 self);
+
+/**
+ * @brief Count the latency of a completed I2C transaction in the latency histogram.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] latency_ms Latency in ms.
+ */
+static void record_i2c_latency(BH1750 self, uint32_t latency_ms)
+{
+    static const uint32_t bounds_ms[BH1750_LATENCY_NUM_BUCKETS - 1] = BH1750_LATENCY_BUCKET_BOUNDS_MS;
+    size_t bucket = 0;
+    while ((bucket < (BH1750_LATENCY_NUM_BUCKETS - 1)) && (latency_ms > bounds_ms[bucket])) {
+        bucket++;
+    }
+    self->counters.latency_buckets[bucket]++;
+    self->counters.latency_sum_ms += latency_ms;
+}
+
+/**
+ * @brief I2C callback passed to every I2C transaction. Updates the counters and forwards to self->i2c_cb.
+ *
+ * @param[in] result_code I2C transaction result code. One of @ref BH1750_I2CResultCode.
+ * @param[in] user_data BH1750 instance.
+ */
+static void i2c_transaction_complete_cb(uint8_t result_code, void *user_data)
+{
+    BH1750 self = (BH1750)user_data;
+    if (!self) {
+        return;
+    }
+
+    if (result_code != BH1750_I2C_RESULT_CODE_OK) {
+        self->counters.num_i2c_errors++;
+    }
+    if (self->get_time) {
+        record_i2c_latency(self, get_time_ms(self) - self->i2c_start_time_ms);
+    }
+    self->i2c_cb(result_code, self->i2c_cb_user_data);
+}
+
+/**
+ * @brief Remember the callback of an I2C transaction that is about to be started.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] cb Callback to execute once the transaction is complete.
+ * @param[in] user_data User data to pass to @p cb.
+ */
+static void begin_i2c_transaction(BH1750 self, BH1750_I2CCompleteCb cb, void *user_data)
+{
+    self->i2c_cb = cb;
+    self->i2c_cb_user_data = user_data;
+    self->i2c_start_time_ms = get_time_ms(self);
+}
+
+/**
+ * @brief Write a one byte command to the sensor.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] cmd Command.
+ * @param[in] cb Callback to execute once the command is sent.
+ * @param[in] user_data User data to pass to @p cb.
+ */
+static void write_cmd(BH1750 self, uint8_t cmd, BH1750_I2CCompleteCb cb, void *user_data)
+{
+    begin_i2c_transaction(self, cb, user_data);
+    self->counters.num_i2c_writes++;
+    self->i2c_write(&cmd, 1, self->i2c_addr, self->i2c_write_user_data, i2c_transaction_complete_cb, (void *)self);
+}
+
 /**
  * @brief Send power on command.
  *
@@ -281,7 +453,7 @@ static void generic_i2c_complete_cb(uint8_t result_code, void *user_data)
 static void send_power_on_cmd(BH1750 self, BH1750_I2CCompleteCb cb, void *user_data)
 {
     uint8_t cmd = BH1750_POWER_ON_CMD;
-    self->i2c_write(&cmd, 1, self->i2c_addr, self->i2c_write_user_data, cb, user_data);
+    write_cmd(self, cmd, cb, user_data);
 }
 
 /**
@@ -294,7 +466,7 @@ static void send_power_on_cmd(BH1750 self, BH1750_I2CCompleteCb cb, void *user_d
 static void send_power_down_cmd(BH1750 self, BH1750_I2CCompleteCb cb, void *user_data)
 {
     uint8_t cmd = BH1750_POWER_DOWN_CMD;
-    self->i2c_write(&cmd, 1, self->i2c_addr, self->i2c_write_user_data, cb, user_data);
+    write_cmd(self, cmd, cb, user_data);
 }
 
 /**
@@ -307,7 +479,7 @@ static void send_power_down_cmd(BH1750 self, BH1750_I2CCompleteCb cb, void *user
 static void send_reset_cmd(BH1750 self, BH1750_I2CCompleteCb cb, void *user_data)
 {
     uint8_t cmd = BH1750_RESET_CMD;
-    self->i2c_write(&cmd, 1, self->i2c_addr, self->i2c_write_user_data, cb, user_data);
+    write_cmd(self, cmd, cb, user_data);
 }
 
 /**
@@ -321,7 +493,10 @@ static void send_reset_cmd(BH1750 self, BH1750_I2CCompleteCb cb, void *user_data
  */
 static void send_read_meas_cmd(BH1750 self, BH1750_I2CCompleteCb cb, void *user_data)
 {
-    self->i2c_read(self->read_buf, 2, self->i2c_addr, self->i2c_read_user_data, cb, user_data);
+    begin_i2c_transaction(self, cb, user_data);
+    self->counters.num_i2c_reads++;
+    self->i2c_read(self->read_buf, 2, self->i2c_addr, self->i2c_read_user_data, i2c_transaction_complete_cb,
+                   (void *)self);
 }
 
 /**
@@ -335,7 +510,7 @@ static void send_read_meas_cmd(BH1750 self, BH1750_I2CCompleteCb cb, void *user_
 static void send_start_continuous_meas_cmd(BH1750 self, uint8_t meas_mode, BH1750_I2CCompleteCb cb, void *user_data)
 {
     uint8_t cmd = get_start_cont_meas_cmd_code(meas_mode);
-    self->i2c_write(&cmd, 1, self->i2c_addr, self->i2c_write_user_data, cb, user_data);
+    write_cmd(self, cmd, cb, user_data);
 }
 
 /**
@@ -349,7 +524,7 @@ static void send_start_continuous_meas_cmd(BH1750 self, uint8_t meas_mode, BH175
 static void send_one_time_meas_cmd(BH1750 self, uint8_t meas_mode, BH1750_I2CCompleteCb cb, void *user_data)
 {
     uint8_t cmd = get_one_time_meas_cmd_code(meas_mode);
-    self->i2c_write(&cmd, 1, self->i2c_addr, self->i2c_write_user_data, cb, user_data);
+    write_cmd(self, cmd, cb, user_data);
 }
 
 /**
@@ -371,7 +546,7 @@ static uint8_t set_mtreg_high_bit(BH1750 self, uint8_t val, BH1750_I2CCompleteCb
         return BH1750_RESULT_CODE_INVALID_ARG;
     }
     uint8_t cmd = ((uint8_t)BH1750_SET_MTREG_HIGH_BIT_CMD) | val;
-    self->i2c_write(&cmd, 1, self->i2c_addr, self->i2c_write_user_data, cb, user_data);
+    write_cmd(self, cmd, cb, user_data);
     return BH1750_RESULT_CODE_OK;
 }
 
@@ -394,37 +569,37 @@ static uint8_t set_mtreg_low_bit(BH1750 self, uint8_t val, BH1750_I2CCompleteCb
         return BH1750_RESULT_CODE_INVALID_ARG;
     }
     uint8_t cmd = ((uint8_t)BH1750_SET_MTREG_LOW_BIT_CMD) | val;
-    self->i2c_write(&cmd, 1, self->i2c_addr, self->i2c_write_user_data, cb, user_data);
+    write_cmd(self, cmd, cb, user_data);
     return BH1750_I2C_RESULT_CODE_OK;
 }
 
 /**
- * @brief Convert raw measurement to illuminance in lx.
+ * @brief Get illuminance in lx that corresponds to one count of raw measurement.
  *
- * @param[in] self BH1750 instance.
- * @param[in] raw_meas Raw measurement
- * @param[out] meas_lx Resulting measurement in lx is written here.
+ * @param[in] meas_mode Measurement mode. One of @ref BH1750MeasMode.
+ * @param[in] meas_time Measurement time set in Mtreg.
+ * @param[out] lx_per_count Illuminance in lx per raw measurement count is written here.
  *
- * @retval BH1750_RESULT_CODE_OK Successfully converted raw measurement to illuminance in lx.
- * @retval BH1750_RESULT_CODE_INVALID_USAGE self->meas_time is 0. Cannot convert, because we need to divide by
- * self->meas_time. self->meas_time should never be 0.
- * @retval BH1750_RESULT_CODE_DRIVER_ERR Something went wrong with the code of this driver.
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_USAGE @p meas_time is 0. Cannot convert, because we need to divide by
+ * @p meas_time.
+ * @retval BH1750_RESULT_CODE_DRIVER_ERR @p meas_mode is invalid.
  */
-static uint8_t convert_raw_meas_to_lx(BH1750 self, uint16_t raw_meas, uint32_t *const meas_lx)
+static uint8_t get_lx_per_count(uint8_t meas_mode, uint8_t meas_time, float *const lx_per_count)
 {
-    if (self->meas_time == 0) {
+    if (meas_time == 0) {
         /* Division by 0 safety check */
         return BH1750_RESULT_CODE_INVALID_USAGE;
     }
-    switch (self->meas_mode) {
+    switch (meas_mode) {
     case BH1750_MEAS_MODE_H_RES:
-        *meas_lx = lroundf(raw_meas * (BH1750_CONVERSION_MAGIC * (69.0f / (self->meas_time))));
+        *lx_per_count = BH1750_CONVERSION_MAGIC * (69.0f / meas_time);
         break;
     case BH1750_MEAS_MODE_H_RES2:
-        *meas_lx = lroundf(raw_meas * ((BH1750_CONVERSION_MAGIC * (69.0f / (self->meas_time))) / 2.0f));
+        *lx_per_count = (BH1750_CONVERSION_MAGIC * (69.0f / meas_time)) / 2.0f;
         break;
     case BH1750_MEAS_MODE_L_RES:
-        *meas_lx = lroundf(raw_meas * (BH1750_CONVERSION_MAGIC * (69.0f / (self->meas_time))));
+        *lx_per_count = BH1750_CONVERSION_MAGIC * (69.0f / meas_time);
         break;
     default:
         /* Invalid measurement mode */
@@ -434,6 +609,272 @@ static uint8_t convert_raw_meas_to_lx(BH1750 self, uint16_t raw_meas, uint32_t *
     return BH1750_RESULT_CODE_OK;
 }
 
+/**
+ * @brief Convert raw measurement to illuminance in lx.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] raw_meas Raw measurement
+ * @param[out] meas_lx Resulting measurement in lx is written here.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully converted raw measurement to illuminance in lx.
+ * @retval BH1750_RESULT_CODE_INVALID_USAGE self->meas_time is 0. Cannot convert, because we need to divide by
+ * self->meas_time. self->meas_time should never be 0.
+ * @retval BH1750_RESULT_CODE_DRIVER_ERR Something went wrong with the code of this driver.
+ */
+static uint8_t convert_raw_meas_to_lx(BH1750 self, uint16_t raw_meas, uint32_t *const meas_lx)
+{
+    float lx_per_count;
+    uint8_t rc = get_lx_per_count(self->meas_mode, self->meas_time, &lx_per_count);
+    if (rc != BH1750_RESULT_CODE_OK) {
+        return rc;
+    }
+
+    *meas_lx = lroundf(raw_meas * lx_per_count);
+    return BH1750_RESULT_CODE_OK;
+}
+
+/**
+ * @brief Get the time it takes the sensor to complete one measurement.
+ *
+ * @param[in] meas_mode Measurement mode.
+ * @param[in] meas_time Measurement time set in Mtreg.
+ *
+ * @return uint32_t Maximum measurement duration in ms.
+ */
+static uint32_t get_meas_duration_ms(uint8_t meas_mode, uint8_t meas_time)
+{
+    uint32_t timer_period_base =
+        (meas_mode == BH1750_MEAS_MODE_L_RES) ? BH1750_MAX_L_RES_MEAS_TIME_MS : BH1750_MAX_H_RES_MEAS_TIME_MS;
+    /* Time we need to wait depends on the meas time currently set in Mtreg. The higher meas_time, the longer it will
+     * take to make a measurement.
+     * For example: Meas time in Mtreg is 138. Default meas time is 69. 138/69 = 2. This means that we should wait twice
+     * as long compared to if meas time were 69.
+     * It takes 180 ms to make a measurement in high res mode when meas time in Mtreg is 69. This means that we should
+     * wait for 180 * 2 = 360 ms - that's how long it will take to make a measurement when meas time in Mtreg is 138.
+     * The logic for low res mode is the same, but we use 24 ms instead of 180 ms, since it takes 24 ms to take a
+     * measurement in low res mode when meas time in Mtreg is 69. */
+    float timer_period_multiplier = ((float)meas_time) / BH1750_DEFAULT_MEAS_TIME;
+    /* Ceil timer period instead of rounding to be sure that measurement is ready after timer expires */
+    return ceilf(timer_period_base * timer_period_multiplier);
+}
+
+/**
+ * @brief Compute the average of the collected raw measurements, rounded to the nearest integer.
+ *
+ * @param[in] samples Raw measurements.
+ * @param[in] num_samples Number of raw measurements in @p samples. Must be > 0.
+ *
+ * @return uint16_t Average.
+ */
+static uint16_t get_boxcar_output(const uint16_t *const samples, uint8_t num_samples)
+{
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < num_samples; i++) {
+        sum += samples[i];
+    }
+    return (uint16_t)((sum + (num_samples / 2U)) / num_samples);
+}
+
+/**
+ * @brief Compute the median of the collected raw measurements.
+ *
+ * Sorts @p samples in place. Insertion sort is used, since there are at most BH1750_MAX_DECIMATION_FACTOR samples.
+ *
+ * @param[in,out] samples Raw measurements.
+ * @param[in] num_samples Number of raw measurements in @p samples. Must be > 0.
+ *
+ * @return uint16_t Median. If @p num_samples is even, the average of the two middle values rounded up.
+ */
+static uint16_t get_median_output(uint16_t *const samples, uint8_t num_samples)
+{
+    for (uint8_t i = 1; i < num_samples; i++) {
+        uint16_t val = samples[i];
+        uint8_t j = i;
+        while ((j > 0) && (samples[j - 1] > val)) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = val;
+    }
+
+    uint8_t mid = num_samples / 2U;
+    if ((num_samples % 2U) != 0) {
+        return samples[mid];
+    }
+    return (uint16_t)((samples[mid - 1] + samples[mid] + 1U) / 2U);
+}
+
+/**
+ * @brief Combine the raw measurements collected during the current read sequence into one raw measurement.
+ *
+ * @param[in] self BH1750 instance.
+ *
+ * @return uint16_t Output of the decimator.
+ */
+static uint16_t get_decimator_output(BH1750 self)
+{
+    if (self->dec_type == BH1750_DECIMATOR_TYPE_MEDIAN) {
+        return get_median_output(self->dec_samples, self->dec_num_samples);
+    }
+    return get_boxcar_output(self->dec_samples, self->dec_num_samples);
+}
+
+/**
+ * @brief Convert illuminance in lx to raw counts, rounding up.
+ *
+ * @param[in] lx Illuminance in lx.
+ * @param[in] lx_per_count Illuminance in lx per raw count. Must be > 0.
+ *
+ * @return uint32_t Smallest raw count with illuminance >= @p lx, capped at 0x10000, which is larger than any raw
+ * measurement.
+ */
+static uint32_t lx_to_raw_ceil(uint32_t lx, float lx_per_count)
+{
+    float raw = ceilf(lx / lx_per_count);
+    return (raw >= 65536.0f) ? 0x10000UL : (uint32_t)raw;
+}
+
+/**
+ * @brief Convert change notification thresholds and deadband from lx to raw counts for a measurement mode and time.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] meas_mode Measurement mode.
+ * @param[in] meas_time Measurement time.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_DRIVER_ERR @p meas_mode or @p meas_time is invalid. This should never happen.
+ */
+static uint8_t compute_notify_raw_thresholds(BH1750 self, uint8_t meas_mode, uint8_t meas_time)
+{
+    float lx_per_count;
+    uint8_t rc = get_lx_per_count(meas_mode, meas_time, &lx_per_count);
+    if (rc != BH1750_RESULT_CODE_OK) {
+        return BH1750_RESULT_CODE_DRIVER_ERR;
+    }
+
+    self->notify_high_raw = lx_to_raw_ceil(self->notify_high_lx, lx_per_count);
+    /* Largest raw count with illuminance <= low_lx. If low_lx is below one raw count, only raw count 0 qualifies. */
+    float low_raw = floorf(self->notify_low_lx / lx_per_count);
+    self->notify_low_raw = (low_raw >= 65535.0f) ? 0xFFFFUL : (uint32_t)low_raw;
+    if (self->notify_low_raw >= self->notify_high_raw) {
+        /* Float rounding of large thresholds must not make a raw count both HIGH and LOW, or measurements at that
+         * count would alternate between the two levels. high_raw is at least 1, since high_lx > low_lx. */
+        self->notify_low_raw = self->notify_high_raw - 1;
+    }
+    self->notify_deadband_raw = lx_to_raw_ceil(self->notify_deadband_lx, lx_per_count);
+    self->notify_meas_mode = meas_mode;
+    self->notify_meas_time = meas_time;
+    return BH1750_RESULT_CODE_OK;
+}
+
+/**
+ * @brief Decide whether a raw measurement should be passed to the read cb when change notification is enabled.
+ *
+ * Updates the change notification state if the measurement should be passed to the read cb.
+ *
+ * @param[in] self BH1750 instance. self->meas_mode and self->meas_time must be the mode and time that @p raw_meas was
+ * taken with.
+ * @param[in] raw_meas Raw measurement.
+ *
+ * @retval true Pass the measurement to the read cb.
+ * @retval false Suppress the measurement.
+ */
+static bool is_meaningful_change(BH1750 self, uint16_t raw_meas)
+{
+    bool notify = false;
+    if ((self->notify_meas_time == 0) || (self->notify_meas_mode != self->meas_mode) ||
+        (self->notify_meas_time != self->meas_time)) {
+        /* First measurement for this mode and time - previous raw values are not comparable */
+        if (compute_notify_raw_thresholds(self, self->meas_mode, self->meas_time) != BH1750_RESULT_CODE_OK) {
+            /* Do not hide measurements because of a bug in this driver */
+            return true;
+        }
+        self->notify_level = BH1750_NOTIFY_LEVEL_UNKNOWN;
+        notify = true;
+    }
+
+    if ((raw_meas >= self->notify_high_raw) && (self->notify_level != BH1750_NOTIFY_LEVEL_HIGH)) {
+        self->notify_level = BH1750_NOTIFY_LEVEL_HIGH;
+        notify = true;
+    } else if ((raw_meas <= self->notify_low_raw) && (self->notify_level != BH1750_NOTIFY_LEVEL_LOW)) {
+        self->notify_level = BH1750_NOTIFY_LEVEL_LOW;
+        notify = true;
+    }
+
+    if (self->notify_deadband_raw != 0) {
+        uint32_t diff = (raw_meas > self->notify_last_raw) ? (raw_meas - self->notify_last_raw)
+                                                           : (self->notify_last_raw - raw_meas);
+        if (diff >= self->notify_deadband_raw) {
+            notify = true;
+        }
+    }
+
+    if (notify) {
+        self->notify_last_raw = raw_meas;
+    }
+    return notify;
+}
+
+/**
+ * @brief Get the current time from the user-defined get_time function.
+ *
+ * @return uint32_t Current time in ms, or 0 if no get_time function was passed to bh1750_create.
+ */
+static uint32_t get_time_ms(BH1750 self)
+{
+    return self->get_time ? self->get_time(self->get_time_user_data) : 0;
+}
+
+/**
+ * @brief Estimate the midpoint of the integration window of the raw measurement that was just read out.
+ *
+ * A one time measurement integrates from the completion of the measurement command for the measurement duration. In
+ * continuous measurement, the sensor returns the last completed window, which ended at most one measurement duration
+ * before the read - the estimate is one measurement duration before the read, but not earlier than the midpoint of the
+ * first window after the start command.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] read_time_ms Time at which the raw measurement was read out.
+ *
+ * @return uint32_t Estimated midpoint in ms.
+ */
+static uint32_t get_window_mid_time_ms(BH1750 self, uint32_t read_time_ms)
+{
+    uint32_t duration_ms = get_meas_duration_ms(self->meas_mode, self->meas_time);
+    if (self->is_one_time_meas_seq) {
+        return self->one_time_cmd_time_ms + (duration_ms / 2);
+    }
+
+    uint32_t mid_time_ms = read_time_ms - duration_ms;
+    if (self->cont_meas_start_known) {
+        uint32_t first_mid_time_ms = self->cont_meas_start_time_ms + (duration_ms / 2);
+        /* Wraparound-safe comparison */
+        if ((int32_t)(mid_time_ms - first_mid_time_ms) < 0) {
+            mid_time_ms = first_mid_time_ms;
+        }
+    }
+    return mid_time_ms;
+}
+
+static void init_final_part(uint8_t result_code, void *user_data)
+{
+    BH1750 self = (BH1750)user_data;
+    if (!self) {
+        return;
+    }
+
+    if (result_code != BH1750_I2C_RESULT_CODE_OK) {
+        execute_complete_cb(self, BH1750_RESULT_CODE_IO_ERR);
+        return;
+    }
+
+    self->cont_meas_ongoing = true;
+    self->cont_meas_start_time_ms = get_time_ms(self);
+    self->cont_meas_start_known = true;
+    self->initialized = true;
+    execute_complete_cb(self, BH1750_RESULT_CODE_OK);
+}
+
 static void set_meas_time_part_3(uint8_t result_code, void *user_data)
 {
     BH1750 self = (BH1750)user_data;
@@ -447,6 +888,13 @@ static void set_meas_time_part_3(uint8_t result_code, void *user_data)
     }
 
     self->meas_time = self->meas_time_to_set;
+    if (self->start_cont_meas_after_init) {
+        /* Init sequence with a startup profile - starting continuous measurement is the last step, the initialized
+         * flag is set once that step is complete. */
+        self->start_cont_meas_after_init = false;
+        send_start_continuous_meas_cmd(self, self->meas_mode, init_final_part, (void *)self);
+        return;
+    }
     /* This function is the last part of two sequences: init sequence and set measurement time sequence. At the end of
      * successful init sequence, we need to set the initialized flag to true. In theory, we do not need to do it at the
      * end of the set measurement time sequence.
@@ -525,7 +973,27 @@ static void init_part_2(uint8_t result_code, void *user_data)
     set_meas_time_part_1(self, self->meas_time_to_set);
 }
 
-static void read_meas_final_part(uint8_t result_code, void *user_data)
+/**
+ * @brief Execute the callback of the ongoing recovery sequence.
+ *
+ * If the recovery was started automatically because a read failed, the read cb is executed with @ref
+ * BH1750_RESULT_CODE_IO_ERR - the measurement is lost regardless of the outcome of the recovery. Otherwise, the
+ * complete cb is executed with @p rc.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] rc Result code of the recovery.
+ */
+static void end_recovery(BH1750 self, uint8_t rc)
+{
+    if (self->is_recovering_after_read_err) {
+        self->is_recovering_after_read_err = false;
+        execute_read_err_cb(self, BH1750_RESULT_CODE_IO_ERR);
+    } else {
+        execute_complete_cb(self, rc);
+    }
+}
+
+static void recover_final_part(uint8_t result_code, void *user_data)
 {
     BH1750 self = (BH1750)user_data;
     if (!self) {
@@ -533,19 +1001,271 @@ static void read_meas_final_part(uint8_t result_code, void *user_data)
     }
 
     if (result_code != BH1750_I2C_RESULT_CODE_OK) {
-        execute_complete_cb(self, BH1750_RESULT_CODE_IO_ERR);
+        end_recovery(self, BH1750_RESULT_CODE_IO_ERR);
         return;
     }
 
-    uint16_t raw_meas = two_big_endian_bytes_to_uint16(self->read_buf);
-    uint8_t rc = convert_raw_meas_to_lx(self, raw_meas, self->meas_p);
-    if (rc != BH1750_RESULT_CODE_OK) {
-        /* self->meas_time is 0, this should never happen */
-        execute_complete_cb(self, BH1750_RESULT_CODE_DRIVER_ERR);
+    if (self->cont_meas_ongoing) {
+        self->cont_meas_start_time_ms = get_time_ms(self);
+        self->cont_meas_start_known = true;
+    }
+    end_recovery(self, BH1750_RESULT_CODE_OK);
+}
+
+static void recover_part_4(uint8_t result_code, void *user_data)
+{
+    BH1750 self = (BH1750)user_data;
+    if (!self) {
         return;
     }
 
-    execute_complete_cb(self, BH1750_RESULT_CODE_OK);
+    if (result_code != BH1750_I2C_RESULT_CODE_OK) {
+        end_recovery(self, BH1750_RESULT_CODE_IO_ERR);
+        return;
+    }
+
+    if (self->cont_meas_ongoing) {
+        send_start_continuous_meas_cmd(self, self->meas_mode, recover_final_part, (void *)self);
+    } else {
+        recover_final_part(BH1750_I2C_RESULT_CODE_OK, (void *)self);
+    }
+}
+
+static void recover_part_3(uint8_t result_code, void *user_data)
+{
+    BH1750 self = (BH1750)user_data;
+    if (!self) {
+        return;
+    }
+
+    if (result_code != BH1750_I2C_RESULT_CODE_OK) {
+        end_recovery(self, BH1750_RESULT_CODE_IO_ERR);
+        return;
+    }
+
+    /* Ignore return value - meas_time is always valid once the instance is initialized */
+    set_mtreg_low_bit(self, get_five_lsb_of_meas_time(self->meas_time), recover_part_4, (void *)self);
+}
+
+static void recover_part_2(uint8_t result_code, void *user_data)
+{
+    BH1750 self = (BH1750)user_data;
+    if (!self) {
+        return;
+    }
+
+    if (result_code != BH1750_I2C_RESULT_CODE_OK) {
+        end_recovery(self, BH1750_RESULT_CODE_IO_ERR);
+        return;
+    }
+
+    /* Ignore return value - meas_time is always valid once the instance is initialized */
+    set_mtreg_high_bit(self, get_three_msb_of_meas_time(self->meas_time), recover_part_3, (void *)self);
+}
+
+/**
+ * @brief Initiate the first operation of the recovery sequence.
+ *
+ * Replays the state of the instance to the sensor: power on, both halves of Mtreg, and the continuous measurement mode
+ * if continuous measurement is ongoing. The state of the instance is not modified.
+ *
+ * @param[in] self BH1750 instance.
+ */
+static void recover_part_1(BH1750 self)
+{
+    send_power_on_cmd(self, recover_part_2, (void *)self);
+}
+
+/**
+ * @brief End a read sequence because an I2C transaction failed.
+ *
+ * If auto recovery is enabled, runs the recovery sequence first, as a part of the same sequence.
+ *
+ * @param[in] self BH1750 instance.
+ */
+static void fail_read_with_io_err(BH1750 self)
+{
+    self->is_preview_pending = false;
+    if (self->auto_recover) {
+        self->is_recovering_after_read_err = true;
+        recover_part_1(self);
+        return;
+    }
+    execute_read_err_cb(self, BH1750_RESULT_CODE_IO_ERR);
+}
+
+static void read_one_time_meas_part_2(uint8_t result_code, void *user_data);
+static void read_meas_final_part(uint8_t result_code, void *user_data);
+
+static void read_cont_meas_next_sample(void *user_data)
+{
+    BH1750 self = (BH1750)user_data;
+    if (!self) {
+        return;
+    }
+
+    send_read_meas_cmd(self, read_meas_final_part, (void *)self);
+}
+
+/**
+ * @brief Start taking the next raw measurement for the decimator.
+ *
+ * In continuous measurement, waits until the sensor completes the next measurement, and then reads it out. In one
+ * time measurement, starts a new one time measurement. Either way, the sequence ends up in read_meas_final_part again.
+ *
+ * @param[in] self BH1750 instance.
+ */
+static void take_next_decimator_sample(BH1750 self)
+{
+    if (self->is_one_time_meas_seq) {
+        send_one_time_meas_cmd(self, self->meas_mode, read_one_time_meas_part_2, (void *)self);
+    } else {
+        self->start_timer(get_meas_duration_ms(self->meas_mode, self->meas_time), self->start_timer_user_data,
+                          read_cont_meas_next_sample, (void *)self);
+    }
+}
+
+/**
+ * @brief Populate a measurement that was taken with the current measurement mode and time.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] raw_meas Raw measurement.
+ * @param[in] mid_time_ms Estimated midpoint of the integration window of @p raw_meas.
+ * @param[in] read_time_ms Time at which @p raw_meas was read out.
+ * @param[out] meas Measurement.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_DRIVER_ERR self->meas_time is 0, this should never happen.
+ */
+static uint8_t fill_meas(BH1750 self, uint16_t raw_meas, uint32_t mid_time_ms, uint32_t read_time_ms,
+                         BH1750Measurement *const meas)
+{
+    meas->raw_meas = raw_meas;
+    meas->meas_mode = self->meas_mode;
+    meas->meas_time = self->meas_time;
+    meas->mid_time_ms = mid_time_ms;
+    meas->read_time_ms = read_time_ms;
+    if (convert_raw_meas_to_lx(self, raw_meas, &meas->meas_lx) != BH1750_RESULT_CODE_OK) {
+        return BH1750_RESULT_CODE_DRIVER_ERR;
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+/**
+ * @brief Store a measurement of a burst, and start the next one time measurement right away, if any.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] raw_meas Raw measurement.
+ * @param[in] mid_time_ms Estimated midpoint of the integration window of @p raw_meas.
+ * @param[in] read_time_ms Time at which @p raw_meas was read out.
+ */
+static void store_burst_meas(BH1750 self, uint16_t raw_meas, uint32_t mid_time_ms, uint32_t read_time_ms)
+{
+    if (fill_meas(self, raw_meas, mid_time_ms, read_time_ms, &self->burst_meas[self->burst_num_done]) !=
+        BH1750_RESULT_CODE_OK) {
+        execute_burst_cb(self, BH1750_RESULT_CODE_DRIVER_ERR);
+        return;
+    }
+    self->burst_num_done++;
+    if (self->burst_num_done < self->burst_len) {
+        send_one_time_meas_cmd(self, self->meas_mode, read_one_time_meas_part_2, (void *)self);
+        return;
+    }
+    execute_burst_cb(self, BH1750_RESULT_CODE_OK);
+}
+
+/**
+ * @brief Execute the preview cb with the L-resolution measurement of a progressive read sequence, and start the refined
+ * one time measurement.
+ *
+ * The preview bypasses the decimator, change notification and the measurement processor - those are applied to the
+ * refined measurement only.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] raw_meas Raw L-resolution measurement.
+ * @param[in] mid_time_ms Estimated midpoint of the integration window of @p raw_meas.
+ * @param[in] read_time_ms Time at which @p raw_meas was read out.
+ */
+static void deliver_preview(BH1750 self, uint16_t raw_meas, uint32_t mid_time_ms, uint32_t read_time_ms)
+{
+    self->is_preview_pending = false;
+
+    BH1750Measurement meas;
+    if (fill_meas(self, raw_meas, mid_time_ms, read_time_ms, &meas) != BH1750_RESULT_CODE_OK) {
+        execute_read_cb(self, BH1750_RESULT_CODE_DRIVER_ERR, NULL);
+        return;
+    }
+
+    /* The sequence is still ongoing, so the preview cb cannot start another sequence */
+    BH1750ReadCb preview_cb = (BH1750ReadCb)self->preview_cb;
+    if (preview_cb) {
+        preview_cb(BH1750_RESULT_CODE_OK, &meas, self->preview_cb_user_data);
+    }
+
+    self->meas_mode = self->refined_meas_mode;
+    send_one_time_meas_cmd(self, self->meas_mode, read_one_time_meas_part_2, (void *)self);
+}
+
+static void read_meas_final_part(uint8_t result_code, void *user_data)
+{
+    BH1750 self = (BH1750)user_data;
+    if (!self) {
+        return;
+    }
+
+    if (result_code != BH1750_I2C_RESULT_CODE_OK) {
+        fail_read_with_io_err(self);
+        return;
+    }
+
+    self->counters.num_samples++;
+    uint16_t raw_meas = two_big_endian_bytes_to_uint16(self->read_buf);
+    uint32_t read_time_ms = get_time_ms(self);
+    uint32_t mid_time_ms = self->get_time ? get_window_mid_time_ms(self, read_time_ms) : 0;
+    if (self->is_preview_pending) {
+        deliver_preview(self, raw_meas, mid_time_ms, read_time_ms);
+        return;
+    }
+    if (self->is_burst_seq) {
+        store_burst_meas(self, raw_meas, mid_time_ms, read_time_ms);
+        return;
+    }
+    if (self->dec_factor > 1) {
+        if (self->dec_num_samples == 0) {
+            self->first_mid_time_ms = mid_time_ms;
+        }
+        self->dec_samples[self->dec_num_samples] = raw_meas;
+        self->dec_num_samples++;
+        if (self->dec_num_samples < self->dec_factor) {
+            take_next_decimator_sample(self);
+            return;
+        }
+        raw_meas = get_decimator_output(self);
+        mid_time_ms = self->first_mid_time_ms + ((mid_time_ms - self->first_mid_time_ms) / 2);
+    }
+
+    if (self->notify_enabled && !is_meaningful_change(self, raw_meas)) {
+        /* No meaningful change - complete the read without converting the measurement */
+        self->counters.num_suppressed++;
+        execute_read_cb(self, BH1750_RESULT_CODE_SUPPRESSED, NULL);
+        return;
+    }
+
+    /* Measurement lives on the stack - it is only valid during the execution of the read cb */
+    BH1750Measurement meas;
+    if (fill_meas(self, raw_meas, mid_time_ms, read_time_ms, &meas) != BH1750_RESULT_CODE_OK) {
+        execute_read_cb(self, BH1750_RESULT_CODE_DRIVER_ERR, NULL);
+        return;
+    }
+
+    if (self->process_meas && !self->process_meas(&meas, self->process_meas_user_data)) {
+        /* Measurement dropped by the processor */
+        self->counters.num_suppressed++;
+        execute_read_cb(self, BH1750_RESULT_CODE_SUPPRESSED, NULL);
+        return;
+    }
+
+    execute_read_cb(self, BH1750_RESULT_CODE_OK, &meas);
 }
 
 static void start_continuous_measurement_part_2(uint8_t result_code, void *user_data)
@@ -559,6 +1279,8 @@ static void start_continuous_measurement_part_2(uint8_t result_code, void *user_
     if (result_code == BH1750_I2C_RESULT_CODE_OK) {
         rc = BH1750_RESULT_CODE_OK;
         self->cont_meas_ongoing = true;
+        self->cont_meas_start_time_ms = get_time_ms(self);
+        self->cont_meas_start_known = true;
     } else {
         rc = BH1750_RESULT_CODE_IO_ERR;
     }
@@ -583,24 +1305,13 @@ static void read_one_time_meas_part_2(uint8_t result_code, void *user_data)
     }
 
     if (result_code != BH1750_I2C_RESULT_CODE_OK) {
-        execute_complete_cb(self, BH1750_RESULT_CODE_IO_ERR);
+        fail_read_with_io_err(self);
         return;
     }
 
-    uint32_t timer_period_base =
-        (self->meas_mode == BH1750_MEAS_MODE_L_RES) ? BH1750_MAX_L_RES_MEAS_TIME_MS : BH1750_MAX_H_RES_MEAS_TIME_MS;
-    /* Time we need to wait depends on the meas time currently set in Mtreg. We keep a RAM copy of that value in
-     * self->meas_time. The higher self->meas_time, the longer it will take to make a measurement.
-     * For example: Meas time in Mtreg is 138. Default meas time is 69. 138/69 = 2. This means that we should wait twice
-     * as long compared to if meas time were 69.
-     * It takes 180 ms to make a measurement in high res mode when meas time in Mtreg is 69. This means that we should
-     * wait for 180 * 2 = 360 ms - that's how long it will take to make a measurement when meas time in Mtreg is 138.
-     * The logic for low res mode is the same, but we use 24 ms instead of 180 ms, since it takes 24 ms to take a
-     * measurement in low res mode when meas time in Mtreg is 69. */
-    float timer_period_multiplier = ((float)self->meas_time) / BH1750_DEFAULT_MEAS_TIME;
-    /* Ceil timer period instead of rounding to be sure that measurement is ready after timer expires */
-    uint32_t timer_period = ceilf(timer_period_base * timer_period_multiplier);
-    self->start_timer(timer_period, self->start_timer_user_data, read_one_time_meas_part_3, (void *)self);
+    self->one_time_cmd_time_ms = get_time_ms(self);
+    self->start_timer(get_meas_duration_ms(self->meas_mode, self->meas_time), self->start_timer_user_data,
+                      read_one_time_meas_part_3, (void *)self);
 }
 
 uint8_t bh1750_create(BH1750 *const inst, const BH1750InitConfig *const cfg)
@@ -620,6 +1331,8 @@ uint8_t bh1750_create(BH1750 *const inst, const BH1750InitConfig *const cfg)
     (*inst)->i2c_read_user_data = cfg->i2c_read_user_data;
     (*inst)->start_timer = cfg->start_timer;
     (*inst)->start_timer_user_data = cfg->start_timer_user_data;
+    (*inst)->get_time = cfg->get_time;
+    (*inst)->get_time_user_data = cfg->get_time_user_data;
     (*inst)->i2c_addr = cfg->i2c_addr;
     (*inst)->cont_meas_ongoing = false;
     /* Will be populated during init where we set the default measurement time (69). Initialized here as a safety
@@ -627,13 +1340,41 @@ uint8_t bh1750_create(BH1750 *const inst, const BH1750InitConfig *const cfg)
     (*inst)->meas_time = 0;
     (*inst)->initialized = false;
     (*inst)->is_seq_ongoing = false;
+    (*inst)->start_cont_meas_after_init = false;
+    (*inst)->dec_type = BH1750_DECIMATOR_TYPE_BOXCAR;
+    /* Decimation disabled by default */
+    (*inst)->dec_factor = 1;
+    (*inst)->dec_num_samples = 0;
+    (*inst)->is_one_time_meas_seq = false;
+    (*inst)->is_preview_pending = false;
+    (*inst)->is_burst_seq = false;
+    (*inst)->burst_meas = NULL;
+    (*inst)->burst_len = 0;
+    (*inst)->burst_num_done = 0;
+    (*inst)->refined_meas_mode = BH1750_MEAS_MODE_H_RES;
+    (*inst)->preview_cb = NULL;
+    (*inst)->preview_cb_user_data = NULL;
+    (*inst)->process_meas = NULL;
+    (*inst)->process_meas_user_data = NULL;
+    (*inst)->notify_enabled = false;
+    (*inst)->cont_meas_start_time_ms = 0;
+    (*inst)->cont_meas_start_known = false;
+    (*inst)->one_time_cmd_time_ms = 0;
+    (*inst)->first_mid_time_ms = 0;
+    (*inst)->auto_recover = false;
+    (*inst)->is_recovering_after_read_err = false;
+    (*inst)->i2c_cb = NULL;
+    (*inst)->i2c_cb_user_data = NULL;
+    (*inst)->i2c_start_time_ms = 0;
+    BH1750Counters zero_counters = {0};
+    (*inst)->counters = zero_counters;
 
     return BH1750_RESULT_CODE_OK;
 }
 
-uint8_t bh1750_init(BH1750 self, BH1750CompleteCb cb, void *user_data)
+uint8_t bh1750_init(BH1750 self, const BH1750StartupProfile *const profile, BH1750CompleteCb cb, void *user_data)
 {
-    if (!self) {
+    if (!self || (profile && !is_valid_startup_profile(profile))) {
         return BH1750_RESULT_CODE_INVALID_ARG;
     }
     if (self->initialized) {
@@ -642,7 +1383,18 @@ uint8_t bh1750_init(BH1750 self, BH1750CompleteCb cb, void *user_data)
     }
 
     start_sequence(self, (void *)cb, user_data);
-    self->meas_time_to_set = BH1750_DEFAULT_MEAS_TIME;
+    if (profile) {
+        self->meas_time_to_set = profile->meas_time;
+        self->start_cont_meas_after_init = profile->start_continuous_meas;
+        if (profile->start_continuous_meas) {
+            /* So that the last part of the init sequence knows which command to send, and subsequent calls to
+             * bh1750_read_continuous_measurement can correctly convert raw measurement to lx. */
+            self->meas_mode = profile->meas_mode;
+        }
+    } else {
+        self->meas_time_to_set = BH1750_DEFAULT_MEAS_TIME;
+        self->start_cont_meas_after_init = false;
+    }
     send_power_on_cmd(self, init_part_2, (void *)self);
     return BH1750_RESULT_CODE_OK;
 }
@@ -656,6 +1408,7 @@ uint8_t bh1750_power_on(BH1750 self, BH1750CompleteCb cb, void *user_data)
         return BH1750_RESULT_CODE_INVALID_USAGE;
     }
     if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
         return BH1750_RESULT_CODE_BUSY;
     }
 
@@ -673,6 +1426,7 @@ uint8_t bh1750_power_down(BH1750 self, BH1750CompleteCb cb, void *user_data)
         return BH1750_RESULT_CODE_INVALID_USAGE;
     }
     if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
         return BH1750_RESULT_CODE_BUSY;
     }
 
@@ -690,6 +1444,7 @@ uint8_t bh1750_reset(BH1750 self, BH1750CompleteCb cb, void *user_data)
         return BH1750_RESULT_CODE_INVALID_USAGE;
     }
     if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
         return BH1750_RESULT_CODE_BUSY;
     }
 
@@ -707,6 +1462,7 @@ uint8_t bh1750_start_continuous_measurement(BH1750 self, uint8_t meas_mode, BH17
         return BH1750_RESULT_CODE_INVALID_USAGE;
     }
     if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
         return BH1750_RESULT_CODE_BUSY;
     }
 
@@ -716,9 +1472,9 @@ uint8_t bh1750_start_continuous_measurement(BH1750 self, uint8_t meas_mode, BH17
     return BH1750_RESULT_CODE_OK;
 }
 
-uint8_t bh1750_read_continuous_measurement(BH1750 self, uint32_t *const meas_lx, BH1750CompleteCb cb, void *user_data)
+uint8_t bh1750_read_continuous_measurement(BH1750 self, BH1750ReadCb cb, void *user_data)
 {
-    if (!self || !meas_lx) {
+    if (!self) {
         return BH1750_RESULT_CODE_INVALID_ARG;
     }
     /* Technically, initialized check is not necessary, because cont_meas_ongoing can become true only when the instance
@@ -727,33 +1483,88 @@ uint8_t bh1750_read_continuous_measurement(BH1750 self, uint32_t *const meas_lx,
         return BH1750_RESULT_CODE_INVALID_USAGE;
     }
     if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
         return BH1750_RESULT_CODE_BUSY;
     }
 
     start_sequence(self, (void *)cb, user_data);
-    self->meas_p = meas_lx;
+    self->dec_num_samples = 0;
+    self->is_one_time_meas_seq = false;
     send_read_meas_cmd(self, read_meas_final_part, (void *)self);
     return BH1750_RESULT_CODE_OK;
 }
 
-uint8_t bh1750_read_one_time_measurement(BH1750 self, uint8_t meas_mode, uint32_t *const meas_lx, BH1750CompleteCb cb,
-                                         void *user_data)
+uint8_t bh1750_read_one_time_measurement(BH1750 self, uint8_t meas_mode, BH1750ReadCb cb, void *user_data)
 {
-    if (!self || !meas_lx || !is_valid_meas_mode(meas_mode)) {
+    if (!self || !is_valid_meas_mode(meas_mode)) {
         return BH1750_RESULT_CODE_INVALID_ARG;
     }
     if (!self->initialized) {
         return BH1750_RESULT_CODE_INVALID_USAGE;
     }
     if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
         return BH1750_RESULT_CODE_BUSY;
     }
 
     start_sequence(self, (void *)cb, user_data);
-    /* So that the last part of the sequence can write the result to meas_lx */
-    self->meas_p = meas_lx;
     /* So that the last part of the sequence can convert raw measurement to lx (mapping depends on meas mode) */
     self->meas_mode = meas_mode;
+    self->dec_num_samples = 0;
+    self->is_one_time_meas_seq = true;
+    send_one_time_meas_cmd(self, meas_mode, read_one_time_meas_part_2, (void *)self);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_read_progressive_measurement(BH1750 self, uint8_t meas_mode, BH1750ReadCb preview_cb,
+                                            void *preview_user_data, BH1750ReadCb cb, void *user_data)
+{
+    if (!self || ((meas_mode != BH1750_MEAS_MODE_H_RES) && (meas_mode != BH1750_MEAS_MODE_H_RES2))) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (!self->initialized) {
+        return BH1750_RESULT_CODE_INVALID_USAGE;
+    }
+    if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    start_sequence(self, (void *)cb, user_data);
+    self->preview_cb = (void *)preview_cb;
+    self->preview_cb_user_data = preview_user_data;
+    self->refined_meas_mode = meas_mode;
+    self->is_preview_pending = true;
+    /* The preview is taken in L-resolution mode, the refined measurement in meas_mode */
+    self->meas_mode = BH1750_MEAS_MODE_L_RES;
+    self->dec_num_samples = 0;
+    self->is_one_time_meas_seq = true;
+    send_one_time_meas_cmd(self, self->meas_mode, read_one_time_meas_part_2, (void *)self);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_read_one_time_burst(BH1750 self, uint8_t meas_mode, BH1750Measurement *const meas, size_t num_meas,
+                                   BH1750BurstCb cb, void *user_data)
+{
+    if (!self || !is_valid_meas_mode(meas_mode) || !meas || (num_meas == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (!self->initialized) {
+        return BH1750_RESULT_CODE_INVALID_USAGE;
+    }
+    if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    start_sequence(self, (void *)cb, user_data);
+    self->is_burst_seq = true;
+    self->burst_meas = meas;
+    self->burst_len = num_meas;
+    self->burst_num_done = 0;
+    self->meas_mode = meas_mode;
+    self->dec_num_samples = 0;
+    self->is_one_time_meas_seq = true;
     send_one_time_meas_cmd(self, meas_mode, read_one_time_meas_part_2, (void *)self);
     return BH1750_RESULT_CODE_OK;
 }
@@ -767,6 +1578,7 @@ uint8_t bh1750_set_measurement_time(BH1750 self, uint8_t meas_time, BH1750Comple
         return BH1750_RESULT_CODE_INVALID_USAGE;
     }
     if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
         return BH1750_RESULT_CODE_BUSY;
     }
 
@@ -775,12 +1587,180 @@ uint8_t bh1750_set_measurement_time(BH1750 self, uint8_t meas_time, BH1750Comple
     return BH1750_RESULT_CODE_OK;
 }
 
+uint8_t bh1750_get_state_snapshot(BH1750 self, BH1750StateSnapshot *const snapshot)
+{
+    if (!self || !snapshot) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    snapshot->initialized = self->initialized;
+    snapshot->meas_time = self->meas_time;
+    snapshot->meas_mode = self->meas_mode;
+    snapshot->cont_meas_ongoing = self->cont_meas_ongoing;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_attach(BH1750 self, const BH1750StateSnapshot *const snapshot)
+{
+    if (!self || !snapshot || !is_valid_state_snapshot(snapshot)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (self->initialized) {
+        return BH1750_RESULT_CODE_INVALID_USAGE;
+    }
+    if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    self->meas_time = snapshot->meas_time;
+    self->meas_mode = snapshot->meas_mode;
+    self->cont_meas_ongoing = snapshot->cont_meas_ongoing;
+    /* Continuous measurement might have been started by another process, at an unknown time */
+    self->cont_meas_start_known = false;
+    self->initialized = true;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_recover(BH1750 self, BH1750CompleteCb cb, void *user_data)
+{
+    if (!self) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (!self->initialized) {
+        /* Nothing to restore */
+        return BH1750_RESULT_CODE_INVALID_USAGE;
+    }
+    if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    start_sequence(self, (void *)cb, user_data);
+    self->is_recovering_after_read_err = false;
+    recover_part_1(self);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_set_auto_recover(BH1750 self, bool enable)
+{
+    if (!self) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    self->auto_recover = enable;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_get_counters(BH1750 self, BH1750Counters *const counters)
+{
+    if (!self || !counters) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    *counters = self->counters;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_set_decimator(BH1750 self, uint8_t type, uint8_t factor)
+{
+    if (!self || !is_valid_decimator_type(type) || (factor == 0) || (factor > BH1750_MAX_DECIMATION_FACTOR)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    self->dec_type = type;
+    self->dec_factor = factor;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_set_meas_processor(BH1750 self, BH1750ProcessMeas process_meas, void *user_data)
+{
+    if (!self) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    self->process_meas = process_meas;
+    self->process_meas_user_data = user_data;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_set_change_notify(BH1750 self, const BH1750ChangeNotifyConfig *const cfg)
+{
+    if (!self || (cfg && (cfg->low_lx >= cfg->high_lx))) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    if (!cfg) {
+        self->notify_enabled = false;
+        return BH1750_RESULT_CODE_OK;
+    }
+    self->notify_low_lx = cfg->low_lx;
+    self->notify_high_lx = cfg->high_lx;
+    self->notify_deadband_lx = cfg->deadband_lx;
+    /* Raw thresholds are computed when the next measurement is evaluated, since the measurement mode of the next
+     * measurement is not known yet */
+    self->notify_meas_time = 0;
+    self->notify_enabled = true;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_get_lx_per_count(uint8_t meas_mode, uint8_t meas_time, float *const lx_per_count)
+{
+    if (!lx_per_count || !is_valid_meas_mode(meas_mode) || !is_valid_meas_time(meas_time)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    return get_lx_per_count(meas_mode, meas_time, lx_per_count);
+}
+
+uint8_t bh1750_get_meas_duration_ms(uint8_t meas_mode, uint8_t meas_time, uint32_t *const duration_ms)
+{
+    if (!duration_ms || !is_valid_meas_mode(meas_mode) || !is_valid_meas_time(meas_time)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    *duration_ms = get_meas_duration_ms(meas_mode, meas_time);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_get_max_burst_rate_mhz(uint8_t meas_mode, uint8_t meas_time, uint32_t *const rate_mhz)
+{
+    if (!rate_mhz || !is_valid_meas_mode(meas_mode) || !is_valid_meas_time(meas_time)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    /* Measurement duration is at least 11 ms for valid measurement times, no division by 0 */
+    *rate_mhz = 1000000UL / get_meas_duration_ms(meas_mode, meas_time);
+    return BH1750_RESULT_CODE_OK;
+}
+
 uint8_t bh1750_destroy(BH1750 self, BH1750FreeInstanceMemory free_instance_memory, void *user_data)
 {
     if (!self) {
         return BH1750_RESULT_CODE_INVALID_ARG;
     }
     if (self->is_seq_ongoing) {
+        self->counters.num_busy++;
         return BH1750_RESULT_CODE_BUSY;
     }
 
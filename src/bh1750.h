@@ -76,6 +76,9 @@ typedef enum {
     BH1750_RESULT_CODE_DRIVER_ERR,
     BH1750_RESULT_CODE_INVALID_USAGE,
     BH1750_RESULT_CODE_BUSY,
+    /** The read succeeded, but the measurement was suppressed by change notification or dropped by the measurement
+     * processor. The read callback receives NULL instead of the measurement. */
+    BH1750_RESULT_CODE_SUPPRESSED,
 } BH1750ResultCode;
 
 typedef enum {
@@ -84,6 +87,87 @@ typedef enum {
     BH1750_MEAS_MODE_L_RES,
 } BH1750MeasMode;
 
+/** Decimator types. See @ref bh1750_set_decimator. */
+typedef enum {
+    /** Average of N raw measurements, rounded to the nearest integer. This is also what a first order CIC decimator
+     * computes. */
+    BH1750_DECIMATOR_TYPE_BOXCAR = 0,
+    /** Median of N raw measurements. Rejects short spikes, e.g. caused by flickering light sources. If N is even, the
+     * two middle values are averaged. */
+    BH1750_DECIMATOR_TYPE_MEDIAN,
+} BH1750DecimatorType;
+
+/**
+ * @brief Callback type to execute when the BH1750 driver finishes reading out a measurement.
+ *
+ * @param result_code Indicates success or the reason for failure. One of @ref BH1750ResultCode.
+ * @param meas Measurement that was read out. Only valid during the execution of this callback - copy the fields that
+ * are needed afterwards. NULL if @p result_code is not @ref BH1750_RESULT_CODE_OK.
+ * @param user_data User data.
+ */
+typedef void (*BH1750ReadCb)(uint8_t result_code, const BH1750Measurement *meas, void *user_data);
+
+/**
+ * @brief Callback type to execute when a burst of one time measurements is complete. See @ref
+ * bh1750_read_one_time_burst.
+ *
+ * @param result_code Indicates success or the reason for failure. One of @ref BH1750ResultCode.
+ * @param num_meas Number of measurements written to the array passed to @ref bh1750_read_one_time_burst. Less than
+ * the requested number if @p result_code is not @ref BH1750_RESULT_CODE_OK.
+ * @param user_data User data.
+ */
+typedef void (*BH1750BurstCb)(uint8_t result_code, size_t num_meas, void *user_data);
+
+/**
+ * @brief Startup profile that can optionally be passed to @ref bh1750_init.
+ *
+ * Allows to apply the target measurement time and measurement mode as a part of the init sequence, instead of calling
+ * @ref bh1750_set_measurement_time and @ref bh1750_start_continuous_measurement after init is complete.
+ */
+typedef struct {
+    /** Measurement time to set in Mtreg. According to the datasheet: 31 <= meas_time <= 254. */
+    uint8_t meas_time;
+    /** Whether to start continuous measurement at the end of the init sequence. */
+    bool start_continuous_meas;
+    /** Continuous measurement mode. One of @ref BH1750MeasMode. Ignored if start_continuous_meas is false. */
+    uint8_t meas_mode;
+} BH1750StartupProfile;
+
+/**
+ * @brief Snapshot of the state of a BH1750 instance.
+ *
+ * Obtained with @ref bh1750_get_state_snapshot and restored with @ref bh1750_attach. The snapshot contains plain values
+ * only, so it can be persisted (e.g. to retained RAM or to a file) and restored by another process or after a reset of
+ * the host.
+ */
+typedef struct {
+    /** Whether the instance is initialized. */
+    bool initialized;
+    /** Measurement time that is set in Mtreg. */
+    uint8_t meas_time;
+    /** Last used measurement mode. One of @ref BH1750MeasMode. */
+    uint8_t meas_mode;
+    /** Whether continuous measurement is ongoing. */
+    bool cont_meas_ongoing;
+} BH1750StateSnapshot;
+
+/**
+ * @brief Change notification config. See @ref bh1750_set_change_notify.
+ *
+ * To only use the deadband, set low_lx to 0 and high_lx to UINT32_MAX. To only use the thresholds, set deadband_lx to
+ * 0.
+ */
+typedef struct {
+    /** Notify when illuminance falls to or below this level. */
+    uint32_t low_lx;
+    /** Notify when illuminance rises to or above this level. Must be > low_lx. The range between low_lx and high_lx is
+     * the hysteresis band: measurements inside it do not trigger a threshold notification. */
+    uint32_t high_lx;
+    /** Notify when illuminance differs from the last notified measurement by at least this amount. 0 disables the
+     * deadband. */
+    uint32_t deadband_lx;
+} BH1750ChangeNotifyConfig;
+
 typedef struct {
     BH1750GetInstanceMemory get_instance_memory;
     void *get_instance_memory_user_data;
@@ -94,6 +178,9 @@ typedef struct {
     BH1750StartTimer start_timer;
     void *start_timer_user_data;
     uint8_t i2c_addr;
+    /** Optional, can be NULL. Used to timestamp measurements. */
+    BH1750GetTime get_time;
+    void *get_time_user_data;
 } BH1750InitConfig;
 
 /**
@@ -120,8 +207,13 @@ uint8_t bh1750_create(BH1750 *const inst, const BH1750InitConfig *const cfg);
  *
  * Performs the following steps:
  * 1. Powers on BH1750 (equivalent to calling @ref bh1750_power_on).
- * 2. Sets measurement time to 69 (default). Equivalent to calling @ref bh1750_set_measurement_time with "meas_time"
- * parameter equal to 69.
+ * 2. Sets measurement time to profile->meas_time, or to 69 (default) if @p profile is NULL. Equivalent to calling @ref
+ * bh1750_set_measurement_time.
+ * 3. Only if @p profile is not NULL and profile->start_continuous_meas is true: starts continuous measurement in
+ * profile->meas_mode. Equivalent to calling @ref bh1750_start_continuous_measurement.
+ *
+ * All steps are performed in one sequence, so passing a startup profile saves the application from waiting for
+ * completion of three separate sequences before the first measurement can be read out.
  *
  * Once the init sequence is complete, or an error occurs, @p cb is executed. "result_code" parameter of @p cb indicates
  * success or reason for failure of the init sequence:
@@ -130,14 +222,17 @@ uint8_t bh1750_create(BH1750 *const inst, const BH1750InitConfig *const cfg);
  * - @ref BH1750_RESULT_CODE_DRIVER_ERR Something went wrong with the code of this driver.
  *
  * @param[in] self BH1750 instance created by @ref bh1750_create.
+ * @param[in] profile Optional startup profile. Pass NULL to set the default measurement time and not start continuous
+ * measurement. The driver does not keep the pointer, the profile can be discarded after this function returns.
  * @param[in] cb Callback to execute once init is complete.
  * @param[in] user_data User data to pass to @p cb.
  *
  * @retval BH1750_RESULT_CODE_OK Successfully initiated the first step of init sequence.
- * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL, or @p profile contains an invalid measurement time or
+ * measurement mode.
  * @retval BH1750_RESULT_CODE_INVALID_USAGE Instance was already initialized.
  */
-uint8_t bh1750_init(BH1750 self, BH1750CompleteCb cb, void *user_data);
+uint8_t bh1750_init(BH1750 self, const BH1750StartupProfile *const profile, BH1750CompleteCb cb, void *user_data);
 
 /**
  * @brief Power on BH1750 device.
@@ -238,9 +333,9 @@ uint8_t bh1750_start_continuous_measurement(BH1750 self, uint8_t meas_mode, BH17
  * if continuous measurement is currently ongoing. Continuous measurement can be started by calling @ref
  * bh1750_start_continuous_measurement.
  *
- * If this function is called two times, and the measurement did not get updated in between the two calls, @p meas_lx
- * will have the same value for both calls. The rate at which the measurement gets updated depends on the measurement
- * mode passed to @ref bh1750_start_continuous_measurement and the measurement time set via @ref
+ * If this function is called two times, and the measurement did not get updated in between the two calls, @p cb
+ * will receive the same measurement for both calls. The rate at which the measurement gets updated depends on the
+ * measurement mode passed to @ref bh1750_start_continuous_measurement and the measurement time set via @ref
  * bh1750_set_measurement_time.
  *
  * Once the read continuous measurement sequence is complete, or an error occurs, @p cb is executed. "result_code"
@@ -250,17 +345,15 @@ uint8_t bh1750_start_continuous_measurement(BH1750 self, uint8_t meas_mode, BH17
  * - @ref BH1750_RESULT_CODE_DRIVER_ERR Something went wrong in the code of this driver.
  *
  * @param[in] self BH1750 instance created by @ref bh1750_create.
- * @param[out] meas_lx Resulting illuminance measurement in lx.
- * @param[in] cb Callback to execute once the measurement is read out. @p meas_lx has a valid value when this callback
- * is being executed, not before that.
+ * @param[in] cb Callback to execute once the measurement is read out. The measurement is passed to this callback.
  * @param[in] user_data User data to pass to @p cb.
  *
  * @retval BH1750_RESULT_CODE_OK Successfully initiated reading continuous measurement.
- * @retval BH1750_RESULT_CODE_INVALID_ARG @p self or @p meas_lx is NULL.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL.
  * @retval BH1750_RESULT_CODE_INVALID_USAGE Cannot read measurement, because continuous measurement is not ongoing.
  * @retval BH1750_RESULT_CODE_BUSY Failed, there is currently another sequence in progress.
  */
-uint8_t bh1750_read_continuous_measurement(BH1750 self, uint32_t *const meas_lx, BH1750CompleteCb cb, void *user_data);
+uint8_t bh1750_read_continuous_measurement(BH1750 self, BH1750ReadCb cb, void *user_data);
 
 /**
  * @brief Read one-time illuminance measurement in lx.
@@ -279,19 +372,87 @@ uint8_t bh1750_read_continuous_measurement(BH1750 self, uint32_t *const meas_lx,
  *
  * @param[in] self BH1750 instance created by @ref bh1750_create.
  * @param[in] meas_mode Measurement mode to use. Use one of @ref BH1750MeasMode.
- * @param[out] meas_lx Resulting illuminance measurement in lx.
- * @param[in] cb Callback to execute once the measurement is read out. @p meas_lx has a valid value when this callback
- * is being executed, not before that.
+ * @param[in] cb Callback to execute once the measurement is read out. The measurement is passed to this callback.
  * @param[in] user_data User data to pass to @p cb.
  *
  * @retval BH1750_RESULT_CODE_OK Successfully initiated reading a one-time measurement.
- * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL, @p meas_lx is NULL, or @p meas_mode is not a valid
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL, or @p meas_mode is not a valid measurement mode.
+ * @retval BH1750_RESULT_CODE_INVALID_USAGE Instance is not yet initialized, call @ref bh1750_init first.
+ * @retval BH1750_RESULT_CODE_BUSY Failed, there is currently another sequence in progress.
+ */
+uint8_t bh1750_read_one_time_measurement(BH1750 self, uint8_t meas_mode, BH1750ReadCb cb, void *user_data);
+
+/**
+ * @brief Read a fast L-resolution preview, followed by a refined one-time measurement in lx.
+ *
+ * Steps:
+ * 1. Perform a one-time measurement in L-resolution mode and pass it to @p preview_cb.
+ * 2. Right after @p preview_cb returns, perform a one-time measurement in @p meas_mode and pass it to @p cb.
+ *
+ * Both measurements use the currently set measurement time. With the default measurement time (69), the preview is
+ * available after 24 ms, and the refined measurement 180 ms later.
+ *
+ * The whole sequence is one sequence - while @p preview_cb is executed, other sequences cannot be started yet. The
+ * preview is passed to @p preview_cb as is. The decimator, change notification and the measurement processor are only
+ * applied to the refined measurement.
+ *
+ * Once the sequence described above is complete, or an error occurs, @p cb is executed. "result_code" parameter of @p
+ * cb indicates success or reason for failure:
+ * - @ref BH1750_RESULT_CODE_OK Successfully performed the progressive read sequence.
+ * - @ref BH1750_RESULT_CODE_IO_ERR One of the I2C transactions in the sequence failed. If it failed before the preview
+ * was read out, @p preview_cb is not executed.
+ * - @ref BH1750_RESULT_CODE_DRIVER_ERR Something went wrong in the code of this driver.
+ *
+ * @param[in] self BH1750 instance created by @ref bh1750_create.
+ * @param[in] meas_mode Measurement mode of the refined measurement. @ref BH1750_MEAS_MODE_H_RES or @ref
+ * BH1750_MEAS_MODE_H_RES2.
+ * @param[in] preview_cb Callback to execute with the preview. Only executed with @ref BH1750_RESULT_CODE_OK. Can be
+ * NULL.
+ * @param[in] preview_user_data User data to pass to @p preview_cb.
+ * @param[in] cb Callback to execute once the refined measurement is read out, or an error occurs.
+ * @param[in] user_data User data to pass to @p cb.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initiated the progressive read sequence.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL, or @p meas_mode is not an H-resolution mode.
+ * @retval BH1750_RESULT_CODE_INVALID_USAGE Instance is not yet initialized, call @ref bh1750_init first.
+ * @retval BH1750_RESULT_CODE_BUSY Failed, there is currently another sequence in progress.
+ */
+uint8_t bh1750_read_progressive_measurement(BH1750 self, uint8_t meas_mode, BH1750ReadCb preview_cb,
+                                            void *preview_user_data, BH1750ReadCb cb, void *user_data);
+
+/**
+ * @brief Read a burst of one-time measurements back to back.
+ *
+ * Performs @p num_meas one-time measurements in @p meas_mode. The one-time measurement command of the next measurement
+ * is sent right after the previous measurement is read out, as a part of the same sequence, so there is no idle time
+ * between the measurements apart from the I2C transactions. The sensor powers down after the last measurement, as after
+ * every one-time measurement.
+ *
+ * Every measurement is written to @p meas as is. The decimator, change notification and the measurement processor are
+ * not applied.
+ *
+ * Once all measurements are read out, or an error occurs, @p cb is executed. "result_code" parameter of @p cb
+ * indicates success or reason for failure:
+ * - @ref BH1750_RESULT_CODE_OK Successfully performed all measurements.
+ * - @ref BH1750_RESULT_CODE_IO_ERR One of the I2C transactions failed. The measurements before the failed one are
+ * valid.
+ * - @ref BH1750_RESULT_CODE_DRIVER_ERR Something went wrong in the code of this driver.
+ *
+ * @param[in] self BH1750 instance created by @ref bh1750_create.
+ * @param[in] meas_mode Measurement mode to use. Use one of @ref BH1750MeasMode.
+ * @param[out] meas Measurements are written to this array. Must stay valid until @p cb is executed.
+ * @param[in] num_meas Number of measurements to perform. Number of elements in @p meas.
+ * @param[in] cb Callback to execute once the burst is complete.
+ * @param[in] user_data User data to pass to @p cb.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initiated the burst.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self or @p meas is NULL, @p num_meas is 0, or @p meas_mode is not a valid
  * measurement mode.
  * @retval BH1750_RESULT_CODE_INVALID_USAGE Instance is not yet initialized, call @ref bh1750_init first.
  * @retval BH1750_RESULT_CODE_BUSY Failed, there is currently another sequence in progress.
  */
-uint8_t bh1750_read_one_time_measurement(BH1750 self, uint8_t meas_mode, uint32_t *const meas_lx, BH1750CompleteCb cb,
-                                         void *user_data);
+uint8_t bh1750_read_one_time_burst(BH1750 self, uint8_t meas_mode, BH1750Measurement *const meas, size_t num_meas,
+                                   BH1750BurstCb cb, void *user_data);
 
 /**
  * @brief Set measurement time.
@@ -332,6 +493,234 @@ uint8_t bh1750_read_one_time_measurement(BH1750 self, uint8_t meas_mode, uint32_
  */
 uint8_t bh1750_set_measurement_time(BH1750 self, uint8_t meas_time, BH1750CompleteCb cb, void *user_data);
 
+/**
+ * @brief Get a snapshot of the state of a BH1750 instance.
+ *
+ * The snapshot can later be passed to @ref bh1750_attach to resume using a sensor that is still configured, without
+ * re-initializing it. This does not perform any I2C transactions.
+ *
+ * @param[in] self BH1750 instance created by @ref bh1750_create.
+ * @param[out] snapshot The state snapshot is written here in case of success.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully got the state snapshot.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self or @p snapshot is NULL.
+ * @retval BH1750_RESULT_CODE_BUSY Failed, there is currently a sequence in progress. The state might change once the
+ * sequence is complete.
+ */
+uint8_t bh1750_get_state_snapshot(BH1750 self, BH1750StateSnapshot *const snapshot);
+
+/**
+ * @brief Attach a BH1750 instance to a sensor that is already configured.
+ *
+ * Can be called instead of @ref bh1750_init. Restores the state of the instance from @p snapshot, which was earlier
+ * obtained with @ref bh1750_get_state_snapshot. This does not perform any I2C transactions. If the sensor is still
+ * performing continuous measurement, the ongoing measurement is not interrupted, and @ref
+ * bh1750_read_continuous_measurement can be called right away.
+ *
+ * It is the responsibility of the caller to make sure that the sensor state matches @p snapshot. This is the case if
+ * the sensor stayed powered and no commands were sent to it since the snapshot was taken. If that is not the case, use
+ * @ref bh1750_init instead.
+ *
+ * @param[in] self BH1750 instance created by @ref bh1750_create.
+ * @param[in] snapshot State snapshot to restore.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully attached.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self or @p snapshot is NULL, or @p snapshot is not a snapshot of an
+ * initialized instance, contains an invalid measurement time, or contains an invalid measurement mode while continuous
+ * measurement is ongoing.
+ * @retval BH1750_RESULT_CODE_INVALID_USAGE Instance was already initialized or attached.
+ * @retval BH1750_RESULT_CODE_BUSY Failed, there is currently another sequence in progress.
+ */
+uint8_t bh1750_attach(BH1750 self, const BH1750StateSnapshot *const snapshot);
+
+/**
+ * @brief Restore the state of the sensor after it was reset, e.g. by a brown-out.
+ *
+ * After a power glitch, the sensor is powered down and its measurement time register is reset, while the instance
+ * still holds the previous state. This replays the state of the instance to the sensor in one sequence: power on,
+ * both halves of the measurement time, and the continuous measurement command if continuous measurement is ongoing.
+ * The state of the instance is not modified, so measurements resume without calling @ref bh1750_init again.
+ *
+ * If continuous measurement is ongoing, the first measurement is only available once the measurement duration has
+ * passed after @p cb is executed.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] cb Callback to execute once the recovery is complete.
+ * @param[in] user_data User data to pass to @p cb.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initiated the recovery.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL.
+ * @retval BH1750_RESULT_CODE_INVALID_USAGE Instance is not yet initialized, call @ref bh1750_init first.
+ * @retval BH1750_RESULT_CODE_BUSY Failed, there is currently another sequence in progress.
+ */
+uint8_t bh1750_recover(BH1750 self, BH1750CompleteCb cb, void *user_data);
+
+/**
+ * @brief Enable or disable automatic recovery after failed reads.
+ *
+ * If enabled, and an I2C transaction of one of the following reads fails, the driver runs the same sequence as @ref
+ * bh1750_recover before it executes the read callback with @ref BH1750_RESULT_CODE_IO_ERR:
+ * - @ref bh1750_read_continuous_measurement
+ * - @ref bh1750_read_one_time_measurement
+ * - @ref bh1750_read_one_time_burst - the burst callback receives the number of measurements read before the failure.
+ * - @ref bh1750_read_progressive_measurement - whether the preview or the refined measurement failed, only the final
+ * read callback is executed with the error.
+ *
+ * The recovery is a part of the read sequence, so the next read can be started from the read callback. Disabled by
+ * default.
+ *
+ * To recover only once a sensor keeps failing, rather than after every failed read, use auto_recover of the health
+ * tracker in bh1750_health.h instead.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] enable true to enable, false to disable.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL.
+ * @retval BH1750_RESULT_CODE_BUSY Another sequence is in progress.
+ */
+uint8_t bh1750_set_auto_recover(BH1750 self, bool enable);
+
+/**
+ * @brief Get the counters of a BH1750 instance.
+ *
+ * Copies the counters, so it is cheap enough to be called for many instances periodically. Unlike most other
+ * functions, this can be called while a sequence is in progress. See src/bh1750_metrics.h to export the counters of
+ * many instances in the OpenMetrics text format.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[out] counters The counters are written here in case of success.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self or @p counters is NULL.
+ */
+uint8_t bh1750_get_counters(BH1750 self, BH1750Counters *const counters);
+
+/**
+ * @brief Configure the decimator of a BH1750 instance.
+ *
+ * By default, every read sequence reads out one raw measurement and executes the read callback with it. If
+ * @p factor is greater than 1, @ref bh1750_read_continuous_measurement and @ref bh1750_read_one_time_measurement
+ * instead take @p factor raw measurements, combine them into one raw measurement as specified by @p type, and execute
+ * the read callback once with the combined measurement. The combination is done in integer arithmetic on raw counts,
+ * before conversion to lx.
+ *
+ * Additional measurements are taken as follows:
+ * - Continuous measurement: the driver waits for the sensor to complete the next measurement using the start timer
+ * function, and then reads it out.
+ * - One time measurement: the driver sends the one time measurement command again.
+ *
+ * If any I2C transaction fails, the read callback is executed with an error and the collected raw measurements are
+ * discarded.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] type Decimator type. One of @ref BH1750DecimatorType.
+ * @param[in] factor Number of raw measurements combined into one output, 1 <= @p factor <= @ref
+ * BH1750_MAX_DECIMATION_FACTOR. Pass 1 to disable decimation.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully configured the decimator.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL, @p type is invalid, or @p factor is out of range.
+ * @retval BH1750_RESULT_CODE_BUSY Another sequence is in progress.
+ */
+uint8_t bh1750_set_decimator(BH1750 self, uint8_t type, uint8_t factor);
+
+/**
+ * @brief Set a function that processes every successfully read measurement before it is passed to the read callback.
+ *
+ * The processor is executed at the end of @ref bh1750_read_continuous_measurement and @ref
+ * bh1750_read_one_time_measurement sequences, after the raw measurement is decimated and converted to lx. It can
+ * modify the measurement in place, e.g. to apply a calibration. If the processor returns false, the measurement is
+ * dropped: the read callback is executed with @ref BH1750_RESULT_CODE_SUPPRESSED and no measurement. Processors are
+ * not executed for failed reads.
+ *
+ * Chains of processing steps can be built with the pipeline module, see bh1750_pipeline.h.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] process_meas Measurement processor. Pass NULL to remove the processor.
+ * @param[in] user_data User data to pass to @p process_meas.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully set the processor.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL.
+ * @retval BH1750_RESULT_CODE_BUSY Another sequence is in progress.
+ */
+uint8_t bh1750_set_meas_processor(BH1750 self, BH1750ProcessMeas process_meas, void *user_data);
+
+/**
+ * @brief Only execute the read callback when the measurement changes meaningfully.
+ *
+ * Once enabled, the read callback of @ref bh1750_read_continuous_measurement and @ref
+ * bh1750_read_one_time_measurement only receives a successful measurement if at least one of the following holds:
+ * - It is the first measurement since change notification was enabled, or since the measurement mode or measurement
+ * time changed.
+ * - Illuminance rose to or above @p cfg->high_lx, and the last threshold notification was not for that threshold.
+ * - Illuminance fell to or below @p cfg->low_lx, and the last threshold notification was not for that threshold.
+ * - Illuminance differs from the last notified measurement by at least @p cfg->deadband_lx.
+ *
+ * Otherwise, the measurement is not converted or passed to the measurement processor, and the read callback is
+ * executed with @ref BH1750_RESULT_CODE_SUPPRESSED and no measurement, so every read still completes. Consumers that
+ * only care about changes ignore that result code. Failed reads are always reported.
+ *
+ * The thresholds and the deadband are converted to raw counts once for the current measurement mode and measurement
+ * time, so every measurement is evaluated with integer comparisons before it is converted to lx. Because of this, they
+ * are accurate to within one raw count. They are converted again when a measurement is taken with a different
+ * measurement mode or measurement time, e.g. after @ref bh1750_set_measurement_time.
+ *
+ * @param[in] self BH1750 instance.
+ * @param[in] cfg Change notification config. Pass NULL to disable change notification. The config is copied.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully configured change notification.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p self is NULL, or @p cfg->low_lx >= @p cfg->high_lx.
+ * @retval BH1750_RESULT_CODE_BUSY Another sequence is in progress.
+ */
+uint8_t bh1750_set_change_notify(BH1750 self, const BH1750ChangeNotifyConfig *const cfg);
+
+/**
+ * @brief Get illuminance in lx that corresponds to one count of raw measurement.
+ *
+ * The read functions of this driver compute illuminance in lx as lroundf(raw_meas * lx_per_count). This function
+ * exposes lx_per_count, so that modules that process raw measurements in bulk can compute the factor once, and use
+ * the same conversion as the driver.
+ *
+ * @param[in] meas_mode Measurement mode. One of @ref BH1750MeasMode.
+ * @param[in] meas_time Measurement time set in Mtreg. 31 <= @p meas_time <= 254.
+ * @param[out] lx_per_count Illuminance in lx per raw measurement count is written here in case of success.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p lx_per_count is NULL, or @p meas_mode or @p meas_time is invalid.
+ */
+uint8_t bh1750_get_lx_per_count(uint8_t meas_mode, uint8_t meas_time, float *const lx_per_count);
+
+/**
+ * @brief Get the maximum time it takes the sensor to complete one measurement.
+ *
+ * This is the integration interval of one measurement: in continuous measurement, the sensor produces a new
+ * measurement at most this often. It is also the time that @ref bh1750_read_one_time_measurement waits before reading
+ * out the measurement.
+ *
+ * @param[in] meas_mode Measurement mode. One of @ref BH1750MeasMode.
+ * @param[in] meas_time Measurement time set in Mtreg. 31 <= @p meas_time <= 254.
+ * @param[out] duration_ms Measurement duration in ms is written here in case of success.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p duration_ms is NULL, or @p meas_mode or @p meas_time is invalid.
+ */
+uint8_t bh1750_get_meas_duration_ms(uint8_t meas_mode, uint8_t meas_time, uint32_t *const duration_ms);
+
+/**
+ * @brief Get the maximum rate of one-time measurements in a burst.
+ *
+ * The rate is limited by the measurement duration, see @ref bh1750_get_meas_duration_ms. The time of the I2C
+ * transactions is not included, so the achieved rate of @ref bh1750_read_one_time_burst is slightly lower.
+ *
+ * @param[in] meas_mode Measurement mode. One of @ref BH1750MeasMode.
+ * @param[in] meas_time Measurement time set in Mtreg. 31 <= @p meas_time <= 254.
+ * @param[out] rate_mhz Maximum number of measurements per second, in mHz, is written here in case of success.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p rate_mhz is NULL, or @p meas_mode or @p meas_time is invalid.
+ */
+uint8_t bh1750_get_max_burst_rate_mhz(uint8_t meas_mode, uint8_t meas_time, uint32_t *const rate_mhz);
+
 /**
  * @brief Destroy a BH1750 instance.
  *
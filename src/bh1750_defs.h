@@ -8,6 +8,7 @@ extern "C"
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 /**
  * @brief BH1750 definitions.
@@ -17,6 +18,9 @@ extern "C"
  * because they contain data types that are present in the struct BH1750Struct definition.
  */
 
+/** Maximum number of raw measurements that can be combined into one output by the decimator of a BH1750 instance. */
+#define BH1750_MAX_DECIMATION_FACTOR 16
+
 /** Result codes describing outcomes of a I2C transaction. */
 typedef enum {
     /** Successful I2C transaction. */
@@ -90,6 +94,83 @@ typedef void (*BH1750_I2CRead)(uint8_t *data, size_t length, uint8_t i2c_addr, v
  */
 typedef void (*BH1750StartTimer)(uint32_t duration_ms, void *user_data, BH1750TimerExpiredCb cb, void *cb_user_data);
 
+/**
+ * @brief Get the current time of a monotonic clock in ms.
+ *
+ * Optional. If passed to @ref bh1750_create, the driver timestamps every measurement, see @ref BH1750Measurement. The
+ * clock is allowed to wrap around.
+ *
+ * @param[in] user_data This parameter will be equal to get_time_user_data from the init config passed to @ref
+ * bh1750_create.
+ *
+ * @return uint32_t Current time in ms.
+ */
+typedef uint32_t (*BH1750GetTime)(void *user_data);
+
+/** Illuminance measurement passed to @ref BH1750ReadCb. */
+typedef struct {
+    /** Illuminance in lx. */
+    uint32_t meas_lx;
+    /** Raw measurement as read out from the data register of BH1750. If a decimator is configured, this is the output
+     * of the decimator. */
+    uint16_t raw_meas;
+    /** Measurement mode that was used to take the measurement. One of @ref BH1750MeasMode. */
+    uint8_t meas_mode;
+    /** Measurement time that was set in Mtreg when the measurement was taken. */
+    uint8_t meas_time;
+    /** Estimated midpoint of the integration window of the measurement in ms. If a decimator is configured, this is the
+     * midpoint between the windows of the first and the last raw measurement. 0 if no get_time callback was passed to
+     * @ref bh1750_create. */
+    uint32_t mid_time_ms;
+    /** Time at which the measurement was read out in ms. 0 if no get_time callback was passed to @ref bh1750_create. */
+    uint32_t read_time_ms;
+} BH1750Measurement;
+
+/**
+ * @brief Measurement processor type. See @ref bh1750_set_meas_processor.
+ *
+ * @param[in,out] meas Measurement that was read out. The processor can modify it in place. Only valid during the
+ * execution of the processor.
+ * @param[in] user_data User data that was passed to @ref bh1750_set_meas_processor.
+ *
+ * @retval true Pass the measurement to the read callback.
+ * @retval false Drop the measurement. The read callback is executed with @ref BH1750_RESULT_CODE_SUPPRESSED.
+ */
+typedef bool (*BH1750ProcessMeas)(BH1750Measurement *meas, void *user_data);
+
+/** Number of buckets of the I2C transaction latency histogram in @ref BH1750Counters, including the last unbounded
+ * one. */
+#define BH1750_LATENCY_NUM_BUCKETS 8
+/** Upper bounds in ms of all but the last bucket of the I2C transaction latency histogram, as an initializer list. */
+#define BH1750_LATENCY_BUCKET_BOUNDS_MS {1, 2, 5, 10, 20, 50, 100}
+
+/**
+ * @brief Counters of a BH1750 instance, see @ref bh1750_get_counters.
+ *
+ * All counters start at 0 when the instance is created and only ever increase. They wrap around on overflow.
+ */
+typedef struct {
+    /** Number of started I2C write transactions. */
+    uint32_t num_i2c_writes;
+    /** Number of started I2C read transactions. */
+    uint32_t num_i2c_reads;
+    /** Number of failed I2C transactions. */
+    uint32_t num_i2c_errors;
+    /** Number of calls to public functions rejected with @ref BH1750_RESULT_CODE_BUSY. */
+    uint32_t num_busy;
+    /** Number of raw measurements successfully read out, including the ones combined by the decimator. */
+    uint32_t num_samples;
+    /** Number of measurements that were read out, but not passed to the read callback, because of change notification
+     * or the measurement processor. */
+    uint32_t num_suppressed;
+    /** Latency histogram of completed I2C transactions. Bucket i counts latencies greater than bound i - 1 and less
+     * than or equal to bound i, see @ref BH1750_LATENCY_BUCKET_BOUNDS_MS. The last bucket counts all latencies above
+     * the last bound. Only populated if a get_time callback was passed to @ref bh1750_create. */
+    uint32_t latency_buckets[BH1750_LATENCY_NUM_BUCKETS];
+    /** Sum of all latencies counted in latency_buckets in ms. */
+    uint64_t latency_sum_ms;
+} BH1750Counters;
+
 #ifdef __cplusplus
 }
 #endif
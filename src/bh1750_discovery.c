@@ -0,0 +1,217 @@
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750_discovery.h"
+
+/* Power on command, see bh1750.c */
+#define BH1750_DISCOVERY_POWER_ON_CMD 0x01
+
+static const uint8_t discovery_addrs[BH1750_DISCOVERY_NUM_ADDRS] = {BH1750_DISCOVERY_ADDR_LOW,
+                                                                    BH1750_DISCOVERY_ADDR_HIGH};
+
+static uint32_t get_elapsed_ms(const BH1750Discovery *const discovery)
+{
+    if (!discovery->cfg.get_time) {
+        return 0;
+    }
+    return discovery->cfg.get_time(discovery->cfg.get_time_user_data) - discovery->start_time_ms;
+}
+
+static void pump(BH1750Discovery *const discovery);
+
+/**
+ * @brief Move a candidate to its final state and let the next candidate of its bus start.
+ */
+static void finish_candidate(BH1750DiscoveryCandidate *const candidate, uint8_t state)
+{
+    BH1750Discovery *discovery = candidate->discovery;
+    candidate->state = state;
+    discovery->cfg.buses[candidate->bus_idx].num_in_flight--;
+    pump(discovery);
+}
+
+static void init_complete_cb(uint8_t result_code, void *user_data)
+{
+    BH1750DiscoveryCandidate *candidate = (BH1750DiscoveryCandidate *)user_data;
+    BH1750Discovery *discovery = candidate->discovery;
+    if (result_code != BH1750_RESULT_CODE_OK) {
+        discovery->result.num_failed++;
+        finish_candidate(candidate, BH1750_DISCOVERY_STATE_FAILED);
+        return;
+    }
+
+    discovery->result.num_ready++;
+    if (discovery->has_profile && discovery->profile.start_continuous_meas && discovery->cfg.get_time) {
+        uint32_t meas_duration_ms;
+        if (bh1750_get_meas_duration_ms(discovery->profile.meas_mode, discovery->profile.meas_time,
+                                        &meas_duration_ms) == BH1750_RESULT_CODE_OK) {
+            uint32_t first_sample_ms = get_elapsed_ms(discovery) + meas_duration_ms;
+            if (first_sample_ms > discovery->result.boot_to_first_sample_ms) {
+                discovery->result.boot_to_first_sample_ms = first_sample_ms;
+            }
+        }
+    }
+    finish_candidate(candidate, BH1750_DISCOVERY_STATE_READY);
+}
+
+static void probe_complete_cb(uint8_t result_code, void *user_data)
+{
+    BH1750DiscoveryCandidate *candidate = (BH1750DiscoveryCandidate *)user_data;
+    BH1750Discovery *discovery = candidate->discovery;
+    if (result_code != BH1750_I2C_RESULT_CODE_OK) {
+        finish_candidate(candidate, BH1750_DISCOVERY_STATE_ABSENT);
+        return;
+    }
+
+    const BH1750DiscoveryBus *bus = &discovery->cfg.buses[candidate->bus_idx];
+    BH1750InitConfig init_cfg = {
+        .get_instance_memory = discovery->cfg.get_instance_memory,
+        .get_instance_memory_user_data = discovery->cfg.get_instance_memory_user_data,
+        .i2c_write = bus->i2c_write,
+        .i2c_write_user_data = bus->i2c_write_user_data,
+        .i2c_read = bus->i2c_read,
+        .i2c_read_user_data = bus->i2c_read_user_data,
+        .start_timer = discovery->cfg.start_timer,
+        .start_timer_user_data = discovery->cfg.start_timer_user_data,
+        .i2c_addr = candidate->i2c_addr,
+        .get_time = discovery->cfg.get_time,
+        .get_time_user_data = discovery->cfg.get_time_user_data,
+    };
+    if (bh1750_create(&candidate->inst, &init_cfg) != BH1750_RESULT_CODE_OK) {
+        candidate->inst = NULL;
+        discovery->result.num_failed++;
+        finish_candidate(candidate, BH1750_DISCOVERY_STATE_FAILED);
+        return;
+    }
+    const BH1750StartupProfile *profile = discovery->has_profile ? &discovery->profile : NULL;
+    if (bh1750_init(candidate->inst, profile, init_complete_cb, candidate) != BH1750_RESULT_CODE_OK) {
+        discovery->result.num_failed++;
+        finish_candidate(candidate, BH1750_DISCOVERY_STATE_FAILED);
+    }
+}
+
+static void start_candidate(BH1750Discovery *const discovery, BH1750DiscoveryCandidate *const candidate)
+{
+    BH1750DiscoveryBus *bus = &discovery->cfg.buses[candidate->bus_idx];
+    candidate->state = BH1750_DISCOVERY_STATE_IN_PROGRESS;
+    bus->num_in_flight++;
+    candidate->probe_cmd = BH1750_DISCOVERY_POWER_ON_CMD;
+    bus->i2c_write(&candidate->probe_cmd, 1, candidate->i2c_addr, bus->i2c_write_user_data, probe_complete_cb,
+                   candidate);
+}
+
+/**
+ * @brief Start as many pending candidates as the in-flight limits allow, and complete the discovery once all
+ * candidates are done.
+ *
+ * I2C functions that complete right away call back into this function. In that case, it only asks the outermost call
+ * to make another pass, so that the stack depth does not grow with the number of candidates.
+ */
+static void pump(BH1750Discovery *const discovery)
+{
+    if (discovery->is_pumping) {
+        discovery->pump_again = true;
+        return;
+    }
+
+    discovery->is_pumping = true;
+    bool is_done;
+    do {
+        discovery->pump_again = false;
+        is_done = true;
+        /* Candidates of one bus are adjacent, so walking the array fills every bus up to its limit in turn */
+        for (size_t i = 0; i < discovery->cfg.num_candidates; i++) {
+            BH1750DiscoveryCandidate *candidate = &discovery->cfg.candidates[i];
+            if (candidate->state == BH1750_DISCOVERY_STATE_PENDING) {
+                is_done = false;
+                if (discovery->cfg.buses[candidate->bus_idx].num_in_flight < discovery->cfg.max_in_flight_per_bus) {
+                    start_candidate(discovery, candidate);
+                }
+            } else if (candidate->state == BH1750_DISCOVERY_STATE_IN_PROGRESS) {
+                is_done = false;
+            }
+        }
+    } while (discovery->pump_again);
+    discovery->is_pumping = false;
+
+    if (is_done && discovery->is_ongoing) {
+        discovery->result.init_duration_ms = get_elapsed_ms(discovery);
+        discovery->is_ongoing = false;
+        if (discovery->cb) {
+            discovery->cb(BH1750_RESULT_CODE_OK, discovery->cb_user_data);
+        }
+    }
+}
+
+static bool is_valid_cfg(const BH1750DiscoveryConfig *const cfg)
+{
+    if (!cfg->buses || (cfg->num_buses == 0) || !cfg->candidates ||
+        (cfg->num_candidates < (cfg->num_buses * BH1750_DISCOVERY_NUM_ADDRS)) || (cfg->max_in_flight_per_bus == 0) ||
+        !cfg->get_instance_memory || !cfg->start_timer) {
+        return false;
+    }
+    for (size_t i = 0; i < cfg->num_buses; i++) {
+        if (!cfg->buses[i].i2c_write || !cfg->buses[i].i2c_read) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t bh1750_discovery_start(BH1750Discovery *const discovery, const BH1750DiscoveryConfig *const cfg,
+                               BH1750CompleteCb cb, void *user_data)
+{
+    if (!discovery || !cfg || !is_valid_cfg(cfg)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (discovery->is_ongoing) {
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    discovery->cfg = *cfg;
+    /* Only the candidates that correspond to a bus and address are used */
+    discovery->cfg.num_candidates = cfg->num_buses * BH1750_DISCOVERY_NUM_ADDRS;
+    discovery->has_profile = (cfg->profile != NULL);
+    if (cfg->profile) {
+        discovery->profile = *cfg->profile;
+    }
+    discovery->cfg.profile = NULL;
+    discovery->is_pumping = false;
+    discovery->pump_again = false;
+    discovery->result.num_ready = 0;
+    discovery->result.num_failed = 0;
+    discovery->result.init_duration_ms = 0;
+    discovery->result.boot_to_first_sample_ms = 0;
+    discovery->cb = cb;
+    discovery->cb_user_data = user_data;
+    discovery->start_time_ms = cfg->get_time ? cfg->get_time(cfg->get_time_user_data) : 0;
+
+    for (size_t i = 0; i < cfg->num_buses; i++) {
+        discovery->cfg.buses[i].num_in_flight = 0;
+    }
+    for (size_t i = 0; i < discovery->cfg.num_candidates; i++) {
+        BH1750DiscoveryCandidate *candidate = &discovery->cfg.candidates[i];
+        candidate->discovery = discovery;
+        candidate->bus_idx = i / BH1750_DISCOVERY_NUM_ADDRS;
+        candidate->i2c_addr = discovery_addrs[i % BH1750_DISCOVERY_NUM_ADDRS];
+        candidate->state = BH1750_DISCOVERY_STATE_PENDING;
+        candidate->inst = NULL;
+    }
+
+    discovery->is_ongoing = true;
+    pump(discovery);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_discovery_get_result(const BH1750Discovery *const discovery, BH1750DiscoveryResult *const result)
+{
+    if (!discovery || !result) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (discovery->is_ongoing) {
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    *result = discovery->result;
+    return BH1750_RESULT_CODE_OK;
+}
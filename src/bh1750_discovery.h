@@ -0,0 +1,166 @@
+#ifndef SRC_BH1750_DISCOVERY_H
+#define SRC_BH1750_DISCOVERY_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/**
+ * @brief Discovery and initialization of all BH1750 sensors at startup.
+ *
+ * Every bus is probed at both I2C addresses of the BH1750 with a power on command. Probes run concurrently across
+ * buses, with a bounded number of probes in flight per bus. A BH1750 instance is created and initialized for every
+ * sensor that acknowledges its probe, while the remaining probes are still running. Once all sensors are initialized,
+ * a single completion callback is executed.
+ *
+ * Multiplexer channels are represented as separate buses, whose I2C functions select the channel.
+ */
+
+/** I2C address of the BH1750 when the ADDR pin is low. */
+#define BH1750_DISCOVERY_ADDR_LOW 0x23
+/** I2C address of the BH1750 when the ADDR pin is high. */
+#define BH1750_DISCOVERY_ADDR_HIGH 0x5C
+/** Number of I2C addresses that are probed on every bus. */
+#define BH1750_DISCOVERY_NUM_ADDRS 2
+
+/** Bus to probe. */
+typedef struct {
+    BH1750_I2CWrite i2c_write;
+    void *i2c_write_user_data;
+    BH1750_I2CRead i2c_read;
+    void *i2c_read_user_data;
+    /** Number of candidates of this bus whose probe or init is in progress. Maintained by the discovery. */
+    size_t num_in_flight;
+} BH1750DiscoveryBus;
+
+typedef enum {
+    /** Not probed yet. */
+    BH1750_DISCOVERY_STATE_PENDING = 0,
+    /** Probe or init in progress. */
+    BH1750_DISCOVERY_STATE_IN_PROGRESS,
+    /** No sensor acknowledged the probe. */
+    BH1750_DISCOVERY_STATE_ABSENT,
+    /** Sensor is initialized, inst is ready to use. */
+    BH1750_DISCOVERY_STATE_READY,
+    /** Sensor acknowledged the probe, but could not be created or initialized. inst is NULL if it could not be
+     * created. */
+    BH1750_DISCOVERY_STATE_FAILED,
+} BH1750DiscoveryState;
+
+struct BH1750DiscoveryStruct;
+
+/** One I2C address on one bus. */
+typedef struct {
+    struct BH1750DiscoveryStruct *discovery;
+    /** Index of the bus in the bus array of the config. */
+    size_t bus_idx;
+    uint8_t i2c_addr;
+    /** One of @ref BH1750DiscoveryState. */
+    uint8_t state;
+    /** Instance of the sensor. Only valid in states @ref BH1750_DISCOVERY_STATE_READY and
+     * @ref BH1750_DISCOVERY_STATE_FAILED. */
+    BH1750 inst;
+    /** Power on command of the probe. Kept here, because the transaction can complete after the write function returns.
+     */
+    uint8_t probe_cmd;
+} BH1750DiscoveryCandidate;
+
+/** Discovery config. */
+typedef struct {
+    /** Buses to probe. Must stay valid until the discovery completes. */
+    BH1750DiscoveryBus *buses;
+    size_t num_buses;
+    /** Memory for candidates, must have at least num_buses * @ref BH1750_DISCOVERY_NUM_ADDRS elements. Candidate
+     * (bus_idx * @ref BH1750_DISCOVERY_NUM_ADDRS + i) is address i of bus bus_idx, the low address first. */
+    BH1750DiscoveryCandidate *candidates;
+    size_t num_candidates;
+    /** Maximum number of candidates whose probe or init is in progress on one bus. Must be at least 1. */
+    size_t max_in_flight_per_bus;
+    /** Used to create instances of the found sensors, see @ref BH1750InitConfig. */
+    BH1750GetInstanceMemory get_instance_memory;
+    void *get_instance_memory_user_data;
+    BH1750StartTimer start_timer;
+    void *start_timer_user_data;
+    /** Optional, can be NULL. Used to timestamp measurements and to report the duration of the discovery. */
+    BH1750GetTime get_time;
+    void *get_time_user_data;
+    /** Startup profile to initialize every found sensor with. Can be NULL. Copied. */
+    const BH1750StartupProfile *profile;
+} BH1750DiscoveryConfig;
+
+/** Outcome of a discovery. */
+typedef struct {
+    /** Number of sensors that are ready. */
+    size_t num_ready;
+    /** Number of sensors that acknowledged the probe, but failed to be created or initialized. */
+    size_t num_failed;
+    /** Time from @ref bh1750_discovery_start until all sensors were initialized in ms. 0 if get_time is NULL. */
+    uint32_t init_duration_ms;
+    /** Time from @ref bh1750_discovery_start until every ready sensor has its first continuous measurement available in
+     * ms. 0 if get_time is NULL, or if the startup profile does not start continuous measurement. */
+    uint32_t boot_to_first_sample_ms;
+} BH1750DiscoveryResult;
+
+/**
+ * @brief Discovery.
+ *
+ * Populated by @ref bh1750_discovery_start. The fields should only be accessed through the functions in this header.
+ */
+typedef struct BH1750DiscoveryStruct {
+    BH1750DiscoveryConfig cfg;
+    BH1750StartupProfile profile;
+    bool has_profile;
+    bool is_ongoing;
+    /** Set while candidates are being started, to avoid recursion with I2C functions that complete right away. */
+    bool is_pumping;
+    bool pump_again;
+    uint32_t start_time_ms;
+    BH1750DiscoveryResult result;
+    BH1750CompleteCb cb;
+    void *cb_user_data;
+} BH1750Discovery;
+
+/**
+ * @brief Start discovering and initializing sensors.
+ *
+ * @p cb is executed once every candidate is either absent, ready or failed. It gets passed BH1750_RESULT_CODE_OK even
+ * if no sensor was found - use @ref bh1750_discovery_get_result and the candidates to find out which sensors are ready.
+ *
+ * @param[out] discovery Discovery. Must be zero-initialized before the first call, so that it is not seen as ongoing.
+ * @param[in] cfg Config. Copied.
+ * @param[in] cb Callback to execute once the discovery completes. Can be NULL.
+ * @param[in] user_data User data to pass to @p cb.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully started the discovery.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p discovery or @p cfg is NULL, cfg->buses, cfg->candidates,
+ * cfg->get_instance_memory or cfg->start_timer is NULL, cfg->num_buses or cfg->max_in_flight_per_bus is 0, the I2C
+ * functions of a bus are NULL, or there are too few candidates.
+ * @retval BH1750_RESULT_CODE_BUSY The discovery is already ongoing.
+ */
+uint8_t bh1750_discovery_start(BH1750Discovery *const discovery, const BH1750DiscoveryConfig *const cfg,
+                               BH1750CompleteCb cb, void *user_data);
+
+/**
+ * @brief Get the outcome of a completed discovery.
+ *
+ * @param[in] discovery Discovery.
+ * @param[out] result Outcome.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p discovery or @p result is NULL.
+ * @retval BH1750_RESULT_CODE_BUSY The discovery is still ongoing.
+ */
+uint8_t bh1750_discovery_get_result(const BH1750Discovery *const discovery, BH1750DiscoveryResult *const result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_DISCOVERY_H */
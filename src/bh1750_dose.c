@@ -0,0 +1,122 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "bh1750_dose.h"
+
+/**
+ * @brief Recompute the conversion factor and integration interval if the mode or measurement time changed.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p meas_mode or @p meas_time is invalid.
+ */
+static uint8_t update_cached_params(BH1750Dose *const dose, uint8_t meas_mode, uint8_t meas_time)
+{
+    if ((dose->cached_meas_time == meas_time) && (dose->cached_meas_mode == meas_mode)) {
+        return BH1750_RESULT_CODE_OK;
+    }
+
+    float lx_per_count;
+    uint32_t meas_duration_ms;
+    if ((bh1750_get_lx_per_count(meas_mode, meas_time, &lx_per_count) != BH1750_RESULT_CODE_OK) ||
+        (bh1750_get_meas_duration_ms(meas_mode, meas_time, &meas_duration_ms) != BH1750_RESULT_CODE_OK)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    /* At most 1.86 lx per count, so this fits into 32 bits */
+    dose->mlx_per_count_q16 = (uint32_t)lroundf(lx_per_count * 1000.0f * 65536.0f);
+    dose->meas_duration_ms = meas_duration_ms;
+    dose->cached_meas_mode = meas_mode;
+    dose->cached_meas_time = meas_time;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_dose_init(BH1750Dose *const dose, uint32_t max_gap_ms)
+{
+    if (!dose || (max_gap_ms == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    dose->state.dose_x2_mlx_ms = 0;
+    dose->state.last_mlx = 0;
+    dose->state.last_time_ms = 0;
+    dose->state.has_last = false;
+    dose->max_gap_ms = max_gap_ms;
+    dose->cached_meas_time = 0;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_dose_add(BH1750Dose *const dose, const BH1750Measurement *const meas, uint32_t time_ms)
+{
+    if (!dose || !meas) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    uint8_t rc = update_cached_params(dose, meas->meas_mode, meas->meas_time);
+    if (rc != BH1750_RESULT_CODE_OK) {
+        return rc;
+    }
+
+    uint32_t mlx = (uint32_t)((((uint64_t)meas->raw_meas * dose->mlx_per_count_q16) + 0x8000U) >> 16);
+    if (dose->state.has_last) {
+        uint32_t dt_ms = time_ms - dose->state.last_time_ms;
+        if (dt_ms == 0) {
+            /* Same time as the previous sample */
+            return BH1750_RESULT_CODE_OK;
+        }
+        if ((dt_ms < 0x80000000UL) && (dt_ms <= dose->max_gap_ms)) {
+            /* Trapezoid, doubled: (last + cur) * dt */
+            dose->state.dose_x2_mlx_ms += ((uint64_t)dose->state.last_mlx + mlx) * dt_ms;
+        } else {
+            /* Sensor was offline, or the clock restarted, e.g. after a reset - only the interval that this measurement
+             * integrated over is known */
+            dose->state.dose_x2_mlx_ms += (uint64_t)mlx * dose->meas_duration_ms * 2U;
+        }
+    }
+
+    dose->state.last_mlx = mlx;
+    dose->state.last_time_ms = time_ms;
+    dose->state.has_last = true;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_dose_get_mlx_ms(const BH1750Dose *const dose, uint64_t *const dose_mlx_ms)
+{
+    if (!dose || !dose_mlx_ms) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    *dose_mlx_ms = dose->state.dose_x2_mlx_ms / 2U;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_dose_reset(BH1750Dose *const dose)
+{
+    if (!dose) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    dose->state.dose_x2_mlx_ms = 0;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_dose_checkpoint(const BH1750Dose *const dose, BH1750DoseCheckpoint *const checkpoint)
+{
+    if (!dose || !checkpoint) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    *checkpoint = dose->state;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_dose_restore(BH1750Dose *const dose, const BH1750DoseCheckpoint *const checkpoint)
+{
+    if (!dose || !checkpoint) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    dose->state = *checkpoint;
+    /* The clock the last sample was timestamped with did not survive the reset */
+    dose->state.has_last = false;
+    return BH1750_RESULT_CODE_OK;
+}
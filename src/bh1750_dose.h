@@ -0,0 +1,143 @@
+#ifndef SRC_BH1750_DOSE_H
+#define SRC_BH1750_DOSE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/** Number of mlx*ms in one lx*h. */
+#define BH1750_DOSE_MLX_MS_PER_LX_H 3600000000ULL
+
+/**
+ * @brief Checkpoint of a light dose integrator.
+ *
+ * Contains plain values only, so it can be persisted (e.g. to flash or retained RAM) and restored with @ref
+ * bh1750_dose_restore after a reset.
+ */
+typedef struct {
+    /** Twice the accumulated dose in mlx*ms. Stored doubled so that trapezoids never need to be rounded. */
+    uint64_t dose_x2_mlx_ms;
+    /** Illuminance of the last sample in mlx. */
+    uint32_t last_mlx;
+    /** Time of the last sample in ms. */
+    uint32_t last_time_ms;
+    /** Whether there is a last sample. */
+    bool has_last;
+} BH1750DoseCheckpoint;
+
+/**
+ * @brief Light dose integrator.
+ *
+ * Populated by @ref bh1750_dose_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    /** Accumulated state. */
+    BH1750DoseCheckpoint state;
+    /** Samples further apart than this are not interpolated. */
+    uint32_t max_gap_ms;
+    /** Illuminance in mlx per raw count with 16 fractional bits, for cached_meas_mode and cached_meas_time. */
+    uint32_t mlx_per_count_q16;
+    /** Integration interval of one measurement for cached_meas_mode and cached_meas_time. */
+    uint32_t meas_duration_ms;
+    /** Measurement mode that mlx_per_count_q16 and meas_duration_ms were computed for. */
+    uint8_t cached_meas_mode;
+    /** Measurement time that mlx_per_count_q16 and meas_duration_ms were computed for. 0 if not computed yet. */
+    uint8_t cached_meas_time;
+} BH1750Dose;
+
+/**
+ * @brief Initialize a light dose integrator.
+ *
+ * @param[out] dose Integrator to initialize. The accumulated dose is 0.
+ * @param[in] max_gap_ms If two consecutive samples are further apart than this, the sensor is assumed to have been
+ * offline in between. Instead of interpolating between the two samples, only the integration interval of the later
+ * sample is accumulated, see @ref bh1750_get_meas_duration_ms. Pass UINT32_MAX to always interpolate.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initialized the integrator.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p dose is NULL or @p max_gap_ms is 0.
+ */
+uint8_t bh1750_dose_init(BH1750Dose *const dose, uint32_t max_gap_ms);
+
+/**
+ * @brief Add a sample to a light dose integrator.
+ *
+ * Accumulates the area of the trapezoid between the previous sample and @p meas. The raw count is converted to mlx in
+ * 64-bit fixed point using the measurement mode and measurement time of @p meas, so samples taken with different modes
+ * or measurement times can be mixed.
+ *
+ * @param[in] dose Integrator.
+ * @param[in] meas Measurement. Only raw_meas, meas_mode and meas_time are used.
+ * @param[in] time_ms Time at which @p meas was taken in ms. Wraparound of the 32-bit ms counter is handled, as long as
+ * consecutive samples are less than 2^31 ms apart. A sample at the same time as the previous sample is ignored. A
+ * sample older than the previous sample, e.g. because the clock restarted, is treated like a sample after a gap longer
+ * than max_gap_ms, and becomes the new previous sample.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully added the sample.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p dose or @p meas is NULL, or @p meas has an invalid measurement mode or
+ * measurement time.
+ */
+uint8_t bh1750_dose_add(BH1750Dose *const dose, const BH1750Measurement *const meas, uint32_t time_ms);
+
+/**
+ * @brief Get the accumulated light dose.
+ *
+ * Divide by @ref BH1750_DOSE_MLX_MS_PER_LX_H to get the dose in lx*h.
+ *
+ * @param[in] dose Integrator.
+ * @param[out] dose_mlx_ms Accumulated dose in mlx*ms, rounded down.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p dose or @p dose_mlx_ms is NULL.
+ */
+uint8_t bh1750_dose_get_mlx_ms(const BH1750Dose *const dose, uint64_t *const dose_mlx_ms);
+
+/**
+ * @brief Set the accumulated light dose to 0, e.g. at the start of a day.
+ *
+ * The last sample is kept, so that the interval between the last sample and the next sample is accumulated into the
+ * new period.
+ *
+ * @param[in] dose Integrator.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p dose is NULL.
+ */
+uint8_t bh1750_dose_reset(BH1750Dose *const dose);
+
+/**
+ * @brief Take a checkpoint of a light dose integrator.
+ *
+ * @param[in] dose Integrator.
+ * @param[out] checkpoint Checkpoint.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p dose or @p checkpoint is NULL.
+ */
+uint8_t bh1750_dose_checkpoint(const BH1750Dose *const dose, BH1750DoseCheckpoint *const checkpoint);
+
+/**
+ * @brief Restore a light dose integrator from a checkpoint.
+ *
+ * The accumulated dose is restored, but the last sample is discarded: its time is meaningless to the clock after a
+ * reset, so the next sample only starts a new trapezoid.
+ *
+ * @param[in] dose Integrator, initialized with @ref bh1750_dose_init.
+ * @param[in] checkpoint Checkpoint taken with @ref bh1750_dose_checkpoint.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p dose or @p checkpoint is NULL.
+ */
+uint8_t bh1750_dose_restore(BH1750Dose *const dose, const BH1750DoseCheckpoint *const checkpoint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_DOSE_H */
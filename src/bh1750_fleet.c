@@ -0,0 +1,126 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750_fleet.h"
+
+/**
+ * @brief Check whether time @p a is at or after time @p b.
+ *
+ * Handles wraparound of the 32-bit millisecond counter, as long as @p a and @p b are less than 2^31 ms apart.
+ */
+static bool is_time_reached(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) >= 0;
+}
+
+uint8_t bh1750_fleet_init(BH1750Fleet *const fleet, const BH1750FleetMemory *const mem, size_t capacity)
+{
+    if (!fleet || !mem || !mem->inst || !mem->raw_meas || !mem->lx_per_count || !mem->next_due_ms || !mem->period_ms ||
+        !mem->meas_mode || !mem->meas_time || (capacity == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    fleet->mem = *mem;
+    fleet->capacity = capacity;
+    fleet->count = 0;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_fleet_add(BH1750Fleet *const fleet, BH1750 inst, uint32_t period_ms, uint32_t first_due_ms,
+                         size_t *const id)
+{
+    if (!fleet || !inst) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (fleet->count >= fleet->capacity) {
+        return BH1750_RESULT_CODE_OUT_OF_MEMORY;
+    }
+
+    size_t i = fleet->count;
+    fleet->mem.inst[i] = inst;
+    fleet->mem.raw_meas[i] = 0;
+    /* Factor of 0 until the first measurement is recorded, so that bh1750_fleet_convert_all yields 0 lx */
+    fleet->mem.lx_per_count[i] = 0.0f;
+    fleet->mem.next_due_ms[i] = first_due_ms;
+    fleet->mem.period_ms[i] = period_ms;
+    fleet->mem.meas_mode[i] = 0;
+    fleet->mem.meas_time[i] = 0;
+    fleet->count++;
+
+    if (id) {
+        *id = i;
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+BH1750 bh1750_fleet_get_instance(const BH1750Fleet *const fleet, size_t id)
+{
+    if (!fleet || (id >= fleet->count)) {
+        return NULL;
+    }
+    return fleet->mem.inst[id];
+}
+
+uint8_t bh1750_fleet_record(BH1750Fleet *const fleet, size_t id, const BH1750Measurement *const meas,
+                            uint32_t now_ms)
+{
+    if (!fleet || !meas || (id >= fleet->count)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    bool config_changed =
+        (meas->meas_mode != fleet->mem.meas_mode[id]) || (meas->meas_time != fleet->mem.meas_time[id]);
+    if (config_changed) {
+        /* Conversion factor only depends on measurement mode and time, which rarely change between measurements */
+        float lx_per_count;
+        uint8_t rc = bh1750_get_lx_per_count(meas->meas_mode, meas->meas_time, &lx_per_count);
+        if (rc != BH1750_RESULT_CODE_OK) {
+            return rc;
+        }
+        fleet->mem.lx_per_count[id] = lx_per_count;
+        fleet->mem.meas_mode[id] = meas->meas_mode;
+        fleet->mem.meas_time[id] = meas->meas_time;
+    }
+
+    fleet->mem.raw_meas[id] = meas->raw_meas;
+    fleet->mem.next_due_ms[id] = now_ms + fleet->mem.period_ms[id];
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_fleet_convert_all(const BH1750Fleet *const fleet, uint32_t *const meas_lx)
+{
+    if (!fleet || !meas_lx) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    const uint16_t *raw_meas = fleet->mem.raw_meas;
+    const float *lx_per_count = fleet->mem.lx_per_count;
+    size_t count = fleet->count;
+    for (size_t i = 0; i < count; i++) {
+        /* Branchless equivalent of lroundf for non-negative values, so that the compiler can vectorize this loop. The
+         * product is below 2^24, so both the truncation and the subtraction are exact. */
+        float product = raw_meas[i] * lx_per_count[i];
+        uint32_t truncated = (uint32_t)product;
+        meas_lx[i] = truncated + (uint32_t)((product - (float)truncated) >= 0.5f);
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_fleet_find_due(const BH1750Fleet *const fleet, uint32_t now_ms, size_t *const ids, size_t max_ids,
+                              size_t *const num_ids)
+{
+    if (!fleet || !ids || !num_ids) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    const uint32_t *next_due_ms = fleet->mem.next_due_ms;
+    size_t num = 0;
+    for (size_t i = 0; (i < fleet->count) && (num < max_ids); i++) {
+        if (is_time_reached(now_ms, next_due_ms[i])) {
+            ids[num++] = i;
+        }
+    }
+    *num_ids = num;
+    return BH1750_RESULT_CODE_OK;
+}
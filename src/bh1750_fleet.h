@@ -0,0 +1,150 @@
+#ifndef SRC_BH1750_FLEET_H
+#define SRC_BH1750_FLEET_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "bh1750.h"
+
+/**
+ * @brief Memory for a BH1750 fleet, provided by the caller.
+ *
+ * Every array must have at least as many elements as the capacity passed to @ref bh1750_fleet_init. Per-sensor state
+ * is stored as a structure of arrays indexed by sensor id, so that batch operations over the whole fleet stream through
+ * contiguous memory.
+ *
+ * The memory must remain valid as long as the fleet is being used.
+ */
+typedef struct {
+    /** BH1750 instances. Only accessed when a single sensor is looked up, never in batch operations. */
+    BH1750 *inst;
+    /** Latest raw measurement of every sensor. */
+    uint16_t *raw_meas;
+    /** Illuminance in lx per raw measurement count of the latest measurement of every sensor. */
+    float *lx_per_count;
+    /** Time in ms at which the next measurement of every sensor is due. */
+    uint32_t *next_due_ms;
+    /** Measurement period of every sensor in ms. */
+    uint32_t *period_ms;
+    /** Measurement mode of the latest measurement of every sensor. */
+    uint8_t *meas_mode;
+    /** Measurement time of the latest measurement of every sensor. */
+    uint8_t *meas_time;
+} BH1750FleetMemory;
+
+/**
+ * @brief BH1750 fleet.
+ *
+ * Populated by @ref bh1750_fleet_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    /** Per-sensor arrays. */
+    BH1750FleetMemory mem;
+    /** Number of elements in every per-sensor array. */
+    size_t capacity;
+    /** Number of sensors in the fleet. Valid sensor ids are 0 to count - 1. */
+    size_t count;
+} BH1750Fleet;
+
+/**
+ * @brief Initialize a BH1750 fleet.
+ *
+ * @param[out] fleet Fleet to initialize.
+ * @param[in] mem Memory for per-sensor state. Every array in @p mem must have at least @p capacity elements. The
+ * pointers are copied, @p mem itself can be discarded after this function returns.
+ * @param[in] capacity Maximum number of sensors in the fleet.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initialized the fleet.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p fleet or @p mem is NULL, one of the arrays in @p mem is NULL, or
+ * @p capacity is 0.
+ */
+uint8_t bh1750_fleet_init(BH1750Fleet *const fleet, const BH1750FleetMemory *const mem, size_t capacity);
+
+/**
+ * @brief Add a sensor to a fleet.
+ *
+ * Sensor ids are assigned in the order in which sensors are added, starting from 0.
+ *
+ * @param[in] fleet Fleet.
+ * @param[in] inst BH1750 instance of the sensor.
+ * @param[in] period_ms Measurement period of the sensor in ms. After a measurement is recorded with @ref
+ * bh1750_fleet_record, the next one is due after this period.
+ * @param[in] first_due_ms Time in ms at which the first measurement is due.
+ * @param[out] id Sensor id is written here in case of success. Can be NULL if the caller is not interested in the id.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully added the sensor.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p fleet or @p inst is NULL.
+ * @retval BH1750_RESULT_CODE_OUT_OF_MEMORY The fleet is full.
+ */
+uint8_t bh1750_fleet_add(BH1750Fleet *const fleet, BH1750 inst, uint32_t period_ms, uint32_t first_due_ms,
+                         size_t *const id);
+
+/**
+ * @brief Get the BH1750 instance of a sensor.
+ *
+ * @param[in] fleet Fleet.
+ * @param[in] id Sensor id.
+ *
+ * @return BH1750 Instance of the sensor. NULL if @p fleet is NULL or @p id is not a valid sensor id.
+ */
+BH1750 bh1750_fleet_get_instance(const BH1750Fleet *const fleet, size_t id);
+
+/**
+ * @brief Record the latest measurement of a sensor.
+ *
+ * Intended to be called from the read callback of the sensor. The next measurement of the sensor becomes due
+ * period_ms after @p now_ms.
+ *
+ * @param[in] fleet Fleet.
+ * @param[in] id Sensor id.
+ * @param[in] meas Measurement passed to the read callback.
+ * @param[in] now_ms Current time in ms.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully recorded the measurement.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p fleet or @p meas is NULL, @p id is not a valid sensor id, or @p meas
+ * contains an invalid measurement mode or measurement time.
+ */
+uint8_t bh1750_fleet_record(BH1750Fleet *const fleet, size_t id, const BH1750Measurement *const meas,
+                            uint32_t now_ms);
+
+/**
+ * @brief Convert the latest raw measurements of all sensors to illuminance in lx.
+ *
+ * Uses the same conversion as the read functions of the driver. Sensors without a recorded measurement yield 0 lx.
+ *
+ * @param[in] fleet Fleet.
+ * @param[out] meas_lx Illuminance in lx of sensor i is written to meas_lx[i]. Must have at least as many elements as
+ * there are sensors in the fleet.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p fleet or @p meas_lx is NULL.
+ */
+uint8_t bh1750_fleet_convert_all(const BH1750Fleet *const fleet, uint32_t *const meas_lx);
+
+/**
+ * @brief Find all sensors whose next measurement is due.
+ *
+ * Time comparisons are wraparound-safe, as long as due times are less than 2^31 ms away from @p now_ms.
+ *
+ * @param[in] fleet Fleet.
+ * @param[in] now_ms Current time in ms.
+ * @param[out] ids Ids of sensors that are due are written here in ascending order.
+ * @param[in] max_ids Maximum number of ids to write to @p ids.
+ * @param[out] num_ids Number of ids written to @p ids.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p fleet, @p ids or @p num_ids is NULL.
+ */
+uint8_t bh1750_fleet_find_due(const BH1750Fleet *const fleet, uint32_t now_ms, size_t *const ids, size_t max_ids,
+                              size_t *const num_ids);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_FLEET_H */
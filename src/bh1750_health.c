@@ -0,0 +1,190 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750_health.h"
+
+/** Error rate of 100 % with 16 fractional bits. */
+#define BH1750_HEALTH_RATE_ONE (1UL << 16)
+/** Number of latency samples before the latency outlier detector becomes active. */
+#define BH1750_HEALTH_LATENCY_WARMUP 8U
+
+static bool is_valid_cfg(const BH1750HealthConfig *const cfg)
+{
+    return (cfg->error_rate_shift >= 1) && (cfg->error_rate_shift <= 15) && (cfg->degraded_error_rate_pct > 0) &&
+           (cfg->degraded_error_rate_pct <= cfg->failed_error_rate_pct) && (cfg->failed_error_rate_pct <= 100) &&
+           (cfg->backoff_base_ms <= cfg->backoff_max_ms) && (!cfg->auto_recover || cfg->inst);
+}
+
+static bool is_error_rate_at_least(const BH1750Health *const health, uint8_t pct)
+{
+    return ((uint64_t)health->error_rate_q16 * 100U) >= ((uint64_t)pct << 16);
+}
+
+static void update_error_rate(BH1750Health *const health, bool is_error)
+{
+    int32_t target = is_error ? (int32_t)BH1750_HEALTH_RATE_ONE : 0;
+    int32_t delta = target - (int32_t)health->error_rate_q16;
+    int32_t step = delta / (int32_t)(1L << health->cfg.error_rate_shift);
+    if ((step == 0) && (delta != 0)) {
+        /* Move by at least one step, so that the rate converges to exactly 0 % or 100 % */
+        step = (delta > 0) ? 1 : -1;
+    }
+    health->error_rate_q16 = (uint32_t)((int32_t)health->error_rate_q16 + step);
+}
+
+/**
+ * @brief Update the smoothed latency and deviation, as in the TCP retransmission timer (RFC 6298).
+ *
+ * @return true The latency is an outlier compared to the estimate before the update.
+ * @return false Not an outlier, or the detector is still warming up.
+ */
+static bool update_latency(BH1750Health *const health, uint32_t latency_ms)
+{
+    if (health->num_latency_samples == 0) {
+        health->latency_x8 = latency_ms * 8U;
+        health->latency_dev_x4 = latency_ms * 2U;
+        health->num_latency_samples = 1;
+        return false;
+    }
+
+    int64_t err = (int64_t)latency_ms - (int64_t)(health->latency_x8 / 8U);
+    bool is_outlier = (health->num_latency_samples >= BH1750_HEALTH_LATENCY_WARMUP) &&
+                      (err > (int64_t)health->latency_dev_x4) && (err > (int64_t)health->cfg.latency_margin_ms);
+
+    health->latency_x8 = (uint32_t)((int64_t)health->latency_x8 + err);
+    int64_t abs_err = (err < 0) ? -err : err;
+    health->latency_dev_x4 =
+        (uint32_t)((int64_t)health->latency_dev_x4 + abs_err - (int64_t)(health->latency_dev_x4 / 4U));
+    if (health->num_latency_samples < BH1750_HEALTH_LATENCY_WARMUP) {
+        health->num_latency_samples++;
+    }
+    return is_outlier;
+}
+
+/**
+ * @brief Evaluate all detectors, update the state and the backoff, and execute the event callback on state change.
+ *
+ * @param[in] is_error Whether the recorded read failed. Only failed reads grow the backoff.
+ */
+static void evaluate(BH1750Health *const health, bool is_error)
+{
+    const BH1750HealthConfig *cfg = &health->cfg;
+    uint8_t reasons = 0;
+    uint8_t state = BH1750_HEALTH_STATE_HEALTHY;
+
+    if (is_error_rate_at_least(health, cfg->degraded_error_rate_pct)) {
+        reasons |= BH1750_HEALTH_REASON_ERROR_RATE;
+        state = BH1750_HEALTH_STATE_DEGRADED;
+    }
+    if ((cfg->latency_outlier_count > 0) && (health->outlier_run >= cfg->latency_outlier_count)) {
+        reasons |= BH1750_HEALTH_REASON_LATENCY;
+        state = BH1750_HEALTH_STATE_DEGRADED;
+    }
+    if (is_error_rate_at_least(health, cfg->failed_error_rate_pct)) {
+        state = BH1750_HEALTH_STATE_FAILED;
+    }
+    if ((cfg->stuck_count > 0) && (health->stuck_run >= cfg->stuck_count)) {
+        reasons |= BH1750_HEALTH_REASON_STUCK;
+        state = BH1750_HEALTH_STATE_FAILED;
+    }
+
+    uint8_t prev_state = health->state;
+    if (state == BH1750_HEALTH_STATE_HEALTHY) {
+        health->backoff_ms = 0;
+    } else if (state != prev_state) {
+        health->backoff_ms = cfg->backoff_base_ms;
+    } else if (is_error) {
+        /* Still degraded or failed, and the read failed again - back off further */
+        health->backoff_ms = ((health->backoff_ms * 2U) > cfg->backoff_max_ms) ? cfg->backoff_max_ms
+                                                                                : (health->backoff_ms * 2U);
+    }
+    health->state = state;
+    health->reasons = reasons;
+
+    if ((state == BH1750_HEALTH_STATE_FAILED) && (prev_state != BH1750_HEALTH_STATE_FAILED) && cfg->auto_recover) {
+        /* Ignore return value - if the instance is busy, the sensor is still failed and the cb can retry */
+        if (bh1750_recover(cfg->inst, NULL, NULL) == BH1750_RESULT_CODE_OK) {
+            health->num_recoveries++;
+        }
+    }
+    if ((state != prev_state) && cfg->cb) {
+        cfg->cb(state, reasons, cfg->user_data);
+    }
+}
+
+uint8_t bh1750_health_init(BH1750Health *const health, const BH1750HealthConfig *const cfg)
+{
+    if (!health || !cfg || !is_valid_cfg(cfg)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    health->cfg = *cfg;
+    health->error_rate_q16 = 0;
+    health->last_raw = 0;
+    health->stuck_run = 0;
+    health->latency_x8 = 0;
+    health->latency_dev_x4 = 0;
+    health->num_latency_samples = 0;
+    health->outlier_run = 0;
+    health->state = BH1750_HEALTH_STATE_HEALTHY;
+    health->reasons = 0;
+    health->backoff_ms = 0;
+    health->num_recoveries = 0;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_health_record(BH1750Health *const health, uint8_t result_code, const BH1750Measurement *const meas,
+                             uint32_t latency_ms)
+{
+    if (!health || ((result_code == BH1750_RESULT_CODE_OK) && !meas)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if ((result_code != BH1750_RESULT_CODE_OK) && (result_code != BH1750_RESULT_CODE_IO_ERR) &&
+        (result_code != BH1750_RESULT_CODE_SUPPRESSED)) {
+        /* Not an outcome of a transaction with the sensor, e.g. BUSY */
+        return BH1750_RESULT_CODE_OK;
+    }
+
+    bool is_error = (result_code == BH1750_RESULT_CODE_IO_ERR);
+    update_error_rate(health, is_error);
+    /* A suppressed measurement was read successfully, but its raw count is unknown */
+    if (result_code == BH1750_RESULT_CODE_OK) {
+        if ((meas->raw_meas == 0) || (meas->raw_meas == UINT16_MAX)) {
+            /* Darkness and saturation are legitimately constant for hours */
+            health->stuck_run = 0;
+        } else if ((health->stuck_run > 0) && (meas->raw_meas == health->last_raw)) {
+            if (health->stuck_run < UINT16_MAX) {
+                health->stuck_run++;
+            }
+        } else {
+            health->stuck_run = 1;
+            health->last_raw = meas->raw_meas;
+        }
+    }
+    if (update_latency(health, latency_ms)) {
+        if (health->outlier_run < UINT8_MAX) {
+            health->outlier_run++;
+        }
+    } else {
+        health->outlier_run = 0;
+    }
+
+    evaluate(health, is_error);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_health_get_status(const BH1750Health *const health, BH1750HealthStatus *const status)
+{
+    if (!health || !status) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    status->state = health->state;
+    status->reasons = health->reasons;
+    status->error_rate_pct = (uint8_t)(((uint64_t)health->error_rate_q16 * 100U) >> 16);
+    status->backoff_ms = health->backoff_ms;
+    status->latency_ms = health->latency_x8 / 8U;
+    status->num_recoveries = health->num_recoveries;
+    return BH1750_RESULT_CODE_OK;
+}
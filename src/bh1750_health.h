@@ -0,0 +1,181 @@
+#ifndef SRC_BH1750_HEALTH_H
+#define SRC_BH1750_HEALTH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/** Health states of a sensor. */
+typedef enum {
+    /** No problems detected. */
+    BH1750_HEALTH_STATE_HEALTHY = 0,
+    /** The sensor works, but with elevated error rate or latency. */
+    BH1750_HEALTH_STATE_DEGRADED,
+    /** The sensor does not deliver usable measurements. */
+    BH1750_HEALTH_STATE_FAILED,
+} BH1750HealthState;
+
+/** Reason flags, see @ref BH1750HealthStatus. */
+/** Error rate of reads reached a threshold. */
+#define BH1750_HEALTH_REASON_ERROR_RATE (1U << 0)
+/** Too many consecutive measurements with the same raw count. */
+#define BH1750_HEALTH_REASON_STUCK (1U << 1)
+/** Too many consecutive reads with outlier latency. */
+#define BH1750_HEALTH_REASON_LATENCY (1U << 2)
+
+/**
+ * @brief Callback type to execute when the health state of a sensor changes.
+ *
+ * @param[in] state New state. One of @ref BH1750HealthState.
+ * @param[in] reasons Combination of BH1750_HEALTH_REASON_* flags that caused the state. 0 if @p state is @ref
+ * BH1750_HEALTH_STATE_HEALTHY.
+ * @param[in] user_data User data that was passed in @ref BH1750HealthConfig.
+ */
+typedef void (*BH1750HealthEventCb)(uint8_t state, uint8_t reasons, void *user_data);
+
+/** Health tracker config. */
+typedef struct {
+    /** The error rate is an exponentially weighted moving average with weight 1 / 2^error_rate_shift for the newest
+     * read, i.e. it covers roughly the last 2^error_rate_shift reads. 1 <= error_rate_shift <= 15. */
+    uint8_t error_rate_shift;
+    /** Error rate in percent at which the sensor becomes degraded. */
+    uint8_t degraded_error_rate_pct;
+    /** Error rate in percent at which the sensor fails. Must be >= degraded_error_rate_pct, and <= 100. */
+    uint8_t failed_error_rate_pct;
+    /** Number of consecutive measurements with the same raw count at which the sensor fails. Raw counts 0 (darkness)
+     * and 0xFFFF (saturation) never count as stuck. Choose it large enough that other constant light does not trigger
+     * it. 0 disables the stuck value detector. */
+    uint16_t stuck_count;
+    /** Number of consecutive latency outliers at which the sensor becomes degraded. 0 disables the latency outlier
+     * detector. */
+    uint8_t latency_outlier_count;
+    /** A read is a latency outlier if its latency exceeds the smoothed latency by more than four times the smoothed
+     * deviation, and by more than this margin in ms. */
+    uint32_t latency_margin_ms;
+    /** Backoff suggested when the sensor becomes degraded or fails, in ms. */
+    uint32_t backoff_base_ms;
+    /** While the sensor stays degraded or failed, the backoff doubles with every further failed read, up to this value
+     * in ms. Successful reads keep it. Must be >= backoff_base_ms. */
+    uint32_t backoff_max_ms;
+    /** Callback to execute when the health state changes. Can be NULL. */
+    BH1750HealthEventCb cb;
+    /** User data to pass to cb. */
+    void *user_data;
+    /** If true, @ref bh1750_recover is started on inst whenever the sensor fails, before cb is executed. This powers
+     * the sensor on again and restores its measurement time and continuous measurement, without @ref bh1750_init. */
+    bool auto_recover;
+    /** Initialized instance that this tracker monitors. Only used if auto_recover is true, must not be NULL then. */
+    BH1750 inst;
+} BH1750HealthConfig;
+
+/** Health status, see @ref bh1750_health_get_status. */
+typedef struct {
+    /** Current state. One of @ref BH1750HealthState. */
+    uint8_t state;
+    /** Combination of BH1750_HEALTH_REASON_* flags that caused the state. */
+    uint8_t reasons;
+    /** Current error rate in percent, rounded down. */
+    uint8_t error_rate_pct;
+    /** Suggested additional delay before the next read in ms. 0 if the sensor is healthy. */
+    uint32_t backoff_ms;
+    /** Smoothed read latency in ms. */
+    uint32_t latency_ms;
+    /** Number of recoveries started because of auto_recover in @ref BH1750HealthConfig. */
+    uint32_t num_recoveries;
+} BH1750HealthStatus;
+
+/**
+ * @brief Health tracker of one sensor.
+ *
+ * Populated by @ref bh1750_health_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    /** Config. */
+    BH1750HealthConfig cfg;
+    /** Error rate with 16 fractional bits, 1.0 is 100 %. */
+    uint32_t error_rate_q16;
+    /** Raw count of the last measurement. */
+    uint16_t last_raw;
+    /** Number of consecutive measurements equal to last_raw. 0 after a raw count of 0 or 0xFFFF. */
+    uint16_t stuck_run;
+    /** Smoothed latency in ms, times 8. */
+    uint32_t latency_x8;
+    /** Smoothed mean deviation of the latency in ms, times 4. */
+    uint32_t latency_dev_x4;
+    /** Number of latency samples, saturates at the warm-up count. */
+    uint8_t num_latency_samples;
+    /** Number of consecutive latency outliers. */
+    uint8_t outlier_run;
+    /** Current state. One of @ref BH1750HealthState. */
+    uint8_t state;
+    /** Reasons of the current state. */
+    uint8_t reasons;
+    /** Current suggested backoff in ms. */
+    uint32_t backoff_ms;
+    /** Number of recoveries started by this tracker. */
+    uint32_t num_recoveries;
+} BH1750Health;
+
+/**
+ * @brief Initialize a health tracker.
+ *
+ * @param[out] health Health tracker to initialize.
+ * @param[in] cfg Config. Copied into @p health.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initialized the health tracker.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p health or @p cfg is NULL, or @p cfg is invalid.
+ */
+uint8_t bh1750_health_init(BH1750Health *const health, const BH1750HealthConfig *const cfg);
+
+/**
+ * @brief Record the outcome of a read.
+ *
+ * Call this from the read callback of @ref bh1750_read_continuous_measurement or @ref
+ * bh1750_read_one_time_measurement. If the health state changes, the event callback is executed before this function
+ * returns.
+ *
+ * If auto_recover is enabled in the config and the sensor fails, the recovery sequence of the instance is started
+ * before this function returns. The read sequence has already ended when the read callback is executed, so the
+ * recovery can start right away. Reads started before the recovery completes return @ref BH1750_RESULT_CODE_BUSY, so
+ * the next read should be scheduled after the suggested backoff.
+ *
+ * @param[in] health Health tracker.
+ * @param[in] result_code Result code passed to the read callback. Only @ref BH1750_RESULT_CODE_OK, @ref
+ * BH1750_RESULT_CODE_IO_ERR and @ref BH1750_RESULT_CODE_SUPPRESSED are recorded, other result codes are ignored. A
+ * suppressed read counts as a successful read, but does not feed the stuck value detector, as its raw count is
+ * unknown.
+ * @param[in] meas Measurement passed to the read callback. Can be NULL if @p result_code is not @ref
+ * BH1750_RESULT_CODE_OK.
+ * @param[in] latency_ms Time from starting the read until the read callback in ms, e.g. meas->read_time_ms minus the
+ * time at which the read was started.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p health is NULL, or @p meas is NULL although @p result_code is @ref
+ * BH1750_RESULT_CODE_OK.
+ */
+uint8_t bh1750_health_record(BH1750Health *const health, uint8_t result_code, const BH1750Measurement *const meas,
+                             uint32_t latency_ms);
+
+/**
+ * @brief Get the health status.
+ *
+ * @param[in] health Health tracker.
+ * @param[out] status Status.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p health or @p status is NULL.
+ */
+uint8_t bh1750_health_get_status(const BH1750Health *const health, BH1750HealthStatus *const status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_HEALTH_H */
@@ -0,0 +1,414 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "bh1750_log.h"
+
+static void put_u16_le(uint8_t *const p, uint16_t val)
+{
+    p[0] = (uint8_t)(val & 0xFFU);
+    p[1] = (uint8_t)(val >> 8);
+}
+
+static void put_u32_le(uint8_t *const p, uint32_t val)
+{
+    p[0] = (uint8_t)(val & 0xFFU);
+    p[1] = (uint8_t)((val >> 8) & 0xFFU);
+    p[2] = (uint8_t)((val >> 16) & 0xFFU);
+    p[3] = (uint8_t)(val >> 24);
+}
+
+static void put_u64_le(uint8_t *const p, uint64_t val)
+{
+    put_u32_le(&p[0], (uint32_t)(val & 0xFFFFFFFFU));
+    put_u32_le(&p[4], (uint32_t)(val >> 32));
+}
+
+static uint16_t get_u16_le(const uint8_t *const p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static uint32_t get_u32_le(const uint8_t *const p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64_le(const uint8_t *const p)
+{
+    return (uint64_t)get_u32_le(&p[0]) | ((uint64_t)get_u32_le(&p[4]) << 32);
+}
+
+/**
+ * @brief Map a signed integer to an unsigned integer, so that values close to 0 map to small values.
+ */
+static uint32_t zigzag_encode(int32_t val)
+{
+    return ((uint32_t)val << 1) ^ (uint32_t)(val >> 31);
+}
+
+static int32_t zigzag_decode(uint32_t val)
+{
+    return (int32_t)(val >> 1) ^ -(int32_t)(val & 1U);
+}
+
+/**
+ * @brief Write a varint.
+ *
+ * @param[out] p Destination. Must have room for 5 bytes.
+ * @param[in] val Value.
+ *
+ * @return size_t Number of bytes written.
+ */
+static size_t put_varint(uint8_t *const p, uint32_t val)
+{
+    size_t i = 0;
+    while (val >= 0x80U) {
+        p[i++] = (uint8_t)(val | 0x80U);
+        val >>= 7;
+    }
+    p[i++] = (uint8_t)val;
+    return i;
+}
+
+/**
+ * @brief Read a varint.
+ *
+ * @param[in] p Source.
+ * @param[in] len Number of bytes available in @p p.
+ * @param[out] val Value.
+ *
+ * @return size_t Number of bytes read. 0 if the varint is truncated or longer than 5 bytes.
+ */
+static size_t get_varint(const uint8_t *const p, size_t len, uint32_t *const val)
+{
+    uint32_t result = 0;
+    for (size_t i = 0; (i < len) && (i < 5); i++) {
+        result |= (uint32_t)(p[i] & 0x7FU) << (7 * i);
+        if ((p[i] & 0x80U) == 0) {
+            *val = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static void write_header(uint8_t *const p, const BH1750LogChunkHeader *const hdr)
+{
+    put_u16_le(&p[0], BH1750_LOG_MAGIC);
+    p[2] = BH1750_LOG_VERSION;
+    p[3] = hdr->i2c_addr;
+    p[4] = hdr->meas_mode;
+    p[5] = hdr->meas_time;
+    put_u16_le(&p[6], hdr->num_samples);
+    put_u16_le(&p[8], hdr->payload_len);
+    put_u16_le(&p[10], hdr->base_raw);
+    put_u64_le(&p[12], hdr->base_time_ms);
+    /* The encoder keeps every chunk within INT32_MAX ms */
+    put_u32_le(&p[20], (uint32_t)(hdr->last_time_ms - hdr->base_time_ms));
+    put_u16_le(&p[24], hdr->min_raw);
+    put_u16_le(&p[26], hdr->max_raw);
+    put_u32_le(&p[28], hdr->sum_raw);
+}
+
+/**
+ * @brief Decode the next sample of a chunk payload.
+ *
+ * @param[in,out] p Position in the payload. Advanced past the sample.
+ * @param[in,out] remaining Number of payload bytes left. Decremented by the size of the sample.
+ * @param[in,out] sample Previous sample on input, next sample on output.
+ *
+ * @return true The sample was decoded.
+ * @return false The payload is truncated or malformed.
+ */
+static bool decode_next_sample(const uint8_t **const p, size_t *const remaining, BH1750LogSample *const sample)
+{
+    uint32_t raw_zz;
+    uint32_t time_zz;
+    size_t n = get_varint(*p, *remaining, &raw_zz);
+    if (n == 0) {
+        return false;
+    }
+    *p += n;
+    *remaining -= n;
+    n = get_varint(*p, *remaining, &time_zz);
+    if (n == 0) {
+        return false;
+    }
+    *p += n;
+    *remaining -= n;
+
+    int32_t raw = (int32_t)sample->raw_meas + zigzag_decode(raw_zz);
+    if ((raw < 0) || (raw > 0xFFFF)) {
+        return false;
+    }
+    int32_t time_delta = zigzag_decode(time_zz);
+    if (time_delta < 0) {
+        /* Timestamps in a chunk do not decrease */
+        return false;
+    }
+    sample->raw_meas = (uint16_t)raw;
+    sample->time_ms += (uint64_t)time_delta;
+    return true;
+}
+
+/**
+ * @brief Start a new chunk with a sample as its first sample.
+ */
+static void start_chunk(BH1750LogEncoder *const enc, const BH1750Measurement *const meas, uint64_t time_ms)
+{
+    enc->hdr.meas_mode = meas->meas_mode;
+    enc->hdr.meas_time = meas->meas_time;
+    enc->hdr.num_samples = 1;
+    enc->hdr.payload_len = 0;
+    enc->hdr.base_time_ms = time_ms;
+    enc->hdr.base_raw = meas->raw_meas;
+    enc->hdr.last_time_ms = time_ms;
+    enc->hdr.min_raw = meas->raw_meas;
+    enc->hdr.max_raw = meas->raw_meas;
+    enc->hdr.sum_raw = meas->raw_meas;
+    /* Header is written when the chunk is complete, once num_samples and payload_len are known */
+    enc->len = BH1750_LOG_HEADER_SIZE;
+    enc->last_raw = meas->raw_meas;
+}
+
+uint8_t bh1750_log_encoder_init(BH1750LogEncoder *const enc, uint8_t *const buf, size_t capacity, uint8_t i2c_addr,
+                                BH1750LogChunkCb cb, void *user_data)
+{
+    if (!enc || !buf || !cb || (capacity < BH1750_LOG_MIN_CHUNK_SIZE)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    enc->buf = buf;
+    /* payload_len is 16 bits */
+    enc->capacity = (capacity > (BH1750_LOG_HEADER_SIZE + 0xFFFFU)) ? (BH1750_LOG_HEADER_SIZE + 0xFFFFU) : capacity;
+    enc->len = 0;
+    enc->cb = cb;
+    enc->user_data = user_data;
+    enc->hdr.i2c_addr = i2c_addr;
+    enc->hdr.num_samples = 0;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_log_encoder_add(BH1750LogEncoder *const enc, const BH1750Measurement *const meas, uint64_t time_ms)
+{
+    if (!enc || !meas) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    if (enc->hdr.num_samples == 0) {
+        start_chunk(enc, meas, time_ms);
+        return BH1750_RESULT_CODE_OK;
+    }
+    if (time_ms < enc->hdr.last_time_ms) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    bool same_config = (meas->meas_mode == enc->hdr.meas_mode) && (meas->meas_time == enc->hdr.meas_time);
+    /* Offsets from the first sample of the chunk are 32 bits, and time deltas are zigzag encoded as int32 */
+    bool fits_time_range = ((time_ms - enc->hdr.base_time_ms) <= (uint64_t)INT32_MAX);
+    if (!same_config || !fits_time_range || (enc->hdr.num_samples == UINT16_MAX) ||
+        ((enc->len + BH1750_LOG_MAX_SAMPLE_SIZE) > enc->capacity)) {
+        bh1750_log_encoder_flush(enc);
+        start_chunk(enc, meas, time_ms);
+        return BH1750_RESULT_CODE_OK;
+    }
+
+    int32_t raw_delta = (int32_t)meas->raw_meas - (int32_t)enc->last_raw;
+    int32_t time_delta = (int32_t)(time_ms - enc->hdr.last_time_ms);
+    size_t n = put_varint(&enc->buf[enc->len], zigzag_encode(raw_delta));
+    n += put_varint(&enc->buf[enc->len + n], zigzag_encode(time_delta));
+    enc->len += n;
+    enc->hdr.payload_len += (uint16_t)n;
+    enc->hdr.num_samples++;
+    enc->hdr.last_time_ms = time_ms;
+    if (meas->raw_meas < enc->hdr.min_raw) {
+        enc->hdr.min_raw = meas->raw_meas;
+    }
+    if (meas->raw_meas > enc->hdr.max_raw) {
+        enc->hdr.max_raw = meas->raw_meas;
+    }
+    /* At most 65535 samples of at most 65535 counts, cannot overflow */
+    enc->hdr.sum_raw += meas->raw_meas;
+    enc->last_raw = meas->raw_meas;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_log_encoder_flush(BH1750LogEncoder *const enc)
+{
+    if (!enc) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (enc->hdr.num_samples == 0) {
+        return BH1750_RESULT_CODE_OK;
+    }
+
+    write_header(enc->buf, &enc->hdr);
+    enc->cb(enc->buf, enc->len, enc->user_data);
+    enc->hdr.num_samples = 0;
+    enc->len = 0;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_log_parse_header(const uint8_t *const data, size_t len, BH1750LogChunkHeader *const hdr)
+{
+    if (!data || !hdr || (len < BH1750_LOG_HEADER_SIZE)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if ((get_u16_le(&data[0]) != BH1750_LOG_MAGIC) || (data[2] != BH1750_LOG_VERSION)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    hdr->i2c_addr = data[3];
+    hdr->meas_mode = data[4];
+    hdr->meas_time = data[5];
+    hdr->num_samples = get_u16_le(&data[6]);
+    hdr->payload_len = get_u16_le(&data[8]);
+    hdr->base_raw = get_u16_le(&data[10]);
+    hdr->base_time_ms = get_u64_le(&data[12]);
+    hdr->last_time_ms = hdr->base_time_ms + get_u32_le(&data[20]);
+    hdr->min_raw = get_u16_le(&data[24]);
+    hdr->max_raw = get_u16_le(&data[26]);
+    hdr->sum_raw = get_u32_le(&data[28]);
+    if ((hdr->num_samples == 0) || (hdr->min_raw > hdr->max_raw)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_log_decode_chunk(const uint8_t *const data, size_t len, BH1750LogChunkHeader *const hdr,
+                                BH1750LogSample *const samples, size_t max_samples, size_t *const chunk_len)
+{
+    if (!samples || !chunk_len) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    uint8_t rc = bh1750_log_parse_header(data, len, hdr);
+    if (rc != BH1750_RESULT_CODE_OK) {
+        return rc;
+    }
+    size_t total_len = BH1750_LOG_HEADER_SIZE + (size_t)hdr->payload_len;
+    if ((len < total_len) || (hdr->num_samples > max_samples)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    samples[0].time_ms = hdr->base_time_ms;
+    samples[0].raw_meas = hdr->base_raw;
+    const uint8_t *p = &data[BH1750_LOG_HEADER_SIZE];
+    size_t remaining = hdr->payload_len;
+    for (size_t i = 1; i < hdr->num_samples; i++) {
+        samples[i] = samples[i - 1];
+        if (!decode_next_sample(&p, &remaining, &samples[i])) {
+            return BH1750_RESULT_CODE_INVALID_ARG;
+        }
+    }
+    if (remaining != 0) {
+        /* Payload length does not match the number of samples */
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    *chunk_len = total_len;
+    return BH1750_RESULT_CODE_OK;
+}
+
+/**
+ * @brief Merge a min, max, sum and count in lx into an aggregate.
+ */
+static void merge_into_aggregate(BH1750LogAggregate *const result, uint32_t num_samples, uint32_t min_lx,
+                                 uint32_t max_lx, uint64_t sum_lx)
+{
+    if (result->num_samples == 0) {
+        result->min_lx = min_lx;
+        result->max_lx = max_lx;
+    } else {
+        if (min_lx < result->min_lx) {
+            result->min_lx = min_lx;
+        }
+        if (max_lx > result->max_lx) {
+            result->max_lx = max_lx;
+        }
+    }
+    result->num_samples += num_samples;
+    result->sum_lx += sum_lx;
+}
+
+/**
+ * @brief Decode a chunk and aggregate its samples that are in a time range.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG The payload is malformed.
+ */
+static uint8_t aggregate_chunk_samples(const uint8_t *const data, const BH1750LogChunkHeader *const hdr,
+                                       float lx_per_count, uint64_t start_ms, uint64_t end_ms,
+                                       BH1750LogAggregate *const result)
+{
+    const uint8_t *p = &data[BH1750_LOG_HEADER_SIZE];
+    size_t remaining = hdr->payload_len;
+    BH1750LogSample sample = {hdr->base_time_ms, hdr->base_raw};
+    for (size_t i = 0; i < hdr->num_samples; i++) {
+        if ((i > 0) && !decode_next_sample(&p, &remaining, &sample)) {
+            return BH1750_RESULT_CODE_INVALID_ARG;
+        }
+        if ((sample.time_ms >= start_ms) && (sample.time_ms < end_ms)) {
+            uint32_t lx = (uint32_t)lroundf(sample.raw_meas * lx_per_count);
+            merge_into_aggregate(result, 1, lx, lx, lx);
+        }
+    }
+    return (remaining == 0) ? BH1750_RESULT_CODE_OK : BH1750_RESULT_CODE_INVALID_ARG;
+}
+
+uint8_t bh1750_log_aggregate(const uint8_t *const data, size_t len, uint64_t start_ms, uint64_t end_ms,
+                             BH1750LogAggregate *const result)
+{
+    if (!data || !result) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    result->num_samples = 0;
+    result->min_lx = 0;
+    result->max_lx = 0;
+    result->sum_lx = 0;
+    result->num_chunks_indexed = 0;
+    result->num_chunks_decoded = 0;
+    result->num_bytes_scanned = 0;
+
+    size_t offset = 0;
+    while (offset < len) {
+        BH1750LogChunkHeader hdr;
+        uint8_t rc = bh1750_log_parse_header(&data[offset], len - offset, &hdr);
+        if (rc != BH1750_RESULT_CODE_OK) {
+            return rc;
+        }
+        size_t chunk_len = BH1750_LOG_HEADER_SIZE + (size_t)hdr.payload_len;
+        if ((len - offset) < chunk_len) {
+            return BH1750_RESULT_CODE_INVALID_ARG;
+        }
+
+        if ((hdr.last_time_ms >= start_ms) && (hdr.base_time_ms < end_ms)) {
+            float lx_per_count;
+            rc = bh1750_get_lx_per_count(hdr.meas_mode, hdr.meas_time, &lx_per_count);
+            if (rc != BH1750_RESULT_CODE_OK) {
+                return rc;
+            }
+            if ((hdr.base_time_ms >= start_ms) && (hdr.last_time_ms < end_ms)) {
+                /* Whole chunk in range - the header has everything we need */
+                merge_into_aggregate(result, hdr.num_samples, (uint32_t)lroundf(hdr.min_raw * lx_per_count),
+                                     (uint32_t)lroundf(hdr.max_raw * lx_per_count),
+                                     (uint64_t)llround((double)hdr.sum_raw * lx_per_count));
+                result->num_chunks_indexed++;
+                result->num_bytes_scanned += BH1750_LOG_HEADER_SIZE;
+            } else {
+                rc = aggregate_chunk_samples(&data[offset], &hdr, lx_per_count, start_ms, end_ms, result);
+                if (rc != BH1750_RESULT_CODE_OK) {
+                    return rc;
+                }
+                result->num_chunks_decoded++;
+                result->num_bytes_scanned += chunk_len;
+            }
+        } else {
+            result->num_bytes_scanned += BH1750_LOG_HEADER_SIZE;
+        }
+        offset += chunk_len;
+    }
+    return BH1750_RESULT_CODE_OK;
+}
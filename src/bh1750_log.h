@@ -0,0 +1,248 @@
+#ifndef SRC_BH1750_LOG_H
+#define SRC_BH1750_LOG_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/**
+ * @brief Compact binary log format for BH1750 samples.
+ *
+ * A log is a sequence of chunks. Every chunk starts with a header of @ref BH1750_LOG_HEADER_SIZE bytes, all multi-byte
+ * fields little endian:
+ *
+ * | Offset | Size | Field                                                      |
+ * |--------|------|------------------------------------------------------------|
+ * | 0      | 2    | Magic, @ref BH1750_LOG_MAGIC                               |
+ * | 2      | 1    | Format version, @ref BH1750_LOG_VERSION                    |
+ * | 3      | 1    | I2C address of the sensor                                  |
+ * | 4      | 1    | Measurement mode, one of @ref BH1750MeasMode               |
+ * | 5      | 1    | Measurement time set in Mtreg                              |
+ * | 6      | 2    | Number of samples in the chunk, >= 1                       |
+ * | 8      | 2    | Payload length in bytes                                    |
+ * | 10     | 2    | Raw count of the first sample                              |
+ * | 12     | 8    | Time of the first sample in ms, e.g. Unix time             |
+ * | 20     | 4    | Time of the last sample relative to the first one in ms    |
+ * | 24     | 2    | Smallest raw count in the chunk                            |
+ * | 26     | 2    | Largest raw count in the chunk                             |
+ * | 28     | 4    | Sum of all raw counts in the chunk                         |
+ *
+ * The header is followed by the payload: for every sample after the first one, the difference of the raw count and the
+ * difference of the time to the previous sample, each zigzag encoded and written as a varint (7 bits per byte, least
+ * significant group first, MSB set on all bytes except the last one).
+ *
+ * All samples of a chunk share the I2C address, measurement mode and measurement time. Slowly changing light sampled
+ * at a fixed period takes about 3 bytes per sample. The time range, min, max and sum in the header index the chunk, so
+ * that readers can aggregate a log without decoding the payload of every chunk.
+ *
+ * Only the first sample of a chunk carries an absolute 64-bit timestamp, all other times are 32-bit deltas to it, so
+ * timestamps never wrap around within a log. Timestamps in a log must not decrease. A chunk spans at most INT32_MAX ms.
+ *
+ * Version 1 had a 16-byte header with a 32-bit timestamp of the first sample and no index.
+ */
+
+/** Chunk magic, "BH" */
+#define BH1750_LOG_MAGIC 0x4842U
+/** Format version written by the encoder. */
+#define BH1750_LOG_VERSION 2U
+/** Size of the chunk header in bytes. */
+#define BH1750_LOG_HEADER_SIZE 32U
+/** Maximum number of payload bytes of one sample: 3 bytes for the raw count, 5 bytes for the time. */
+#define BH1750_LOG_MAX_SAMPLE_SIZE 8U
+/** Smallest chunk buffer that the encoder accepts. */
+#define BH1750_LOG_MIN_CHUNK_SIZE (BH1750_LOG_HEADER_SIZE + BH1750_LOG_MAX_SAMPLE_SIZE)
+
+/** Decoded chunk header. */
+typedef struct {
+    /** I2C address of the sensor. */
+    uint8_t i2c_addr;
+    /** Measurement mode of all samples in the chunk. */
+    uint8_t meas_mode;
+    /** Measurement time of all samples in the chunk. */
+    uint8_t meas_time;
+    /** Number of samples in the chunk. */
+    uint16_t num_samples;
+    /** Number of payload bytes following the header. */
+    uint16_t payload_len;
+    /** Time of the first sample in ms. */
+    uint64_t base_time_ms;
+    /** Raw count of the first sample. */
+    uint16_t base_raw;
+    /** Time of the last sample in ms. Stored in the chunk as a 32-bit offset from base_time_ms. */
+    uint64_t last_time_ms;
+    /** Smallest raw count in the chunk. */
+    uint16_t min_raw;
+    /** Largest raw count in the chunk. */
+    uint16_t max_raw;
+    /** Sum of all raw counts in the chunk. */
+    uint32_t sum_raw;
+} BH1750LogChunkHeader;
+
+/** Decoded sample. */
+typedef struct {
+    /** Time at which the sample was taken in ms. */
+    uint64_t time_ms;
+    /** Raw count. Convert to lx with the measurement mode and time from the chunk header, see @ref
+     * bh1750_get_lx_per_count. */
+    uint16_t raw_meas;
+} BH1750LogSample;
+
+/**
+ * @brief Callback type to execute when the encoder completes a chunk.
+ *
+ * @param[in] chunk Complete chunk. Only valid during the execution of this callback - write or copy it.
+ * @param[in] len Length of @p chunk in bytes.
+ * @param[in] user_data User data that was passed to @ref bh1750_log_encoder_init.
+ */
+typedef void (*BH1750LogChunkCb)(const uint8_t *chunk, size_t len, void *user_data);
+
+/**
+ * @brief Streaming log encoder.
+ *
+ * Populated by @ref bh1750_log_encoder_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    /** Chunk buffer. */
+    uint8_t *buf;
+    /** Size of buf in bytes. */
+    size_t capacity;
+    /** Number of bytes of buf in use, including the header. */
+    size_t len;
+    /** Callback to execute when a chunk is complete. */
+    BH1750LogChunkCb cb;
+    /** User data to pass to cb. */
+    void *user_data;
+    /** Header of the current chunk. num_samples is 0 if the chunk is empty. */
+    BH1750LogChunkHeader hdr;
+    /** Raw count of the previous sample. */
+    uint16_t last_raw;
+} BH1750LogEncoder;
+
+/**
+ * @brief Initialize a log encoder.
+ *
+ * @param[out] enc Encoder to initialize.
+ * @param[in] buf Chunk buffer. Determines the maximum size of a chunk. Must remain valid as long as the encoder is
+ * being used.
+ * @param[in] capacity Size of @p buf in bytes. Must be at least @ref BH1750_LOG_MIN_CHUNK_SIZE.
+ * @param[in] i2c_addr I2C address of the sensor, written to every chunk header.
+ * @param[in] cb Callback to execute with every complete chunk.
+ * @param[in] user_data User data to pass to @p cb.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initialized the encoder.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p enc, @p buf or @p cb is NULL, or @p capacity is too small.
+ */
+uint8_t bh1750_log_encoder_init(BH1750LogEncoder *const enc, uint8_t *const buf, size_t capacity, uint8_t i2c_addr,
+                                BH1750LogChunkCb cb, void *user_data);
+
+/**
+ * @brief Add a sample to a log encoder.
+ *
+ * If the sample does not fit into the current chunk, has a different measurement mode or measurement time than the
+ * samples in the current chunk, or is more than INT32_MAX ms after the first sample of the current chunk, the current
+ * chunk is completed and passed to the chunk callback first. The sample then becomes the first sample of a new chunk.
+ *
+ * @param[in] enc Encoder.
+ * @param[in] meas Measurement. Only raw_meas, meas_mode and meas_time are used.
+ * @param[in] time_ms Time at which the measurement was taken in ms. A 64-bit clock that does not wrap around, e.g.
+ * Unix time in ms. Must not be earlier than the time of the previous sample.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully added the sample.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p enc or @p meas is NULL, or @p time_ms is earlier than the time of the
+ * previous sample.
+ */
+uint8_t bh1750_log_encoder_add(BH1750LogEncoder *const enc, const BH1750Measurement *const meas, uint64_t time_ms);
+
+/**
+ * @brief Complete the current chunk and pass it to the chunk callback, if it contains any samples.
+ *
+ * @param[in] enc Encoder.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p enc is NULL.
+ */
+uint8_t bh1750_log_encoder_flush(BH1750LogEncoder *const enc);
+
+/**
+ * @brief Parse the header of a chunk.
+ *
+ * @param[in] data Chunk.
+ * @param[in] len Number of bytes available in @p data.
+ * @param[out] hdr Header.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success. The whole chunk is BH1750_LOG_HEADER_SIZE + hdr->payload_len bytes long.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p data or @p hdr is NULL, @p len is smaller than the header, the magic or
+ * version does not match, or the chunk has no samples.
+ */
+uint8_t bh1750_log_parse_header(const uint8_t *const data, size_t len, BH1750LogChunkHeader *const hdr);
+
+/**
+ * @brief Decode all samples of a chunk.
+ *
+ * @param[in] data Chunk, starting with its header.
+ * @param[in] len Number of bytes available in @p data. Can be larger than the chunk.
+ * @param[out] hdr Header of the chunk.
+ * @param[out] samples Decoded samples. Must have room for hdr->num_samples samples, see @p max_samples.
+ * @param[in] max_samples Number of elements in @p samples.
+ * @param[out] chunk_len Length of the chunk in bytes, i.e. offset of the next chunk in @p data.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG One of the pointers is NULL, the header is invalid, the chunk is truncated or
+ * malformed, or it has more samples than @p max_samples.
+ */
+uint8_t bh1750_log_decode_chunk(const uint8_t *const data, size_t len, BH1750LogChunkHeader *const hdr,
+                                BH1750LogSample *const samples, size_t max_samples, size_t *const chunk_len);
+
+/** Aggregate of the samples of a log in a time range. */
+typedef struct {
+    /** Number of samples in the range. */
+    uint32_t num_samples;
+    /** Smallest illuminance in lx. */
+    uint32_t min_lx;
+    /** Largest illuminance in lx. */
+    uint32_t max_lx;
+    /** Sum of illuminance in lx. Divide by num_samples to get the mean. */
+    uint64_t sum_lx;
+    /** Number of chunks that were aggregated from their header only. */
+    uint32_t num_chunks_indexed;
+    /** Number of chunks whose payload was decoded, because they are only partially in the range. */
+    uint32_t num_chunks_decoded;
+    /** Number of bytes of the log that were read, headers included. */
+    size_t num_bytes_scanned;
+} BH1750LogAggregate;
+
+/**
+ * @brief Aggregate all samples of a log whose timestamps are in a time range.
+ *
+ * Chunks outside of the range are skipped using only their header. Chunks completely inside of the range are
+ * aggregated from their header, without decoding the payload. Only chunks that straddle a boundary of the range are
+ * decoded.
+ *
+ * Raw counts are converted to lx with the same formula as the driver, see @ref bh1750_get_lx_per_count. For chunks
+ * aggregated from their header, the sum of the chunk is converted at once, so sum_lx can differ from the sum of the
+ * individually converted samples by up to 0.5 lx per sample.
+ *
+ * @param[in] data Log. A sequence of chunks, e.g. the contents of a log file in memory.
+ * @param[in] len Length of @p data in bytes.
+ * @param[in] start_ms Start of the range in ms, inclusive.
+ * @param[in] end_ms End of the range in ms, exclusive.
+ * @param[out] result Aggregate. All lx fields are 0 if num_samples is 0.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p data or @p result is NULL, or one of the chunks is truncated or malformed.
+ */
+uint8_t bh1750_log_aggregate(const uint8_t *const data, size_t len, uint64_t start_ms, uint64_t end_ms,
+                             BH1750LogAggregate *const result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_LOG_H */
@@ -0,0 +1,180 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750_merge.h"
+
+/**
+ * @brief Get the heap key of a source.
+ *
+ * The key is the time of the oldest queued entry, or the watermark if the queue is empty, shifted left by one. The
+ * lowest bit is set for empty queues, so that on equal times a source with a queued entry comes first. Finished sources
+ * with an empty queue come last.
+ */
+static uint64_t get_key(const BH1750MergeSource *const src)
+{
+    if (src->count > 0) {
+        return (uint64_t)src->entries[src->head].time_ms << 1;
+    }
+    if (src->finished) {
+        return UINT64_MAX;
+    }
+    return ((uint64_t)src->watermark_ms << 1) | 1U;
+}
+
+static void swap_heap_entries(BH1750Merge *const merge, size_t a, size_t b)
+{
+    size_t tmp = merge->heap[a];
+    merge->heap[a] = merge->heap[b];
+    merge->heap[b] = tmp;
+    merge->sources[merge->heap[a]].heap_pos = a;
+    merge->sources[merge->heap[b]].heap_pos = b;
+}
+
+/**
+ * @brief Restore the heap order after the key of a source changed.
+ */
+static void fix_heap(BH1750Merge *const merge, size_t source)
+{
+    size_t pos = merge->sources[source].heap_pos;
+    uint64_t key = get_key(&merge->sources[source]);
+
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (get_key(&merge->sources[merge->heap[parent]]) <= key) {
+            break;
+        }
+        swap_heap_entries(merge, pos, parent);
+        pos = parent;
+    }
+
+    while (true) {
+        size_t smallest = pos;
+        uint64_t smallest_key = key;
+        for (size_t child = (2 * pos) + 1; (child <= (2 * pos) + 2) && (child < merge->num_sources); child++) {
+            uint64_t child_key = get_key(&merge->sources[merge->heap[child]]);
+            if (child_key < smallest_key) {
+                smallest = child;
+                smallest_key = child_key;
+            }
+        }
+        if (smallest == pos) {
+            break;
+        }
+        swap_heap_entries(merge, pos, smallest);
+        pos = smallest;
+    }
+}
+
+uint8_t bh1750_merge_init(BH1750Merge *const merge, BH1750MergeSource *const sources, size_t *const heap,
+                          size_t num_sources)
+{
+    if (!merge || !sources || !heap || (num_sources == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    for (size_t i = 0; i < num_sources; i++) {
+        if (!sources[i].entries || (sources[i].capacity == 0)) {
+            return BH1750_RESULT_CODE_INVALID_ARG;
+        }
+    }
+
+    /* All keys are equal, so the identity permutation is a valid heap */
+    for (size_t i = 0; i < num_sources; i++) {
+        sources[i].head = 0;
+        sources[i].count = 0;
+        sources[i].watermark_ms = 0;
+        sources[i].finished = false;
+        sources[i].heap_pos = i;
+        heap[i] = i;
+    }
+    merge->sources = sources;
+    merge->heap = heap;
+    merge->num_sources = num_sources;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_merge_push(BH1750Merge *const merge, size_t source, const BH1750Measurement *const meas,
+                          uint32_t time_ms)
+{
+    if (!merge || !meas || (source >= merge->num_sources)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    BH1750MergeSource *src = &merge->sources[source];
+    if (src->finished) {
+        return BH1750_RESULT_CODE_INVALID_USAGE;
+    }
+    if (time_ms < src->watermark_ms) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (src->count == src->capacity) {
+        return BH1750_RESULT_CODE_OUT_OF_MEMORY;
+    }
+
+    BH1750MergeEntry *entry = &src->entries[(src->head + src->count) % src->capacity];
+    entry->time_ms = time_ms;
+    entry->meas = *meas;
+    src->count++;
+    src->watermark_ms = time_ms;
+    if (src->count == 1) {
+        /* Key only depends on the oldest entry */
+        fix_heap(merge, source);
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_merge_advance_watermark(BH1750Merge *const merge, size_t source, uint32_t time_ms)
+{
+    if (!merge || (source >= merge->num_sources)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    BH1750MergeSource *src = &merge->sources[source];
+    if (time_ms <= src->watermark_ms) {
+        return BH1750_RESULT_CODE_OK;
+    }
+
+    src->watermark_ms = time_ms;
+    if (src->count == 0) {
+        fix_heap(merge, source);
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_merge_finish_source(BH1750Merge *const merge, size_t source)
+{
+    if (!merge || (source >= merge->num_sources)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    merge->sources[source].finished = true;
+    fix_heap(merge, source);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_merge_pop(BH1750Merge *const merge, BH1750MergeItem *const items, size_t max_items,
+                         size_t *const num_items)
+{
+    if (!merge || !items || !num_items) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    size_t n = 0;
+    while (n < max_items) {
+        size_t source = merge->heap[0];
+        BH1750MergeSource *src = &merge->sources[source];
+        if (src->count == 0) {
+            /* The source with the oldest key has nothing queued - either it can still produce an older measurement
+             * than everything that is queued, or all sources are finished and drained. */
+            break;
+        }
+
+        items[n].source = source;
+        items[n].time_ms = src->entries[src->head].time_ms;
+        items[n].meas = src->entries[src->head].meas;
+        n++;
+        src->head = (src->head + 1) % src->capacity;
+        src->count--;
+        fix_heap(merge, source);
+    }
+    *num_items = n;
+    return BH1750_RESULT_CODE_OK;
+}
@@ -0,0 +1,160 @@
+#ifndef SRC_BH1750_MERGE_H
+#define SRC_BH1750_MERGE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/** Timestamped measurement in the queue of a source. */
+typedef struct {
+    /** Time at which the measurement was taken in ms. */
+    uint32_t time_ms;
+    /** Measurement. */
+    BH1750Measurement meas;
+} BH1750MergeEntry;
+
+/** Measurement output by the merge, with the index of the source it came from. */
+typedef struct {
+    /** Index of the source. */
+    size_t source;
+    /** Time at which the measurement was taken in ms. */
+    uint32_t time_ms;
+    /** Measurement. */
+    BH1750Measurement meas;
+} BH1750MergeItem;
+
+/**
+ * @brief One input stream of a merge, e.g. one sensor.
+ *
+ * The caller populates entries and capacity before passing the source to @ref bh1750_merge_init. The remaining fields
+ * are managed by the merge.
+ */
+typedef struct {
+    /** Ring buffer of queued entries. Must have capacity elements and remain valid as long as the merge is being
+     * used. */
+    BH1750MergeEntry *entries;
+    /** Number of elements in entries. */
+    size_t capacity;
+    /** Index of the oldest queued entry. */
+    size_t head;
+    /** Number of queued entries. */
+    size_t count;
+    /** The source will not produce measurements older than this time. */
+    uint32_t watermark_ms;
+    /** Whether the source will not produce any more measurements. */
+    bool finished;
+    /** Position of the source in the heap. */
+    size_t heap_pos;
+} BH1750MergeSource;
+
+/**
+ * @brief Time-ordered k-way merge of measurement streams.
+ *
+ * Populated by @ref bh1750_merge_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    /** Sources. */
+    BH1750MergeSource *sources;
+    /** Min-heap of source indices, ordered by the time of the oldest queued entry or by the watermark if the queue is
+     * empty. */
+    size_t *heap;
+    /** Number of elements in sources and heap. */
+    size_t num_sources;
+} BH1750Merge;
+
+/**
+ * @brief Initialize a merge.
+ *
+ * Every source pushes its measurements in time order into its own queue. @ref bh1750_merge_pop outputs the queued
+ * measurements of all sources in global time order. A measurement is only output once no source can produce an older
+ * one anymore: each source is either finished, has a queued measurement that is not older, or has advanced its
+ * watermark past it. Every push and pop costs O(log k) for k sources, and no memory is allocated.
+ *
+ * Timestamps are compared as unsigned values, so the ms counter must not wrap around while the merge is being used.
+ *
+ * @param[out] merge Merge to initialize.
+ * @param[in] sources Sources. Must remain valid as long as the merge is being used.
+ * @param[in] heap Heap memory. Must have @p num_sources elements and remain valid as long as the merge is being used.
+ * @param[in] num_sources Number of elements in @p sources.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initialized the merge.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p merge, @p sources or @p heap is NULL, @p num_sources is 0, or one of the
+ * sources has no entries memory.
+ */
+uint8_t bh1750_merge_init(BH1750Merge *const merge, BH1750MergeSource *const sources, size_t *const heap,
+                          size_t num_sources);
+
+/**
+ * @brief Queue a measurement of a source.
+ *
+ * Also advances the watermark of the source to @p time_ms.
+ *
+ * @param[in] merge Merge.
+ * @param[in] source Index of the source.
+ * @param[in] meas Measurement.
+ * @param[in] time_ms Time at which the measurement was taken in ms.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully queued the measurement.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p merge or @p meas is NULL, @p source is out of range, or @p time_ms is
+ * older than the watermark of the source.
+ * @retval BH1750_RESULT_CODE_INVALID_USAGE The source is finished.
+ * @retval BH1750_RESULT_CODE_OUT_OF_MEMORY The queue of the source is full.
+ */
+uint8_t bh1750_merge_push(BH1750Merge *const merge, size_t source, const BH1750Measurement *const meas,
+                          uint32_t time_ms);
+
+/**
+ * @brief Promise that a source will not produce measurements older than @p time_ms.
+ *
+ * Call this for live sources that have nothing to push, e.g. a sensor whose read failed, so that they do not hold back
+ * the measurements of the other sources. Has no effect if the watermark is already newer.
+ *
+ * @param[in] merge Merge.
+ * @param[in] source Index of the source.
+ * @param[in] time_ms New watermark in ms.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p merge is NULL, or @p source is out of range.
+ */
+uint8_t bh1750_merge_advance_watermark(BH1750Merge *const merge, size_t source, uint32_t time_ms);
+
+/**
+ * @brief Mark a source as finished, e.g. at the end of a recorded stream.
+ *
+ * Measurements that are already queued are still output. A finished source does not hold back the other sources.
+ *
+ * @param[in] merge Merge.
+ * @param[in] source Index of the source.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p merge is NULL, or @p source is out of range.
+ */
+uint8_t bh1750_merge_finish_source(BH1750Merge *const merge, size_t source);
+
+/**
+ * @brief Output the measurements that are ready, oldest first.
+ *
+ * @param[in] merge Merge.
+ * @param[out] items Output measurements.
+ * @param[in] max_items Number of elements in @p items.
+ * @param[out] num_items Number of measurements written to @p items. Less than @p max_items if no more measurements
+ * are ready.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p merge, @p items or @p num_items is NULL.
+ */
+uint8_t bh1750_merge_pop(BH1750Merge *const merge, BH1750MergeItem *const items, size_t max_items,
+                         size_t *const num_items);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_MERGE_H */
@@ -0,0 +1,216 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "bh1750_metrics.h"
+
+/** Output buffer. Once it overflows, further writes are ignored. */
+typedef struct {
+    char *buf;
+    /** Capacity of buf, excluding the terminating null character. */
+    size_t capacity;
+    size_t len;
+    bool overflow;
+} Writer;
+
+/** Metric family with one counter sample per instance. */
+typedef struct {
+    const char *name;
+    const char *help;
+    /** Offset of the uint32_t counter in BH1750Counters. */
+    size_t offset;
+} CounterFamily;
+
+static const CounterFamily counter_families[] = {
+    {"bh1750_i2c_errors", "Failed I2C transactions.", offsetof(BH1750Counters, num_i2c_errors)},
+    {"bh1750_busy_rejections", "Calls rejected because another sequence was in progress.",
+     offsetof(BH1750Counters, num_busy)},
+    {"bh1750_samples", "Raw measurements read out.", offsetof(BH1750Counters, num_samples)},
+    {"bh1750_suppressed_measurements", "Measurements not passed to the read callback.",
+     offsetof(BH1750Counters, num_suppressed)},
+};
+
+static void put_char(Writer *const w, char c)
+{
+    if (w->len >= w->capacity) {
+        w->overflow = true;
+        return;
+    }
+    w->buf[w->len++] = c;
+}
+
+static void put_str(Writer *const w, const char *str)
+{
+    while (*str != '\0') {
+        put_char(w, *str);
+        str++;
+    }
+}
+
+static void put_uint(Writer *const w, uint64_t val)
+{
+    char digits[20];
+    size_t num_digits = 0;
+    do {
+        digits[num_digits++] = (char)('0' + (val % 10U));
+        val /= 10U;
+    } while (val > 0);
+    while (num_digits > 0) {
+        put_char(w, digits[--num_digits]);
+    }
+}
+
+/**
+ * @brief Write a label value, escaping it as required by OpenMetrics.
+ */
+static void put_label_value(Writer *const w, const char *value)
+{
+    while (*value != '\0') {
+        if (*value == '\n') {
+            put_str(w, "\\n");
+        } else {
+            if ((*value == '\\') || (*value == '"')) {
+                put_char(w, '\\');
+            }
+            put_char(w, *value);
+        }
+        value++;
+    }
+}
+
+/**
+ * @brief Write the label set of a sample, e.g. {bus="i2c-1",addr="0x23",op="read"}.
+ *
+ * @param[in] w Writer.
+ * @param[in] target Target that provides the bus and addr labels.
+ * @param[in] extra_name Name of an additional label. NULL for no additional label.
+ * @param[in] extra_value Value of the additional label. Not escaped.
+ */
+static void put_labels(Writer *const w, const BH1750MetricsTarget *const target, const char *extra_name,
+                       const char *extra_value)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+    put_str(w, "{bus=\"");
+    put_label_value(w, target->bus);
+    put_str(w, "\",addr=\"0x");
+    put_char(w, hex_digits[target->i2c_addr >> 4]);
+    put_char(w, hex_digits[target->i2c_addr & 0x0FU]);
+    put_char(w, '"');
+    if (extra_name) {
+        put_char(w, ',');
+        put_str(w, extra_name);
+        put_str(w, "=\"");
+        put_str(w, extra_value);
+        put_char(w, '"');
+    }
+    put_char(w, '}');
+}
+
+static void put_family_header(Writer *const w, const char *name, const char *type, const char *help)
+{
+    put_str(w, "# TYPE ");
+    put_str(w, name);
+    put_char(w, ' ');
+    put_str(w, type);
+    put_str(w, "\n# HELP ");
+    put_str(w, name);
+    put_char(w, ' ');
+    put_str(w, help);
+    put_char(w, '\n');
+}
+
+static void put_sample(Writer *const w, const char *name, const char *suffix, const BH1750MetricsTarget *const target,
+                       const char *extra_name, const char *extra_value, uint64_t val)
+{
+    put_str(w, name);
+    put_str(w, suffix);
+    put_labels(w, target, extra_name, extra_value);
+    put_char(w, ' ');
+    put_uint(w, val);
+    put_char(w, '\n');
+}
+
+static void put_transactions(Writer *const w, const BH1750MetricsTarget *const targets, size_t num_targets)
+{
+    static const char name[] = "bh1750_i2c_transactions";
+    put_family_header(w, name, "counter", "Started I2C transactions.");
+    for (size_t i = 0; i < num_targets; i++) {
+        put_sample(w, name, "_total", &targets[i], "op", "write", targets[i].counters.num_i2c_writes);
+        put_sample(w, name, "_total", &targets[i], "op", "read", targets[i].counters.num_i2c_reads);
+    }
+}
+
+static void put_counter_family(Writer *const w, const CounterFamily *const family,
+                               const BH1750MetricsTarget *const targets, size_t num_targets)
+{
+    put_family_header(w, family->name, "counter", family->help);
+    for (size_t i = 0; i < num_targets; i++) {
+        const uint32_t *val = (const uint32_t *)(const void *)((const uint8_t *)&targets[i].counters + family->offset);
+        put_sample(w, family->name, "_total", &targets[i], NULL, NULL, *val);
+    }
+}
+
+static void put_latency_histogram(Writer *const w, const BH1750MetricsTarget *const targets, size_t num_targets)
+{
+    static const char name[] = "bh1750_i2c_latency_milliseconds";
+    static const uint32_t bounds_ms[BH1750_LATENCY_NUM_BUCKETS - 1] = BH1750_LATENCY_BUCKET_BOUNDS_MS;
+    /* Bounds as label values, formatted once per export. 10 digits of a uint32_t, or "+Inf". */
+    char bounds[BH1750_LATENCY_NUM_BUCKETS][11];
+    for (size_t b = 0; b < (BH1750_LATENCY_NUM_BUCKETS - 1); b++) {
+        (void)snprintf(bounds[b], sizeof(bounds[b]), "%" PRIu32, bounds_ms[b]);
+    }
+    (void)snprintf(bounds[BH1750_LATENCY_NUM_BUCKETS - 1], sizeof(bounds[0]), "+Inf");
+
+    put_family_header(w, name, "histogram", "Latency of completed I2C transactions.");
+    put_str(w, "# UNIT bh1750_i2c_latency_milliseconds milliseconds\n");
+    for (size_t i = 0; i < num_targets; i++) {
+        const BH1750Counters *counters = &targets[i].counters;
+        /* OpenMetrics buckets are cumulative */
+        uint64_t count = 0;
+        for (size_t b = 0; b < BH1750_LATENCY_NUM_BUCKETS; b++) {
+            count += counters->latency_buckets[b];
+            put_sample(w, name, "_bucket", &targets[i], "le", bounds[b], count);
+        }
+        put_sample(w, name, "_count", &targets[i], NULL, NULL, count);
+        put_sample(w, name, "_sum", &targets[i], NULL, NULL, counters->latency_sum_ms);
+    }
+}
+
+uint8_t bh1750_metrics_write(BH1750MetricsTarget *const targets, size_t num_targets, char *const buf, size_t size,
+                             size_t *const len)
+{
+    if (!buf || !len || (!targets && (num_targets > 0))) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    for (size_t i = 0; i < num_targets; i++) {
+        if (!targets[i].inst || !targets[i].bus) {
+            return BH1750_RESULT_CODE_INVALID_ARG;
+        }
+    }
+    if (size == 0) {
+        return BH1750_RESULT_CODE_OUT_OF_MEMORY;
+    }
+
+    for (size_t i = 0; i < num_targets; i++) {
+        /* Cannot fail - the arguments were validated */
+        bh1750_get_counters(targets[i].inst, &targets[i].counters);
+    }
+
+    Writer w = {buf, size - 1, 0, false};
+    /* Families must not be interleaved, so every family iterates over all targets */
+    put_transactions(&w, targets, num_targets);
+    for (size_t f = 0; f < (sizeof(counter_families) / sizeof(counter_families[0])); f++) {
+        put_counter_family(&w, &counter_families[f], targets, num_targets);
+    }
+    put_latency_histogram(&w, targets, num_targets);
+    put_str(&w, "# EOF\n");
+    if (w.overflow) {
+        return BH1750_RESULT_CODE_OUT_OF_MEMORY;
+    }
+
+    buf[w.len] = '\0';
+    *len = w.len;
+    return BH1750_RESULT_CODE_OK;
+}
@@ -0,0 +1,65 @@
+#ifndef SRC_BH1750_METRICS_H
+#define SRC_BH1750_METRICS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "bh1750.h"
+
+/**
+ * @brief A BH1750 instance to export, together with the values of its labels.
+ *
+ * The caller populates inst, bus and i2c_addr. The remaining fields are managed by @ref bh1750_metrics_write.
+ */
+typedef struct {
+    /** BH1750 instance. */
+    BH1750 inst;
+    /** Value of the "bus" label, e.g. "i2c-1". Backslashes, double quotes and line feeds are escaped. */
+    const char *bus;
+    /** Value of the "addr" label, written in hex, e.g. "0x23". */
+    uint8_t i2c_addr;
+    /** Snapshot of the counters of inst, taken once per export. */
+    BH1750Counters counters;
+} BH1750MetricsTarget;
+
+/**
+ * @brief Write the counters of BH1750 instances in the OpenMetrics text format.
+ *
+ * Writes the following metric families, with one sample per instance in every family:
+ * - bh1750_i2c_transactions_total (counter), with label op="write" or op="read".
+ * - bh1750_i2c_errors_total (counter).
+ * - bh1750_busy_rejections_total (counter).
+ * - bh1750_samples_total (counter).
+ * - bh1750_suppressed_measurements_total (counter).
+ * - bh1750_i2c_latency_milliseconds (histogram).
+ *
+ * Every sample has the labels bus and addr. The output is terminated by the "# EOF" line, as required by OpenMetrics,
+ * and by a null character. No memory is allocated, and the counters are read with @ref bh1750_get_counters, so this
+ * can be called while sequences are in progress. The counters of every target are copied into the target once, before
+ * anything is written, so that all families of a target are consistent with each other.
+ *
+ * @param[in,out] targets Instances to export.
+ * @param[in] num_targets Number of elements in @p targets.
+ * @param[out] buf The text is written here.
+ * @param[in] size Size of @p buf in bytes, including space for the terminating null character.
+ * @param[out] len Length of the text in bytes, excluding the terminating null character, is written here in case of
+ * success.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p buf or @p len is NULL, @p targets is NULL while @p num_targets is not 0,
+ * or the instance or the bus label of one of the targets is NULL.
+ * @retval BH1750_RESULT_CODE_OUT_OF_MEMORY @p buf is too small. The contents of @p buf are undefined.
+ */
+uint8_t bh1750_metrics_write(BH1750MetricsTarget *const targets, size_t num_targets, char *const buf, size_t size,
+                             size_t *const len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_METRICS_H */
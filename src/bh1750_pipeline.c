@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750_pipeline.h"
+
+uint8_t bh1750_pipeline_init(BH1750Pipeline *const pipeline, const BH1750PipelineStage *const stages,
+                             size_t num_stages)
+{
+    if (!pipeline || !stages || (num_stages == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    for (size_t i = 0; i < num_stages; i++) {
+        if (!stages[i].fn) {
+            return BH1750_RESULT_CODE_INVALID_ARG;
+        }
+    }
+
+    pipeline->stages = stages;
+    pipeline->num_stages = num_stages;
+    return BH1750_RESULT_CODE_OK;
+}
+
+bool bh1750_pipeline_process(BH1750Measurement *meas, void *user_data)
+{
+    const BH1750Pipeline *pipeline = (const BH1750Pipeline *)user_data;
+    if (!meas || !pipeline) {
+        return false;
+    }
+
+    for (size_t i = 0; i < pipeline->num_stages; i++) {
+        if (!pipeline->stages[i].fn(meas, pipeline->stages[i].state)) {
+            /* Early exit - subsequent stages do not see dropped measurements */
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t bh1750_pipeline_process_batch(const BH1750Pipeline *const pipeline, BH1750Measurement *const meas,
+                                      size_t num_meas, size_t *const kept_idx, size_t *const num_kept)
+{
+    if (!pipeline || !meas || !kept_idx || !num_kept) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    for (size_t j = 0; j < num_meas; j++) {
+        kept_idx[j] = j;
+    }
+    size_t num_remaining = num_meas;
+    for (size_t i = 0; i < pipeline->num_stages; i++) {
+        BH1750PipelineStageFn fn = pipeline->stages[i].fn;
+        void *state = pipeline->stages[i].state;
+        /* Compact indices rather than measurements, preserving their order */
+        size_t num_out = 0;
+        for (size_t j = 0; j < num_remaining; j++) {
+            size_t idx = kept_idx[j];
+            if (fn(&meas[idx], state)) {
+                kept_idx[num_out] = idx;
+                num_out++;
+            }
+        }
+        num_remaining = num_out;
+    }
+
+    *num_kept = num_remaining;
+    return BH1750_RESULT_CODE_OK;
+}
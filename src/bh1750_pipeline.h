@@ -0,0 +1,107 @@
+#ifndef SRC_BH1750_PIPELINE_H
+#define SRC_BH1750_PIPELINE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/**
+ * @brief Pipeline stage function type.
+ *
+ * @param[in,out] meas Measurement to process. The stage can modify it in place.
+ * @param[in,out] state Per-stage state that was passed in @ref BH1750PipelineStage.
+ *
+ * @retval true Pass the measurement to the next stage.
+ * @retval false Drop the measurement. Subsequent stages are not executed for it.
+ */
+typedef bool (*BH1750PipelineStageFn)(BH1750Measurement *meas, void *state);
+
+/** Pipeline stage. */
+typedef struct {
+    /** Stage function. */
+    BH1750PipelineStageFn fn;
+    /** State of this stage, e.g. calibration coefficients or filter history. Passed to fn. Memory is owned by the
+     * caller. */
+    void *state;
+} BH1750PipelineStage;
+
+/**
+ * @brief Pipeline of measurement processing stages.
+ *
+ * Populated by @ref bh1750_pipeline_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    /** Stages, executed in order. */
+    const BH1750PipelineStage *stages;
+    /** Number of elements in stages. */
+    size_t num_stages;
+} BH1750Pipeline;
+
+/**
+ * @brief Initialize a pipeline.
+ *
+ * The pipeline does not allocate memory and does not copy measurements. Stages and their state live in memory
+ * provided by the caller, which must remain valid as long as the pipeline is being used.
+ *
+ * @param[out] pipeline Pipeline to initialize.
+ * @param[in] stages Stages, executed in order.
+ * @param[in] num_stages Number of elements in @p stages.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initialized the pipeline.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p pipeline or @p stages is NULL, @p num_stages is 0, or one of the stages
+ * has a NULL function.
+ */
+uint8_t bh1750_pipeline_init(BH1750Pipeline *const pipeline, const BH1750PipelineStage *const stages,
+                             size_t num_stages);
+
+/**
+ * @brief Run one measurement through all stages of a pipeline.
+ *
+ * Has the signature of @ref BH1750ProcessMeas, so that a pipeline can be attached to a BH1750 instance:
+ * @code
+ * bh1750_set_meas_processor(inst, bh1750_pipeline_process, &pipeline);
+ * @endcode
+ *
+ * @param[in,out] meas Measurement to process.
+ * @param[in] user_data Pointer to an initialized @ref BH1750Pipeline.
+ *
+ * @retval true All stages passed the measurement.
+ * @retval false One of the stages dropped the measurement, or one of the arguments is NULL.
+ */
+bool bh1750_pipeline_process(BH1750Measurement *meas, void *user_data);
+
+/**
+ * @brief Run a batch of buffered measurements through all stages of a pipeline.
+ *
+ * Stages are executed one at a time over the whole batch, so that the code and state of each stage stay in cache
+ * while it processes the batch. Every stage sees the measurements in the same order as they are in @p meas.
+ *
+ * Measurements are processed in place and are never moved or copied. Instead, the indices of the measurements that
+ * are still kept are compacted after every stage, so that the next stage only visits those. Once all stages are done,
+ * kept_idx[0] to kept_idx[num_kept - 1] are the indices in @p meas of the measurements that passed all stages, in
+ * ascending order.
+ *
+ * @param[in] pipeline Pipeline.
+ * @param[in,out] meas Measurements to process.
+ * @param[in] num_meas Number of elements in @p meas.
+ * @param[out] kept_idx Indices of the measurements that passed all stages. Must have @p num_meas elements.
+ * @param[out] num_kept Number of measurements that passed all stages.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p pipeline, @p meas, @p kept_idx or @p num_kept is NULL.
+ */
+uint8_t bh1750_pipeline_process_batch(const BH1750Pipeline *const pipeline, BH1750Measurement *const meas,
+                                      size_t num_meas, size_t *const kept_idx, size_t *const num_kept);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_PIPELINE_H */
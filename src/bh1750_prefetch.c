@@ -0,0 +1,235 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750_prefetch.h"
+
+/** Maximum value of period_shift in @ref BH1750PrefetchConfig. */
+#define BH1750_PREFETCH_MAX_PERIOD_SHIFT 8
+
+static bool is_valid_cfg(const BH1750PrefetchConfig *const cfg)
+{
+    return cfg->inst && cfg->start_timer && cfg->get_time && (cfg->meas_mode <= BH1750_MEAS_MODE_L_RES) &&
+           (cfg->period_shift <= BH1750_PREFETCH_MAX_PERIOD_SHIFT) && (cfg->max_age_ms > 0);
+}
+
+static uint32_t get_now_ms(const BH1750Prefetch *const prefetch)
+{
+    return prefetch->cfg.get_time(prefetch->cfg.get_time_user_data);
+}
+
+/**
+ * @brief Update the learned request period with the interval since the previous request.
+ */
+static void learn_period(BH1750Prefetch *const prefetch, uint32_t now_ms)
+{
+    if (prefetch->has_last_request) {
+        uint32_t interval_ms = now_ms - prefetch->last_request_ms;
+        uint8_t shift = prefetch->cfg.period_shift;
+        if (prefetch->period_ms == 0) {
+            prefetch->period_scaled = (uint64_t)interval_ms << shift;
+        } else {
+            /* Scaled by 2^shift, so that intervals that differ from the period by less than 2^shift still move it */
+            prefetch->period_scaled = prefetch->period_scaled + interval_ms - (prefetch->period_scaled >> shift);
+        }
+        prefetch->period_ms = (uint32_t)(prefetch->period_scaled >> shift);
+        if (prefetch->period_ms == 0) {
+            /* Requests at the same ms - keep the period known */
+            prefetch->period_ms = 1;
+        }
+    }
+    prefetch->has_last_request = true;
+    prefetch->last_request_ms = now_ms;
+}
+
+static void read_complete_cb(uint8_t result_code, const BH1750Measurement *meas, void *user_data);
+
+/**
+ * @brief Start a one time measurement.
+ *
+ * The state is updated before the read is started, in case the read completes right away.
+ */
+static uint8_t start_read(BH1750Prefetch *const prefetch, bool is_prefetch, uint32_t now_ms)
+{
+    prefetch->is_reading = true;
+    prefetch->is_prefetch_read = is_prefetch;
+    prefetch->read_start_ms = now_ms;
+    uint8_t rc = bh1750_read_one_time_measurement(prefetch->cfg.inst, prefetch->cfg.meas_mode, read_complete_cb,
+                                                  (void *)prefetch);
+    if (rc != BH1750_RESULT_CODE_OK) {
+        prefetch->is_reading = false;
+    }
+    return rc;
+}
+
+static void start_prefetch(BH1750Prefetch *const prefetch)
+{
+    if (prefetch->is_reading) {
+        prefetch->start_after_read = true;
+        return;
+    }
+    /* Ignore return value - if the instance is busy, the next request misses */
+    start_read(prefetch, true, get_now_ms(prefetch));
+}
+
+static void timer_expired_cb(void *user_data)
+{
+    BH1750Prefetch *prefetch = (BH1750Prefetch *)user_data;
+    prefetch->is_timer_pending = false;
+    if (!prefetch->is_prefetch_scheduled) {
+        return;
+    }
+
+    uint32_t now_ms = get_now_ms(prefetch);
+    int32_t remaining_ms = (int32_t)(prefetch->prefetch_at_ms - now_ms);
+    if (remaining_ms > 0) {
+        /* Rescheduled to a later time while the timer was pending */
+        prefetch->is_timer_pending = true;
+        prefetch->cfg.start_timer((uint32_t)remaining_ms, prefetch->cfg.start_timer_user_data, timer_expired_cb,
+                                  (void *)prefetch);
+        return;
+    }
+    prefetch->is_prefetch_scheduled = false;
+    start_prefetch(prefetch);
+}
+
+/**
+ * @brief Schedule a prefetch, so that it completes lead_ms before the predicted next request.
+ *
+ * If a timer is already pending, only the time is updated. Timers cannot be cancelled, so if the new time is earlier
+ * than the pending timer, the prefetch starts when the pending timer expires.
+ */
+static void schedule_prefetch(BH1750Prefetch *const prefetch, uint32_t now_ms)
+{
+    if (prefetch->period_ms == 0) {
+        return;
+    }
+
+    uint32_t ahead_ms = prefetch->read_duration_ms + prefetch->cfg.lead_ms;
+    uint32_t delay_ms = (prefetch->period_ms > ahead_ms) ? (prefetch->period_ms - ahead_ms) : 0;
+    prefetch->prefetch_at_ms = now_ms + delay_ms;
+    prefetch->is_prefetch_scheduled = true;
+    if (!prefetch->is_timer_pending) {
+        prefetch->is_timer_pending = true;
+        prefetch->cfg.start_timer(delay_ms, prefetch->cfg.start_timer_user_data, timer_expired_cb, (void *)prefetch);
+    }
+}
+
+static void read_complete_cb(uint8_t result_code, const BH1750Measurement *meas, void *user_data)
+{
+    BH1750Prefetch *prefetch = (BH1750Prefetch *)user_data;
+    uint32_t now_ms = get_now_ms(prefetch);
+    prefetch->is_reading = false;
+    if ((result_code == BH1750_RESULT_CODE_OK) || (result_code == BH1750_RESULT_CODE_SUPPRESSED)) {
+        prefetch->read_duration_ms = now_ms - prefetch->read_start_ms;
+    }
+
+    if (prefetch->has_waiter) {
+        prefetch->has_waiter = false;
+        if (prefetch->waiter_cb) {
+            prefetch->waiter_cb(result_code, meas, prefetch->waiter_user_data);
+        }
+    } else if (prefetch->is_prefetch_read && (result_code == BH1750_RESULT_CODE_OK)) {
+        if (prefetch->has_cached) {
+            prefetch->stats.num_wasted++;
+        }
+        prefetch->cached = *meas;
+        prefetch->cached_time_ms = now_ms;
+        prefetch->has_cached = true;
+    }
+
+    if (prefetch->start_after_read && !prefetch->is_reading) {
+        prefetch->start_after_read = false;
+        start_prefetch(prefetch);
+    }
+}
+
+uint8_t bh1750_prefetch_init(BH1750Prefetch *const prefetch, const BH1750PrefetchConfig *const cfg)
+{
+    if (!prefetch || !cfg || !is_valid_cfg(cfg)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    prefetch->cfg = *cfg;
+    prefetch->is_reading = false;
+    prefetch->is_prefetch_read = false;
+    prefetch->read_start_ms = 0;
+    prefetch->read_duration_ms = 0;
+    prefetch->has_waiter = false;
+    prefetch->waiter_cb = NULL;
+    prefetch->waiter_user_data = NULL;
+    prefetch->has_cached = false;
+    prefetch->cached_time_ms = 0;
+    prefetch->has_last_request = false;
+    prefetch->last_request_ms = 0;
+    prefetch->period_scaled = 0;
+    prefetch->period_ms = 0;
+    prefetch->is_timer_pending = false;
+    prefetch->is_prefetch_scheduled = false;
+    prefetch->prefetch_at_ms = 0;
+    prefetch->start_after_read = false;
+    BH1750PrefetchStats zero_stats = {0};
+    prefetch->stats = zero_stats;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_prefetch_request(BH1750Prefetch *const prefetch, BH1750ReadCb cb, void *user_data)
+{
+    if (!prefetch) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (prefetch->has_waiter) {
+        return BH1750_RESULT_CODE_BUSY;
+    }
+
+    uint32_t now_ms = get_now_ms(prefetch);
+    if (prefetch->has_cached && ((now_ms - prefetch->cached_time_ms) > prefetch->cfg.max_age_ms)) {
+        prefetch->has_cached = false;
+        prefetch->stats.num_wasted++;
+    }
+
+    if (prefetch->has_cached) {
+        prefetch->has_cached = false;
+        prefetch->stats.num_requests++;
+        prefetch->stats.num_hits++;
+        learn_period(prefetch, now_ms);
+        schedule_prefetch(prefetch, now_ms);
+        /* Copied, so that the cb can issue the next request */
+        BH1750Measurement meas = prefetch->cached;
+        if (cb) {
+            cb(BH1750_RESULT_CODE_OK, &meas, user_data);
+        }
+        return BH1750_RESULT_CODE_OK;
+    }
+
+    prefetch->has_waiter = true;
+    prefetch->waiter_cb = cb;
+    prefetch->waiter_user_data = user_data;
+    if (prefetch->is_reading) {
+        prefetch->stats.num_late++;
+    } else {
+        uint8_t rc = start_read(prefetch, false, now_ms);
+        if (rc != BH1750_RESULT_CODE_OK) {
+            prefetch->has_waiter = false;
+            return rc;
+        }
+        prefetch->stats.num_misses++;
+    }
+    prefetch->stats.num_requests++;
+    learn_period(prefetch, now_ms);
+    schedule_prefetch(prefetch, now_ms);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_prefetch_get_stats(const BH1750Prefetch *const prefetch, BH1750PrefetchStats *const stats)
+{
+    if (!prefetch || !stats) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    *stats = prefetch->stats;
+    stats->hit_rate_pct =
+        (stats->num_requests > 0) ? (uint8_t)(((uint64_t)stats->num_hits * 100U) / stats->num_requests) : 0;
+    stats->period_ms = prefetch->period_ms;
+    return BH1750_RESULT_CODE_OK;
+}
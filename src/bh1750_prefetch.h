@@ -0,0 +1,153 @@
+#ifndef SRC_BH1750_PREFETCH_H
+#define SRC_BH1750_PREFETCH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/**
+ * @brief Predictive prefetch of one time measurements.
+ *
+ * Learns the period at which a consumer requests measurements from an instance, and starts the next one time
+ * measurement ahead of the predicted request, so that the measurement is already cached when the request arrives. The
+ * period is a moving average of the intervals between requests, and the lead time is the measured duration of the last
+ * read plus a configurable margin.
+ *
+ * While a prefetcher is used, the instance must only be read through it.
+ */
+
+/** Prefetcher config. */
+typedef struct {
+    /** Initialized instance to read from. */
+    BH1750 inst;
+    /** Measurement mode of the one time measurements. One of @ref BH1750MeasMode. */
+    uint8_t meas_mode;
+    /** Used to schedule prefetches. Independent of the timer of the instance. */
+    BH1750StartTimer start_timer;
+    void *start_timer_user_data;
+    BH1750GetTime get_time;
+    void *get_time_user_data;
+    /** The request period is an exponentially weighted moving average with weight 1 / 2^period_shift for the newest
+     * interval. 0 <= period_shift <= 8. */
+    uint8_t period_shift;
+    /** Margin in ms by which a prefetched measurement should complete before the predicted request. */
+    uint32_t lead_ms;
+    /** A cached measurement older than this in ms is not returned, and counts as wasted. Must be > 0. */
+    uint32_t max_age_ms;
+} BH1750PrefetchConfig;
+
+/** Prefetcher statistics, see @ref bh1750_prefetch_get_stats. */
+typedef struct {
+    /** Number of accepted requests. */
+    uint32_t num_requests;
+    /** Number of requests served from the cache, before @ref bh1750_prefetch_request returned. */
+    uint32_t num_hits;
+    /** Number of requests that arrived while a prefetch was in progress. They are served once it completes. */
+    uint32_t num_late;
+    /** Number of requests that had to start a new measurement. */
+    uint32_t num_misses;
+    /** Number of prefetched measurements that were never returned, because they expired or were replaced. */
+    uint32_t num_wasted;
+    /** num_hits in percent of num_requests, rounded down. 0 if there were no requests. */
+    uint8_t hit_rate_pct;
+    /** Currently learned request period in ms. 0 if not known yet. */
+    uint32_t period_ms;
+} BH1750PrefetchStats;
+
+/**
+ * @brief Prefetcher of one instance.
+ *
+ * Populated by @ref bh1750_prefetch_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    BH1750PrefetchConfig cfg;
+    /** Whether a read of the instance is in progress. */
+    bool is_reading;
+    /** Whether the read in progress was started by a prefetch, rather than by a request. */
+    bool is_prefetch_read;
+    /** Time at which the read in progress was started. */
+    uint32_t read_start_ms;
+    /** Duration of the last successful read in ms. */
+    uint32_t read_duration_ms;
+    /** Request waiting for the read in progress. */
+    bool has_waiter;
+    BH1750ReadCb waiter_cb;
+    void *waiter_user_data;
+    /** Prefetched measurement that was not returned yet. */
+    bool has_cached;
+    BH1750Measurement cached;
+    uint32_t cached_time_ms;
+    /** Time of the last request. */
+    bool has_last_request;
+    uint32_t last_request_ms;
+    /** Learned request period in ms, times 2^period_shift. */
+    uint64_t period_scaled;
+    /** Learned request period in ms, period_scaled / 2^period_shift. 0 if not known yet. */
+    uint32_t period_ms;
+    /** Whether a timer of this prefetcher is pending. Timers cannot be cancelled, so at most one is started at a time.
+     */
+    bool is_timer_pending;
+    /** Whether a prefetch should start at prefetch_at_ms. */
+    bool is_prefetch_scheduled;
+    uint32_t prefetch_at_ms;
+    /** Whether a prefetch should start as soon as the read in progress completes. */
+    bool start_after_read;
+    BH1750PrefetchStats stats;
+} BH1750Prefetch;
+
+/**
+ * @brief Initialize a prefetcher.
+ *
+ * @param[out] prefetch Prefetcher to initialize.
+ * @param[in] cfg Config. Copied into @p prefetch.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initialized the prefetcher.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p prefetch or @p cfg is NULL, or @p cfg is invalid.
+ */
+uint8_t bh1750_prefetch_init(BH1750Prefetch *const prefetch, const BH1750PrefetchConfig *const cfg);
+
+/**
+ * @brief Request a one time measurement.
+ *
+ * If a prefetched measurement is cached, @p cb is executed with it before this function returns. If a prefetch is in
+ * progress, @p cb is executed once it completes. Otherwise, a new one time measurement is started, and @p cb is
+ * executed once it completes. Either way, the request is used to learn the request period, and the next prefetch is
+ * scheduled.
+ *
+ * @param[in] prefetch Prefetcher.
+ * @param[in] cb Callback to execute with the measurement. Same semantics as the read callback of @ref
+ * bh1750_read_one_time_measurement, including @ref BH1750_RESULT_CODE_SUPPRESSED if change notification or a
+ * measurement processor of the instance suppressed the measurement. Can be NULL.
+ * @param[in] user_data User data to pass to @p cb.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully accepted the request.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p prefetch is NULL.
+ * @retval BH1750_RESULT_CODE_BUSY A previous request is still waiting for its measurement, or the instance is busy with
+ * another sequence.
+ * @retval BH1750_RESULT_CODE_INVALID_USAGE The instance is not initialized.
+ */
+uint8_t bh1750_prefetch_request(BH1750Prefetch *const prefetch, BH1750ReadCb cb, void *user_data);
+
+/**
+ * @brief Get prefetcher statistics.
+ *
+ * @param[in] prefetch Prefetcher.
+ * @param[out] stats Statistics.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p prefetch or @p stats is NULL.
+ */
+uint8_t bh1750_prefetch_get_stats(const BH1750Prefetch *const prefetch, BH1750PrefetchStats *const stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_PREFETCH_H */
@@ -30,6 +30,10 @@ struct BH1750Struct {
     BH1750StartTimer start_timer;
     /** @brief User data to pass to start_timer. */
     void *start_timer_user_data;
+    /** @brief User-defined get time function that was passed to bh1750_create. Can be NULL. */
+    BH1750GetTime get_time;
+    /** @brief User data to pass to get_time. */
+    void *get_time_user_data;
     /** @brief Callback to execute once current sequence is complete.
      *
      * void * because different sequences types might require different callback types to be executed.
@@ -37,12 +41,13 @@ struct BH1750Struct {
     void *seq_cb;
     /** @brief User data to pass to seq_cb. */
     void *seq_cb_user_data;
-    /** @brief Address to write measurement in lx. Only valid for read_cont_meas sequence. */
-    uint32_t *meas_p;
     /** @brief I2C address of this BH1750 instance. */
     uint8_t i2c_addr;
     /** @brief Used only in the set_meas_time sequence. */
     uint8_t meas_time_to_set;
+    /** @brief Whether the init sequence should start continuous measurement in meas_mode after setting Mtreg. Used
+     * only in the init sequence. */
+    bool start_cont_meas_after_init;
     /** @brief This buffer is passed to i2c_read function to save the received data. */
     uint8_t read_buf[2];
     /** @brief Whether continuous measurement is currently ongoing. */
@@ -60,6 +65,81 @@ struct BH1750Struct {
      * Used for converting raw measurements to light intensity in lx.
      */
     uint8_t meas_time;
+    /** @brief Decimator type. One of @ref BH1750DecimatorType. */
+    uint8_t dec_type;
+    /** @brief Number of raw measurements combined into one output. 1 means decimation is disabled. */
+    uint8_t dec_factor;
+    /** @brief Number of raw measurements collected in dec_samples during the current read sequence. */
+    uint8_t dec_num_samples;
+    /** @brief Raw measurements collected during the current read sequence. */
+    uint16_t dec_samples[BH1750_MAX_DECIMATION_FACTOR];
+    /** @brief Whether the current read sequence is a one time measurement sequence. Used to decide how to take the
+     * next raw measurement for the decimator. */
+    bool is_one_time_meas_seq;
+    /** @brief Whether the next raw measurement of the ongoing sequence is the L-resolution preview of a progressive
+     * read sequence. */
+    bool is_preview_pending;
+    /** @brief Measurement mode of the refined measurement that follows the preview. Used only in the progressive read
+     * sequence. */
+    uint8_t refined_meas_mode;
+    /** @brief Callback to execute with the preview measurement. Interpreted as BH1750ReadCb. Can be NULL. */
+    void *preview_cb;
+    /** @brief User data to pass to preview_cb. */
+    void *preview_cb_user_data;
+    /** @brief Whether the ongoing sequence is a burst of one time measurements. seq_cb is interpreted as BH1750BurstCb
+     * in that case. */
+    bool is_burst_seq;
+    /** @brief Caller-provided array that the measurements of the burst are written to. */
+    BH1750Measurement *burst_meas;
+    /** @brief Number of elements in burst_meas. */
+    size_t burst_len;
+    /** @brief Number of measurements of the burst written to burst_meas so far. */
+    size_t burst_num_done;
+    /** @brief Processor executed for every successfully read measurement before the read cb. Can be NULL. */
+    BH1750ProcessMeas process_meas;
+    /** @brief User data to pass to process_meas. */
+    void *process_meas_user_data;
+    /** @brief Whether change notification is enabled. */
+    bool notify_enabled;
+    /** @brief Change notification thresholds and deadband in lx, as passed to bh1750_set_change_notify. */
+    uint32_t notify_low_lx;
+    uint32_t notify_high_lx;
+    uint32_t notify_deadband_lx;
+    /** @brief Change notification thresholds and deadband converted to raw counts for notify_meas_mode and
+     * notify_meas_time. */
+    uint32_t notify_low_raw;
+    uint32_t notify_high_raw;
+    uint32_t notify_deadband_raw;
+    /** @brief Measurement mode and time that the raw thresholds were computed for. notify_meas_time is 0 if no
+     * measurement has been evaluated since change notification was configured. */
+    uint8_t notify_meas_mode;
+    uint8_t notify_meas_time;
+    /** @brief Which threshold was crossed last. Used to implement hysteresis. */
+    uint8_t notify_level;
+    /** @brief Raw measurement that was last passed to the read cb. Used for the deadband. */
+    uint16_t notify_last_raw;
+    /** @brief Time at which the start continuous measurement command completed. Only valid if cont_meas_start_known
+     * is true. */
+    uint32_t cont_meas_start_time_ms;
+    /** @brief False if continuous measurement was started before attach, so its start time is unknown. */
+    bool cont_meas_start_known;
+    /** @brief Time at which the last one time measurement command completed. */
+    uint32_t one_time_cmd_time_ms;
+    /** @brief Midpoint of the integration window of the first raw measurement collected for the decimator. */
+    uint32_t first_mid_time_ms;
+    /** @brief Whether to run the recovery sequence when an I2C transaction of a read sequence fails. */
+    bool auto_recover;
+    /** @brief Whether the ongoing recovery sequence was started because a read failed. Decides which callback type to
+     * execute at the end of the recovery sequence. */
+    bool is_recovering_after_read_err;
+    /** @brief Callback to execute once the ongoing I2C transaction is complete. */
+    BH1750_I2CCompleteCb i2c_cb;
+    /** @brief User data to pass to i2c_cb. */
+    void *i2c_cb_user_data;
+    /** @brief Time at which the ongoing I2C transaction was started. */
+    uint32_t i2c_start_time_ms;
+    /** @brief Counters returned by bh1750_get_counters. */
+    BH1750Counters counters;
     /** @brief Whether the instance is initialized. Set to true after init is called successfully. */
     bool initialized;
     /** @brief True if there is currently a sequence ongoing, false otherwise. */
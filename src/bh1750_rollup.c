@@ -0,0 +1,181 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750_rollup.h"
+
+/**
+ * @brief Merge aggregate @p src into aggregate @p dst.
+ */
+static void merge_entry(BH1750RollupEntry *const dst, const BH1750RollupEntry *const src)
+{
+    if (src->num_samples == 0) {
+        return;
+    }
+    if (dst->num_samples == 0) {
+        *dst = *src;
+        return;
+    }
+
+    dst->num_samples += src->num_samples;
+    dst->sum_lx += src->sum_lx;
+    if (src->min_lx < dst->min_lx) {
+        dst->min_lx = src->min_lx;
+    }
+    if (src->max_lx > dst->max_lx) {
+        dst->max_lx = src->max_lx;
+    }
+}
+
+/**
+ * @brief Merge an aggregate into a level, opening a new bucket if necessary.
+ *
+ * If a new bucket is opened, the bucket that was closed is merged into the next coarser level.
+ *
+ * @param[in] rollup Rollup store.
+ * @param[in] level_idx Level index.
+ * @param[in] src Aggregate to merge. src->start_s determines the bucket.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG The bucket of @p src is older than the newest bucket of the level.
+ */
+static uint8_t merge_into_level(BH1750Rollup *const rollup, size_t level_idx, const BH1750RollupEntry *const src)
+{
+    BH1750RollupLevel *level = &rollup->levels[level_idx];
+    uint32_t bucket_start_s = src->start_s - (src->start_s % level->resolution_s);
+
+    if (level->count > 0) {
+        BH1750RollupEntry *newest = &level->entries[level->newest];
+        if (bucket_start_s == newest->start_s) {
+            merge_entry(newest, src);
+            return BH1750_RESULT_CODE_OK;
+        }
+        if (bucket_start_s < newest->start_s) {
+            return BH1750_RESULT_CODE_INVALID_ARG;
+        }
+    }
+
+    bool has_closed = (level->count > 0);
+    /* Copy before opening the new bucket, which can overwrite the closed entry if capacity is 1 */
+    BH1750RollupEntry closed;
+    if (has_closed) {
+        closed = level->entries[level->newest];
+    }
+
+    level->newest = (level->count > 0) ? ((level->newest + 1) % level->capacity) : 0;
+    if (level->count < level->capacity) {
+        level->count++;
+    }
+    level->entries[level->newest] = *src;
+    level->entries[level->newest].start_s = bucket_start_s;
+
+    if (has_closed && ((level_idx + 1) < rollup->num_levels)) {
+        /* Closed buckets are always older than the newest bucket of the coarser level, so this cannot fail */
+        merge_into_level(rollup, level_idx + 1, &closed);
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+static const BH1750RollupEntry *get_entry_at_age(const BH1750RollupLevel *const level, size_t age)
+{
+    return &level->entries[(level->newest + level->capacity - age) % level->capacity];
+}
+
+/**
+ * @brief Find the newest entry of a level that starts before a time.
+ *
+ * @param[in] level Level.
+ * @param[in] end_s Time in s.
+ *
+ * @return size_t Age of the entry, or level->count if all entries start at or after @p end_s.
+ */
+static size_t find_newest_before(const BH1750RollupLevel *const level, uint32_t end_s)
+{
+    /* Start times decrease with age, so entries before end_s are a suffix of the ages */
+    size_t lo = 0;
+    size_t hi = level->count;
+    while (lo < hi) {
+        size_t mid = lo + ((hi - lo) / 2);
+        if (get_entry_at_age(level, mid)->start_s < end_s) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+uint8_t bh1750_rollup_init(BH1750Rollup *const rollup, BH1750RollupLevel *const levels, size_t num_levels)
+{
+    if (!rollup || !levels || (num_levels == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    for (size_t i = 0; i < num_levels; i++) {
+        if (!levels[i].entries || (levels[i].capacity == 0) || (levels[i].resolution_s == 0)) {
+            return BH1750_RESULT_CODE_INVALID_ARG;
+        }
+        if ((i > 0) && ((levels[i].resolution_s % levels[i - 1].resolution_s) != 0)) {
+            return BH1750_RESULT_CODE_INVALID_ARG;
+        }
+    }
+
+    for (size_t i = 0; i < num_levels; i++) {
+        levels[i].newest = 0;
+        levels[i].count = 0;
+    }
+    rollup->levels = levels;
+    rollup->num_levels = num_levels;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_rollup_add(BH1750Rollup *const rollup, const BH1750Measurement *const meas, uint32_t time_s)
+{
+    if (!rollup || !meas) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    BH1750RollupEntry sample;
+    sample.start_s = time_s;
+    sample.num_samples = 1;
+    sample.min_lx = meas->meas_lx;
+    sample.max_lx = meas->meas_lx;
+    sample.sum_lx = meas->meas_lx;
+    return merge_into_level(rollup, 0, &sample);
+}
+
+uint8_t bh1750_rollup_get_entry(const BH1750Rollup *const rollup, size_t level, size_t age,
+                                BH1750RollupEntry *const entry)
+{
+    if (!rollup || !entry || (level >= rollup->num_levels) || (age >= rollup->levels[level].count)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    *entry = *get_entry_at_age(&rollup->levels[level], age);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_rollup_query(const BH1750Rollup *const rollup, size_t level, uint32_t start_s, uint32_t end_s,
+                            BH1750RollupEntry *const result)
+{
+    if (!rollup || !result || (level >= rollup->num_levels)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    result->start_s = 0;
+    result->num_samples = 0;
+    result->min_lx = 0;
+    result->max_lx = 0;
+    result->sum_lx = 0;
+
+    const BH1750RollupLevel *l = &rollup->levels[level];
+    for (size_t age = find_newest_before(l, end_s); age < l->count; age++) {
+        const BH1750RollupEntry *entry = get_entry_at_age(l, age);
+        if (entry->start_s < start_s) {
+            /* Entries are ordered by time, all remaining entries are older */
+            break;
+        }
+        merge_entry(result, entry);
+        result->start_s = entry->start_s;
+    }
+    return BH1750_RESULT_CODE_OK;
+}
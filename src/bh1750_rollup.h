@@ -0,0 +1,132 @@
+#ifndef SRC_BH1750_ROLLUP_H
+#define SRC_BH1750_ROLLUP_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/** Aggregate of all measurements in one time bucket. */
+typedef struct {
+    /** Start of the time bucket in s. A multiple of the resolution of the level. */
+    uint32_t start_s;
+    /** Number of measurements in the bucket. */
+    uint32_t num_samples;
+    /** Smallest illuminance in lx. */
+    uint32_t min_lx;
+    /** Largest illuminance in lx. */
+    uint32_t max_lx;
+    /** Sum of illuminance in lx. Divide by num_samples to get the mean. */
+    uint64_t sum_lx;
+} BH1750RollupEntry;
+
+/**
+ * @brief One resolution level of a rollup store.
+ *
+ * The caller populates entries, capacity and resolution_s before passing the level to @ref bh1750_rollup_init. The
+ * remaining fields are managed by the rollup store.
+ */
+typedef struct {
+    /** Ring buffer of entries. Must have capacity elements and remain valid as long as the rollup store is being
+     * used. */
+    BH1750RollupEntry *entries;
+    /** Number of elements in entries. The level keeps the history of the last capacity * resolution_s seconds. */
+    size_t capacity;
+    /** Length of the time bucket of every entry in s. */
+    uint32_t resolution_s;
+    /** Index of the newest entry. */
+    size_t newest;
+    /** Number of valid entries. */
+    size_t count;
+} BH1750RollupLevel;
+
+/**
+ * @brief Multi-resolution rollup store.
+ *
+ * Populated by @ref bh1750_rollup_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    /** Levels, from the finest to the coarsest resolution. */
+    BH1750RollupLevel *levels;
+    /** Number of elements in levels. */
+    size_t num_levels;
+} BH1750Rollup;
+
+/**
+ * @brief Initialize a rollup store.
+ *
+ * Every level keeps a ring buffer of aggregates at its resolution. Measurements are only added to the finest level.
+ * Every time a bucket of a level is closed, because a measurement for a later bucket arrived, the closed entry is
+ * merged into the next coarser level. As a result, the newest entry of a coarser level does not include the buckets of
+ * the finer levels that are still open.
+ *
+ * @param[out] rollup Rollup store to initialize.
+ * @param[in] levels Levels, from the finest to the coarsest resolution. The resolution of every level must be a
+ * multiple of the resolution of the previous level.
+ * @param[in] num_levels Number of elements in @p levels.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initialized the rollup store.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p rollup or @p levels is NULL, @p num_levels is 0, or one of the levels is
+ * invalid.
+ */
+uint8_t bh1750_rollup_init(BH1750Rollup *const rollup, BH1750RollupLevel *const levels, size_t num_levels);
+
+/**
+ * @brief Add a measurement to a rollup store.
+ *
+ * @param[in] rollup Rollup store.
+ * @param[in] meas Measurement. Only meas_lx is used.
+ * @param[in] time_s Time at which the measurement was taken in s.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully added the measurement.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p rollup or @p meas is NULL, or @p time_s is earlier than the start of the
+ * newest bucket of the finest level.
+ */
+uint8_t bh1750_rollup_add(BH1750Rollup *const rollup, const BH1750Measurement *const meas, uint32_t time_s);
+
+/**
+ * @brief Get an entry of one level of a rollup store.
+ *
+ * @param[in] rollup Rollup store.
+ * @param[in] level Level index.
+ * @param[in] age Age of the entry. 0 is the newest entry.
+ * @param[out] entry Entry.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p rollup or @p entry is NULL, @p level is out of range, or the level has no
+ * entry with this @p age.
+ */
+uint8_t bh1750_rollup_get_entry(const BH1750Rollup *const rollup, size_t level, size_t age,
+                                BH1750RollupEntry *const entry);
+
+/**
+ * @brief Aggregate all entries of one level whose buckets start in a time range.
+ *
+ * Entries of a level are ordered by time, so the newest entry that starts before @p end_s is found with a binary
+ * search. From there, entries are walked towards the oldest one, up to the first entry older than @p start_s. A query
+ * at a level with resolution R touches about log2(capacity) + (end_s - start_s) / R entries.
+ *
+ * @param[in] rollup Rollup store.
+ * @param[in] level Level index.
+ * @param[in] start_s Start of the range in s, inclusive.
+ * @param[in] end_s End of the range in s, exclusive.
+ * @param[out] result Aggregate of the entries. start_s is the start of the oldest included bucket. num_samples is 0 if
+ * no entries are in the range.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p rollup or @p result is NULL, or @p level is out of range.
+ */
+uint8_t bh1750_rollup_query(const BH1750Rollup *const rollup, size_t level, uint32_t start_s, uint32_t end_s,
+                            BH1750RollupEntry *const result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_ROLLUP_H */
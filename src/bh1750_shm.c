@@ -0,0 +1,119 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750_shm.h"
+
+static uint32_t load_acquire(const uint32_t *ptr)
+{
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+static void store_release(uint32_t *ptr, uint32_t val)
+{
+    __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+}
+
+size_t bh1750_shm_get_region_size(uint16_t num_slots)
+{
+    return sizeof(BH1750ShmHeader) + ((size_t)num_slots * sizeof(BH1750ShmSlot));
+}
+
+uint8_t bh1750_shm_writer_init(BH1750ShmWriter *const writer, void *const mem, size_t size, uint16_t num_slots)
+{
+    if (!writer || !mem || (num_slots == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (size < bh1750_shm_get_region_size(num_slots)) {
+        return BH1750_RESULT_CODE_OUT_OF_MEMORY;
+    }
+
+    writer->hdr = (BH1750ShmHeader *)mem;
+    writer->slots = (BH1750ShmSlot *)(void *)((uint8_t *)mem + sizeof(BH1750ShmHeader));
+    /* Readers must not attach to a half-initialized region */
+    store_release(&writer->hdr->magic, 0);
+    for (uint16_t i = 0; i < num_slots; i++) {
+        writer->slots[i].seq = 0;
+        writer->slots[i].num_published = 0;
+    }
+    writer->hdr->version = BH1750_SHM_VERSION;
+    writer->hdr->num_slots = num_slots;
+    writer->hdr->slot_size = (uint32_t)sizeof(BH1750ShmSlot);
+    writer->hdr->reserved = 0;
+    store_release(&writer->hdr->magic, BH1750_SHM_MAGIC);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_shm_publish(BH1750ShmWriter *const writer, uint16_t slot, const BH1750Measurement *const meas)
+{
+    if (!writer || !meas || (slot >= writer->hdr->num_slots)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    BH1750ShmSlot *s = &writer->slots[slot];
+    /* Only this writer modifies seq, so a relaxed load is enough */
+    uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->seq, seq + 1U, __ATOMIC_RELAXED);
+    /* Odd seq must be visible before any of the data changes */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s->history[s->num_published % BH1750_SHM_HISTORY_LEN] = *meas;
+    s->num_published++;
+    store_release(&s->seq, seq + 2U);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_shm_reader_init(BH1750ShmReader *const reader, const void *const mem, size_t size)
+{
+    if (!reader || !mem || (size < sizeof(BH1750ShmHeader))) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    const BH1750ShmHeader *hdr = (const BH1750ShmHeader *)mem;
+    if ((load_acquire(&hdr->magic) != BH1750_SHM_MAGIC) || (hdr->version != BH1750_SHM_VERSION) ||
+        (hdr->slot_size != sizeof(BH1750ShmSlot))) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (size < bh1750_shm_get_region_size(hdr->num_slots)) {
+        return BH1750_RESULT_CODE_OUT_OF_MEMORY;
+    }
+
+    reader->slots = (const BH1750ShmSlot *)(const void *)((const uint8_t *)mem + sizeof(BH1750ShmHeader));
+    reader->num_slots = hdr->num_slots;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint16_t bh1750_shm_get_num_slots(const BH1750ShmReader *const reader)
+{
+    return reader ? reader->num_slots : 0;
+}
+
+uint8_t bh1750_shm_read(const BH1750ShmReader *const reader, uint16_t slot, BH1750ShmSnapshot *const snapshot)
+{
+    if (!reader || !snapshot || (slot >= reader->num_slots)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    const BH1750ShmSlot *s = &reader->slots[slot];
+    for (uint32_t attempt = 0; attempt < BH1750_SHM_MAX_READ_RETRIES; attempt++) {
+        uint32_t seq_before = load_acquire(&s->seq);
+        if ((seq_before & 1U) != 0) {
+            /* Writer is in the middle of an update */
+            continue;
+        }
+
+        uint32_t num_published = s->num_published;
+        uint8_t num_history =
+            (uint8_t)((num_published < BH1750_SHM_HISTORY_LEN) ? num_published : BH1750_SHM_HISTORY_LEN);
+        for (uint8_t i = 0; i < num_history; i++) {
+            snapshot->history[i] = s->history[(num_published - 1U - i) % BH1750_SHM_HISTORY_LEN];
+        }
+        /* The copy must complete before seq is read again */
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) == seq_before) {
+            snapshot->num_published = num_published;
+            snapshot->num_history = num_history;
+            return BH1750_RESULT_CODE_OK;
+        }
+    }
+    return BH1750_RESULT_CODE_BUSY;
+}
@@ -0,0 +1,174 @@
+#ifndef SRC_BH1750_SHM_H
+#define SRC_BH1750_SHM_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/**
+ * @brief Region that publishes the latest measurements of many sensors to readers in other processes.
+ *
+ * The region is a block of memory provided by the caller, typically a POSIX shared memory object mapped into the
+ * writer and all readers. It starts with a @ref BH1750ShmHeader, followed by one @ref BH1750ShmSlot per sensor. The
+ * region contains no pointers, so it can be mapped at different addresses in different processes.
+ *
+ * Every slot is protected by a sequence lock: the writer makes the sequence number odd, updates the slot, and makes it
+ * even again. A reader copies the slot, and retries if the sequence number was odd or changed during the copy. Readers
+ * never write to the region and never block the writer, so any number of readers can read without system calls.
+ *
+ * There must be at most one writer per slot. Memory ordering uses the GCC/Clang __atomic builtins.
+ */
+
+/** Region magic, "BHSM" */
+#define BH1750_SHM_MAGIC 0x4D534842UL
+/** Layout version written by the writer. */
+#define BH1750_SHM_VERSION 1U
+/** Number of measurements in the history of every slot. */
+#define BH1750_SHM_HISTORY_LEN 16U
+/** Number of times a reader retries a copy that raced with the writer before giving up. */
+#define BH1750_SHM_MAX_READ_RETRIES 64U
+
+/** Header at the start of the region. */
+typedef struct {
+    /** @ref BH1750_SHM_MAGIC once the writer has initialized the region, 0 before. */
+    uint32_t magic;
+    /** @ref BH1750_SHM_VERSION */
+    uint16_t version;
+    /** Number of slots that follow the header. */
+    uint16_t num_slots;
+    /** sizeof(BH1750ShmSlot) of the writer, so that readers built with a different layout are rejected. */
+    uint32_t slot_size;
+    /** Reserved, 0. */
+    uint32_t reserved;
+} BH1750ShmHeader;
+
+/** Slot of one sensor. */
+typedef struct {
+    /** Sequence number. Odd while the writer updates the slot. */
+    uint32_t seq;
+    /** Number of measurements published to this slot. The latest measurement is at index
+     * (num_published - 1) % BH1750_SHM_HISTORY_LEN of history. */
+    uint32_t num_published;
+    /** Ring buffer of the latest measurements. */
+    BH1750Measurement history[BH1750_SHM_HISTORY_LEN];
+} BH1750ShmSlot;
+
+/** Consistent copy of a slot, see @ref bh1750_shm_read. */
+typedef struct {
+    /** Number of measurements published to the slot so far. Can be used to detect new measurements. */
+    uint32_t num_published;
+    /** Number of valid elements in history, min(num_published, BH1750_SHM_HISTORY_LEN). */
+    uint8_t num_history;
+    /** Latest measurements, the latest one first. */
+    BH1750Measurement history[BH1750_SHM_HISTORY_LEN];
+} BH1750ShmSnapshot;
+
+/**
+ * @brief Writer side of a region.
+ *
+ * Populated by @ref bh1750_shm_writer_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    BH1750ShmHeader *hdr;
+    BH1750ShmSlot *slots;
+} BH1750ShmWriter;
+
+/**
+ * @brief Reader side of a region.
+ *
+ * Populated by @ref bh1750_shm_reader_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    const BH1750ShmSlot *slots;
+    uint16_t num_slots;
+} BH1750ShmReader;
+
+/**
+ * @brief Get the size of a region in bytes.
+ *
+ * @param[in] num_slots Number of slots.
+ *
+ * @return size_t Size in bytes.
+ */
+size_t bh1750_shm_get_region_size(uint16_t num_slots);
+
+/**
+ * @brief Initialize a region and its writer.
+ *
+ * All slots are emptied. The magic is written last, so readers that attach concurrently either see a fully
+ * initialized region or fail to attach.
+ *
+ * @param[out] writer Writer to initialize.
+ * @param[in] mem Memory of the region, aligned to at least 4 bytes.
+ * @param[in] size Size of @p mem in bytes.
+ * @param[in] num_slots Number of slots, one per sensor.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p writer or @p mem is NULL, or @p num_slots is 0.
+ * @retval BH1750_RESULT_CODE_OUT_OF_MEMORY @p size is less than @ref bh1750_shm_get_region_size.
+ */
+uint8_t bh1750_shm_writer_init(BH1750ShmWriter *const writer, void *const mem, size_t size, uint16_t num_slots);
+
+/**
+ * @brief Publish a measurement to a slot.
+ *
+ * Typically called from the read callback of the instance that owns the slot.
+ *
+ * @param[in] writer Writer.
+ * @param[in] slot Slot index.
+ * @param[in] meas Measurement.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p writer or @p meas is NULL, or @p slot is out of range.
+ */
+uint8_t bh1750_shm_publish(BH1750ShmWriter *const writer, uint16_t slot, const BH1750Measurement *const meas);
+
+/**
+ * @brief Attach a reader to a region that was initialized by a writer.
+ *
+ * @param[out] reader Reader to initialize.
+ * @param[in] mem Memory of the region, can be mapped read-only.
+ * @param[in] size Size of @p mem in bytes.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p reader or @p mem is NULL, the region is not initialized yet, or was
+ * initialized with a different version or layout.
+ * @retval BH1750_RESULT_CODE_OUT_OF_MEMORY @p size is too small for the number of slots in the header.
+ */
+uint8_t bh1750_shm_reader_init(BH1750ShmReader *const reader, const void *const mem, size_t size);
+
+/**
+ * @brief Get the number of slots of a region.
+ *
+ * @param[in] reader Reader.
+ *
+ * @return uint16_t Number of slots. 0 if @p reader is NULL.
+ */
+uint16_t bh1750_shm_get_num_slots(const BH1750ShmReader *const reader);
+
+/**
+ * @brief Get a consistent copy of a slot.
+ *
+ * @param[in] reader Reader.
+ * @param[in] slot Slot index.
+ * @param[out] snapshot Copy of the slot is written here in case of success.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success. snapshot->num_history is 0 if nothing was published to the slot yet.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p reader or @p snapshot is NULL, or @p slot is out of range.
+ * @retval BH1750_RESULT_CODE_BUSY Every one of @ref BH1750_SHM_MAX_READ_RETRIES attempts raced with the writer, or the
+ * writer stopped in the middle of an update.
+ */
+uint8_t bh1750_shm_read(const BH1750ShmReader *const reader, uint16_t slot, BH1750ShmSnapshot *const snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_SHM_H */
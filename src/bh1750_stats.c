@@ -0,0 +1,215 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "bh1750_stats.h"
+
+/** Number of fractional bits of fixed point mean and m2 values. */
+#define BH1750_STATS_Q 8
+
+/**
+ * @brief Divide a signed integer by a positive integer, rounding to the nearest integer.
+ */
+static int64_t div_round(int64_t num, int64_t den)
+{
+    return (num >= 0) ? ((num + (den / 2)) / den) : -((-num + (den / 2)) / den);
+}
+
+static void clear_pane(BH1750StatsPane *const pane)
+{
+    pane->mean_q8 = 0;
+    pane->m2_q8 = 0;
+    pane->num_samples = 0;
+    pane->min_raw = 0;
+    pane->max_raw = 0;
+}
+
+static void clear_all_panes(BH1750Stats *const stats)
+{
+    for (size_t i = 0; i < stats->cfg.num_panes; i++) {
+        clear_pane(&stats->cfg.panes[i]);
+    }
+    stats->cur_pane = 0;
+    stats->num_full_panes = 0;
+    stats->meas_time = 0;
+}
+
+/**
+ * @brief Add a raw count to a pane using Welford's update in fixed point.
+ */
+static void add_to_pane(BH1750StatsPane *const pane, uint16_t raw_meas)
+{
+    int32_t x_q8 = (int32_t)raw_meas << BH1750_STATS_Q;
+    if (pane->num_samples == 0) {
+        pane->mean_q8 = (uint32_t)x_q8;
+        pane->m2_q8 = 0;
+        pane->min_raw = raw_meas;
+        pane->max_raw = raw_meas;
+        pane->num_samples = 1;
+        return;
+    }
+
+    pane->num_samples++;
+    int32_t delta = x_q8 - (int32_t)pane->mean_q8;
+    pane->mean_q8 = (uint32_t)((int32_t)pane->mean_q8 + (int32_t)div_round(delta, pane->num_samples));
+    int32_t delta2 = x_q8 - (int32_t)pane->mean_q8;
+    /* delta * delta2 has 16 fractional bits. It can only be negative because of rounding of the mean, in which case it
+     * is negligibly small. */
+    int64_t m2_inc = ((int64_t)delta * delta2) >> BH1750_STATS_Q;
+    if (m2_inc > 0) {
+        pane->m2_q8 += (uint64_t)m2_inc;
+    }
+    if (raw_meas < pane->min_raw) {
+        pane->min_raw = raw_meas;
+    }
+    if (raw_meas > pane->max_raw) {
+        pane->max_raw = raw_meas;
+    }
+}
+
+/** Statistics of a whole window. Same as a pane, but the sample count can exceed a pane. */
+typedef struct {
+    uint32_t mean_q8;
+    uint64_t m2_q8;
+    uint32_t num_samples;
+    uint16_t min_raw;
+    uint16_t max_raw;
+} WindowAcc;
+
+/**
+ * @brief Merge a pane into a window accumulator using the parallel variant of Welford's algorithm.
+ */
+static void merge_pane(WindowAcc *const acc, const BH1750StatsPane *const pane)
+{
+    if (pane->num_samples == 0) {
+        return;
+    }
+    if (acc->num_samples == 0) {
+        acc->mean_q8 = pane->mean_q8;
+        acc->m2_q8 = pane->m2_q8;
+        acc->num_samples = pane->num_samples;
+        acc->min_raw = pane->min_raw;
+        acc->max_raw = pane->max_raw;
+        return;
+    }
+
+    int64_t n_a = acc->num_samples;
+    int64_t n_b = pane->num_samples;
+    int64_t n = n_a + n_b;
+    int64_t delta = (int64_t)pane->mean_q8 - (int64_t)acc->mean_q8;
+    acc->mean_q8 = (uint32_t)((int64_t)acc->mean_q8 + div_round(delta * n_b, n));
+    /* delta_sq_q8 * n_a * n_b / n, rounded. Dividing delta_sq_q8 by n first keeps the products within 64 bits, since
+     * n_a * n_b / n <= min(n_a, n_b) and the window size is bounded by BH1750_STATS_MAX_WINDOW_SAMPLES. The remainder
+     * is scaled before it is divided, so that no precision is lost for small or uneven panes. */
+    uint64_t delta_sq_q8 = (uint64_t)((delta * delta) >> BH1750_STATS_Q);
+    uint64_t n_ab = (uint64_t)n_a * (uint64_t)n_b;
+    uint64_t quot = delta_sq_q8 / (uint64_t)n;
+    uint64_t rem = delta_sq_q8 % (uint64_t)n;
+    acc->m2_q8 += pane->m2_q8 + (quot * n_ab) + (((rem * n_ab) + ((uint64_t)n / 2U)) / (uint64_t)n);
+    acc->num_samples = (uint32_t)n;
+    if (pane->min_raw < acc->min_raw) {
+        acc->min_raw = pane->min_raw;
+    }
+    if (pane->max_raw > acc->max_raw) {
+        acc->max_raw = pane->max_raw;
+    }
+}
+
+/**
+ * @brief Merge all panes of a complete window and execute the window callback.
+ *
+ * @param[in] stats Accumulator. All panes must be full, and stats->cur_pane must be the newest pane.
+ */
+static void emit_window(BH1750Stats *const stats)
+{
+    WindowAcc acc = {0};
+    /* Oldest to newest */
+    for (size_t i = 1; i <= stats->cfg.num_panes; i++) {
+        merge_pane(&acc, &stats->cfg.panes[(stats->cur_pane + i) % stats->cfg.num_panes]);
+    }
+
+    float lx_per_count;
+    if (bh1750_get_lx_per_count(stats->meas_mode, stats->meas_time, &lx_per_count) != BH1750_RESULT_CODE_OK) {
+        /* Mode and time were validated when the samples were added, this should never happen */
+        return;
+    }
+
+    BH1750StatsSummary summary;
+    summary.num_samples = acc.num_samples;
+    summary.min_raw = acc.min_raw;
+    summary.max_raw = acc.max_raw;
+    summary.mean_raw_q8 = acc.mean_q8;
+    summary.variance_raw_q8 = (acc.m2_q8 + (acc.num_samples / 2U)) / acc.num_samples;
+    /* Same conversion as the driver for min and max. Conversion to lx is done once per window, not per sample. */
+    summary.min_lx = lroundf(acc.min_raw * lx_per_count);
+    summary.max_lx = lroundf(acc.max_raw * lx_per_count);
+    summary.mean_lx = ((float)acc.mean_q8 / (1U << BH1750_STATS_Q)) * lx_per_count;
+    summary.stddev_lx = sqrtf((float)summary.variance_raw_q8 / (1U << BH1750_STATS_Q)) * lx_per_count;
+    summary.meas_mode = stats->meas_mode;
+    summary.meas_time = stats->meas_time;
+    stats->cfg.cb(&summary, stats->cfg.user_data);
+}
+
+uint8_t bh1750_stats_init(BH1750Stats *const stats, const BH1750StatsConfig *const cfg)
+{
+    if (!stats || !cfg || !cfg->panes || !cfg->cb || (cfg->num_panes == 0) || (cfg->samples_per_pane == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (cfg->num_panes > (BH1750_STATS_MAX_WINDOW_SAMPLES / cfg->samples_per_pane)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    stats->cfg = *cfg;
+    clear_all_panes(stats);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_stats_add(BH1750Stats *const stats, const BH1750Measurement *const meas)
+{
+    float lx_per_count;
+    if (!stats || !meas ||
+        (bh1750_get_lx_per_count(meas->meas_mode, meas->meas_time, &lx_per_count) != BH1750_RESULT_CODE_OK)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    if ((meas->meas_mode != stats->meas_mode) || (meas->meas_time != stats->meas_time)) {
+        /* Raw counts taken with different mode or time are not comparable - start a new window */
+        clear_all_panes(stats);
+        stats->meas_mode = meas->meas_mode;
+        stats->meas_time = meas->meas_time;
+    }
+
+    BH1750StatsPane *pane = &stats->cfg.panes[stats->cur_pane];
+    add_to_pane(pane, meas->raw_meas);
+    if (pane->num_samples < stats->cfg.samples_per_pane) {
+        return BH1750_RESULT_CODE_OK;
+    }
+
+    stats->num_full_panes++;
+    if (stats->num_full_panes == stats->cfg.num_panes) {
+        emit_window(stats);
+        /* The oldest pane is reused for the next samples, so it is no longer a part of the window */
+        stats->num_full_panes--;
+    }
+    stats->cur_pane = (stats->cur_pane + 1) % stats->cfg.num_panes;
+    clear_pane(&stats->cfg.panes[stats->cur_pane]);
+    return BH1750_RESULT_CODE_OK;
+}
+
+bool bh1750_stats_process(BH1750Measurement *meas, void *user_data)
+{
+    /* Ignore return value - a measurement that cannot be added to the statistics is still passed on */
+    bh1750_stats_add((BH1750Stats *)user_data, meas);
+    return true;
+}
+
+uint8_t bh1750_stats_reset(BH1750Stats *const stats)
+{
+    if (!stats) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    clear_all_panes(stats);
+    return BH1750_RESULT_CODE_OK;
+}
@@ -0,0 +1,173 @@
+#ifndef SRC_BH1750_STATS_H
+#define SRC_BH1750_STATS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/** Maximum number of samples in one window. Bounds the fixed point accumulators so that they cannot overflow. */
+#define BH1750_STATS_MAX_WINDOW_SAMPLES 65535U
+
+/**
+ * @brief Partial statistics of a group of consecutive samples.
+ *
+ * Memory for panes is provided by the caller, see @ref BH1750StatsConfig. The fields should only be accessed by the
+ * functions in this header.
+ */
+typedef struct {
+    /** Mean raw count with 8 fractional bits. */
+    uint32_t mean_q8;
+    /** Sum of squared differences from the mean in raw counts squared, with 8 fractional bits. */
+    uint64_t m2_q8;
+    /** Number of samples in this pane. */
+    uint16_t num_samples;
+    /** Smallest raw count in this pane. */
+    uint16_t min_raw;
+    /** Largest raw count in this pane. */
+    uint16_t max_raw;
+} BH1750StatsPane;
+
+/** Statistics of one window, passed to @ref BH1750StatsWindowCb. */
+typedef struct {
+    /** Number of samples in the window. */
+    uint32_t num_samples;
+    /** Smallest raw count. */
+    uint16_t min_raw;
+    /** Largest raw count. */
+    uint16_t max_raw;
+    /** Mean raw count with 8 fractional bits. */
+    uint32_t mean_raw_q8;
+    /** Population variance of raw counts with 8 fractional bits. */
+    uint64_t variance_raw_q8;
+    /** Smallest illuminance in lx. */
+    uint32_t min_lx;
+    /** Largest illuminance in lx. */
+    uint32_t max_lx;
+    /** Mean illuminance in lx. */
+    float mean_lx;
+    /** Population standard deviation of illuminance in lx. */
+    float stddev_lx;
+    /** Measurement mode of all samples in the window. */
+    uint8_t meas_mode;
+    /** Measurement time of all samples in the window. */
+    uint8_t meas_time;
+} BH1750StatsSummary;
+
+/**
+ * @brief Callback type to execute when a window is complete.
+ *
+ * @param[in] summary Statistics of the window. Only valid during the execution of this callback.
+ * @param[in] user_data User data that was passed in @ref BH1750StatsConfig.
+ */
+typedef void (*BH1750StatsWindowCb)(const BH1750StatsSummary *summary, void *user_data);
+
+/**
+ * @brief Statistics accumulator config.
+ *
+ * A window consists of num_panes panes of samples_per_pane samples each.
+ * - Tumbling window: num_panes is 1. A summary is produced for every samples_per_pane samples, windows do not overlap.
+ * - Sliding window: num_panes is > 1. Once the first window is full, a summary of the last num_panes panes is produced
+ * every time a pane is complete. Consecutive windows overlap by num_panes - 1 panes.
+ */
+typedef struct {
+    /** Memory for the panes. Must have at least num_panes elements and remain valid as long as the accumulator is being
+     * used. */
+    BH1750StatsPane *panes;
+    /** Number of panes in a window. */
+    size_t num_panes;
+    /** Number of samples in a pane. num_panes * samples_per_pane must not exceed @ref
+     * BH1750_STATS_MAX_WINDOW_SAMPLES. */
+    uint16_t samples_per_pane;
+    /** Callback to execute with the summary of every complete window. */
+    BH1750StatsWindowCb cb;
+    /** User data to pass to cb. */
+    void *user_data;
+} BH1750StatsConfig;
+
+/**
+ * @brief Streaming statistics accumulator.
+ *
+ * Populated by @ref bh1750_stats_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    /** Config passed to bh1750_stats_init. */
+    BH1750StatsConfig cfg;
+    /** Index of the pane that the next sample is added to. */
+    size_t cur_pane;
+    /** Number of complete panes, up to cfg.num_panes. */
+    size_t num_full_panes;
+    /** Measurement mode of the samples in the current window. */
+    uint8_t meas_mode;
+    /** Measurement time of the samples in the current window. 0 if the window is empty. */
+    uint8_t meas_time;
+} BH1750Stats;
+
+/**
+ * @brief Initialize a statistics accumulator.
+ *
+ * @param[out] stats Accumulator to initialize.
+ * @param[in] cfg Config. Copied into @p stats.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully initialized the accumulator.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p stats or @p cfg is NULL, cfg->panes or cfg->cb is NULL, cfg->num_panes or
+ * cfg->samples_per_pane is 0, or the window has more than @ref BH1750_STATS_MAX_WINDOW_SAMPLES samples.
+ */
+uint8_t bh1750_stats_init(BH1750Stats *const stats, const BH1750StatsConfig *const cfg);
+
+/**
+ * @brief Add a sample to a statistics accumulator.
+ *
+ * Takes O(1) time per sample, except for the sample that completes a pane, which merges num_panes panes. If a window
+ * is complete, the window callback is executed from this function.
+ *
+ * All samples in a window must have the same measurement mode and measurement time, since raw counts are only
+ * comparable in that case. If @p meas has a different mode or time than the previous samples, the incomplete window is
+ * discarded and a new window is started with @p meas.
+ *
+ * @param[in] stats Accumulator.
+ * @param[in] meas Measurement. Only raw_meas, meas_mode and meas_time are used.
+ *
+ * @retval BH1750_RESULT_CODE_OK Successfully added the sample.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p stats or @p meas is NULL, or @p meas has an invalid measurement mode or
+ * measurement time.
+ */
+uint8_t bh1750_stats_add(BH1750Stats *const stats, const BH1750Measurement *const meas);
+
+/**
+ * @brief Add a measurement to a statistics accumulator and keep the measurement.
+ *
+ * Has the signature of @ref BH1750ProcessMeas and @ref BH1750PipelineStageFn, so that an accumulator can be attached
+ * to a BH1750 instance directly, or used as a pipeline stage:
+ * @code
+ * bh1750_set_meas_processor(inst, bh1750_stats_process, &stats);
+ * @endcode
+ *
+ * @param[in] meas Measurement.
+ * @param[in] user_data Pointer to an initialized @ref BH1750Stats.
+ *
+ * @retval true Always, so that the measurement is passed on.
+ */
+bool bh1750_stats_process(BH1750Measurement *meas, void *user_data);
+
+/**
+ * @brief Discard all samples of the current window.
+ *
+ * @param[in] stats Accumulator.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p stats is NULL.
+ */
+uint8_t bh1750_stats_reset(BH1750Stats *const stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_BH1750_STATS_H */
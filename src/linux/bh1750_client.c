@@ -0,0 +1,75 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bh1750_client.h"
+
+uint8_t bh1750_client_open(BH1750Client *const client, const char *name)
+{
+    if (!client || !name) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    client->mem = NULL;
+    client->size = 0;
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return BH1750_RESULT_CODE_IO_ERR;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+        close(fd);
+        return BH1750_RESULT_CODE_IO_ERR;
+    }
+    void *mem = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    /* The mapping stays valid after the descriptor is closed */
+    close(fd);
+    if (mem == MAP_FAILED) {
+        return BH1750_RESULT_CODE_IO_ERR;
+    }
+
+    uint8_t rc = bh1750_shm_reader_init(&client->reader, mem, (size_t)st.st_size);
+    if (rc != BH1750_RESULT_CODE_OK) {
+        munmap(mem, (size_t)st.st_size);
+        return rc;
+    }
+    client->mem = mem;
+    client->size = (size_t)st.st_size;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint16_t bh1750_client_get_num_sensors(const BH1750Client *const client)
+{
+    if (!client || !client->mem) {
+        return 0;
+    }
+    return bh1750_shm_get_num_slots(&client->reader);
+}
+
+uint8_t bh1750_client_read(const BH1750Client *const client, uint16_t sensor, BH1750ShmSnapshot *const snapshot)
+{
+    if (!client || !client->mem) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    return bh1750_shm_read(&client->reader, sensor, snapshot);
+}
+
+uint8_t bh1750_client_close(BH1750Client *const client)
+{
+    if (!client) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    if (client->mem) {
+        munmap((void *)client->mem, client->size);
+        client->mem = NULL;
+        client->size = 0;
+    }
+    return BH1750_RESULT_CODE_OK;
+}
@@ -0,0 +1,89 @@
+#ifndef SRC_LINUX_BH1750_CLIENT_H
+#define SRC_LINUX_BH1750_CLIENT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+#include "bh1750_shm.h"
+
+/**
+ * @brief Client of the measurements that bh1750d publishes.
+ *
+ * Maps the POSIX shared memory object of the daemon read-only and reads the slot of a sensor with @ref
+ * bh1750_shm_read. Opening the client costs a few system calls, every read after that costs none.
+ */
+
+/** Name of the shared memory object that bh1750d creates by default. */
+#define BH1750_CLIENT_DEFAULT_SHM_NAME "/bh1750"
+
+/**
+ * @brief Client.
+ *
+ * Populated by @ref bh1750_client_open. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    /** Mapping of the shared memory object. NULL while the client is not open. */
+    const void *mem;
+    size_t size;
+    BH1750ShmReader reader;
+} BH1750Client;
+
+/**
+ * @brief Map the shared memory object of the daemon and attach to it.
+ *
+ * @param[out] client Client to open.
+ * @param[in] name Name of the shared memory object, e.g. @ref BH1750_CLIENT_DEFAULT_SHM_NAME.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p client or @p name is NULL, or the object was not initialized by the
+ * daemon, or was initialized with a different version or layout.
+ * @retval BH1750_RESULT_CODE_OUT_OF_MEMORY The object is too small for the number of slots in its header.
+ * @retval BH1750_RESULT_CODE_IO_ERR Failed to open or map the object, e.g. because the daemon is not running.
+ */
+uint8_t bh1750_client_open(BH1750Client *const client, const char *name);
+
+/**
+ * @brief Get the number of sensors the daemon publishes.
+ *
+ * @param[in] client Client.
+ *
+ * @return uint16_t Number of sensors. 0 if @p client is NULL or not open.
+ */
+uint16_t bh1750_client_get_num_sensors(const BH1750Client *const client);
+
+/**
+ * @brief Get the latest measurements of a sensor.
+ *
+ * @param[in] client Client.
+ * @param[in] sensor Sensor index, in the order the sensors were passed to the daemon.
+ * @param[out] snapshot Latest measurements are written here in case of success, see @ref bh1750_shm_read.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success. snapshot->num_history is 0 if nothing was published for the sensor yet.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p client or @p snapshot is NULL, @p client is not open, or @p sensor is out
+ * of range.
+ * @retval BH1750_RESULT_CODE_BUSY Every read attempt raced with the daemon.
+ */
+uint8_t bh1750_client_read(const BH1750Client *const client, uint16_t sensor, BH1750ShmSnapshot *const snapshot);
+
+/**
+ * @brief Unmap the shared memory object.
+ *
+ * @param[in] client Client.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p client is NULL.
+ */
+uint8_t bh1750_client_close(BH1750Client *const client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_LINUX_BH1750_CLIENT_H */
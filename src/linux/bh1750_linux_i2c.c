@@ -0,0 +1,225 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "bh1750_linux_i2c.h"
+
+static int sys_open(const char *path, int flags)
+{
+    return open(path, flags);
+}
+
+static int sys_ioctl(int fd, unsigned long request, void *arg)
+{
+    return ioctl(fd, request, arg);
+}
+
+static int sys_close(int fd)
+{
+    return close(fd);
+}
+
+/**
+ * @brief Queue a completion, to be executed by bh1750_linux_i2c_process.
+ */
+static void defer_completion(BH1750LinuxI2C *const i2c, uint8_t result_code, BH1750_I2CCompleteCb cb,
+                             void *cb_user_data)
+{
+    if (result_code != BH1750_I2C_RESULT_CODE_OK) {
+        i2c->stats.num_errors++;
+    }
+    if (i2c->count == i2c->capacity) {
+        /* Capacity is smaller than the number of instances. Executing the callback right away is the only way not to
+         * lose it - it is still the same context. */
+        cb(result_code, cb_user_data);
+        return;
+    }
+
+    BH1750LinuxI2CCompletion *completion = &i2c->completions[(i2c->head + i2c->count) % i2c->capacity];
+    completion->cb = cb;
+    completion->cb_user_data = cb_user_data;
+    completion->result_code = result_code;
+    i2c->count++;
+    if ((i2c->count == 1) && i2c->notify) {
+        i2c->notify(i2c->notify_user_data);
+    }
+}
+
+/**
+ * @brief Open the device of the bus, if it is not open yet.
+ *
+ * @retval true The device is open.
+ * @retval false Failed to open the device.
+ */
+static bool ensure_open(BH1750LinuxI2CBus *const bus)
+{
+    if (bus->fd >= 0) {
+        return true;
+    }
+    bus->i2c->stats.num_syscalls++;
+    bus->fd = bus->i2c->sys.open(bus->path, O_RDWR | O_CLOEXEC);
+    return bus->fd >= 0;
+}
+
+/**
+ * @brief Whether an ioctl error means that the file descriptor is unusable, rather than that the transaction failed.
+ *
+ * E.g. the adapter was removed (ENODEV), or the descriptor was closed behind the back of the backend (EBADF).
+ */
+static bool is_fd_error(int err)
+{
+    return (err == ENODEV) || (err == EBADF) || (err == ENOTTY);
+}
+
+/**
+ * @brief Perform one I2C message as a single I2C_RDWR transfer, and defer its completion.
+ */
+static void transfer(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, bool is_read,
+                     BH1750_I2CCompleteCb cb, void *cb_user_data)
+{
+    if (!cb) {
+        return;
+    }
+    BH1750LinuxI2CBus *bus = (BH1750LinuxI2CBus *)user_data;
+    if (!bus) {
+        /* No backend to defer to, but the driver waits for the completion */
+        cb(BH1750_I2C_RESULT_CODE_ERR, cb_user_data);
+        return;
+    }
+
+    BH1750LinuxI2C *i2c = bus->i2c;
+    i2c->stats.num_transactions++;
+    /* i2c_msg.len is 16 bits wide */
+    if ((length > UINT16_MAX) || !ensure_open(bus)) {
+        defer_completion(i2c, BH1750_I2C_RESULT_CODE_ERR, cb, cb_user_data);
+        return;
+    }
+
+    struct i2c_msg msg;
+    msg.addr = i2c_addr;
+    msg.flags = is_read ? I2C_M_RD : 0;
+    msg.len = (uint16_t)length;
+    msg.buf = data;
+    struct i2c_rdwr_ioctl_data rdwr;
+    rdwr.msgs = &msg;
+    rdwr.nmsgs = 1;
+    i2c->stats.num_syscalls++;
+    int rc = i2c->sys.ioctl(bus->fd, I2C_RDWR, &rdwr);
+    if ((rc < 0) && is_fd_error(errno)) {
+        /* Reopened by the next transaction */
+        (void)bh1750_linux_i2c_bus_close(bus);
+    }
+    /* I2C_RDWR returns the number of messages transferred */
+    defer_completion(i2c, (rc == 1) ? BH1750_I2C_RESULT_CODE_OK : BH1750_I2C_RESULT_CODE_ERR, cb, cb_user_data);
+}
+
+uint8_t bh1750_linux_i2c_init(BH1750LinuxI2C *const i2c, BH1750LinuxI2CCompletion *const completions, size_t capacity,
+                              const BH1750LinuxSys *const sys)
+{
+    if (!i2c || !completions || (capacity == 0) || (sys && (!sys->open || !sys->ioctl || !sys->close))) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    if (sys) {
+        i2c->sys = *sys;
+    } else {
+        i2c->sys.open = sys_open;
+        i2c->sys.ioctl = sys_ioctl;
+        i2c->sys.close = sys_close;
+    }
+    i2c->completions = completions;
+    i2c->capacity = capacity;
+    i2c->head = 0;
+    i2c->count = 0;
+    i2c->notify = NULL;
+    i2c->notify_user_data = NULL;
+    i2c->stats.num_transactions = 0;
+    i2c->stats.num_syscalls = 0;
+    i2c->stats.num_errors = 0;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_linux_i2c_set_notify(BH1750LinuxI2C *const i2c, BH1750LinuxI2CNotify notify, void *user_data)
+{
+    if (!i2c) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    i2c->notify = notify;
+    i2c->notify_user_data = user_data;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_linux_i2c_bus_init(BH1750LinuxI2CBus *const bus, BH1750LinuxI2C *const i2c, uint32_t bus_nr)
+{
+    if (!bus || !i2c) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    bus->i2c = i2c;
+    (void)snprintf(bus->path, sizeof(bus->path), "/dev/i2c-%lu", (unsigned long)bus_nr);
+    bus->fd = -1;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_linux_i2c_bus_close(BH1750LinuxI2CBus *const bus)
+{
+    if (!bus) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    if (bus->fd >= 0) {
+        bus->i2c->stats.num_syscalls++;
+        (void)bus->i2c->sys.close(bus->fd);
+        bus->fd = -1;
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+void bh1750_linux_i2c_write(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                            void *cb_user_data)
+{
+    transfer(data, length, i2c_addr, user_data, false, cb, cb_user_data);
+}
+
+void bh1750_linux_i2c_read(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                           void *cb_user_data)
+{
+    transfer(data, length, i2c_addr, user_data, true, cb, cb_user_data);
+}
+
+size_t bh1750_linux_i2c_process(BH1750LinuxI2C *const i2c)
+{
+    if (!i2c) {
+        return 0;
+    }
+
+    size_t num_to_execute = i2c->count;
+    for (size_t i = 0; i < num_to_execute; i++) {
+        /* Dequeue before executing, the callback can queue a new completion */
+        BH1750LinuxI2CCompletion completion = i2c->completions[i2c->head];
+        i2c->head = (i2c->head + 1) % i2c->capacity;
+        i2c->count--;
+        completion.cb(completion.result_code, completion.cb_user_data);
+    }
+    return num_to_execute;
+}
+
+uint8_t bh1750_linux_i2c_get_stats(const BH1750LinuxI2C *const i2c, BH1750LinuxI2CStats *const stats)
+{
+    if (!i2c || !stats) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    *stats = i2c->stats;
+    return BH1750_RESULT_CODE_OK;
+}
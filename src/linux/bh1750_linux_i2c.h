@@ -0,0 +1,198 @@
+#ifndef SRC_LINUX_BH1750_LINUX_I2C_H
+#define SRC_LINUX_BH1750_LINUX_I2C_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+
+/**
+ * @brief Implementation of the I2C functions of the driver on top of the Linux i2c-dev interface.
+ *
+ * Every I2C transaction of the driver is performed with a single ioctl(I2C_RDWR) call, which carries the I2C address
+ * in the message, so no I2C_SLAVE ioctl or read/write system call is needed. The file descriptor of every bus is
+ * opened on the first transaction and then kept open.
+ *
+ * The transfers are blocking, but the completion callbacks are deferred: they are queued and executed by
+ * @ref bh1750_linux_i2c_process, from the same context as all other driver functions. This way, long chains of
+ * transactions do not recurse into the driver.
+ *
+ * If the ioctl fails because the file descriptor is unusable, e.g. with ENODEV after the adapter was removed, the
+ * device is closed and reopened by the next transaction.
+ */
+
+/** Maximum length of the device path of a bus, including the terminating null character. */
+#define BH1750_LINUX_I2C_MAX_PATH_LEN 32
+
+/** open() as used by the backend. */
+typedef int (*BH1750LinuxOpen)(const char *path, int flags);
+/** ioctl() as used by the backend. Must return -1 and set errno on failure, like ioctl(). */
+typedef int (*BH1750LinuxIoctl)(int fd, unsigned long request, void *arg);
+/** close() as used by the backend. */
+typedef int (*BH1750LinuxClose)(int fd);
+
+/**
+ * @brief System calls used by the backend.
+ *
+ * Allows to run the backend against a fake device in tests. Pass NULL instead of this struct to use the real system
+ * calls.
+ */
+typedef struct {
+    BH1750LinuxOpen open;
+    BH1750LinuxIoctl ioctl;
+    BH1750LinuxClose close;
+} BH1750LinuxSys;
+
+/**
+ * @brief Callback type to execute when a completion is queued while no other completions are pending.
+ *
+ * @param[in] user_data User data that was passed to @ref bh1750_linux_i2c_set_notify.
+ */
+typedef void (*BH1750LinuxI2CNotify)(void *user_data);
+
+/** Deferred completion of an I2C transaction. */
+typedef struct {
+    BH1750_I2CCompleteCb cb;
+    void *cb_user_data;
+    uint8_t result_code;
+} BH1750LinuxI2CCompletion;
+
+/** Statistics of a backend. */
+typedef struct {
+    /** Number of I2C transactions. */
+    uint32_t num_transactions;
+    /** Number of system calls: open, ioctl and close. */
+    uint32_t num_syscalls;
+    /** Number of failed I2C transactions, including the ones that failed because the bus could not be opened. */
+    uint32_t num_errors;
+} BH1750LinuxI2CStats;
+
+/**
+ * @brief Backend state shared by all buses.
+ *
+ * Populated by @ref bh1750_linux_i2c_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    BH1750LinuxSys sys;
+    /** Ring buffer of deferred completions. */
+    BH1750LinuxI2CCompletion *completions;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    BH1750LinuxI2CNotify notify;
+    void *notify_user_data;
+    BH1750LinuxI2CStats stats;
+} BH1750LinuxI2C;
+
+/**
+ * @brief One I2C bus, e.g. /dev/i2c-1.
+ *
+ * Populated by @ref bh1750_linux_i2c_bus_init. Pass a pointer to it as i2c_write_user_data and i2c_read_user_data of
+ * every instance on this bus.
+ */
+typedef struct {
+    BH1750LinuxI2C *i2c;
+    char path[BH1750_LINUX_I2C_MAX_PATH_LEN];
+    /** File descriptor, -1 while the bus is not open. */
+    int fd;
+} BH1750LinuxI2CBus;
+
+/**
+ * @brief Initialize the backend.
+ *
+ * @param[out] i2c Backend to initialize.
+ * @param[in] completions Memory for deferred completions. Every instance has at most one transaction in progress, so
+ * @p capacity must be at least the number of instances that use the backend.
+ * @param[in] capacity Number of elements in @p completions.
+ * @param[in] sys System calls to use. Copied. NULL to use the real system calls.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p i2c or @p completions is NULL, @p capacity is 0, or one of the functions in
+ * @p sys is NULL.
+ */
+uint8_t bh1750_linux_i2c_init(BH1750LinuxI2C *const i2c, BH1750LinuxI2CCompletion *const completions, size_t capacity,
+                              const BH1750LinuxSys *const sys);
+
+/**
+ * @brief Set the callback to execute when completions become pending.
+ *
+ * Allows an event loop to wake up and call @ref bh1750_linux_i2c_process, see src/linux/bh1750_linux_loop.h.
+ *
+ * @param[in] i2c Backend.
+ * @param[in] notify Callback. NULL to disable.
+ * @param[in] user_data User data to pass to @p notify.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p i2c is NULL.
+ */
+uint8_t bh1750_linux_i2c_set_notify(BH1750LinuxI2C *const i2c, BH1750LinuxI2CNotify notify, void *user_data);
+
+/**
+ * @brief Initialize a bus. The device is opened on the first transaction.
+ *
+ * @param[out] bus Bus to initialize.
+ * @param[in] i2c Backend.
+ * @param[in] bus_nr Bus number N of /dev/i2c-N.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p bus or @p i2c is NULL.
+ */
+uint8_t bh1750_linux_i2c_bus_init(BH1750LinuxI2CBus *const bus, BH1750LinuxI2C *const i2c, uint32_t bus_nr);
+
+/**
+ * @brief Close the device of a bus, if it is open.
+ *
+ * @param[in] bus Bus.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p bus is NULL.
+ */
+uint8_t bh1750_linux_i2c_bus_close(BH1750LinuxI2CBus *const bus);
+
+/**
+ * @brief @ref BH1750_I2CWrite implementation. @p user_data must point to a @ref BH1750LinuxI2CBus.
+ *
+ * If @p user_data is NULL, @p cb is executed right away with BH1750_I2C_RESULT_CODE_ERR. A @p length above UINT16_MAX
+ * completes with BH1750_I2C_RESULT_CODE_ERR without a transfer.
+ */
+void bh1750_linux_i2c_write(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                            void *cb_user_data);
+
+/** @ref BH1750_I2CRead implementation. Same semantics as @ref bh1750_linux_i2c_write. */
+void bh1750_linux_i2c_read(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                           void *cb_user_data);
+
+/**
+ * @brief Execute the deferred completions.
+ *
+ * Only executes the completions that were queued before this call. Completions of transactions that the callbacks start
+ * are executed by the next call.
+ *
+ * @param[in] i2c Backend.
+ *
+ * @return size_t Number of executed completions. 0 if @p i2c is NULL.
+ */
+size_t bh1750_linux_i2c_process(BH1750LinuxI2C *const i2c);
+
+/**
+ * @brief Get the statistics of the backend.
+ *
+ * @param[in] i2c Backend.
+ * @param[out] stats Statistics.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p i2c or @p stats is NULL.
+ */
+uint8_t bh1750_linux_i2c_get_stats(const BH1750LinuxI2C *const i2c, BH1750LinuxI2CStats *const stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_LINUX_BH1750_LINUX_I2C_H */
@@ -0,0 +1,256 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+
+#include "bh1750_linux_loop.h"
+
+/** Tags of the file descriptors in epoll_event.data.u32. */
+#define BH1750_LINUX_LOOP_TAG_TIMER 1U
+#define BH1750_LINUX_LOOP_TAG_EVENT 2U
+
+static uint64_t get_monotonic_ms(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000U) + ((uint64_t)ts.tv_nsec / 1000000U);
+}
+
+static void swap_timers(BH1750LinuxTimer *const a, BH1750LinuxTimer *const b)
+{
+    BH1750LinuxTimer tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static void push_timer(BH1750LinuxLoop *const loop, const BH1750LinuxTimer *const timer)
+{
+    size_t pos = loop->num_timers++;
+    loop->timers[pos] = *timer;
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (loop->timers[parent].deadline_ms <= loop->timers[pos].deadline_ms) {
+            break;
+        }
+        swap_timers(&loop->timers[parent], &loop->timers[pos]);
+        pos = parent;
+    }
+}
+
+static void pop_timer(BH1750LinuxLoop *const loop, BH1750LinuxTimer *const timer)
+{
+    *timer = loop->timers[0];
+    loop->num_timers--;
+    loop->timers[0] = loop->timers[loop->num_timers];
+    size_t pos = 0;
+    for (;;) {
+        size_t smallest = pos;
+        size_t left = (2 * pos) + 1;
+        size_t right = left + 1;
+        if ((left < loop->num_timers) && (loop->timers[left].deadline_ms < loop->timers[smallest].deadline_ms)) {
+            smallest = left;
+        }
+        if ((right < loop->num_timers) && (loop->timers[right].deadline_ms < loop->timers[smallest].deadline_ms)) {
+            smallest = right;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        swap_timers(&loop->timers[pos], &loop->timers[smallest]);
+        pos = smallest;
+    }
+}
+
+/**
+ * @brief Arm the timerfd to the earliest deadline, or disarm it if no timers are pending.
+ */
+static void arm_timer_fd(BH1750LinuxLoop *const loop)
+{
+    uint64_t deadline_ms = (loop->num_timers > 0) ? loop->timers[0].deadline_ms : 0;
+    if (deadline_ms == loop->armed_deadline_ms) {
+        return;
+    }
+
+    struct itimerspec its = {{0, 0}, {0, 0}};
+    if (deadline_ms != 0) {
+        its.it_value.tv_sec = (time_t)(deadline_ms / 1000U);
+        its.it_value.tv_nsec = (long)((deadline_ms % 1000U) * 1000000U);
+    }
+    (void)timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+    loop->armed_deadline_ms = deadline_ms;
+}
+
+static void notify_i2c_completion(void *user_data)
+{
+    BH1750LinuxLoop *loop = (BH1750LinuxLoop *)user_data;
+    uint64_t one = 1;
+    (void)write(loop->event_fd, &one, sizeof(one));
+}
+
+static void dispatch_timers(BH1750LinuxLoop *const loop)
+{
+    uint64_t expirations;
+    (void)read(loop->timer_fd, &expirations, sizeof(expirations));
+    /* The timerfd fired, so it is no longer armed */
+    loop->armed_deadline_ms = 0;
+
+    uint64_t now_ms = get_monotonic_ms();
+    while ((loop->num_timers > 0) && (loop->timers[0].deadline_ms <= now_ms)) {
+        /* Pop before executing, the callback can start a new timer */
+        BH1750LinuxTimer timer;
+        pop_timer(loop, &timer);
+        loop->stats.num_timers_fired++;
+        timer.cb(timer.cb_user_data);
+    }
+    arm_timer_fd(loop);
+}
+
+static void dispatch_i2c_completions(BH1750LinuxLoop *const loop)
+{
+    uint64_t count;
+    (void)read(loop->event_fd, &count, sizeof(count));
+    if (loop->i2c) {
+        /* Completions queued by the callbacks are executed right away, without another round trip through epoll */
+        while (bh1750_linux_i2c_process(loop->i2c) > 0) {
+        }
+    }
+}
+
+static bool add_to_epoll(int epoll_fd, int fd, uint32_t tag)
+{
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = 0;
+    ev.data.u32 = tag;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+uint8_t bh1750_linux_loop_init(BH1750LinuxLoop *const loop, BH1750LinuxTimer *const timers, size_t capacity,
+                               BH1750LinuxI2C *const i2c)
+{
+    if (!loop || !timers || (capacity == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    loop->timers = timers;
+    loop->capacity = capacity;
+    loop->num_timers = 0;
+    loop->armed_deadline_ms = 0;
+    loop->i2c = NULL;
+    loop->stats.num_wakeups = 0;
+    loop->stats.num_timers_fired = 0;
+    loop->stats.num_timers_dropped = 0;
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    loop->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((loop->epoll_fd < 0) || (loop->timer_fd < 0) || (loop->event_fd < 0) ||
+        !add_to_epoll(loop->epoll_fd, loop->timer_fd, BH1750_LINUX_LOOP_TAG_TIMER) ||
+        !add_to_epoll(loop->epoll_fd, loop->event_fd, BH1750_LINUX_LOOP_TAG_EVENT)) {
+        (void)bh1750_linux_loop_deinit(loop);
+        return BH1750_RESULT_CODE_IO_ERR;
+    }
+
+    loop->i2c = i2c;
+    if (i2c) {
+        (void)bh1750_linux_i2c_set_notify(i2c, notify_i2c_completion, loop);
+        if (i2c->count > 0) {
+            /* Completions queued before the loop existed */
+            notify_i2c_completion(loop);
+        }
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_linux_loop_deinit(BH1750LinuxLoop *const loop)
+{
+    if (!loop) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    int *fds[] = {&loop->epoll_fd, &loop->timer_fd, &loop->event_fd};
+    for (size_t i = 0; i < (sizeof(fds) / sizeof(fds[0])); i++) {
+        if (*fds[i] >= 0) {
+            (void)close(*fds[i]);
+        }
+        *fds[i] = -1;
+    }
+    loop->num_timers = 0;
+    if (loop->i2c) {
+        (void)bh1750_linux_i2c_set_notify(loop->i2c, NULL, NULL);
+        loop->i2c = NULL;
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+void bh1750_linux_loop_start_timer(uint32_t duration_ms, void *user_data, BH1750TimerExpiredCb cb,
+                                   void *cb_user_data)
+{
+    BH1750LinuxLoop *loop = (BH1750LinuxLoop *)user_data;
+    if (!loop || !cb) {
+        return;
+    }
+    if (loop->num_timers == loop->capacity) {
+        loop->stats.num_timers_dropped++;
+        return;
+    }
+
+    BH1750LinuxTimer timer;
+    /* Round up - the current time is truncated to ms, and cb must not be executed before duration_ms pass. This also
+     * keeps the deadline away from 0, which means disarmed. */
+    timer.deadline_ms = get_monotonic_ms() + duration_ms + 1U;
+    timer.cb = cb;
+    timer.cb_user_data = cb_user_data;
+    push_timer(loop, &timer);
+    arm_timer_fd(loop);
+}
+
+uint32_t bh1750_linux_loop_get_time(void *user_data)
+{
+    (void)user_data;
+    return (uint32_t)get_monotonic_ms();
+}
+
+uint8_t bh1750_linux_loop_run_once(BH1750LinuxLoop *const loop, int timeout_ms)
+{
+    if (!loop) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+    if (loop->stats.num_timers_dropped > 0) {
+        /* The instance that started the dropped timer never completes its sequence, this cannot be recovered from */
+        return BH1750_RESULT_CODE_OUT_OF_MEMORY;
+    }
+
+    struct epoll_event events[2];
+    int num_events = epoll_wait(loop->epoll_fd, events, 2, timeout_ms);
+    if (num_events < 0) {
+        return (errno == EINTR) ? BH1750_RESULT_CODE_OK : BH1750_RESULT_CODE_IO_ERR;
+    }
+    if (num_events > 0) {
+        loop->stats.num_wakeups++;
+    }
+    for (int i = 0; i < num_events; i++) {
+        if (events[i].data.u32 == BH1750_LINUX_LOOP_TAG_TIMER) {
+            dispatch_timers(loop);
+        } else {
+            dispatch_i2c_completions(loop);
+        }
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_linux_loop_get_stats(const BH1750LinuxLoop *const loop, BH1750LinuxLoopStats *const stats)
+{
+    if (!loop || !stats) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    *stats = loop->stats;
+    return BH1750_RESULT_CODE_OK;
+}
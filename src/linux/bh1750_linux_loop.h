@@ -0,0 +1,136 @@
+#ifndef SRC_LINUX_BH1750_LINUX_LOOP_H
+#define SRC_LINUX_BH1750_LINUX_LOOP_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "bh1750.h"
+#include "bh1750_linux_i2c.h"
+
+/**
+ * @brief Single-threaded event loop that drives any number of BH1750 instances on Linux.
+ *
+ * All pending timers are kept in a min-heap ordered by deadline, and a single timerfd is armed to the earliest
+ * deadline. Completions of the I2C backend (see src/linux/bh1750_linux_i2c.h) are signaled through an eventfd. Both
+ * file descriptors are waited on with one epoll instance, so the thread only wakes up when a timer expires or an I2C
+ * transaction completes.
+ *
+ * All driver functions must be called from the thread that runs the loop.
+ */
+
+/** Pending timer. */
+typedef struct {
+    /** Deadline on CLOCK_MONOTONIC in ms. */
+    uint64_t deadline_ms;
+    BH1750TimerExpiredCb cb;
+    void *cb_user_data;
+} BH1750LinuxTimer;
+
+/** Statistics of a loop. */
+typedef struct {
+    /** Number of times epoll_wait returned with at least one event. */
+    uint32_t num_wakeups;
+    /** Number of expired timers. */
+    uint32_t num_timers_fired;
+    /** Number of timers that were dropped because the timer heap was full. The callback of a dropped timer is never
+     * executed, so its instance is stuck - any dropped timer makes @ref bh1750_linux_loop_run_once fail. */
+    uint32_t num_timers_dropped;
+} BH1750LinuxLoopStats;
+
+/**
+ * @brief Event loop.
+ *
+ * Populated by @ref bh1750_linux_loop_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct {
+    int epoll_fd;
+    int timer_fd;
+    int event_fd;
+    /** Min-heap of pending timers, ordered by deadline. */
+    BH1750LinuxTimer *timers;
+    size_t capacity;
+    size_t num_timers;
+    /** Deadline the timerfd is armed to. 0 if disarmed. */
+    uint64_t armed_deadline_ms;
+    /** I2C backend whose completions are dispatched by the loop. Can be NULL. */
+    BH1750LinuxI2C *i2c;
+    BH1750LinuxLoopStats stats;
+} BH1750LinuxLoop;
+
+/**
+ * @brief Initialize an event loop.
+ *
+ * @param[out] loop Loop to initialize.
+ * @param[in] timers Memory for pending timers. Every instance and every prefetcher (see bh1750_prefetch.h) has at most
+ * one timer pending, so @p capacity must be at least the number of instances plus the number of prefetchers that use
+ * the loop, plus any timers the application starts itself.
+ * @param[in] capacity Number of elements in @p timers.
+ * @param[in] i2c I2C backend to dispatch completions of. Can be NULL. The loop sets its notify callback.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p loop or @p timers is NULL, or @p capacity is 0.
+ * @retval BH1750_RESULT_CODE_IO_ERR Failed to create the epoll instance, the timerfd or the eventfd.
+ */
+uint8_t bh1750_linux_loop_init(BH1750LinuxLoop *const loop, BH1750LinuxTimer *const timers, size_t capacity,
+                               BH1750LinuxI2C *const i2c);
+
+/**
+ * @brief Close the file descriptors of a loop. Pending timers are discarded.
+ *
+ * @param[in] loop Loop.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p loop is NULL.
+ */
+uint8_t bh1750_linux_loop_deinit(BH1750LinuxLoop *const loop);
+
+/**
+ * @brief @ref BH1750StartTimer implementation. @p user_data must point to a @ref BH1750LinuxLoop.
+ *
+ * If the timer heap is full, the timer is dropped and counted in num_timers_dropped of @ref BH1750LinuxLoopStats, and
+ * every following call of @ref bh1750_linux_loop_run_once fails.
+ */
+void bh1750_linux_loop_start_timer(uint32_t duration_ms, void *user_data, BH1750TimerExpiredCb cb,
+                                   void *cb_user_data);
+
+/** @ref BH1750GetTime implementation, based on CLOCK_MONOTONIC. @p user_data is ignored. */
+uint32_t bh1750_linux_loop_get_time(void *user_data);
+
+/**
+ * @brief Wait for events once, and dispatch them.
+ *
+ * Executes the callbacks of all expired timers and all pending I2C completions.
+ *
+ * @param[in] loop Loop.
+ * @param[in] timeout_ms Maximum time to wait in ms. -1 to wait until an event occurs.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success, including timeouts and interrupted waits.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p loop is NULL.
+ * @retval BH1750_RESULT_CODE_OUT_OF_MEMORY A timer was dropped because the timer heap was full. Nothing is dispatched,
+ * the capacity passed to @ref bh1750_linux_loop_init is too small.
+ * @retval BH1750_RESULT_CODE_IO_ERR epoll_wait failed.
+ */
+uint8_t bh1750_linux_loop_run_once(BH1750LinuxLoop *const loop, int timeout_ms);
+
+/**
+ * @brief Get the statistics of a loop.
+ *
+ * @param[in] loop Loop.
+ * @param[out] stats Statistics.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p loop or @p stats is NULL.
+ */
+uint8_t bh1750_linux_loop_get_stats(const BH1750LinuxLoop *const loop, BH1750LinuxLoopStats *const stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_LINUX_BH1750_LINUX_LOOP_H */
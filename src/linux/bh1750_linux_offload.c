@@ -0,0 +1,264 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bh1750_linux_offload.h"
+
+/**
+ * @brief Find a bus that has queued requests and no transfer in progress.
+ *
+ * Must be called with the mutex locked. Starts after the bus that was served last, so that all buses are served in
+ * turn.
+ *
+ * @return BH1750LinuxOffloadBus* Bus, or NULL if there is no work.
+ */
+static BH1750LinuxOffloadBus *find_ready_bus(BH1750LinuxOffload *const offload)
+{
+    if (!offload->buses) {
+        return NULL;
+    }
+
+    BH1750LinuxOffloadBus *start = (offload->last_served && offload->last_served->next) ? offload->last_served->next
+                                                                                         : offload->buses;
+    BH1750LinuxOffloadBus *bus = start;
+    do {
+        if ((bus->count > 0) && !bus->is_busy) {
+            return bus;
+        }
+        bus = bus->next ? bus->next : offload->buses;
+    } while (bus != start);
+    return NULL;
+}
+
+static void *worker(void *arg)
+{
+    BH1750LinuxOffload *offload = (BH1750LinuxOffload *)arg;
+    pthread_mutex_lock(&offload->mutex);
+    for (;;) {
+        BH1750LinuxOffloadBus *bus = find_ready_bus(offload);
+        if (!bus) {
+            if (offload->is_stopping) {
+                break;
+            }
+            pthread_cond_wait(&offload->work_cond, &offload->mutex);
+            continue;
+        }
+
+        BH1750LinuxOffloadRequest request = bus->requests[bus->head];
+        bus->head = (bus->head + 1) % bus->capacity;
+        bus->count--;
+        bus->is_busy = true;
+        offload->last_served = bus;
+        pthread_mutex_unlock(&offload->mutex);
+
+        uint8_t *data = request.is_read ? request.data : request.write_data;
+        request.result_code =
+            bus->transfer(request.is_read, data, request.length, request.i2c_addr, bus->transfer_user_data);
+
+        pthread_mutex_lock(&offload->mutex);
+        bus->is_busy = false;
+        if (bus->count > 0) {
+            /* This worker is about to queue the completion, let another one take the next request of this bus */
+            pthread_cond_signal(&offload->work_cond);
+        }
+        /* Only happens if the completion capacity is smaller than the number of instances */
+        while ((offload->count == offload->capacity) && !offload->is_stopping) {
+            pthread_cond_wait(&offload->space_cond, &offload->mutex);
+        }
+        if (offload->count == offload->capacity) {
+            /* Shutting down and nobody executes completions anymore */
+            continue;
+        }
+        offload->completions[(offload->head + offload->count) % offload->capacity] = request;
+        offload->count++;
+        offload->stats.num_transactions++;
+        if ((offload->count == 1) && offload->notify) {
+            offload->notify(offload->notify_user_data);
+        }
+    }
+    pthread_mutex_unlock(&offload->mutex);
+    return NULL;
+}
+
+static void stop_workers(BH1750LinuxOffload *const offload, size_t num_workers)
+{
+    pthread_mutex_lock(&offload->mutex);
+    offload->is_stopping = true;
+    pthread_cond_broadcast(&offload->work_cond);
+    pthread_cond_broadcast(&offload->space_cond);
+    pthread_mutex_unlock(&offload->mutex);
+    for (size_t i = 0; i < num_workers; i++) {
+        pthread_join(offload->workers[i], NULL);
+    }
+}
+
+uint8_t bh1750_linux_offload_init(BH1750LinuxOffload *const offload, pthread_t *const workers, size_t num_workers,
+                                  BH1750LinuxOffloadRequest *const completions, size_t capacity)
+{
+    if (!offload || !workers || (num_workers == 0) || !completions || (capacity == 0)) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    pthread_mutex_init(&offload->mutex, NULL);
+    pthread_cond_init(&offload->work_cond, NULL);
+    pthread_cond_init(&offload->space_cond, NULL);
+    offload->workers = workers;
+    offload->num_workers = 0;
+    offload->buses = NULL;
+    offload->last_served = NULL;
+    offload->completions = completions;
+    offload->capacity = capacity;
+    offload->head = 0;
+    offload->count = 0;
+    offload->notify = NULL;
+    offload->notify_user_data = NULL;
+    offload->is_stopping = false;
+    offload->stats.num_transactions = 0;
+    offload->stats.num_rejected = 0;
+    offload->stats.max_queue_depth = 0;
+
+    for (size_t i = 0; i < num_workers; i++) {
+        if (pthread_create(&workers[i], NULL, worker, offload) != 0) {
+            stop_workers(offload, i);
+            return BH1750_RESULT_CODE_IO_ERR;
+        }
+        offload->num_workers++;
+    }
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_linux_offload_deinit(BH1750LinuxOffload *const offload)
+{
+    if (!offload) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    stop_workers(offload, offload->num_workers);
+    offload->num_workers = 0;
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_linux_offload_set_notify(BH1750LinuxOffload *const offload, BH1750LinuxOffloadNotify notify,
+                                        void *user_data)
+{
+    if (!offload) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&offload->mutex);
+    offload->notify = notify;
+    offload->notify_user_data = user_data;
+    pthread_mutex_unlock(&offload->mutex);
+    return BH1750_RESULT_CODE_OK;
+}
+
+uint8_t bh1750_linux_offload_bus_init(BH1750LinuxOffloadBus *const bus, BH1750LinuxOffload *const offload,
+                                      BH1750LinuxOffloadRequest *const requests, size_t capacity,
+                                      BH1750BlockingTransfer transfer, void *transfer_user_data)
+{
+    if (!bus || !offload || !requests || (capacity == 0) || !transfer) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    bus->offload = offload;
+    bus->transfer = transfer;
+    bus->transfer_user_data = transfer_user_data;
+    bus->requests = requests;
+    bus->capacity = capacity;
+    bus->head = 0;
+    bus->count = 0;
+    bus->is_busy = false;
+    pthread_mutex_lock(&offload->mutex);
+    bus->next = offload->buses;
+    offload->buses = bus;
+    pthread_mutex_unlock(&offload->mutex);
+    return BH1750_RESULT_CODE_OK;
+}
+
+static void submit(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, bool is_read,
+                   BH1750_I2CCompleteCb cb, void *cb_user_data)
+{
+    BH1750LinuxOffloadBus *bus = (BH1750LinuxOffloadBus *)user_data;
+    BH1750LinuxOffload *offload = bus->offload;
+
+    pthread_mutex_lock(&offload->mutex);
+    if ((bus->count == bus->capacity) || (!is_read && (length > BH1750_LINUX_OFFLOAD_MAX_WRITE_LEN))) {
+        offload->stats.num_rejected++;
+        pthread_mutex_unlock(&offload->mutex);
+        /* Either capacity is smaller than the number of instances on the bus, or the write does not fit into the
+         * request. We are in the driver context, so failing right away does not break the execution context rule. */
+        cb(BH1750_I2C_RESULT_CODE_ERR, cb_user_data);
+        return;
+    }
+
+    BH1750LinuxOffloadRequest *request = &bus->requests[(bus->head + bus->count) % bus->capacity];
+    request->is_read = is_read;
+    if (is_read) {
+        request->data = data;
+    } else {
+        request->data = NULL;
+        memcpy(request->write_data, data, length);
+    }
+    request->length = length;
+    request->i2c_addr = i2c_addr;
+    request->cb = cb;
+    request->cb_user_data = cb_user_data;
+    bus->count++;
+    if (bus->count > offload->stats.max_queue_depth) {
+        offload->stats.max_queue_depth = (uint32_t)bus->count;
+    }
+    if (!bus->is_busy) {
+        pthread_cond_signal(&offload->work_cond);
+    }
+    pthread_mutex_unlock(&offload->mutex);
+}
+
+void bh1750_linux_offload_write(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data,
+                                BH1750_I2CCompleteCb cb, void *cb_user_data)
+{
+    submit(data, length, i2c_addr, user_data, false, cb, cb_user_data);
+}
+
+void bh1750_linux_offload_read(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data,
+                               BH1750_I2CCompleteCb cb, void *cb_user_data)
+{
+    submit(data, length, i2c_addr, user_data, true, cb, cb_user_data);
+}
+
+size_t bh1750_linux_offload_process(BH1750LinuxOffload *const offload)
+{
+    if (!offload) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&offload->mutex);
+    size_t num_to_execute = offload->count;
+    pthread_mutex_unlock(&offload->mutex);
+    for (size_t i = 0; i < num_to_execute; i++) {
+        /* Dequeue before executing, the callback can start a new transaction */
+        pthread_mutex_lock(&offload->mutex);
+        BH1750LinuxOffloadRequest completion = offload->completions[offload->head];
+        offload->head = (offload->head + 1) % offload->capacity;
+        offload->count--;
+        pthread_cond_signal(&offload->space_cond);
+        pthread_mutex_unlock(&offload->mutex);
+        completion.cb(completion.result_code, completion.cb_user_data);
+    }
+    return num_to_execute;
+}
+
+uint8_t bh1750_linux_offload_get_stats(BH1750LinuxOffload *const offload, BH1750LinuxOffloadStats *const stats)
+{
+    if (!offload || !stats) {
+        return BH1750_RESULT_CODE_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&offload->mutex);
+    *stats = offload->stats;
+    pthread_mutex_unlock(&offload->mutex);
+    return BH1750_RESULT_CODE_OK;
+}
@@ -0,0 +1,233 @@
+#ifndef SRC_LINUX_BH1750_LINUX_OFFLOAD_H
+#define SRC_LINUX_BH1750_LINUX_OFFLOAD_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "bh1750.h"
+
+/**
+ * @brief Adapter that implements the asynchronous I2C functions of the driver on top of a blocking transfer function.
+ *
+ * Transfers run on a bounded pool of worker threads, so a slow or stuck transfer does not stall the thread that drives
+ * the BH1750 instances. Every bus has its own queue of requests. At most one transfer per bus is in progress at a time,
+ * so the transfer function of a bus is never called concurrently, while transfers on different buses run in parallel.
+ *
+ * Completions are queued and executed by @ref bh1750_linux_offload_process, which must be called from the same context
+ * as all other driver functions.
+ */
+
+/**
+ * @brief Maximum length of a write transaction.
+ *
+ * The driver does not keep write data alive after @ref BH1750_I2CWrite returns, so it is copied into the request. The
+ * driver only writes single byte commands.
+ */
+#define BH1750_LINUX_OFFLOAD_MAX_WRITE_LEN 4
+
+/**
+ * @brief Blocking I2C transfer.
+ *
+ * Called from a worker thread.
+ *
+ * @param[in] is_read true to read @p length bytes into @p data, false to write @p length bytes of @p data.
+ * @param data Data to write, or memory to read into.
+ * @param[in] length Number of bytes.
+ * @param[in] i2c_addr I2C address of the device.
+ * @param[in] user_data User data that was passed to @ref bh1750_linux_offload_bus_init.
+ *
+ * @return uint8_t BH1750_I2C_RESULT_CODE_OK if the transfer succeeded, BH1750_I2C_RESULT_CODE_ERR otherwise.
+ */
+typedef uint8_t (*BH1750BlockingTransfer)(bool is_read, uint8_t *data, size_t length, uint8_t i2c_addr,
+                                          void *user_data);
+
+/**
+ * @brief Callback type to execute when a completion is queued while no other completions are pending.
+ *
+ * Called from a worker thread, with the lock of the adapter held, so it must not call the functions of the adapter.
+ * Typically writes to an eventfd or posts to a message queue to wake up the thread that calls
+ * @ref bh1750_linux_offload_process.
+ *
+ * @param[in] user_data User data that was passed to @ref bh1750_linux_offload_set_notify.
+ */
+typedef void (*BH1750LinuxOffloadNotify)(void *user_data);
+
+/** I2C transaction, queued first for a worker, then for @ref bh1750_linux_offload_process. */
+typedef struct {
+    bool is_read;
+    /** Memory to read into, or NULL for writes. */
+    uint8_t *data;
+    uint8_t write_data[BH1750_LINUX_OFFLOAD_MAX_WRITE_LEN];
+    size_t length;
+    uint8_t i2c_addr;
+    BH1750_I2CCompleteCb cb;
+    void *cb_user_data;
+    uint8_t result_code;
+} BH1750LinuxOffloadRequest;
+
+/** Statistics of an adapter. */
+typedef struct {
+    /** Number of completed transfers. */
+    uint32_t num_transactions;
+    /** Number of transactions that failed right away because the queue of their bus was full, or because the write
+     * was longer than @ref BH1750_LINUX_OFFLOAD_MAX_WRITE_LEN. */
+    uint32_t num_rejected;
+    /** Largest number of requests that waited in the queue of one bus. */
+    uint32_t max_queue_depth;
+} BH1750LinuxOffloadStats;
+
+struct BH1750LinuxOffloadStruct;
+
+/**
+ * @brief One bus with its own request queue.
+ *
+ * Populated by @ref bh1750_linux_offload_bus_init. Pass a pointer to it as i2c_write_user_data and i2c_read_user_data
+ * of every instance on this bus.
+ */
+typedef struct BH1750LinuxOffloadBusStruct {
+    struct BH1750LinuxOffloadStruct *offload;
+    BH1750BlockingTransfer transfer;
+    void *transfer_user_data;
+    /** Ring buffer of requests that wait for a worker. */
+    BH1750LinuxOffloadRequest *requests;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    /** Whether a worker is running a transfer of this bus. */
+    bool is_busy;
+    struct BH1750LinuxOffloadBusStruct *next;
+} BH1750LinuxOffloadBus;
+
+/**
+ * @brief Worker pool shared by all buses.
+ *
+ * Populated by @ref bh1750_linux_offload_init. The fields should only be accessed through the functions in this header.
+ */
+typedef struct BH1750LinuxOffloadStruct {
+    pthread_mutex_t mutex;
+    /** Signaled when a bus gets a request that a worker can take, and on shutdown. */
+    pthread_cond_t work_cond;
+    /** Signaled when completions are executed, and on shutdown. */
+    pthread_cond_t space_cond;
+    pthread_t *workers;
+    size_t num_workers;
+    /** Buses, linked through their next field. */
+    BH1750LinuxOffloadBus *buses;
+    /** Bus that was served last. Workers start looking for work after it, so that no bus is starved. */
+    BH1750LinuxOffloadBus *last_served;
+    /** Ring buffer of completed requests. */
+    BH1750LinuxOffloadRequest *completions;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    BH1750LinuxOffloadNotify notify;
+    void *notify_user_data;
+    bool is_stopping;
+    BH1750LinuxOffloadStats stats;
+} BH1750LinuxOffload;
+
+/**
+ * @brief Initialize an adapter and start its worker threads.
+ *
+ * @param[out] offload Adapter to initialize.
+ * @param[in] workers Memory for the worker thread handles.
+ * @param[in] num_workers Number of worker threads. Transfers on at most this many buses run in parallel.
+ * @param[in] completions Memory for completed requests. Every instance has at most one transaction in progress, so
+ * @p capacity must be at least the number of instances that use the adapter.
+ * @param[in] capacity Number of elements in @p completions.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p offload, @p workers or @p completions is NULL, or @p num_workers or
+ * @p capacity is 0.
+ * @retval BH1750_RESULT_CODE_IO_ERR Failed to create the worker threads.
+ */
+uint8_t bh1750_linux_offload_init(BH1750LinuxOffload *const offload, pthread_t *const workers, size_t num_workers,
+                                  BH1750LinuxOffloadRequest *const completions, size_t capacity);
+
+/**
+ * @brief Stop and join the worker threads.
+ *
+ * Transfers that are already queued are still performed, and their completions can be executed with
+ * @ref bh1750_linux_offload_process afterwards. Completions that do not fit into the completion memory are discarded.
+ *
+ * @param[in] offload Adapter.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p offload is NULL.
+ */
+uint8_t bh1750_linux_offload_deinit(BH1750LinuxOffload *const offload);
+
+/**
+ * @brief Set the callback to execute when completions become pending.
+ *
+ * @param[in] offload Adapter.
+ * @param[in] notify Callback. NULL to disable.
+ * @param[in] user_data User data to pass to @p notify.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p offload is NULL.
+ */
+uint8_t bh1750_linux_offload_set_notify(BH1750LinuxOffload *const offload, BH1750LinuxOffloadNotify notify,
+                                        void *user_data);
+
+/**
+ * @brief Initialize a bus and add it to an adapter.
+ *
+ * The bus must stay valid until @ref bh1750_linux_offload_deinit is called.
+ *
+ * @param[out] bus Bus to initialize.
+ * @param[in] offload Adapter.
+ * @param[in] requests Memory for queued requests. @p capacity must be at least the number of instances on this bus.
+ * @param[in] capacity Number of elements in @p requests.
+ * @param[in] transfer Blocking transfer function of this bus.
+ * @param[in] transfer_user_data User data to pass to @p transfer.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p bus, @p offload, @p requests or @p transfer is NULL, or @p capacity is 0.
+ */
+uint8_t bh1750_linux_offload_bus_init(BH1750LinuxOffloadBus *const bus, BH1750LinuxOffload *const offload,
+                                      BH1750LinuxOffloadRequest *const requests, size_t capacity,
+                                      BH1750BlockingTransfer transfer, void *transfer_user_data);
+
+/** @ref BH1750_I2CWrite implementation. @p user_data must point to a @ref BH1750LinuxOffloadBus. */
+void bh1750_linux_offload_write(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data,
+                                BH1750_I2CCompleteCb cb, void *cb_user_data);
+
+/** @ref BH1750_I2CRead implementation. @p user_data must point to a @ref BH1750LinuxOffloadBus. */
+void bh1750_linux_offload_read(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data,
+                               BH1750_I2CCompleteCb cb, void *cb_user_data);
+
+/**
+ * @brief Execute the completions of finished transfers.
+ *
+ * Only executes the completions that were queued before this call.
+ *
+ * @param[in] offload Adapter.
+ *
+ * @return size_t Number of executed completions. 0 if @p offload is NULL.
+ */
+size_t bh1750_linux_offload_process(BH1750LinuxOffload *const offload);
+
+/**
+ * @brief Get the statistics of an adapter.
+ *
+ * @param[in] offload Adapter.
+ * @param[out] stats Statistics.
+ *
+ * @retval BH1750_RESULT_CODE_OK Success.
+ * @retval BH1750_RESULT_CODE_INVALID_ARG @p offload or @p stats is NULL.
+ */
+uint8_t bh1750_linux_offload_get_stats(BH1750LinuxOffload *const offload, BH1750LinuxOffloadStats *const stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SRC_LINUX_BH1750_LINUX_OFFLOAD_H */
@@ -0,0 +1,308 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bh1750.h"
+/* Included to know the size of BH1750 instances */
+#include "bh1750_private.h"
+#include "bh1750_shm.h"
+#include "bh1750_client.h"
+#include "bh1750_linux_i2c.h"
+#include "bh1750_linux_loop.h"
+
+/**
+ * bh1750d - owns the sensors of one or more I2C buses and publishes their measurements to local clients.
+ *
+ * Every sensor runs in continuous H-resolution mode and is read every period. Every measurement is published to the
+ * slot of the sensor in a POSIX shared memory object, see bh1750_shm.h. Clients read it with bh1750_client.h. A sensor
+ * is given as bus_nr:i2c_addr, or as i2c_addr on the bus selected with -b. All buses share one event loop, so one
+ * daemon serves the whole system. The daemon refuses to start if the shared memory object already exists, so a second
+ * daemon can not take over the slots of the first one.
+ *
+ * Usage: bh1750d [-b bus_nr] [-p period_ms] [-n shm_name] [bus_nr:]i2c_addr...
+ */
+
+/** Maximum number of sensors, one slot each. */
+#define BH1750D_MAX_SENSORS 16
+#define BH1750D_DEFAULT_BUS_NR 1
+#define BH1750D_DEFAULT_PERIOD_MS 200
+
+typedef struct {
+    struct BH1750Struct inst_mem;
+    BH1750 inst;
+    uint16_t slot;
+    BH1750LinuxI2CBus *bus;
+    bool is_initialized;
+    /** Init is retried every period while the sensor does not respond, the failure is only reported once. */
+    bool has_reported_init_failure;
+} Sensor;
+
+static Sensor sensors[BH1750D_MAX_SENSORS];
+static size_t num_sensors;
+static uint32_t period_ms = BH1750D_DEFAULT_PERIOD_MS;
+
+/* Every instance has one timer of its own, and one poll timer of the daemon */
+static BH1750LinuxTimer timers[2 * BH1750D_MAX_SENSORS];
+static BH1750LinuxLoop loop;
+static BH1750LinuxI2CCompletion completions[BH1750D_MAX_SENSORS];
+static BH1750LinuxI2C i2c;
+/* Every sensor can be on a bus of its own */
+static BH1750LinuxI2CBus buses[BH1750D_MAX_SENSORS];
+static uint32_t bus_nrs[BH1750D_MAX_SENSORS];
+static size_t num_buses;
+static BH1750ShmWriter writer;
+
+static volatile sig_atomic_t should_stop;
+
+static void stop_handler(int sig)
+{
+    (void)sig;
+    should_stop = 1;
+}
+
+static void *get_instance_memory(void *user_data)
+{
+    return &((Sensor *)user_data)->inst_mem;
+}
+
+static void poll_timer_cb(void *user_data);
+
+static void schedule_poll(Sensor *const sensor)
+{
+    bh1750_linux_loop_start_timer(period_ms, &loop, poll_timer_cb, (void *)sensor);
+}
+
+static void read_cb(uint8_t result_code, const BH1750Measurement *meas, void *user_data)
+{
+    Sensor *sensor = (Sensor *)user_data;
+    if (result_code == BH1750_RESULT_CODE_OK) {
+        bh1750_shm_publish(&writer, sensor->slot, meas);
+    }
+    schedule_poll(sensor);
+}
+
+static void init_cb(uint8_t result_code, void *user_data)
+{
+    Sensor *sensor = (Sensor *)user_data;
+    if (result_code == BH1750_RESULT_CODE_OK) {
+        sensor->is_initialized = true;
+        /* Recover within the read sequence if the sensor was reset, e.g. by a brown-out */
+        bh1750_set_auto_recover(sensor->inst, true);
+    } else if (!sensor->has_reported_init_failure) {
+        sensor->has_reported_init_failure = true;
+        fprintf(stderr, "bh1750d: init of sensor %u failed: %u\n", (unsigned)sensor->slot, (unsigned)result_code);
+    }
+    /* The first measurement is available after the period, or init is retried */
+    schedule_poll(sensor);
+}
+
+static void poll_timer_cb(void *user_data)
+{
+    Sensor *sensor = (Sensor *)user_data;
+    uint8_t rc;
+    if (sensor->is_initialized) {
+        rc = bh1750_read_continuous_measurement(sensor->inst, read_cb, (void *)sensor);
+    } else {
+        BH1750StartupProfile profile = {
+            .meas_time = 69,
+            .start_continuous_meas = true,
+            .meas_mode = BH1750_MEAS_MODE_H_RES,
+        };
+        rc = bh1750_init(sensor->inst, &profile, init_cb, (void *)sensor);
+    }
+    if (rc != BH1750_RESULT_CODE_OK) {
+        schedule_poll(sensor);
+    }
+}
+
+static bool parse_uint(const char *str, unsigned long max, unsigned long *const val)
+{
+    char *end;
+    *val = strtoul(str, &end, 0);
+    return (*str != '\0') && (*end == '\0') && (*val <= max);
+}
+
+/* Parse [bus_nr:]i2c_addr */
+static bool parse_sensor(const char *str, unsigned long default_bus_nr, unsigned long *const bus_nr,
+                         unsigned long *const i2c_addr)
+{
+    const char *colon = strchr(str, ':');
+    *bus_nr = default_bus_nr;
+    if (colon) {
+        char *end;
+        *bus_nr = strtoul(str, &end, 0);
+        if ((colon == str) || (end != colon) || (*bus_nr > UINT32_MAX)) {
+            return false;
+        }
+        str = colon + 1;
+    }
+    return parse_uint(str, 0x7F, i2c_addr);
+}
+
+/* Get the bus with bus_nr, initialize it on first use */
+static BH1750LinuxI2CBus *get_bus(uint32_t bus_nr)
+{
+    for (size_t i = 0; i < num_buses; i++) {
+        if (bus_nrs[i] == bus_nr) {
+            return &buses[i];
+        }
+    }
+    if (bh1750_linux_i2c_bus_init(&buses[num_buses], &i2c, bus_nr) != BH1750_RESULT_CODE_OK) {
+        return NULL;
+    }
+    bus_nrs[num_buses] = bus_nr;
+    return &buses[num_buses++];
+}
+
+static void close_buses(void)
+{
+    for (size_t i = 0; i < num_buses; i++) {
+        bh1750_linux_i2c_bus_close(&buses[i]);
+    }
+}
+
+static void print_usage(void)
+{
+    fprintf(stderr, "usage: bh1750d [-b bus_nr] [-p period_ms] [-n shm_name] [bus_nr:]i2c_addr...\n");
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long bus_nr = BH1750D_DEFAULT_BUS_NR;
+    const char *shm_name = BH1750_CLIENT_DEFAULT_SHM_NAME;
+    unsigned long val;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:p:n:")) != -1) {
+        switch (opt) {
+        case 'b':
+            if (!parse_uint(optarg, UINT32_MAX, &bus_nr)) {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'p':
+            if (!parse_uint(optarg, UINT32_MAX, &val) || (val == 0)) {
+                print_usage();
+                return EXIT_FAILURE;
+            }
+            period_ms = (uint32_t)val;
+            break;
+        case 'n':
+            shm_name = optarg;
+            break;
+        default:
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+    num_sensors = (size_t)(argc - optind);
+    if ((num_sensors == 0) || (num_sensors > BH1750D_MAX_SENSORS)) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    uint8_t rc = bh1750_linux_i2c_init(&i2c, completions, BH1750D_MAX_SENSORS, NULL);
+    if (rc == BH1750_RESULT_CODE_OK) {
+        rc = bh1750_linux_loop_init(&loop, timers, 2 * BH1750D_MAX_SENSORS, &i2c);
+    }
+    if (rc != BH1750_RESULT_CODE_OK) {
+        fprintf(stderr, "bh1750d: failed to set up the I2C backend and the loop: %u\n", (unsigned)rc);
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < num_sensors; i++) {
+        unsigned long sensor_bus_nr;
+        if (!parse_sensor(argv[optind + (int)i], bus_nr, &sensor_bus_nr, &val)) {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+        Sensor *sensor = &sensors[i];
+        sensor->slot = (uint16_t)i;
+        sensor->bus = get_bus((uint32_t)sensor_bus_nr);
+        if (!sensor->bus) {
+            fprintf(stderr, "bh1750d: failed to set up bus %lu\n", sensor_bus_nr);
+            return EXIT_FAILURE;
+        }
+        BH1750InitConfig init_cfg = {
+            .get_instance_memory = get_instance_memory,
+            .get_instance_memory_user_data = (void *)sensor,
+            .i2c_write = bh1750_linux_i2c_write,
+            .i2c_write_user_data = sensor->bus,
+            .i2c_read = bh1750_linux_i2c_read,
+            .i2c_read_user_data = sensor->bus,
+            .start_timer = bh1750_linux_loop_start_timer,
+            .start_timer_user_data = &loop,
+            .i2c_addr = (uint8_t)val,
+            .get_time = bh1750_linux_loop_get_time,
+        };
+        rc = bh1750_create(&sensor->inst, &init_cfg);
+        if (rc != BH1750_RESULT_CODE_OK) {
+            fprintf(stderr, "bh1750d: failed to create sensor %zu: %u\n", i, (unsigned)rc);
+            return EXIT_FAILURE;
+        }
+    }
+
+    size_t size = bh1750_shm_get_region_size((uint16_t)num_sensors);
+    /* Never truncate the object of a running daemon. A stale object of a killed daemon has to be removed manually. */
+    int fd = shm_open(shm_name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("bh1750d: shm_open");
+        return EXIT_FAILURE;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        perror("bh1750d: ftruncate");
+        close(fd);
+        shm_unlink(shm_name);
+        return EXIT_FAILURE;
+    }
+    void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        perror("bh1750d: mmap");
+        shm_unlink(shm_name);
+        return EXIT_FAILURE;
+    }
+    rc = bh1750_shm_writer_init(&writer, mem, size, (uint16_t)num_sensors);
+    if (rc != BH1750_RESULT_CODE_OK) {
+        fprintf(stderr, "bh1750d: failed to initialize the shared memory: %u\n", (unsigned)rc);
+        munmap(mem, size);
+        shm_unlink(shm_name);
+        return EXIT_FAILURE;
+    }
+
+    struct sigaction sa = {0};
+    sa.sa_handler = stop_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    for (size_t i = 0; i < num_sensors; i++) {
+        poll_timer_cb((void *)&sensors[i]);
+    }
+    int exit_code = EXIT_SUCCESS;
+    while (!should_stop) {
+        /* Returns OK when a signal interrupts the wait */
+        rc = bh1750_linux_loop_run_once(&loop, -1);
+        if (rc != BH1750_RESULT_CODE_OK) {
+            fprintf(stderr, "bh1750d: loop failed: %u\n", (unsigned)rc);
+            exit_code = EXIT_FAILURE;
+            break;
+        }
+    }
+
+    munmap(mem, size);
+    shm_unlink(shm_name);
+    bh1750_linux_loop_deinit(&loop);
+    close_buses();
+    return exit_code;
+}
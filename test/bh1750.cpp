@@ -50,6 +50,23 @@ static void bh1750_complete_cb(uint8_t result_code, void *user_data)
     complete_cb_user_data = user_data;
 }
 
+/* Populated from inside bh1750_read_cb. The measurement is copied, because the pointer passed to the read cb is only
+ * valid during the execution of the read cb. */
+static bool read_cb_meas_null;
+static BH1750Measurement read_cb_meas;
+
+/* Read cb also populates the complete cb variables, so that the same checks can be used for all sequences */
+static void bh1750_read_cb(uint8_t result_code, const BH1750Measurement *meas, void *user_data)
+{
+    complete_cb_call_count++;
+    complete_cb_result_code = result_code;
+    complete_cb_user_data = user_data;
+    read_cb_meas_null = (meas == NULL);
+    if (meas) {
+        read_cb_meas = *meas;
+    }
+}
+
 static void populate_default_init_cfg(BH1750InitConfig *const cfg)
 {
     cfg->get_instance_memory = mock_bh1750_get_instance_memory;
@@ -92,6 +109,8 @@ TEST_GROUP(BH1750)
         complete_cb_call_count = 0;
         complete_cb_result_code = 0xFF;
         complete_cb_user_data = NULL;
+        read_cb_meas_null = false;
+        memset(&read_cb_meas, 0, sizeof(BH1750Measurement));
 
         bh1750 = NULL;
         memset(&init_cfg, 0, sizeof(BH1750InitConfig));
@@ -146,7 +165,7 @@ static void call_init()
         .withParameter("user_data", i2c_write_user_data)
         .ignoreOtherParameters();
 
-    uint8_t rc_init = bh1750_init(bh1750, NULL, NULL);
+    uint8_t rc_init = bh1750_init(bh1750, NULL, NULL, NULL);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_init);
     /* init performs three writes - one for power on cmd, two for setting meas time in Mtreg */
     i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
@@ -193,6 +212,8 @@ typedef enum {
     INVALID_ARG_TEST_TYPE_READ_CONT_MEAS,
     /** Test bh1750_read_one_time_measurement function. */
     INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS,
+    /** Test bh1750_init function. */
+    INVALID_ARG_TEST_TYPE_INIT,
 } InvalidArgTestType;
 
 /**
@@ -249,14 +270,6 @@ static void test_send_cmd_func(bool is_start_meas_cmd, uint8_t meas_mode, SendCm
     }
 }
 
-/** Context for testing invalid argument scenarios of bh1750_read_one_time_measurement. */
-typedef struct {
-    /** Passed to meas_mode parameter of bh1750_read_one_time_measurement. */
-    uint8_t meas_mode;
-    /** Passed to meas_lx parameter of bh1750_read_one_time_measurement. */
-    uint32_t *meas_lx_p;
-} ReadOneTimeMeasInvalidArgTestCtxt;
-
 /**
  * @brief Test a function when @ref BH1750_RESULT_CODE_INVALID_ARG is expected to be returned.
  *
@@ -271,11 +284,11 @@ typedef struct {
  * BH1750MeasMode. This defines the value of meas_mode argument passed to bh1750_start_continuous_measurement.
  * - INVALID_ARG_TEST_TYPE_SET_MEAS_TIME: Should be a pointer to uint8_t. The uint8_t value is interpreted as the
  * measurement time to pass to bh1750_set_measurement_time as the "meas_time" parameter.
- * - INVALID_ARG_TEST_TYPE_READ_CONT_MEAS: Should be a pointer to uint32_t. This pointer is passed to the meas_lx
- * parameter of bh1750_read_continuous_measurement. Can be NULL if needed for the test.
- * - INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS: Should be a pointer to ReadOneTimeMeasInvalidArgTestCtxt. meas_mode and
- * meas_lx_p are passed as arguments to the meas_mode and meas_lx parameters of bh1750_read_one_time_measurement
- * respectively.
+ * - INVALID_ARG_TEST_TYPE_READ_CONT_MEAS: Ignored, can be NULL.
+ * - INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS: Should point to a uint8_t. The uint8_t value is passed to the meas_mode
+ * parameter of bh1750_read_one_time_measurement.
+ * - INVALID_ARG_TEST_TYPE_INIT: Should be a pointer to BH1750StartupProfile, or NULL. This pointer is passed to the
+ * profile parameter of bh1750_init.
  */
 static void test_invalid_arg(BH1750 *inst_p, uint8_t test_type, void *test_type_context)
 {
@@ -311,14 +324,17 @@ static void test_invalid_arg(BH1750 *inst_p, uint8_t test_type, void *test_type_
         uint8_t i2c_write_data = 0x10;
         call_start_continuous_measurement(&i2c_write_data, BH1750_MEAS_MODE_H_RES);
 
-        uint32_t *meas_lx = (uint32_t *)test_type_context;
-        rc = bh1750_read_continuous_measurement(inst, meas_lx, bh1750_complete_cb, complete_cb_user_data_expected);
+        rc = bh1750_read_continuous_measurement(inst, bh1750_read_cb, complete_cb_user_data_expected);
+        break;
+    }
+    case INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS: {
+        uint8_t *meas_mode = (uint8_t *)test_type_context;
+        rc = bh1750_read_one_time_measurement(inst, *meas_mode, bh1750_read_cb, complete_cb_user_data_expected);
         break;
     }
-    case INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS:
-        ReadOneTimeMeasInvalidArgTestCtxt *ctxt = (ReadOneTimeMeasInvalidArgTestCtxt *)test_type_context;
-        rc = bh1750_read_one_time_measurement(inst, ctxt->meas_mode, ctxt->meas_lx_p, bh1750_complete_cb,
-                                              complete_cb_user_data_expected);
+    case INVALID_ARG_TEST_TYPE_INIT:
+        const BH1750StartupProfile *profile = (const BH1750StartupProfile *)test_type_context;
+        rc = bh1750_init(inst, profile, bh1750_complete_cb, complete_cb_user_data_expected);
         break;
     }
 
@@ -700,7 +716,7 @@ static void test_init(uint8_t i2c_addr, uint8_t i2c_write_rc_1, uint8_t i2c_writ
     }
 
     void *complete_cb_user_data_expected = (void *)0x14;
-    uint8_t rc = bh1750_init(bh1750, complete_cb, complete_cb_user_data_expected);
+    uint8_t rc = bh1750_init(bh1750, NULL, complete_cb, complete_cb_user_data_expected);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
     i2c_write_complete_cb(i2c_write_rc_1, i2c_write_complete_cb_user_data);
     if (i2c_write_rc_1 == BH1750_I2C_RESULT_CODE_OK) {
@@ -773,7 +789,132 @@ TEST(BH1750, InitAltI2cAddr)
 
 TEST(BH1750, InitSelfNull)
 {
-    test_invalid_arg(NULL, INVALID_ARG_TEST_TYPE_SEND_CMD_FUNC, (void *)bh1750_init);
+    test_invalid_arg(NULL, INVALID_ARG_TEST_TYPE_INIT, NULL);
+}
+
+/**
+ * @brief Test bh1750_init with a startup profile.
+ *
+ * @param profile Startup profile to pass to bh1750_init.
+ * @param i2c_write_data_2 Expected command to set the three high bits of Mtreg.
+ * @param i2c_write_data_3 Expected command to set the five low bits of Mtreg.
+ * @param i2c_write_data_4 Expected command to start continuous measurement. Only used if
+ * profile->start_continuous_meas is true.
+ * @param last_i2c_write_rc Result code to invoke the last I2C write complete callback with.
+ * @param expected_complete_cb_rc Result code that the tests expects to be returned from the init complete cb.
+ */
+static void test_init_with_profile(const BH1750StartupProfile *profile, uint8_t i2c_write_data_2,
+                                   uint8_t i2c_write_data_3, uint8_t i2c_write_data_4, uint8_t last_i2c_write_rc,
+                                   uint8_t expected_complete_cb_rc)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+
+    /* Power on command */
+    uint8_t i2c_write_data_1 = 0x01;
+    uint8_t *i2c_write_data[] = {&i2c_write_data_1, &i2c_write_data_2, &i2c_write_data_3, &i2c_write_data_4};
+    size_t num_writes = profile->start_continuous_meas ? 4 : 3;
+    for (size_t i = 0; i < num_writes; i++) {
+        mock()
+            .expectOneCall("mock_bh1750_i2c_write")
+            .withMemoryBufferParameter("data", i2c_write_data[i], 1)
+            .withParameter("length", 1)
+            .withParameter("i2c_addr", init_cfg.i2c_addr)
+            .withParameter("user_data", i2c_write_user_data)
+            .ignoreOtherParameters();
+    }
+
+    void *complete_cb_user_data_expected = (void *)0x18;
+    uint8_t rc = bh1750_init(bh1750, profile, bh1750_complete_cb, complete_cb_user_data_expected);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    for (size_t i = 0; i < (num_writes - 1); i++) {
+        CHECK_EQUAL(0, complete_cb_call_count);
+        i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    }
+    i2c_write_complete_cb(last_i2c_write_rc, i2c_write_complete_cb_user_data);
+
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(expected_complete_cb_rc, complete_cb_result_code);
+    CHECK_EQUAL(complete_cb_user_data_expected, complete_cb_user_data);
+}
+
+TEST(BH1750, InitWithProfileStartsContMeas)
+{
+    BH1750StartupProfile profile = {
+        .meas_time = 138, /* bin: 10001010 */
+        .start_continuous_meas = true,
+        .meas_mode = BH1750_MEAS_MODE_L_RES,
+    };
+    /* MTreg 100 and 01010, start continuous measurement in L-resolution mode */
+    test_init_with_profile(&profile, 0x44, 0x6A, 0x13, BH1750_I2C_RESULT_CODE_OK, BH1750_RESULT_CODE_OK);
+
+    /* Continuous measurement is ongoing right after init, and the measurement is converted using meas time 138 */
+    uint8_t i2c_read_data[] = {0x83, 0x90};
+    mock()
+        .expectOneCall("mock_bh1750_i2c_read")
+        .withOutputParameterReturning("data", i2c_read_data, 2)
+        .withParameter("length", 2)
+        .withParameter("i2c_addr", init_cfg.i2c_addr)
+        .withParameter("user_data", i2c_read_user_data)
+        .ignoreOtherParameters();
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(2, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    CHECK_EQUAL(14033, read_cb_meas.meas_lx); /* (0x8390 * ((1 / 1.2) * (69 / 138))) */
+    CHECK_EQUAL(BH1750_MEAS_MODE_L_RES, read_cb_meas.meas_mode);
+}
+
+TEST(BH1750, InitWithProfileNoContMeas)
+{
+    BH1750StartupProfile profile = {
+        .meas_time = 31, /* bin: 00011111 */
+        .start_continuous_meas = false,
+        .meas_mode = 0xAB, /* Ignored, because continuous measurement is not started */
+    };
+    /* MTreg 000 and 11111 */
+    test_init_with_profile(&profile, 0x40, 0x7F, 0x0, BH1750_I2C_RESULT_CODE_OK, BH1750_RESULT_CODE_OK);
+
+    /* Continuous measurement was not started */
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
+}
+
+TEST(BH1750, InitWithProfileStartContMeasFail)
+{
+    BH1750StartupProfile profile = {
+        .meas_time = 138, /* bin: 10001010 */
+        .start_continuous_meas = true,
+        .meas_mode = BH1750_MEAS_MODE_H_RES,
+    };
+    /* MTreg 100 and 01010, start continuous measurement in H-resolution mode */
+    test_init_with_profile(&profile, 0x44, 0x6A, 0x10, BH1750_I2C_RESULT_CODE_ERR, BH1750_RESULT_CODE_IO_ERR);
+
+    /* Init failed, so the instance is not initialized */
+    uint8_t rc = bh1750_power_on(bh1750, bh1750_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
+}
+
+TEST(BH1750, InitWithProfileInvalidMeasTime)
+{
+    BH1750StartupProfile profile = {
+        .meas_time = 30,
+        .start_continuous_meas = false,
+        .meas_mode = BH1750_MEAS_MODE_H_RES,
+    };
+    test_invalid_arg(&bh1750, INVALID_ARG_TEST_TYPE_INIT, &profile);
+}
+
+TEST(BH1750, InitWithProfileInvalidMeasMode)
+{
+    BH1750StartupProfile profile = {
+        .meas_time = 69,
+        .start_continuous_meas = true,
+        .meas_mode = 0xF1,
+    };
+    test_invalid_arg(&bh1750, INVALID_ARG_TEST_TYPE_INIT, &profile);
 }
 
 typedef struct {
@@ -787,10 +928,11 @@ typedef struct {
     uint8_t *i2c_read_data;
     /** I2C return code to execute I2C read complete callback with. */
     uint8_t i2c_read_rc;
-    /** Expected measurement in lx. It is only checked if expected_complete_cb_rc is BH1750_RESULT_CODE_OK. */
+    /** Expected measurement in lx. It is only checked if complete_cb is not NULL and expected_complete_cb_rc is
+     * BH1750_RESULT_CODE_OK. */
     uint32_t expected_meas_lx;
-    /** Complete callback to execute once bh1750_read_continuous_measurement is complete. */
-    BH1750CompleteCb complete_cb;
+    /** Read callback to execute once bh1750_read_continuous_measurement is complete. */
+    BH1750ReadCb complete_cb;
     /** Expected complete callback rc. Only checked if complete_cb is not NULL. */
     uint8_t expected_complete_cb_rc;
 } TestReadContMeasCfg;
@@ -813,8 +955,7 @@ static void test_read_cont_meas(const TestReadContMeasCfg *const cfg)
         .ignoreOtherParameters();
 
     void *complete_cb_user_data_expected = (void *)0x15;
-    uint32_t meas_lx;
-    uint8_t rc = bh1750_read_continuous_measurement(bh1750, &meas_lx, cfg->complete_cb, complete_cb_user_data_expected);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, cfg->complete_cb, complete_cb_user_data_expected);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
     i2c_read_complete_cb(cfg->i2c_read_rc, i2c_read_complete_cb_user_data);
 
@@ -822,9 +963,11 @@ static void test_read_cont_meas(const TestReadContMeasCfg *const cfg)
         CHECK_EQUAL(1, complete_cb_call_count);
         CHECK_EQUAL(cfg->expected_complete_cb_rc, complete_cb_result_code);
         CHECK_EQUAL(complete_cb_user_data_expected, complete_cb_user_data);
-    }
-    if (cfg->expected_complete_cb_rc == BH1750_RESULT_CODE_OK) {
-        CHECK_EQUAL(cfg->expected_meas_lx, meas_lx);
+        if (cfg->expected_complete_cb_rc == BH1750_RESULT_CODE_OK) {
+            CHECK_EQUAL(cfg->expected_meas_lx, read_cb_meas.meas_lx);
+        } else {
+            CHECK_TRUE(read_cb_meas_null);
+        }
     }
 }
 
@@ -841,7 +984,7 @@ TEST(BH1750, ReadContMeasReadFail)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_ERR,
         .expected_meas_lx = 0, /* Don't care */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_IO_ERR,
     };
     test_read_cont_meas(&cfg);
@@ -860,7 +1003,7 @@ TEST(BH1750, ReadContMeasHResSuccess)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 28067,
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_cont_meas(&cfg);
@@ -878,7 +1021,7 @@ TEST(BH1750, ReadContMeasHResSuccess2)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 25026,
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_cont_meas(&cfg);
@@ -897,7 +1040,7 @@ TEST(BH1750, ReadContMeasHRes2Success)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 14033,
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_cont_meas(&cfg);
@@ -916,7 +1059,7 @@ TEST(BH1750, ReadContMeasLResSuccess)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 28067,
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_cont_meas(&cfg);
@@ -936,7 +1079,6 @@ TEST(BH1750, ReadContMeasCbNull)
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 28067,
         .complete_cb = NULL,
-        /* OK so that meas_lx is checked against the expected one */
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_cont_meas(&cfg);
@@ -955,21 +1097,39 @@ TEST(BH1750, ReadContMeasAltI2cAddr)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 28067,
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_cont_meas(&cfg);
 }
 
-TEST(BH1750, ReadContMeasSelfNull)
+TEST(BH1750, ReadContMeasCbReceivesRawMeasAndConfig)
 {
-    uint32_t meas_lx;
-    test_invalid_arg(NULL, INVALID_ARG_TEST_TYPE_READ_CONT_MEAS, &meas_lx);
+    /* Start continuous measurement in H-resolution 2 mode cmd */
+    uint8_t i2c_write_data = 0x11;
+    /* Example from the datasheet, p. 7 */
+    uint8_t i2c_read_data[] = {0x83, 0x90};
+    TestReadContMeasCfg cfg = {
+        .i2c_addr = BH1750_TEST_DEFAULT_I2C_ADDR,
+        .meas_mode = BH1750_MEAS_MODE_H_RES2,
+        .i2c_write_data = &i2c_write_data,
+        .i2c_read_data = i2c_read_data,
+        .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
+        .expected_meas_lx = 14033,
+        .complete_cb = bh1750_read_cb,
+        .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
+    };
+    test_read_cont_meas(&cfg);
+
+    CHECK_FALSE(read_cb_meas_null);
+    CHECK_EQUAL(0x8390, read_cb_meas.raw_meas);
+    CHECK_EQUAL(BH1750_MEAS_MODE_H_RES2, read_cb_meas.meas_mode);
+    CHECK_EQUAL(BH1750_TEST_DEFAULT_MEAS_TIME, read_cb_meas.meas_time);
 }
 
-TEST(BH1750, ReadContMeasMeasLxNull)
+TEST(BH1750, ReadContMeasSelfNull)
 {
-    test_invalid_arg(&bh1750, INVALID_ARG_TEST_TYPE_READ_CONT_MEAS, NULL);
+    test_invalid_arg(NULL, INVALID_ARG_TEST_TYPE_READ_CONT_MEAS, NULL);
 }
 
 TEST(BH1750, ReadContMeasCalledBeforeStartContMeas)
@@ -978,8 +1138,7 @@ TEST(BH1750, ReadContMeasCalledBeforeStartContMeas)
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
     call_init();
 
-    uint32_t meas_lx;
-    uint8_t rc = bh1750_read_continuous_measurement(bh1750, &meas_lx, bh1750_complete_cb, NULL);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
     CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
 }
 
@@ -1005,8 +1164,7 @@ TEST(BH1750, ReadContMeasCalledAfterFailedStartContMeas)
     /* Code ERR, so continuous measurement should not be marked as ongoing */
     i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_ERR, i2c_write_complete_cb_user_data);
 
-    uint32_t meas_lx;
-    uint8_t rc = bh1750_read_continuous_measurement(bh1750, &meas_lx, bh1750_complete_cb, NULL);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
     CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
 }
 
@@ -1066,16 +1224,14 @@ static void test_cont_meas_changes_with_meas_time(uint32_t meas_time, uint8_t *i
     i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
 
     void *complete_cb_user_data_expected = (void *)0x16;
-    uint32_t meas_lx;
-    uint8_t rc =
-        bh1750_read_continuous_measurement(bh1750, &meas_lx, bh1750_complete_cb, complete_cb_user_data_expected);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, complete_cb_user_data_expected);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
     i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
 
     CHECK_EQUAL(1, complete_cb_call_count);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
     CHECK_EQUAL(complete_cb_user_data_expected, complete_cb_user_data);
-    CHECK_EQUAL(expected_meas_lx, meas_lx);
+    CHECK_EQUAL(expected_meas_lx, read_cb_meas.meas_lx);
 }
 
 TEST(BH1750, ReadContMeasHResMeasTime138)
@@ -1213,10 +1369,11 @@ typedef struct {
     uint8_t *i2c_read_data;
     /** I2C return code to execute I2C read complete callback with. */
     uint8_t i2c_read_rc;
-    /** Expected measurement in lx. It is only checked if expected_complete_cb_rc is BH1750_RESULT_CODE_OK. */
+    /** Expected measurement in lx. It is only checked if complete_cb is not NULL and expected_complete_cb_rc is
+     * BH1750_RESULT_CODE_OK. */
     uint32_t expected_meas_lx;
-    /** Complete callback to execute once bh1750_read_one_time_measurement is complete. */
-    BH1750CompleteCb complete_cb;
+    /** Read callback to execute once bh1750_read_one_time_measurement is complete. */
+    BH1750ReadCb complete_cb;
     /** Expected complete callback rc. Only checked if complete_cb is not NULL. */
     uint8_t expected_complete_cb_rc;
 } TestReadOneTimeMeasCfg;
@@ -1278,10 +1435,9 @@ static void test_read_one_time_meas(const TestReadOneTimeMeasCfg *const cfg)
             .ignoreOtherParameters();
     }
 
-    uint32_t meas_lx;
     void *complete_cb_user_data_expected = (void *)0x17;
-    uint8_t rc = bh1750_read_one_time_measurement(bh1750, cfg->meas_mode, &meas_lx, cfg->complete_cb,
-                                                  complete_cb_user_data_expected);
+    uint8_t rc =
+        bh1750_read_one_time_measurement(bh1750, cfg->meas_mode, cfg->complete_cb, complete_cb_user_data_expected);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
     i2c_write_complete_cb(cfg->i2c_write_rc, i2c_write_complete_cb_user_data);
     if (cfg->i2c_write_rc == BH1750_I2C_RESULT_CODE_OK) {
@@ -1293,9 +1449,11 @@ static void test_read_one_time_meas(const TestReadOneTimeMeasCfg *const cfg)
         CHECK_EQUAL(1, complete_cb_call_count);
         CHECK_EQUAL(cfg->expected_complete_cb_rc, complete_cb_result_code);
         CHECK_EQUAL(complete_cb_user_data_expected, complete_cb_user_data);
-    }
-    if (cfg->expected_complete_cb_rc == BH1750_RESULT_CODE_OK) {
-        CHECK_EQUAL(cfg->expected_meas_lx, meas_lx);
+        if (cfg->expected_complete_cb_rc == BH1750_RESULT_CODE_OK) {
+            CHECK_EQUAL(cfg->expected_meas_lx, read_cb_meas.meas_lx);
+        } else {
+            CHECK_TRUE(read_cb_meas_null);
+        }
     }
 }
 
@@ -1317,7 +1475,7 @@ TEST(BH1750, ReadOneTimeMeasWriteFail)
         .i2c_read_data = i2c_read_data,            /* Don't care */
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_ERR, /* Don't care */
         .expected_meas_lx = 0,                     /* Don't care */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_IO_ERR,
     };
     test_read_one_time_meas(&cfg);
@@ -1341,7 +1499,7 @@ TEST(BH1750, ReadOneTimeMeasReadFail)
         .i2c_read_data = i2c_read_data, /* Don't care */
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_ERR,
         .expected_meas_lx = 0, /* Don't care */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_IO_ERR,
     };
     test_read_one_time_meas(&cfg);
@@ -1365,7 +1523,7 @@ TEST(BH1750, ReadOneTimeMeasHResMode)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 28067, /* (0x8390 / 1.2) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1389,7 +1547,7 @@ TEST(BH1750, ReadOneTimeMeasHResMode2)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 14033, /* ((0x8390 / 1.2) / 2) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1413,7 +1571,7 @@ TEST(BH1750, ReadOneTimeMeasLResMode)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 28067, /* (0x8390 / 1.2) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1438,7 +1596,7 @@ TEST(BH1750, ReadOneTimeMeasCbNull)
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 28067, /* (0x8390 / 1.2) */
         .complete_cb = NULL,
-        .expected_complete_cb_rc = BH1750_RESULT_CODE_OK, /* So that meas_lx is checked against expected_meas_lx */
+        .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
 }
@@ -1461,7 +1619,7 @@ TEST(BH1750, ReadOneTimeMeasAltI2cAddr)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 28067, /* (0x8390 / 1.2) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1469,31 +1627,14 @@ TEST(BH1750, ReadOneTimeMeasAltI2cAddr)
 
 TEST(BH1750, ReadOneTimeMeasSelfNull)
 {
-    uint32_t meas_lx;
-    ReadOneTimeMeasInvalidArgTestCtxt ctxt = {
-        .meas_mode = BH1750_MEAS_MODE_H_RES,
-        .meas_lx_p = &meas_lx,
-    };
-    test_invalid_arg(NULL, INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS, &ctxt);
-}
-
-TEST(BH1750, ReadOneTimeMeasMeasLxNull)
-{
-    ReadOneTimeMeasInvalidArgTestCtxt ctxt = {
-        .meas_mode = BH1750_MEAS_MODE_H_RES,
-        .meas_lx_p = NULL,
-    };
-    test_invalid_arg(&bh1750, INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS, &ctxt);
+    uint8_t meas_mode = BH1750_MEAS_MODE_H_RES;
+    test_invalid_arg(NULL, INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS, &meas_mode);
 }
 
 TEST(BH1750, ReadOneTimeMeasInvalidMeasMode)
 {
-    uint32_t meas_lx;
-    ReadOneTimeMeasInvalidArgTestCtxt ctxt = {
-        .meas_mode = 0xF2, /* Invalid meas mode */
-        .meas_lx_p = &meas_lx,
-    };
-    test_invalid_arg(&bh1750, INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS, &ctxt);
+    uint8_t meas_mode = 0xF2; /* Invalid meas mode */
+    test_invalid_arg(&bh1750, INVALID_ARG_TEST_TYPE_READ_ONE_TIME_MEAS, &meas_mode);
 }
 
 TEST(BH1750, ReadOneTimeMeasHResModeMeasTime138)
@@ -1518,10 +1659,42 @@ TEST(BH1750, ReadOneTimeMeasHResModeMeasTime138)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 14033, /* (0x8390 * ((1 / 1.2) * (69 / 138))) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
+        .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
+    };
+    test_read_one_time_meas(&cfg);
+}
+
+TEST(BH1750, ReadOneTimeMeasCbReceivesRawMeasAndConfig)
+{
+    /* Set three most significant bits of MTreg to 100 */
+    uint8_t meas_time_i2c_write_data_1 = 0x44;
+    /* Set five least significant bits of MTreg to 01010 */
+    uint8_t meas_time_i2c_write_data_2 = 0x6A;
+    /* One-time measurement in L-resolution mode cmd */
+    uint8_t i2c_write_data = 0x23;
+    uint8_t i2c_read_data[] = {0x01, 0x2C};
+    TestReadOneTimeMeasCfg cfg = {
+        .i2c_addr = BH1750_TEST_DEFAULT_I2C_ADDR,
+        .meas_time = 138, /* bin: 10001010 */
+        .meas_time_i2c_write_data_1 = &meas_time_i2c_write_data_1,
+        .meas_time_i2c_write_data_2 = &meas_time_i2c_write_data_2,
+        .meas_mode = BH1750_MEAS_MODE_L_RES,
+        .i2c_write_data = &i2c_write_data,
+        .i2c_write_rc = BH1750_I2C_RESULT_CODE_OK,
+        .timer_period = 48, /* 24 * 2, because meas time is 2 timer higher than default (69) */
+        .i2c_read_data = i2c_read_data,
+        .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
+        .expected_meas_lx = 125, /* (300 * ((1 / 1.2) * (69 / 138))) */
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
+
+    CHECK_FALSE(read_cb_meas_null);
+    CHECK_EQUAL(300, read_cb_meas.raw_meas);
+    CHECK_EQUAL(BH1750_MEAS_MODE_L_RES, read_cb_meas.meas_mode);
+    CHECK_EQUAL(138, read_cb_meas.meas_time);
 }
 
 TEST(BH1750, ReadOneTimeMeasHResModeMeasTime254)
@@ -1546,7 +1719,7 @@ TEST(BH1750, ReadOneTimeMeasHResModeMeasTime254)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 7624, /* (0x8390 * ((1 / 1.2) * (69 / 254))) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1574,7 +1747,7 @@ TEST(BH1750, ReadOneTimeMeasHResModeMeasTime31)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 62471, /* (0x8390 * ((1 / 1.2) * (69 / 31))) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1605,7 +1778,7 @@ TEST(BH1750, ReadOneTimeMeasHResModeMeasTime32TimerPeriodCeil)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 60519, /* (0x8390 * ((1 / 1.2) * (69 / 32))) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1632,7 +1805,7 @@ TEST(BH1750, ReadOneTimeMeasHResModeMeasTime138DiffMeas)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 20, /* (0x0030 * ((1 / 1.2) * (69 / 138))) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1660,7 +1833,7 @@ TEST(BH1750, ReadOneTimeMeasHRes2ModeMeasTime138)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 7017, /* (0x8390 * ((1 / 1.2) * (69 / 138) / 2)) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1688,7 +1861,7 @@ TEST(BH1750, ReadOneTimeMeasLResModeMeasTime138)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 14033, /* (0x8390 * ((1 / 1.2) * (69 / 138))) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1716,7 +1889,7 @@ TEST(BH1750, ReadOneTimeMeasLResModeMeasTime31)
         .i2c_read_data = i2c_read_data,
         .i2c_read_rc = BH1750_I2C_RESULT_CODE_OK,
         .expected_meas_lx = 62471, /* (0x8390 * ((1 / 1.2) * (69 / 31))) */
-        .complete_cb = bh1750_complete_cb,
+        .complete_cb = bh1750_read_cb,
         .expected_complete_cb_rc = BH1750_RESULT_CODE_OK,
     };
     test_read_one_time_meas(&cfg);
@@ -1778,7 +1951,7 @@ TEST(BH1750, InitCalledTwice)
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
     call_init();
 
-    uint8_t rc = bh1750_init(bh1750, bh1750_complete_cb, NULL);
+    uint8_t rc = bh1750_init(bh1750, NULL, bh1750_complete_cb, NULL);
     CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
 }
 
@@ -1823,8 +1996,7 @@ TEST(BH1750, ReadContMeasBeforeInit)
     uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
 
-    uint32_t meas_lx;
-    uint8_t rc = bh1750_read_continuous_measurement(bh1750, &meas_lx, bh1750_complete_cb, NULL);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
     CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
 }
 
@@ -1833,8 +2005,7 @@ TEST(BH1750, ReadOneTimeMeasBeforeInit)
     uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
 
-    uint32_t meas_lx;
-    uint8_t rc = bh1750_read_one_time_measurement(bh1750, BH1750_MEAS_MODE_L_RES, &meas_lx, bh1750_complete_cb, NULL);
+    uint8_t rc = bh1750_read_one_time_measurement(bh1750, BH1750_MEAS_MODE_L_RES, bh1750_read_cb, NULL);
     CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
 }
 
@@ -1896,7 +2067,7 @@ TEST(BH1750, FunctionsCannotBeCalledAfterFailedInit)
         .ignoreOtherParameters();
 
     void *complete_cb_user_data_expected = (void *)0x14;
-    uint8_t rc_init = bh1750_init(bh1750, bh1750_complete_cb, complete_cb_user_data_expected);
+    uint8_t rc_init = bh1750_init(bh1750, NULL, bh1750_complete_cb, complete_cb_user_data_expected);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_init);
     i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
     i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
@@ -2009,8 +2180,7 @@ TEST(BH1750, StartContMeasBusy)
 
 static uint8_t read_continuous_measurement()
 {
-    uint32_t meas_lx;
-    return bh1750_read_continuous_measurement(bh1750, &meas_lx, bh1750_complete_cb, NULL);
+    return bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
 }
 
 TEST(BH1750, ReadContMeasBusy)
@@ -2048,8 +2218,7 @@ TEST(BH1750, ReadContMeasBusy)
 
 static uint8_t read_one_time_measurement()
 {
-    uint32_t meas_lx;
-    return bh1750_read_one_time_measurement(bh1750, BH1750_MEAS_MODE_H_RES, &meas_lx, bh1750_complete_cb, NULL);
+    return bh1750_read_one_time_measurement(bh1750, BH1750_MEAS_MODE_H_RES, bh1750_read_cb, NULL);
 }
 
 TEST(BH1750, ReadOneTimeMeasBusy)
@@ -2173,8 +2342,7 @@ TEST(BH1750, ReadContMeasCannotBeInterrupted)
         .withParameter("user_data", i2c_write_user_data)
         .ignoreOtherParameters();
 
-    uint32_t meas_lx;
-    uint8_t rc = bh1750_read_continuous_measurement(bh1750, &meas_lx, bh1750_complete_cb, NULL);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
 
     uint8_t other_cmd_rc;
@@ -2228,8 +2396,7 @@ static void test_read_one_time_meas_cannot_be_interrupted(uint8_t i2c_write_rc,
         .withParameter("user_data", i2c_write_user_data)
         .ignoreOtherParameters();
 
-    uint32_t meas_lx;
-    uint8_t rc = bh1750_read_one_time_measurement(bh1750, BH1750_MEAS_MODE_H_RES, &meas_lx, bh1750_complete_cb, NULL);
+    uint8_t rc = bh1750_read_one_time_measurement(bh1750, BH1750_MEAS_MODE_H_RES, bh1750_read_cb, NULL);
     CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
 
     uint8_t other_cmd_rc;
@@ -2357,3 +2524,1232 @@ TEST(BH1750, SetMeasTimeCannotBeInterruptedSuccess)
     uint8_t i2c_write_rc_2 = BH1750_I2C_RESULT_CODE_OK;
     test_set_meas_time_cannot_be_interrupted(i2c_write_rc_1, i2c_write_rc_2);
 }
+
+TEST(BH1750, GetStateSnapshotAfterStartContMeas)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+    /* Start continuous measurement in H-resolution mode 2 cmd */
+    uint8_t i2c_write_data = 0x11;
+    call_start_continuous_measurement(&i2c_write_data, BH1750_MEAS_MODE_H_RES2);
+
+    BH1750StateSnapshot snapshot;
+    uint8_t rc = bh1750_get_state_snapshot(bh1750, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_TRUE(snapshot.initialized);
+    CHECK_EQUAL(BH1750_TEST_DEFAULT_MEAS_TIME, snapshot.meas_time);
+    CHECK_EQUAL(BH1750_MEAS_MODE_H_RES2, snapshot.meas_mode);
+    CHECK_TRUE(snapshot.cont_meas_ongoing);
+}
+
+TEST(BH1750, GetStateSnapshotBeforeInit)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+
+    BH1750StateSnapshot snapshot;
+    uint8_t rc = bh1750_get_state_snapshot(bh1750, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_FALSE(snapshot.initialized);
+    CHECK_FALSE(snapshot.cont_meas_ongoing);
+}
+
+TEST(BH1750, GetStateSnapshotInvalidArg)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+
+    BH1750StateSnapshot snapshot;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_state_snapshot(NULL, &snapshot));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_state_snapshot(bh1750, NULL));
+}
+
+static uint8_t get_state_snapshot()
+{
+    BH1750StateSnapshot snapshot;
+    return bh1750_get_state_snapshot(bh1750, &snapshot);
+}
+
+TEST(BH1750, GetStateSnapshotBusy)
+{
+    test_busy_if_seq_in_progress(get_state_snapshot);
+}
+
+TEST(BH1750, AttachResumesContMeasWithoutI2cTransactions)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+
+    BH1750StateSnapshot snapshot = {
+        .initialized = true,
+        .meas_time = 138,
+        .meas_mode = BH1750_MEAS_MODE_H_RES,
+        .cont_meas_ongoing = true,
+    };
+    /* No I2C transactions are expected */
+    uint8_t rc_attach = bh1750_attach(bh1750, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_attach);
+
+    /* Example from the datasheet, p. 7 */
+    uint8_t i2c_read_data[] = {0x83, 0x90};
+    mock()
+        .expectOneCall("mock_bh1750_i2c_read")
+        .withOutputParameterReturning("data", i2c_read_data, 2)
+        .withParameter("length", 2)
+        .withParameter("i2c_addr", init_cfg.i2c_addr)
+        .withParameter("user_data", i2c_read_user_data)
+        .ignoreOtherParameters();
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    CHECK_EQUAL(14033, read_cb_meas.meas_lx); /* (0x8390 * ((1 / 1.2) * (69 / 138))) */
+}
+
+TEST(BH1750, AttachWithoutContMeas)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+
+    BH1750StateSnapshot snapshot = {
+        .initialized = true,
+        .meas_time = 69,
+        .meas_mode = 0xFF, /* Ignored, because continuous measurement is not ongoing */
+        .cont_meas_ongoing = false,
+    };
+    uint8_t rc_attach = bh1750_attach(bh1750, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_attach);
+
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
+}
+
+TEST(BH1750, AttachAfterInit)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+
+    BH1750StateSnapshot snapshot = {
+        .initialized = true,
+        .meas_time = 69,
+        .meas_mode = BH1750_MEAS_MODE_H_RES,
+        .cont_meas_ongoing = false,
+    };
+    uint8_t rc = bh1750_attach(bh1750, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
+}
+
+TEST(BH1750, AttachInvalidSnapshot)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+
+    BH1750StateSnapshot not_initialized = {
+        .initialized = false,
+        .meas_time = 69,
+        .meas_mode = BH1750_MEAS_MODE_H_RES,
+        .cont_meas_ongoing = false,
+    };
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_attach(bh1750, &not_initialized));
+
+    BH1750StateSnapshot invalid_meas_time = {
+        .initialized = true,
+        .meas_time = 255,
+        .meas_mode = BH1750_MEAS_MODE_H_RES,
+        .cont_meas_ongoing = false,
+    };
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_attach(bh1750, &invalid_meas_time));
+
+    BH1750StateSnapshot invalid_meas_mode = {
+        .initialized = true,
+        .meas_time = 69,
+        .meas_mode = 0xF0,
+        .cont_meas_ongoing = true,
+    };
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_attach(bh1750, &invalid_meas_mode));
+
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_attach(bh1750, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_attach(NULL, &invalid_meas_mode));
+
+    /* Instance is still not initialized */
+    uint8_t rc = bh1750_power_on(bh1750, bh1750_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
+}
+
+/**
+ * @brief Attach to a sensor that performs continuous measurement in H-resolution mode with default measurement time.
+ *
+ * Attaching does not perform any I2C transactions, which keeps the expected mock calls of decimator tests short.
+ */
+static void attach_with_cont_meas()
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+
+    BH1750StateSnapshot snapshot = {
+        .initialized = true,
+        .meas_time = BH1750_TEST_DEFAULT_MEAS_TIME,
+        .meas_mode = BH1750_MEAS_MODE_H_RES,
+        .cont_meas_ongoing = true,
+    };
+    uint8_t rc_attach = bh1750_attach(bh1750, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_attach);
+}
+
+static void expect_i2c_read(uint8_t *i2c_read_data)
+{
+    mock()
+        .expectOneCall("mock_bh1750_i2c_read")
+        .withOutputParameterReturning("data", i2c_read_data, 2)
+        .withParameter("length", 2)
+        .withParameter("i2c_addr", init_cfg.i2c_addr)
+        .withParameter("user_data", i2c_read_user_data)
+        .ignoreOtherParameters();
+}
+
+static void expect_start_timer(uint32_t duration_ms)
+{
+    mock()
+        .expectOneCall("mock_bh1750_start_timer")
+        .withParameter("duration_ms", duration_ms)
+        .withParameter("user_data", start_timer_user_data)
+        .ignoreOtherParameters();
+}
+
+/**
+ * @brief Read continuous measurement with a decimator configured, and check the raw measurement passed to read cb.
+ *
+ * @param type Decimator type.
+ * @param num_samples Decimation factor. Number of elements in @p samples.
+ * @param samples Raw measurements returned by the sensor.
+ * @param expected_raw_meas Expected output of the decimator.
+ */
+static void test_read_cont_meas_decimator(uint8_t type, uint8_t num_samples, const uint16_t *samples,
+                                          uint16_t expected_raw_meas)
+{
+    attach_with_cont_meas();
+    uint8_t rc_set_decimator = bh1750_set_decimator(bh1750, type, num_samples);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_set_decimator);
+
+    uint8_t i2c_read_data[BH1750_MAX_DECIMATION_FACTOR][2];
+    for (uint8_t i = 0; i < num_samples; i++) {
+        i2c_read_data[i][0] = (uint8_t)(samples[i] >> 8);
+        i2c_read_data[i][1] = (uint8_t)(samples[i] & 0xFF);
+        if (i > 0) {
+            /* Wait for the next measurement in H-resolution mode with default meas time */
+            expect_start_timer(180);
+        }
+        expect_i2c_read(i2c_read_data[i]);
+    }
+
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    for (uint8_t i = 0; i < num_samples; i++) {
+        if (i > 0) {
+            timer_expired_cb(timer_expired_cb_user_data);
+        }
+        /* Read cb is only executed once all samples are collected */
+        CHECK_EQUAL(0, complete_cb_call_count);
+        i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    }
+
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    CHECK_EQUAL(expected_raw_meas, read_cb_meas.raw_meas);
+}
+
+TEST(BH1750, ReadContMeasBoxcarDecimator)
+{
+    uint16_t samples[] = {16, 32, 49};
+    /* 97 / 3 = 32.33 */
+    test_read_cont_meas_decimator(BH1750_DECIMATOR_TYPE_BOXCAR, 3, samples, 32);
+}
+
+TEST(BH1750, ReadContMeasBoxcarDecimatorRoundsToNearest)
+{
+    uint16_t samples[] = {0xFFFF, 0xFFFE};
+    /* 0x1FFFD / 2 = 0xFFFE.8 */
+    test_read_cont_meas_decimator(BH1750_DECIMATOR_TYPE_BOXCAR, 2, samples, 0xFFFF);
+}
+
+TEST(BH1750, ReadContMeasMedianDecimatorRejectsSpike)
+{
+    uint16_t samples[] = {100, 5000, 102};
+    test_read_cont_meas_decimator(BH1750_DECIMATOR_TYPE_MEDIAN, 3, samples, 102);
+}
+
+TEST(BH1750, ReadContMeasMedianDecimatorEvenFactor)
+{
+    uint16_t samples[] = {10, 1000, 21, 20};
+    /* Average of the two middle values 20 and 21, rounded up */
+    test_read_cont_meas_decimator(BH1750_DECIMATOR_TYPE_MEDIAN, 4, samples, 21);
+}
+
+TEST(BH1750, ReadContMeasDecimatorConvertsOutputToLx)
+{
+    /* Example from the datasheet, p. 7 */
+    uint16_t samples[] = {0x8390, 0x8390};
+    test_read_cont_meas_decimator(BH1750_DECIMATOR_TYPE_BOXCAR, 2, samples, 0x8390);
+    CHECK_EQUAL(28067, read_cb_meas.meas_lx); /* (0x8390 / 1.2) */
+}
+
+TEST(BH1750, ReadOneTimeMeasDecimator)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+    uint8_t rc_set_decimator = bh1750_set_decimator(bh1750, BH1750_DECIMATOR_TYPE_BOXCAR, 2);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_set_decimator);
+
+    /* One time measurement L-resolution mode cmd */
+    uint8_t i2c_write_data = 0x23;
+    uint8_t i2c_read_data_1[] = {0x00, 0x64};
+    uint8_t i2c_read_data_2[] = {0x00, 0x6E};
+    for (uint8_t i = 0; i < 2; i++) {
+        mock()
+            .expectOneCall("mock_bh1750_i2c_write")
+            .withMemoryBufferParameter("data", &i2c_write_data, 1)
+            .withParameter("length", 1)
+            .withParameter("i2c_addr", init_cfg.i2c_addr)
+            .withParameter("user_data", i2c_write_user_data)
+            .ignoreOtherParameters();
+        expect_start_timer(24);
+        expect_i2c_read((i == 0) ? i2c_read_data_1 : i2c_read_data_2);
+    }
+
+    uint8_t rc = bh1750_read_one_time_measurement(bh1750, BH1750_MEAS_MODE_L_RES, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    for (uint8_t i = 0; i < 2; i++) {
+        i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+        timer_expired_cb(timer_expired_cb_user_data);
+        CHECK_EQUAL(0, complete_cb_call_count);
+        i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    }
+
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    /* (100 + 110) / 2 */
+    CHECK_EQUAL(105, read_cb_meas.raw_meas);
+    CHECK_EQUAL(BH1750_MEAS_MODE_L_RES, read_cb_meas.meas_mode);
+}
+
+TEST(BH1750, ReadContMeasDecimatorReadFailDiscardsSamples)
+{
+    attach_with_cont_meas();
+    uint8_t rc_set_decimator = bh1750_set_decimator(bh1750, BH1750_DECIMATOR_TYPE_BOXCAR, 2);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_set_decimator);
+
+    uint8_t i2c_read_data_1[] = {0x10, 0x00};
+    uint8_t i2c_read_data_2[] = {0x00, 0x64};
+    uint8_t i2c_read_data_3[] = {0x00, 0x6E};
+    expect_i2c_read(i2c_read_data_1);
+    expect_start_timer(180);
+    expect_i2c_read(i2c_read_data_2);
+
+    uint8_t rc_1 = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_1);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_ERR, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, complete_cb_result_code);
+    CHECK_TRUE(read_cb_meas_null);
+
+    /* The sample read before the failure must not be a part of the next output */
+    expect_i2c_read(i2c_read_data_2);
+    expect_start_timer(180);
+    expect_i2c_read(i2c_read_data_3);
+
+    uint8_t rc_2 = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_2);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(2, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    CHECK_EQUAL(105, read_cb_meas.raw_meas);
+}
+
+TEST(BH1750, ReadContMeasDecimatorFactorOneReadsOnce)
+{
+    uint16_t samples[] = {0x1234};
+    test_read_cont_meas_decimator(BH1750_DECIMATOR_TYPE_MEDIAN, 1, samples, 0x1234);
+}
+
+TEST(BH1750, SetDecimatorInvalidArgs)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_set_decimator(NULL, BH1750_DECIMATOR_TYPE_BOXCAR, 2));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_set_decimator(bh1750, 0xAB, 2));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_set_decimator(bh1750, BH1750_DECIMATOR_TYPE_BOXCAR, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_set_decimator(bh1750, BH1750_DECIMATOR_TYPE_BOXCAR, BH1750_MAX_DECIMATION_FACTOR + 1));
+}
+
+static uint8_t set_decimator()
+{
+    return bh1750_set_decimator(bh1750, BH1750_DECIMATOR_TYPE_MEDIAN, 3);
+}
+
+TEST(BH1750, SetDecimatorBusy)
+{
+    test_busy_if_seq_in_progress(set_decimator);
+}
+
+/* Populated from inside meas_processor */
+static size_t meas_processor_call_count;
+static void *meas_processor_user_data;
+
+/* Adds 1 lx to every measurement and keeps it, unless user_data points to false */
+static bool meas_processor(BH1750Measurement *meas, void *user_data)
+{
+    meas_processor_call_count++;
+    meas_processor_user_data = user_data;
+    meas->meas_lx += 1;
+    return user_data ? *(bool *)user_data : true;
+}
+
+TEST(BH1750, MeasProcessorModifiesMeasPassedToReadCb)
+{
+    meas_processor_call_count = 0;
+    attach_with_cont_meas();
+    bool keep = true;
+    uint8_t rc_set = bh1750_set_meas_processor(bh1750, meas_processor, &keep);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_set);
+
+    /* Example from the datasheet, p. 7 */
+    uint8_t i2c_read_data[] = {0x83, 0x90};
+    expect_i2c_read(i2c_read_data);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(1, meas_processor_call_count);
+    POINTERS_EQUAL(&keep, meas_processor_user_data);
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    CHECK_EQUAL(28068, read_cb_meas.meas_lx); /* (0x8390 / 1.2) + 1 */
+}
+
+TEST(BH1750, MeasProcessorDropCompletesReadAsSuppressed)
+{
+    meas_processor_call_count = 0;
+    attach_with_cont_meas();
+    bool keep = false;
+    uint8_t rc_set = bh1750_set_meas_processor(bh1750, meas_processor, &keep);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_set);
+
+    uint8_t i2c_read_data[] = {0x83, 0x90};
+    expect_i2c_read(i2c_read_data);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(1, meas_processor_call_count);
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_SUPPRESSED, complete_cb_result_code);
+    CHECK_TRUE(read_cb_meas_null);
+
+    /* Sequence ended, so another read can be started */
+    expect_i2c_read(i2c_read_data);
+    uint8_t rc_2 = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_2);
+}
+
+TEST(BH1750, MeasProcessorNotExecutedOnReadFail)
+{
+    meas_processor_call_count = 0;
+    attach_with_cont_meas();
+    uint8_t rc_set = bh1750_set_meas_processor(bh1750, meas_processor, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_set);
+
+    uint8_t i2c_read_data[] = {0x83, 0x90};
+    expect_i2c_read(i2c_read_data);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_ERR, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(0, meas_processor_call_count);
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, complete_cb_result_code);
+}
+
+TEST(BH1750, SetMeasProcessorInvalidArg)
+{
+    uint8_t rc = bh1750_set_meas_processor(NULL, meas_processor, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+    /* Setup expects bh1750_create to be called */
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+}
+
+static uint8_t set_meas_processor()
+{
+    return bh1750_set_meas_processor(bh1750, meas_processor, NULL);
+}
+
+TEST(BH1750, SetMeasProcessorBusy)
+{
+    test_busy_if_seq_in_progress(set_meas_processor);
+}
+
+/**
+ * @brief Check that the read cb was executed once since @p call_count_before, and return whether it received the
+ * measurement rather than @ref BH1750_RESULT_CODE_SUPPRESSED.
+ */
+static bool check_read_completed(size_t call_count_before)
+{
+    CHECK_EQUAL(call_count_before + 1, complete_cb_call_count);
+    if (complete_cb_result_code == BH1750_RESULT_CODE_SUPPRESSED) {
+        CHECK_TRUE(read_cb_meas_null);
+        return false;
+    }
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    return true;
+}
+
+/**
+ * @brief Read continuous measurement that returns @p raw_meas, and return whether the read cb received the
+ * measurement.
+ */
+static bool read_cont_meas_notified(uint16_t raw_meas)
+{
+    size_t call_count_before = complete_cb_call_count;
+    uint8_t i2c_read_data[] = {(uint8_t)(raw_meas >> 8), (uint8_t)(raw_meas & 0xFF)};
+    expect_i2c_read(i2c_read_data);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    return check_read_completed(call_count_before);
+}
+
+/**
+ * @brief Read one time measurement in @p meas_mode that returns @p raw_meas, and return whether the read cb received
+ * the measurement.
+ */
+static bool read_one_time_meas_notified(uint8_t meas_mode, uint8_t cmd, uint32_t timer_duration_ms, uint16_t raw_meas)
+{
+    size_t call_count_before = complete_cb_call_count;
+    uint8_t i2c_read_data[] = {(uint8_t)(raw_meas >> 8), (uint8_t)(raw_meas & 0xFF)};
+    mock()
+        .expectOneCall("mock_bh1750_i2c_write")
+        .withMemoryBufferParameter("data", &cmd, 1)
+        .withParameter("length", 1)
+        .withParameter("i2c_addr", init_cfg.i2c_addr)
+        .withParameter("user_data", i2c_write_user_data)
+        .ignoreOtherParameters();
+    expect_start_timer(timer_duration_ms);
+    expect_i2c_read(i2c_read_data);
+
+    uint8_t rc = bh1750_read_one_time_measurement(bh1750, meas_mode, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    return check_read_completed(call_count_before);
+}
+
+TEST(BH1750, ChangeNotifyThresholdsWithHysteresis)
+{
+    attach_with_cont_meas();
+    BH1750ChangeNotifyConfig cfg = {.low_lx = 100, .high_lx = 1000, .deadband_lx = 0};
+    uint8_t rc = bh1750_set_change_notify(bh1750, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    /* Default meas time, H-resolution mode: 1 raw count = 1 / 1.2 lx */
+    CHECK_TRUE(read_cont_meas_notified(600)); /* 500 lx, first measurement is always notified */
+    CHECK_EQUAL(500, read_cb_meas.meas_lx);
+    CHECK_FALSE(read_cont_meas_notified(610));  /* 508 lx */
+    CHECK_TRUE(read_cont_meas_notified(1300));  /* 1083 lx, crossed high threshold */
+    CHECK_EQUAL(1083, read_cb_meas.meas_lx);
+    CHECK_FALSE(read_cont_meas_notified(1400)); /* 1167 lx, still above high threshold */
+    CHECK_FALSE(read_cont_meas_notified(900));  /* 750 lx, inside hysteresis band */
+    CHECK_FALSE(read_cont_meas_notified(1300)); /* 1083 lx, high threshold was the last one crossed */
+    CHECK_TRUE(read_cont_meas_notified(100));   /* 83 lx, crossed low threshold */
+    CHECK_FALSE(read_cont_meas_notified(50));   /* 42 lx, still below low threshold */
+    CHECK_FALSE(read_cont_meas_notified(900));  /* 750 lx, inside hysteresis band */
+    CHECK_TRUE(read_cont_meas_notified(1300));  /* 1083 lx, crossed high threshold */
+    /* Every read completed, the suppressed ones without a measurement */
+    CHECK_EQUAL(11, complete_cb_call_count);
+}
+
+TEST(BH1750, ChangeNotifyDeadband)
+{
+    attach_with_cont_meas();
+    BH1750ChangeNotifyConfig cfg = {.low_lx = 0, .high_lx = UINT32_MAX, .deadband_lx = 100};
+    uint8_t rc = bh1750_set_change_notify(bh1750, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    CHECK_TRUE(read_cont_meas_notified(1000));  /* 833 lx */
+    CHECK_FALSE(read_cont_meas_notified(1100)); /* 917 lx, 83 lx from last notified */
+    CHECK_TRUE(read_cont_meas_notified(1130));  /* 942 lx, 108 lx from last notified */
+    CHECK_FALSE(read_cont_meas_notified(1020)); /* 850 lx, 92 lx from last notified */
+    CHECK_TRUE(read_cont_meas_notified(1000));  /* 833 lx, 108 lx from last notified */
+}
+
+TEST(BH1750, ChangeNotifyRecomputedWhenMeasModeChanges)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+    BH1750ChangeNotifyConfig cfg = {.low_lx = 0, .high_lx = 1000, .deadband_lx = 0};
+    uint8_t rc = bh1750_set_change_notify(bh1750, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    /* H-resolution mode: 1500 counts = 1250 lx */
+    CHECK_TRUE(read_one_time_meas_notified(BH1750_MEAS_MODE_H_RES, 0x20, 180, 1500));
+    CHECK_FALSE(read_one_time_meas_notified(BH1750_MEAS_MODE_H_RES, 0x20, 180, 1500));
+    /* H-resolution mode 2: 1 raw count = 1 / 2.4 lx. The first measurement with a new mode is always notified. */
+    CHECK_TRUE(read_one_time_meas_notified(BH1750_MEAS_MODE_H_RES2, 0x21, 180, 1500));
+    CHECK_EQUAL(625, read_cb_meas.meas_lx);
+    /* 958 lx. The same raw count would be above the threshold in H-resolution mode. */
+    CHECK_FALSE(read_one_time_meas_notified(BH1750_MEAS_MODE_H_RES2, 0x21, 180, 2300));
+    /* 1042 lx, crossed high threshold */
+    CHECK_TRUE(read_one_time_meas_notified(BH1750_MEAS_MODE_H_RES2, 0x21, 180, 2500));
+}
+
+TEST(BH1750, ChangeNotifyReadFailIsReported)
+{
+    attach_with_cont_meas();
+    BH1750ChangeNotifyConfig cfg = {.low_lx = 100, .high_lx = 1000, .deadband_lx = 0};
+    uint8_t rc = bh1750_set_change_notify(bh1750, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_TRUE(read_cont_meas_notified(600));
+
+    uint8_t i2c_read_data[] = {0x02, 0x58};
+    expect_i2c_read(i2c_read_data);
+    uint8_t rc_read = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_read);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_ERR, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(2, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, complete_cb_result_code);
+}
+
+TEST(BH1750, ChangeNotifyDisable)
+{
+    attach_with_cont_meas();
+    BH1750ChangeNotifyConfig cfg = {.low_lx = 100, .high_lx = 1000, .deadband_lx = 0};
+    uint8_t rc = bh1750_set_change_notify(bh1750, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_TRUE(read_cont_meas_notified(600));
+    CHECK_FALSE(read_cont_meas_notified(600));
+
+    uint8_t rc_disable = bh1750_set_change_notify(bh1750, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_disable);
+    CHECK_TRUE(read_cont_meas_notified(600));
+}
+
+TEST(BH1750, SetChangeNotifyInvalidArgs)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+
+    BH1750ChangeNotifyConfig cfg = {.low_lx = 1001, .high_lx = 1000, .deadband_lx = 0};
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_set_change_notify(bh1750, &cfg));
+    /* Equal thresholds leave no hysteresis band */
+    cfg.low_lx = 1000;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_set_change_notify(bh1750, &cfg));
+    cfg.low_lx = 100;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_set_change_notify(NULL, &cfg));
+}
+
+static uint8_t set_change_notify()
+{
+    BH1750ChangeNotifyConfig cfg = {.low_lx = 100, .high_lx = 1000, .deadband_lx = 0};
+    return bh1750_set_change_notify(bh1750, &cfg);
+}
+
+TEST(BH1750, SetChangeNotifyBusy)
+{
+    test_busy_if_seq_in_progress(set_change_notify);
+}
+
+TEST(BH1750, GetMeasDurationMs)
+{
+    uint32_t duration_ms = 0;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_get_meas_duration_ms(BH1750_MEAS_MODE_H_RES, 69, &duration_ms));
+    CHECK_EQUAL(180, duration_ms);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_get_meas_duration_ms(BH1750_MEAS_MODE_H_RES2, 138, &duration_ms));
+    CHECK_EQUAL(360, duration_ms);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_get_meas_duration_ms(BH1750_MEAS_MODE_L_RES, 31, &duration_ms));
+    CHECK_EQUAL(11, duration_ms); /* ceil(24 * 31 / 69) */
+
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_meas_duration_ms(BH1750_MEAS_MODE_H_RES, 69, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_meas_duration_ms(0xAB, 69, &duration_ms));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_meas_duration_ms(BH1750_MEAS_MODE_H_RES, 30, &duration_ms));
+
+    /* Setup expects bh1750_create to be called */
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+}
+
+static uint32_t fake_time_ms;
+
+static uint32_t fake_get_time(void *user_data)
+{
+    (void)user_data;
+    return fake_time_ms;
+}
+
+/**
+ * @brief Read continuous measurement, with the read completing at @p read_time_ms.
+ */
+static void read_cont_meas_at(uint32_t read_time_ms)
+{
+    uint8_t i2c_read_data[] = {0x00, 0x64};
+    expect_i2c_read(i2c_read_data);
+
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    fake_time_ms = read_time_ms;
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+}
+
+TEST(BH1750, ReadOneTimeMeasTimestamps)
+{
+    init_cfg.get_time = fake_get_time;
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+
+    /* One time measurement L-resolution mode cmd */
+    uint8_t i2c_write_data = 0x23;
+    uint8_t i2c_read_data[] = {0x00, 0x64};
+    mock()
+        .expectOneCall("mock_bh1750_i2c_write")
+        .withMemoryBufferParameter("data", &i2c_write_data, 1)
+        .withParameter("length", 1)
+        .withParameter("i2c_addr", init_cfg.i2c_addr)
+        .withParameter("user_data", i2c_write_user_data)
+        .ignoreOtherParameters();
+    expect_start_timer(24);
+    expect_i2c_read(i2c_read_data);
+
+    uint8_t rc = bh1750_read_one_time_measurement(bh1750, BH1750_MEAS_MODE_L_RES, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    fake_time_ms = 1000;
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    fake_time_ms = 1026;
+    timer_expired_cb(timer_expired_cb_user_data);
+    fake_time_ms = 1030;
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(1, complete_cb_call_count);
+    /* Integration window starts when the command completes and lasts 24 ms */
+    CHECK_EQUAL(1012, read_cb_meas.mid_time_ms);
+    CHECK_EQUAL(1030, read_cb_meas.read_time_ms);
+}
+
+TEST(BH1750, ReadContMeasTimestamps)
+{
+    init_cfg.get_time = fake_get_time;
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+    /* Continuously H-resolution mode cmd */
+    uint8_t i2c_write_data = 0x10;
+    fake_time_ms = 5000;
+    call_start_continuous_measurement(&i2c_write_data, BH1750_MEAS_MODE_H_RES);
+
+    /* Shortly after start, the returned measurement is the first window: 5000 - 5180 */
+    read_cont_meas_at(5100);
+    CHECK_EQUAL(5090, read_cb_meas.mid_time_ms);
+    CHECK_EQUAL(5100, read_cb_meas.read_time_ms);
+
+    /* Last completed window ended between 9820 and 10000 */
+    read_cont_meas_at(10000);
+    CHECK_EQUAL(9820, read_cb_meas.mid_time_ms);
+    CHECK_EQUAL(10000, read_cb_meas.read_time_ms);
+}
+
+TEST(BH1750, ReadContMeasTimestampsAfterAttach)
+{
+    init_cfg.get_time = fake_get_time;
+    attach_with_cont_meas();
+
+    /* Start of continuous measurement is unknown */
+    read_cont_meas_at(100);
+    CHECK_EQUAL((uint32_t)(100 - 180), read_cb_meas.mid_time_ms);
+    CHECK_EQUAL(100, read_cb_meas.read_time_ms);
+}
+
+TEST(BH1750, ReadContMeasDecimatorTimestamps)
+{
+    init_cfg.get_time = fake_get_time;
+    attach_with_cont_meas();
+    uint8_t rc_set_decimator = bh1750_set_decimator(bh1750, BH1750_DECIMATOR_TYPE_BOXCAR, 2);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_set_decimator);
+
+    uint8_t i2c_read_data[] = {0x00, 0x64};
+    expect_i2c_read(i2c_read_data);
+    expect_start_timer(180);
+    expect_i2c_read(i2c_read_data);
+
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    fake_time_ms = 1000;
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    fake_time_ms = 1190;
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(1, complete_cb_call_count);
+    /* Between the windows of the two raw measurements: 820 and 1010 */
+    CHECK_EQUAL(915, read_cb_meas.mid_time_ms);
+    CHECK_EQUAL(1190, read_cb_meas.read_time_ms);
+}
+
+static void expect_i2c_write(uint8_t *i2c_write_data)
+{
+    mock()
+        .expectOneCall("mock_bh1750_i2c_write")
+        .withMemoryBufferParameter("data", i2c_write_data, 1)
+        .withParameter("length", 1)
+        .withParameter("i2c_addr", init_cfg.i2c_addr)
+        .withParameter("user_data", i2c_write_user_data)
+        .ignoreOtherParameters();
+}
+
+TEST(BH1750, RecoverReplaysState)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    BH1750StateSnapshot snapshot = {
+        .initialized = true,
+        .meas_time = 138,
+        .meas_mode = BH1750_MEAS_MODE_H_RES2,
+        .cont_meas_ongoing = true,
+    };
+    uint8_t rc_attach = bh1750_attach(bh1750, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_attach);
+
+    /* Power on, Mtreg high bits, Mtreg low bits, continuous H-resolution mode 2 */
+    uint8_t i2c_write_data[] = {0x01, 0x44, 0x6A, 0x11};
+    for (size_t i = 0; i < 4; i++) {
+        expect_i2c_write(&i2c_write_data[i]);
+    }
+    uint8_t rc = bh1750_recover(bh1750, bh1750_complete_cb, (void *)0x55);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    for (size_t i = 0; i < 4; i++) {
+        CHECK_EQUAL(0, complete_cb_call_count);
+        i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    }
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    POINTERS_EQUAL((void *)0x55, complete_cb_user_data);
+
+    /* State of the instance is unchanged */
+    BH1750StateSnapshot after;
+    uint8_t rc_snapshot = bh1750_get_state_snapshot(bh1750, &after);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_snapshot);
+    CHECK_TRUE(after.initialized);
+    CHECK_EQUAL(138, after.meas_time);
+    CHECK_EQUAL(BH1750_MEAS_MODE_H_RES2, after.meas_mode);
+    CHECK_TRUE(after.cont_meas_ongoing);
+}
+
+TEST(BH1750, RecoverWithoutContMeas)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+
+    uint8_t i2c_write_data[] = {0x01, 0x42, 0x65};
+    for (size_t i = 0; i < 3; i++) {
+        expect_i2c_write(&i2c_write_data[i]);
+    }
+    uint8_t rc = bh1750_recover(bh1750, bh1750_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    for (size_t i = 0; i < 3; i++) {
+        i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    }
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+}
+
+TEST(BH1750, RecoverWriteFail)
+{
+    attach_with_cont_meas();
+
+    uint8_t i2c_write_data[] = {0x01, 0x42};
+    expect_i2c_write(&i2c_write_data[0]);
+    expect_i2c_write(&i2c_write_data[1]);
+    uint8_t rc = bh1750_recover(bh1750, bh1750_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    /* Sequence stops at the first failed write */
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_ERR, i2c_write_complete_cb_user_data);
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, complete_cb_result_code);
+
+    /* Recovery can be retried */
+    uint8_t i2c_write_data_retry = 0x01;
+    expect_i2c_write(&i2c_write_data_retry);
+    rc = bh1750_recover(bh1750, bh1750_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+TEST(BH1750, RecoverBeforeInit)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, bh1750_recover(bh1750, bh1750_complete_cb, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_recover(NULL, bh1750_complete_cb, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_set_auto_recover(NULL, true));
+}
+
+static uint8_t recover()
+{
+    return bh1750_recover(bh1750, bh1750_complete_cb, NULL);
+}
+
+TEST(BH1750, RecoverBusy)
+{
+    test_busy_if_seq_in_progress(recover);
+}
+
+static uint8_t set_auto_recover()
+{
+    return bh1750_set_auto_recover(bh1750, true);
+}
+
+TEST(BH1750, SetAutoRecoverBusy)
+{
+    test_busy_if_seq_in_progress(set_auto_recover);
+}
+
+TEST(BH1750, ReadContMeasFailAutoRecover)
+{
+    attach_with_cont_meas();
+    uint8_t rc_auto_recover = bh1750_set_auto_recover(bh1750, true);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_auto_recover);
+
+    uint8_t i2c_read_data[] = {0x00, 0x00};
+    expect_i2c_read(i2c_read_data);
+    uint8_t i2c_write_data[] = {0x01, 0x42, 0x65, 0x10};
+    for (size_t i = 0; i < 4; i++) {
+        expect_i2c_write(&i2c_write_data[i]);
+    }
+
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_ERR, i2c_read_complete_cb_user_data);
+    for (size_t i = 0; i < 4; i++) {
+        /* Read cb is only executed once the recovery is complete */
+        CHECK_EQUAL(0, complete_cb_call_count);
+        i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    }
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, complete_cb_result_code);
+    CHECK_TRUE(read_cb_meas_null);
+
+    /* Measurements resume */
+    uint8_t i2c_read_data_2[] = {0x00, 0x64};
+    expect_i2c_read(i2c_read_data_2);
+    rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    CHECK_EQUAL(2, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    CHECK_EQUAL(0x64, read_cb_meas.raw_meas);
+}
+
+TEST(BH1750, ReadContMeasFailAutoRecoverDisabled)
+{
+    attach_with_cont_meas();
+    uint8_t rc_auto_recover = bh1750_set_auto_recover(bh1750, true);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_auto_recover);
+    rc_auto_recover = bh1750_set_auto_recover(bh1750, false);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_auto_recover);
+
+    /* No I2C writes are expected */
+    uint8_t i2c_read_data[] = {0x00, 0x00};
+    expect_i2c_read(i2c_read_data);
+    uint8_t rc = bh1750_read_continuous_measurement(bh1750, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_ERR, i2c_read_complete_cb_user_data);
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, complete_cb_result_code);
+}
+
+static size_t preview_cb_call_count;
+static BH1750Measurement preview_cb_meas;
+static void *preview_cb_user_data;
+static size_t preview_cb_complete_cb_call_count;
+
+static void bh1750_preview_cb(uint8_t result_code, const BH1750Measurement *meas, void *user_data)
+{
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, result_code);
+    preview_cb_call_count++;
+    preview_cb_meas = *meas;
+    preview_cb_user_data = user_data;
+    preview_cb_complete_cb_call_count = complete_cb_call_count;
+    /* The sequence is still ongoing */
+    CHECK_EQUAL(BH1750_RESULT_CODE_BUSY, bh1750_power_down(bh1750, NULL, NULL));
+}
+
+static void reset_preview_cb()
+{
+    preview_cb_call_count = 0;
+    memset(&preview_cb_meas, 0, sizeof(preview_cb_meas));
+    preview_cb_user_data = NULL;
+    preview_cb_complete_cb_call_count = 0xFF;
+}
+
+TEST(BH1750, ReadProgressiveMeasPreviewThenRefined)
+{
+    reset_preview_cb();
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+
+    /* One time measurement L-resolution mode cmd, then H-resolution mode 2 cmd */
+    uint8_t i2c_write_data_1 = 0x23;
+    uint8_t i2c_write_data_2 = 0x21;
+    uint8_t i2c_read_data_1[] = {0x00, 0x78};
+    uint8_t i2c_read_data_2[] = {0x01, 0xE1};
+    expect_i2c_write(&i2c_write_data_1);
+    expect_start_timer(24);
+    expect_i2c_read(i2c_read_data_1);
+    expect_i2c_write(&i2c_write_data_2);
+    expect_start_timer(180);
+    expect_i2c_read(i2c_read_data_2);
+
+    uint8_t rc = bh1750_read_progressive_measurement(bh1750, BH1750_MEAS_MODE_H_RES2, bh1750_preview_cb, (void *)0x11,
+                                                     bh1750_read_cb, (void *)0x22);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(1, preview_cb_call_count);
+    CHECK_EQUAL(0, preview_cb_complete_cb_call_count);
+    POINTERS_EQUAL((void *)0x11, preview_cb_user_data);
+    CHECK_EQUAL(0x78, preview_cb_meas.raw_meas);
+    /* 120 / 1.2 */
+    CHECK_EQUAL(100, preview_cb_meas.meas_lx);
+    CHECK_EQUAL(BH1750_MEAS_MODE_L_RES, preview_cb_meas.meas_mode);
+    CHECK_EQUAL(0, complete_cb_call_count);
+
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(1, preview_cb_call_count);
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    POINTERS_EQUAL((void *)0x22, complete_cb_user_data);
+    CHECK_EQUAL(0x1E1, read_cb_meas.raw_meas);
+    /* 481 / 1.2 / 2 */
+    CHECK_EQUAL(200, read_cb_meas.meas_lx);
+    CHECK_EQUAL(BH1750_MEAS_MODE_H_RES2, read_cb_meas.meas_mode);
+}
+
+TEST(BH1750, ReadProgressiveMeasPreviewReadFail)
+{
+    reset_preview_cb();
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+
+    uint8_t i2c_write_data = 0x23;
+    uint8_t i2c_read_data[] = {0x00, 0x00};
+    expect_i2c_write(&i2c_write_data);
+    expect_start_timer(24);
+    expect_i2c_read(i2c_read_data);
+
+    uint8_t rc = bh1750_read_progressive_measurement(bh1750, BH1750_MEAS_MODE_H_RES, bh1750_preview_cb, NULL,
+                                                     bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_ERR, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(0, preview_cb_call_count);
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, complete_cb_result_code);
+    CHECK_TRUE(read_cb_meas_null);
+
+    /* A regular one time measurement afterwards does not deliver a preview */
+    uint8_t i2c_write_data_2 = 0x20;
+    uint8_t i2c_read_data_2[] = {0x00, 0x78};
+    expect_i2c_write(&i2c_write_data_2);
+    expect_start_timer(180);
+    expect_i2c_read(i2c_read_data_2);
+    rc = bh1750_read_one_time_measurement(bh1750, BH1750_MEAS_MODE_H_RES, bh1750_read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    CHECK_EQUAL(0, preview_cb_call_count);
+    CHECK_EQUAL(2, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+}
+
+TEST(BH1750, ReadProgressiveMeasInvalidArgs)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE,
+                bh1750_read_progressive_measurement(bh1750, BH1750_MEAS_MODE_H_RES, NULL, NULL, bh1750_read_cb, NULL));
+    call_init();
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_read_progressive_measurement(NULL, BH1750_MEAS_MODE_H_RES, NULL, NULL, bh1750_read_cb, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_read_progressive_measurement(bh1750, BH1750_MEAS_MODE_L_RES, NULL, NULL, bh1750_read_cb, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_read_progressive_measurement(bh1750, 0xFF, NULL, NULL, bh1750_read_cb, NULL));
+}
+
+static uint8_t read_progressive_measurement()
+{
+    return bh1750_read_progressive_measurement(bh1750, BH1750_MEAS_MODE_H_RES, NULL, NULL, bh1750_read_cb, NULL);
+}
+
+TEST(BH1750, ReadProgressiveMeasBusy)
+{
+    test_busy_if_seq_in_progress(read_progressive_measurement);
+}
+
+static size_t burst_cb_num_meas;
+
+/* Burst cb also populates the complete cb variables, so that the same checks can be used for all sequences */
+static void bh1750_burst_cb(uint8_t result_code, size_t num_meas, void *user_data)
+{
+    complete_cb_call_count++;
+    complete_cb_result_code = result_code;
+    complete_cb_user_data = user_data;
+    burst_cb_num_meas = num_meas;
+}
+
+TEST(BH1750, ReadOneTimeBurst)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+
+    /* One time measurement H-resolution mode cmd */
+    uint8_t i2c_write_data = 0x20;
+    uint8_t i2c_read_data[3][2] = {{0x00, 0x78}, {0x00, 0xF0}, {0x01, 0xE0}};
+    for (size_t i = 0; i < 3; i++) {
+        expect_i2c_write(&i2c_write_data);
+        expect_start_timer(180);
+        expect_i2c_read(i2c_read_data[i]);
+    }
+
+    BH1750Measurement meas[3];
+    uint8_t rc = bh1750_read_one_time_burst(bh1750, BH1750_MEAS_MODE_H_RES, meas, 3, bh1750_burst_cb, (void *)0x33);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    for (size_t i = 0; i < 3; i++) {
+        CHECK_EQUAL(0, complete_cb_call_count);
+        i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+        timer_expired_cb(timer_expired_cb_user_data);
+        /* The next one time measurement cmd is sent from the completion of this read */
+        i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    }
+
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, complete_cb_result_code);
+    POINTERS_EQUAL((void *)0x33, complete_cb_user_data);
+    CHECK_EQUAL(3, burst_cb_num_meas);
+    CHECK_EQUAL(0x78, meas[0].raw_meas);
+    CHECK_EQUAL(100, meas[0].meas_lx);
+    CHECK_EQUAL(200, meas[1].meas_lx);
+    CHECK_EQUAL(400, meas[2].meas_lx);
+    CHECK_EQUAL(BH1750_MEAS_MODE_H_RES, meas[2].meas_mode);
+    CHECK_EQUAL(BH1750_TEST_DEFAULT_MEAS_TIME, meas[2].meas_time);
+}
+
+TEST(BH1750, ReadOneTimeBurstReadFail)
+{
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    call_init();
+
+    /* One time measurement L-resolution mode cmd */
+    uint8_t i2c_write_data = 0x23;
+    uint8_t i2c_read_data[] = {0x00, 0x78};
+    for (size_t i = 0; i < 2; i++) {
+        expect_i2c_write(&i2c_write_data);
+        expect_start_timer(24);
+        expect_i2c_read(i2c_read_data);
+    }
+
+    BH1750Measurement meas[4];
+    uint8_t rc = bh1750_read_one_time_burst(bh1750, BH1750_MEAS_MODE_L_RES, meas, 4, bh1750_burst_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_read_complete_cb_user_data);
+    i2c_write_complete_cb(BH1750_I2C_RESULT_CODE_OK, i2c_write_complete_cb_user_data);
+    timer_expired_cb(timer_expired_cb_user_data);
+    i2c_read_complete_cb(BH1750_I2C_RESULT_CODE_ERR, i2c_read_complete_cb_user_data);
+
+    CHECK_EQUAL(1, complete_cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, complete_cb_result_code);
+    CHECK_EQUAL(1, burst_cb_num_meas);
+    CHECK_EQUAL(0x78, meas[0].raw_meas);
+}
+
+TEST(BH1750, ReadOneTimeBurstInvalidArgs)
+{
+    BH1750Measurement meas[2];
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE,
+                bh1750_read_one_time_burst(bh1750, BH1750_MEAS_MODE_H_RES, meas, 2, bh1750_burst_cb, NULL));
+    call_init();
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_read_one_time_burst(NULL, BH1750_MEAS_MODE_H_RES, meas, 2, bh1750_burst_cb, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_read_one_time_burst(bh1750, 0xFF, meas, 2, bh1750_burst_cb, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_read_one_time_burst(bh1750, BH1750_MEAS_MODE_H_RES, NULL, 2, bh1750_burst_cb, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_read_one_time_burst(bh1750, BH1750_MEAS_MODE_H_RES, meas, 0, bh1750_burst_cb, NULL));
+}
+
+static uint8_t read_one_time_burst()
+{
+    static BH1750Measurement meas[2];
+    return bh1750_read_one_time_burst(bh1750, BH1750_MEAS_MODE_H_RES, meas, 2, bh1750_burst_cb, NULL);
+}
+
+TEST(BH1750, ReadOneTimeBurstBusy)
+{
+    test_busy_if_seq_in_progress(read_one_time_burst);
+}
+
+TEST(BH1750, GetMaxBurstRate)
+{
+    uint32_t rate_mhz;
+    uint8_t rc = bh1750_get_max_burst_rate_mhz(BH1750_MEAS_MODE_H_RES, 69, &rate_mhz);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* 180 ms per measurement */
+    CHECK_EQUAL(5555, rate_mhz);
+    rc = bh1750_get_max_burst_rate_mhz(BH1750_MEAS_MODE_H_RES2, 138, &rate_mhz);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* 360 ms per measurement */
+    CHECK_EQUAL(2777, rate_mhz);
+    rc = bh1750_get_max_burst_rate_mhz(BH1750_MEAS_MODE_L_RES, 31, &rate_mhz);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* 11 ms per measurement */
+    CHECK_EQUAL(90909, rate_mhz);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_max_burst_rate_mhz(BH1750_MEAS_MODE_H_RES, 30, &rate_mhz));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_max_burst_rate_mhz(0xFF, 69, &rate_mhz));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_max_burst_rate_mhz(BH1750_MEAS_MODE_H_RES, 69, NULL));
+
+    /* Setup expects bh1750_create to be called */
+    uint8_t rc_create = bh1750_create(&bh1750, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc_create);
+}
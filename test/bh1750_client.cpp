@@ -0,0 +1,96 @@
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_client.h"
+
+#define NUM_SLOTS 2
+
+static char shm_name[32];
+static size_t size;
+static void *mem;
+static BH1750ShmWriter writer;
+static BH1750Client client;
+
+// clang-format off
+TEST_GROUP(BH1750Client)
+{
+    void setup() {
+        snprintf(shm_name, sizeof(shm_name), "/bh1750_test_%ld", (long)getpid());
+        size = bh1750_shm_get_region_size(NUM_SLOTS);
+        int fd = shm_open(shm_name, O_CREAT | O_RDWR, 0600);
+        CHECK_TRUE(fd >= 0);
+        CHECK_EQUAL(0, ftruncate(fd, (off_t)size));
+        mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        CHECK_TRUE(mem != MAP_FAILED);
+        uint8_t rc = bh1750_shm_writer_init(&writer, mem, size, NUM_SLOTS);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        memset(&client, 0, sizeof(client));
+    }
+
+    void teardown() {
+        bh1750_client_close(&client);
+        munmap(mem, size);
+        shm_unlink(shm_name);
+    }
+};
+// clang-format on
+
+TEST(BH1750Client, ReadsPublishedMeasurement)
+{
+    uint8_t rc = bh1750_client_open(&client, shm_name);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(NUM_SLOTS, bh1750_client_get_num_sensors(&client));
+
+    BH1750Measurement meas = {120, 0x90, BH1750_MEAS_MODE_H_RES, 69, 100, 100};
+    rc = bh1750_shm_publish(&writer, 1, &meas);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    BH1750ShmSnapshot snapshot;
+    rc = bh1750_client_read(&client, 1, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(1, snapshot.num_history);
+    CHECK_EQUAL(120, snapshot.history[0].meas_lx);
+    rc = bh1750_client_read(&client, 0, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(0, snapshot.num_history);
+}
+
+TEST(BH1750Client, OpenMissingObjectFails)
+{
+    uint8_t rc = bh1750_client_open(&client, "/bh1750_test_missing");
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, rc);
+    CHECK_EQUAL(0, bh1750_client_get_num_sensors(&client));
+}
+
+TEST(BH1750Client, OpenUninitializedObjectFails)
+{
+    memset(mem, 0, size);
+    uint8_t rc = bh1750_client_open(&client, shm_name);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+}
+
+TEST(BH1750Client, ClosedClientCannotRead)
+{
+    uint8_t rc = bh1750_client_open(&client, shm_name);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    rc = bh1750_client_close(&client);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    BH1750ShmSnapshot snapshot;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_client_read(&client, 0, &snapshot));
+}
+
+TEST(BH1750Client, InvalidArgs)
+{
+    BH1750ShmSnapshot snapshot;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_client_open(NULL, shm_name));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_client_open(&client, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_client_read(NULL, 0, &snapshot));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_client_close(NULL));
+    CHECK_EQUAL(0, bh1750_client_get_num_sensors(NULL));
+}
@@ -0,0 +1,305 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_discovery.h"
+/* Included to know the size of BH1750 instances to return from get_instance_memory */
+#include "bh1750_private.h"
+
+#define NUM_BUSES 3
+#define NUM_CANDIDATES (NUM_BUSES * BH1750_DISCOVERY_NUM_ADDRS)
+
+/* Fake bus with up to two BH1750 devices */
+typedef struct {
+    size_t idx;
+    /** Whether a device is present at the low and the high address. */
+    bool present[BH1750_DISCOVERY_NUM_ADDRS];
+    /** Whether a present device fails all transactions after the probe. */
+    bool fails_after_probe;
+    size_t num_writes[BH1750_DISCOVERY_NUM_ADDRS];
+} FakeBus;
+
+static FakeBus fake_buses[NUM_BUSES];
+static BH1750DiscoveryBus buses[NUM_BUSES];
+static BH1750DiscoveryCandidate candidates[NUM_CANDIDATES];
+static BH1750Discovery discovery;
+static BH1750DiscoveryConfig cfg;
+
+/* Transactions complete right away, or are queued until complete_pending is called */
+static bool is_deferred;
+typedef struct {
+    BH1750_I2CCompleteCb cb;
+    void *cb_user_data;
+    uint8_t result_code;
+} PendingCompletion;
+static PendingCompletion pending[32];
+static size_t num_pending;
+static size_t max_in_flight_seen;
+static uint32_t now_ms;
+
+static size_t addr_idx(uint8_t i2c_addr)
+{
+    return (i2c_addr == BH1750_DISCOVERY_ADDR_LOW) ? 0 : 1;
+}
+
+static void complete(uint8_t result_code, BH1750_I2CCompleteCb cb, void *cb_user_data)
+{
+    if (!is_deferred) {
+        cb(result_code, cb_user_data);
+        return;
+    }
+    pending[num_pending].cb = cb;
+    pending[num_pending].cb_user_data = cb_user_data;
+    pending[num_pending].result_code = result_code;
+    num_pending++;
+}
+
+static void fake_write(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                       void *cb_user_data)
+{
+    (void)data;
+    (void)length;
+    FakeBus *bus = (FakeBus *)user_data;
+    now_ms++;
+    if (buses[bus->idx].num_in_flight > max_in_flight_seen) {
+        max_in_flight_seen = buses[bus->idx].num_in_flight;
+    }
+    size_t idx = addr_idx(i2c_addr);
+    bool ack = bus->present[idx] && !(bus->fails_after_probe && (bus->num_writes[idx] > 0));
+    bus->num_writes[idx]++;
+    complete(ack ? BH1750_I2C_RESULT_CODE_OK : BH1750_I2C_RESULT_CODE_ERR, cb, cb_user_data);
+}
+
+static void fake_read(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                      void *cb_user_data)
+{
+    (void)data;
+    (void)length;
+    (void)i2c_addr;
+    (void)user_data;
+    complete(BH1750_I2C_RESULT_CODE_ERR, cb, cb_user_data);
+}
+
+/* Execute pending completions in order, including the ones they queue */
+static void complete_pending()
+{
+    for (size_t i = 0; i < num_pending; i++) {
+        pending[i].cb(pending[i].result_code, pending[i].cb_user_data);
+    }
+    num_pending = 0;
+}
+
+static struct BH1750Struct instance_memory[NUM_CANDIDATES];
+static size_t num_instances_created;
+static size_t max_num_instances;
+
+static void *get_instance_memory(void *user_data)
+{
+    (void)user_data;
+    return (num_instances_created < max_num_instances) ? &instance_memory[num_instances_created++] : NULL;
+}
+
+static void start_timer(uint32_t duration_ms, void *user_data, BH1750TimerExpiredCb cb, void *cb_user_data)
+{
+    (void)duration_ms;
+    (void)user_data;
+    (void)cb;
+    (void)cb_user_data;
+}
+
+static uint32_t get_time(void *user_data)
+{
+    (void)user_data;
+    return now_ms;
+}
+
+static size_t cb_call_count;
+static uint8_t cb_result_code;
+
+static void discovery_complete_cb(uint8_t result_code, void *user_data)
+{
+    (void)user_data;
+    cb_call_count++;
+    cb_result_code = result_code;
+}
+
+// clang-format off
+TEST_GROUP(BH1750Discovery)
+{
+    void setup() {
+        memset(&discovery, 0, sizeof(discovery));
+        memset(fake_buses, 0, sizeof(fake_buses));
+        for (size_t i = 0; i < NUM_BUSES; i++) {
+            fake_buses[i].idx = i;
+            buses[i].i2c_write = fake_write;
+            buses[i].i2c_write_user_data = &fake_buses[i];
+            buses[i].i2c_read = fake_read;
+            buses[i].i2c_read_user_data = &fake_buses[i];
+        }
+        is_deferred = false;
+        num_pending = 0;
+        max_in_flight_seen = 0;
+        now_ms = 0;
+        num_instances_created = 0;
+        max_num_instances = NUM_CANDIDATES;
+        cb_call_count = 0;
+
+        cfg = {};
+        cfg.buses = buses;
+        cfg.num_buses = NUM_BUSES;
+        cfg.candidates = candidates;
+        cfg.num_candidates = NUM_CANDIDATES;
+        cfg.max_in_flight_per_bus = 1;
+        cfg.get_instance_memory = get_instance_memory;
+        cfg.start_timer = start_timer;
+    }
+};
+// clang-format on
+
+static BH1750DiscoveryResult get_result()
+{
+    BH1750DiscoveryResult result;
+    uint8_t rc = bh1750_discovery_get_result(&discovery, &result);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return result;
+}
+
+TEST(BH1750Discovery, ProbesBusesConcurrently)
+{
+    fake_buses[0].present[0] = true;
+    fake_buses[0].present[1] = true;
+    fake_buses[2].present[1] = true;
+    is_deferred = true;
+    uint8_t rc = bh1750_discovery_start(&discovery, &cfg, discovery_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* One probe per bus is in flight right away */
+    CHECK_EQUAL(NUM_BUSES, num_pending);
+    CHECK_EQUAL(BH1750_RESULT_CODE_BUSY, bh1750_discovery_start(&discovery, &cfg, discovery_complete_cb, NULL));
+
+    for (size_t i = 0; (i < 32) && (num_pending > 0); i++) {
+        complete_pending();
+    }
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, cb_result_code);
+    CHECK_EQUAL(1, max_in_flight_seen);
+
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_READY, candidates[0].state);
+    CHECK_EQUAL(BH1750_DISCOVERY_ADDR_LOW, candidates[0].i2c_addr);
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_READY, candidates[1].state);
+    CHECK_EQUAL(BH1750_DISCOVERY_ADDR_HIGH, candidates[1].i2c_addr);
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_ABSENT, candidates[2].state);
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_ABSENT, candidates[3].state);
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_ABSENT, candidates[4].state);
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_READY, candidates[5].state);
+    CHECK_EQUAL(2, candidates[5].bus_idx);
+    CHECK_TRUE(candidates[5].inst != NULL);
+    CHECK_EQUAL(3, get_result().num_ready);
+    CHECK_EQUAL(0, get_result().num_failed);
+}
+
+TEST(BH1750Discovery, BoundedInFlightPerBus)
+{
+    for (size_t i = 0; i < NUM_BUSES; i++) {
+        fake_buses[i].present[0] = true;
+        fake_buses[i].present[1] = true;
+    }
+    is_deferred = true;
+    cfg.max_in_flight_per_bus = 2;
+    uint8_t rc = bh1750_discovery_start(&discovery, &cfg, discovery_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(NUM_CANDIDATES, num_pending);
+    for (size_t i = 0; (i < 32) && (num_pending > 0); i++) {
+        complete_pending();
+    }
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(2, max_in_flight_seen);
+    CHECK_EQUAL(NUM_CANDIDATES, get_result().num_ready);
+}
+
+TEST(BH1750Discovery, I2cCompletesRightAway)
+{
+    for (size_t i = 0; i < NUM_BUSES; i++) {
+        fake_buses[i].present[0] = true;
+    }
+    uint8_t rc = bh1750_discovery_start(&discovery, &cfg, discovery_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(NUM_BUSES, get_result().num_ready);
+    CHECK_EQUAL(1, max_in_flight_seen);
+}
+
+TEST(BH1750Discovery, InitFailure)
+{
+    fake_buses[0].present[0] = true;
+    fake_buses[0].fails_after_probe = true;
+    fake_buses[1].present[0] = true;
+    uint8_t rc = bh1750_discovery_start(&discovery, &cfg, discovery_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, cb_result_code);
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_FAILED, candidates[0].state);
+    CHECK_TRUE(candidates[0].inst != NULL);
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_READY, candidates[2].state);
+    CHECK_EQUAL(1, get_result().num_ready);
+    CHECK_EQUAL(1, get_result().num_failed);
+}
+
+TEST(BH1750Discovery, OutOfInstanceMemory)
+{
+    fake_buses[0].present[0] = true;
+    fake_buses[1].present[0] = true;
+    max_num_instances = 1;
+    uint8_t rc = bh1750_discovery_start(&discovery, &cfg, discovery_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_READY, candidates[0].state);
+    CHECK_EQUAL(BH1750_DISCOVERY_STATE_FAILED, candidates[2].state);
+    POINTERS_EQUAL(NULL, candidates[2].inst);
+    CHECK_EQUAL(1, get_result().num_failed);
+}
+
+TEST(BH1750Discovery, ReportsBootToFirstSample)
+{
+    fake_buses[0].present[0] = true;
+    cfg.num_buses = 1;
+    cfg.get_time = get_time;
+    BH1750StartupProfile profile = {69, true, BH1750_MEAS_MODE_H_RES};
+    cfg.profile = &profile;
+    uint8_t rc = bh1750_discovery_start(&discovery, &cfg, discovery_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* Every write takes 1 ms: probe at both addresses, then power on, two Mtreg writes and the continuous command */
+    CHECK_EQUAL(6, get_result().init_duration_ms);
+    uint32_t meas_duration_ms;
+    rc = bh1750_get_meas_duration_ms(BH1750_MEAS_MODE_H_RES, 69, &meas_duration_ms);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* The sensor at the low address was ready after 5 ms */
+    CHECK_EQUAL(5 + meas_duration_ms, get_result().boot_to_first_sample_ms);
+}
+
+TEST(BH1750Discovery, NoSensors)
+{
+    uint8_t rc = bh1750_discovery_start(&discovery, &cfg, discovery_complete_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(0, get_result().num_ready);
+    CHECK_EQUAL(0, get_result().boot_to_first_sample_ms);
+}
+
+TEST(BH1750Discovery, InvalidArgs)
+{
+    BH1750DiscoveryResult result;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_discovery_start(NULL, &cfg, NULL, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_discovery_start(&discovery, NULL, NULL, NULL));
+    BH1750DiscoveryConfig invalid_cfg = cfg;
+    invalid_cfg.num_candidates = NUM_CANDIDATES - 1;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_discovery_start(&discovery, &invalid_cfg, NULL, NULL));
+    invalid_cfg = cfg;
+    invalid_cfg.max_in_flight_per_bus = 0;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_discovery_start(&discovery, &invalid_cfg, NULL, NULL));
+    invalid_cfg = cfg;
+    invalid_cfg.get_instance_memory = NULL;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_discovery_start(&discovery, &invalid_cfg, NULL, NULL));
+    buses[1].i2c_read = NULL;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_discovery_start(&discovery, &cfg, NULL, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_discovery_get_result(&discovery, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_discovery_get_result(NULL, &result));
+}
@@ -0,0 +1,175 @@
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_dose.h"
+
+static BH1750Dose dose;
+
+// clang-format off
+TEST_GROUP(BH1750Dose)
+{
+    void setup() {
+        uint8_t rc = bh1750_dose_init(&dose, 10000);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+static void add(uint16_t raw_meas, uint32_t time_ms, uint8_t meas_mode = BH1750_MEAS_MODE_H_RES,
+                uint8_t meas_time = 69)
+{
+    BH1750Measurement meas;
+    meas.meas_lx = 0;
+    meas.raw_meas = raw_meas;
+    meas.meas_mode = meas_mode;
+    meas.meas_time = meas_time;
+    uint8_t rc = bh1750_dose_add(&dose, &meas, time_ms);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+static uint64_t get_dose()
+{
+    uint64_t dose_mlx_ms = 0xDEADBEEF;
+    uint8_t rc = bh1750_dose_get_mlx_ms(&dose, &dose_mlx_ms);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return dose_mlx_ms;
+}
+
+TEST(BH1750Dose, FirstSampleDoesNotAccumulate)
+{
+    add(1200, 0);
+    CHECK_EQUAL(0, get_dose());
+}
+
+TEST(BH1750Dose, Trapezoid)
+{
+    /* H-resolution mode, default meas time: 1200 counts = 1000 lx, 2400 counts = 2000 lx */
+    add(1200, 0);
+    add(2400, 1000);
+    /* (1000 + 2000) / 2 lx * 1000 ms */
+    CHECK_EQUAL(1500000000ULL, get_dose());
+    add(2400, 3000);
+    CHECK_EQUAL(5500000000ULL, get_dose());
+}
+
+TEST(BH1750Dose, MixedModesAndMeasTimes)
+{
+    /* 1000 lx in H-resolution mode with default meas time */
+    add(1200, 0);
+    /* 1000 lx in H-resolution mode 2 with meas time 138: 1 count = 1 / 4.8 lx */
+    add(4800, 1000, BH1750_MEAS_MODE_H_RES2, 138);
+    DOUBLES_EQUAL(1000000000.0, (double)get_dose(), 1000.0);
+}
+
+TEST(BH1750Dose, DayOfFullSunlightDoesNotOverflow)
+{
+    /* Largest possible illuminance: 65535 counts at meas time 31 is ~121557 lx, sampled every second for a day */
+    for (uint32_t t = 0; t <= 86400; t++) {
+        add(0xFFFF, t * 1000, BH1750_MEAS_MODE_H_RES, 31);
+    }
+    double expected_lx_h = 65535 * (1 / 1.2) * (69.0 / 31) * 24;
+    DOUBLES_EQUAL(expected_lx_h, (double)get_dose() / BH1750_DOSE_MLX_MS_PER_LX_H, expected_lx_h * 1e-5);
+}
+
+TEST(BH1750Dose, GapUsesMeasurementDuration)
+{
+    add(1200, 0);
+    /* 20 s gap exceeds max gap of 10 s. Only the integration interval of the sample (180 ms) is accumulated. */
+    add(1200, 20000);
+    CHECK_EQUAL(1000000ULL * 180, get_dose());
+}
+
+TEST(BH1750Dose, SampleAtSameTimeIgnored)
+{
+    add(1200, 1000);
+    add(2400, 1000);
+    CHECK_EQUAL(0, get_dose());
+    add(1200, 2000);
+    /* The ignored sample did not replace the last sample */
+    CHECK_EQUAL(1000000000ULL, get_dose());
+}
+
+TEST(BH1750Dose, OlderSampleIsTreatedAsGap)
+{
+    add(1200, 1000);
+    /* 2000 lx over the measurement duration of 180 ms */
+    add(2400, 500);
+    CHECK_EQUAL(2000000ULL * 180, get_dose());
+    /* The older sample replaced the last sample: (2000 + 1000) / 2 lx * 1500 ms */
+    add(1200, 2000);
+    CHECK_EQUAL((2000000ULL * 180) + 2250000000ULL, get_dose());
+}
+
+TEST(BH1750Dose, TimeWraparound)
+{
+    add(1200, 0xFFFFFE0C); /* 500 ms before wraparound */
+    add(1200, 500);
+    CHECK_EQUAL(1000000000ULL, get_dose());
+}
+
+TEST(BH1750Dose, ResetKeepsLastSample)
+{
+    add(1200, 0);
+    add(1200, 1000);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_reset(&dose));
+    CHECK_EQUAL(0, get_dose());
+    add(1200, 2000);
+    CHECK_EQUAL(1000000000ULL, get_dose());
+}
+
+TEST(BH1750Dose, CheckpointAndRestore)
+{
+    add(1200, 0);
+    add(2400, 1000);
+    BH1750DoseCheckpoint checkpoint;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_checkpoint(&dose, &checkpoint));
+
+    BH1750Dose restored;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_init(&restored, 10000));
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_restore(&restored, &checkpoint));
+    /* The first sample after the restore only starts a new trapezoid */
+    BH1750Measurement meas = {0, 2400, BH1750_MEAS_MODE_H_RES, 69};
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_add(&restored, &meas, 2000));
+    uint64_t dose_mlx_ms;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_get_mlx_ms(&restored, &dose_mlx_ms));
+    CHECK_EQUAL(1500000000ULL, dose_mlx_ms);
+
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_add(&restored, &meas, 3000));
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_get_mlx_ms(&restored, &dose_mlx_ms));
+    CHECK_EQUAL(3500000000ULL, dose_mlx_ms);
+}
+
+TEST(BH1750Dose, RestoreAfterClockRestart)
+{
+    /* Checkpoint taken after running for a day */
+    add(1200, 86400000);
+    add(1200, 86401000);
+    BH1750DoseCheckpoint checkpoint;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_checkpoint(&dose, &checkpoint));
+
+    /* The ms counter starts again from 0 after the reset */
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_init(&dose, 10000));
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_dose_restore(&dose, &checkpoint));
+    add(1200, 100);
+    add(1200, 1100);
+    add(1200, 2100);
+    CHECK_EQUAL(3000000000ULL, get_dose());
+}
+
+TEST(BH1750Dose, InvalidArgs)
+{
+    BH1750DoseCheckpoint checkpoint;
+    uint64_t dose_mlx_ms;
+    BH1750Measurement meas = {0, 1200, BH1750_MEAS_MODE_H_RES, 255};
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_init(NULL, 1000));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_init(&dose, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_add(&dose, &meas, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_add(NULL, &meas, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_add(&dose, NULL, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_get_mlx_ms(NULL, &dose_mlx_ms));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_get_mlx_ms(&dose, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_reset(NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_checkpoint(NULL, &checkpoint));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_checkpoint(&dose, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_restore(NULL, &checkpoint));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_dose_restore(&dose, NULL));
+}
@@ -0,0 +1,225 @@
+#include <math.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_fleet.h"
+
+#define BH1750_TEST_FLEET_CAPACITY 4
+
+/* Instances are only stored and returned by the fleet, never dereferenced */
+static BH1750 inst_0 = (BH1750)0x10;
+static BH1750 inst_1 = (BH1750)0x20;
+static BH1750 inst_2 = (BH1750)0x30;
+
+static BH1750 inst_arr[BH1750_TEST_FLEET_CAPACITY];
+static uint16_t raw_meas_arr[BH1750_TEST_FLEET_CAPACITY];
+static float lx_per_count_arr[BH1750_TEST_FLEET_CAPACITY];
+static uint32_t next_due_ms_arr[BH1750_TEST_FLEET_CAPACITY];
+static uint32_t period_ms_arr[BH1750_TEST_FLEET_CAPACITY];
+static uint8_t meas_mode_arr[BH1750_TEST_FLEET_CAPACITY];
+static uint8_t meas_time_arr[BH1750_TEST_FLEET_CAPACITY];
+
+static BH1750FleetMemory mem;
+static BH1750Fleet fleet;
+
+// clang-format off
+TEST_GROUP(BH1750Fleet)
+{
+    void setup() {
+        mem.inst = inst_arr;
+        mem.raw_meas = raw_meas_arr;
+        mem.lx_per_count = lx_per_count_arr;
+        mem.next_due_ms = next_due_ms_arr;
+        mem.period_ms = period_ms_arr;
+        mem.meas_mode = meas_mode_arr;
+        mem.meas_time = meas_time_arr;
+        uint8_t rc = bh1750_fleet_init(&fleet, &mem, BH1750_TEST_FLEET_CAPACITY);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+static void record(size_t id, uint16_t raw_meas, uint8_t meas_mode, uint8_t meas_time, uint32_t now_ms)
+{
+    BH1750Measurement meas;
+    meas.meas_lx = 0;
+    meas.raw_meas = raw_meas;
+    meas.meas_mode = meas_mode;
+    meas.meas_time = meas_time;
+    uint8_t rc = bh1750_fleet_record(&fleet, id, &meas, now_ms);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+TEST(BH1750Fleet, InitInvalidArgs)
+{
+    BH1750Fleet other_fleet;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_init(NULL, &mem, BH1750_TEST_FLEET_CAPACITY));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_init(&other_fleet, NULL, BH1750_TEST_FLEET_CAPACITY));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_init(&other_fleet, &mem, 0));
+
+    BH1750FleetMemory incomplete_mem = mem;
+    incomplete_mem.lx_per_count = NULL;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_fleet_init(&other_fleet, &incomplete_mem, BH1750_TEST_FLEET_CAPACITY));
+}
+
+TEST(BH1750Fleet, AddAssignsSequentialIds)
+{
+    size_t id_0 = 0xFF;
+    size_t id_1 = 0xFF;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_fleet_add(&fleet, inst_0, 1000, 0, &id_0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_fleet_add(&fleet, inst_1, 1000, 0, &id_1));
+    CHECK_EQUAL(0, id_0);
+    CHECK_EQUAL(1, id_1);
+    POINTERS_EQUAL(inst_0, bh1750_fleet_get_instance(&fleet, 0));
+    POINTERS_EQUAL(inst_1, bh1750_fleet_get_instance(&fleet, 1));
+    POINTERS_EQUAL(NULL, bh1750_fleet_get_instance(&fleet, 2));
+}
+
+TEST(BH1750Fleet, AddFleetFull)
+{
+    for (size_t i = 0; i < BH1750_TEST_FLEET_CAPACITY; i++) {
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_fleet_add(&fleet, inst_0, 1000, 0, NULL));
+    }
+    CHECK_EQUAL(BH1750_RESULT_CODE_OUT_OF_MEMORY, bh1750_fleet_add(&fleet, inst_1, 1000, 0, NULL));
+}
+
+TEST(BH1750Fleet, AddInvalidArgs)
+{
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_add(NULL, inst_0, 1000, 0, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_add(&fleet, NULL, 1000, 0, NULL));
+}
+
+TEST(BH1750Fleet, RecordInvalidArgs)
+{
+    bh1750_fleet_add(&fleet, inst_0, 1000, 0, NULL);
+    BH1750Measurement meas = {0, 100, BH1750_MEAS_MODE_H_RES, 69};
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_record(NULL, 0, &meas, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_record(&fleet, 0, NULL, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_record(&fleet, 1, &meas, 0));
+    meas.meas_time = 30;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_record(&fleet, 0, &meas, 0));
+    meas.meas_time = 69;
+    meas.meas_mode = 0x55;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_record(&fleet, 0, &meas, 0));
+}
+
+TEST(BH1750Fleet, ConvertAllBeforeFirstRecordYieldsZero)
+{
+    bh1750_fleet_add(&fleet, inst_0, 1000, 0, NULL);
+    uint32_t meas_lx[1] = {0xFFFF};
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_fleet_convert_all(&fleet, meas_lx));
+    CHECK_EQUAL(0, meas_lx[0]);
+}
+
+TEST(BH1750Fleet, ConvertAllUsesPerSensorConfig)
+{
+    bh1750_fleet_add(&fleet, inst_0, 1000, 0, NULL);
+    bh1750_fleet_add(&fleet, inst_1, 1000, 0, NULL);
+    bh1750_fleet_add(&fleet, inst_2, 1000, 0, NULL);
+    /* Same values as in the driver read tests */
+    record(0, 0x8390, BH1750_MEAS_MODE_H_RES, 69, 0);
+    record(1, 0x8390, BH1750_MEAS_MODE_H_RES2, 69, 0);
+    record(2, 0x8390, BH1750_MEAS_MODE_H_RES, 138, 0);
+
+    uint32_t meas_lx[3];
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_fleet_convert_all(&fleet, meas_lx));
+    CHECK_EQUAL(28067, meas_lx[0]);
+    CHECK_EQUAL(14033, meas_lx[1]);
+    CHECK_EQUAL(14033, meas_lx[2]);
+}
+
+TEST(BH1750Fleet, ConvertAllMatchesDriverConversion)
+{
+    bh1750_fleet_add(&fleet, inst_0, 1000, 0, NULL);
+    const uint8_t meas_modes[] = {BH1750_MEAS_MODE_H_RES, BH1750_MEAS_MODE_H_RES2, BH1750_MEAS_MODE_L_RES};
+    for (size_t m = 0; m < sizeof(meas_modes); m++) {
+        for (uint16_t meas_time = 31; meas_time <= 254; meas_time += 37) {
+            float lx_per_count;
+            CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_get_lx_per_count(meas_modes[m], meas_time, &lx_per_count));
+            for (uint32_t raw_meas = 0; raw_meas <= 0xFFFF; raw_meas += 7) {
+                record(0, raw_meas, meas_modes[m], meas_time, 0);
+                uint32_t meas_lx;
+                bh1750_fleet_convert_all(&fleet, &meas_lx);
+                CHECK_EQUAL((uint32_t)lroundf(raw_meas * lx_per_count), meas_lx);
+            }
+        }
+    }
+}
+
+TEST(BH1750Fleet, ConvertAllInvalidArgs)
+{
+    uint32_t meas_lx[1];
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_convert_all(NULL, meas_lx));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_convert_all(&fleet, NULL));
+}
+
+TEST(BH1750Fleet, FindDueReturnsDueSensors)
+{
+    bh1750_fleet_add(&fleet, inst_0, 1000, 100, NULL);
+    bh1750_fleet_add(&fleet, inst_1, 1000, 300, NULL);
+    bh1750_fleet_add(&fleet, inst_2, 1000, 200, NULL);
+
+    size_t ids[BH1750_TEST_FLEET_CAPACITY];
+    size_t num_ids = 0xFF;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_fleet_find_due(&fleet, 200, ids, BH1750_TEST_FLEET_CAPACITY, &num_ids));
+    CHECK_EQUAL(2, num_ids);
+    CHECK_EQUAL(0, ids[0]);
+    CHECK_EQUAL(2, ids[1]);
+}
+
+TEST(BH1750Fleet, FindDueRespectsMaxIds)
+{
+    bh1750_fleet_add(&fleet, inst_0, 1000, 0, NULL);
+    bh1750_fleet_add(&fleet, inst_1, 1000, 0, NULL);
+
+    size_t ids[1];
+    size_t num_ids = 0xFF;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_fleet_find_due(&fleet, 0, ids, 1, &num_ids));
+    CHECK_EQUAL(1, num_ids);
+    CHECK_EQUAL(0, ids[0]);
+}
+
+TEST(BH1750Fleet, RecordReschedulesSensor)
+{
+    bh1750_fleet_add(&fleet, inst_0, 1000, 0, NULL);
+    record(0, 100, BH1750_MEAS_MODE_H_RES, 69, 50);
+
+    size_t ids[1];
+    size_t num_ids = 0xFF;
+    bh1750_fleet_find_due(&fleet, 1049, ids, 1, &num_ids);
+    CHECK_EQUAL(0, num_ids);
+    bh1750_fleet_find_due(&fleet, 1050, ids, 1, &num_ids);
+    CHECK_EQUAL(1, num_ids);
+}
+
+TEST(BH1750Fleet, FindDueHandlesTimeWraparound)
+{
+    bh1750_fleet_add(&fleet, inst_0, 1000, 0, NULL);
+    record(0, 100, BH1750_MEAS_MODE_H_RES, 69, 0xFFFFFF00);
+
+    size_t ids[1];
+    size_t num_ids = 0xFF;
+    /* Due at 0xFFFFFF00 + 1000, which wraps around to 744 */
+    bh1750_fleet_find_due(&fleet, 0xFFFFFFF0, ids, 1, &num_ids);
+    CHECK_EQUAL(0, num_ids);
+    bh1750_fleet_find_due(&fleet, 744, ids, 1, &num_ids);
+    CHECK_EQUAL(1, num_ids);
+}
+
+TEST(BH1750Fleet, FindDueInvalidArgs)
+{
+    size_t ids[1];
+    size_t num_ids;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_find_due(NULL, 0, ids, 1, &num_ids));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_find_due(&fleet, 0, NULL, 1, &num_ids));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_fleet_find_due(&fleet, 0, ids, 1, NULL));
+}
+
+TEST(BH1750Fleet, GetLxPerCountInvalidArgs)
+{
+    float lx_per_count;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_lx_per_count(BH1750_MEAS_MODE_H_RES, 69, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_lx_per_count(BH1750_MEAS_MODE_H_RES, 30, &lx_per_count));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_lx_per_count(0x55, 69, &lx_per_count));
+}
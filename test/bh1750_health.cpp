@@ -0,0 +1,369 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_health.h"
+/* Included to know the size of BH1750 instances to return from get_instance_memory */
+#include "bh1750_private.h"
+
+#define MAX_NUM_CMDS 8
+
+static BH1750Health health;
+static BH1750HealthConfig cfg;
+static size_t num_events;
+static uint8_t event_state;
+static uint8_t event_reasons;
+
+static void health_event_cb(uint8_t state, uint8_t reasons, void *user_data)
+{
+    (void)user_data;
+    num_events++;
+    event_state = state;
+    event_reasons = reasons;
+}
+
+// clang-format off
+TEST_GROUP(BH1750Health)
+{
+    void setup() {
+        num_events = 0;
+        event_state = 0xFF;
+        event_reasons = 0xFF;
+        /* Error rate covers about the last 8 reads */
+        cfg.error_rate_shift = 3;
+        cfg.degraded_error_rate_pct = 10;
+        cfg.failed_error_rate_pct = 50;
+        cfg.stuck_count = 5;
+        cfg.latency_outlier_count = 2;
+        cfg.latency_margin_ms = 10;
+        cfg.backoff_base_ms = 100;
+        cfg.backoff_max_ms = 300;
+        cfg.cb = health_event_cb;
+        cfg.user_data = NULL;
+        cfg.auto_recover = false;
+        cfg.inst = NULL;
+        uint8_t rc = bh1750_health_init(&health, &cfg);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+static void record_ok(uint16_t raw_meas, uint32_t latency_ms)
+{
+    BH1750Measurement meas = {0, raw_meas, BH1750_MEAS_MODE_H_RES, 69};
+    uint8_t rc = bh1750_health_record(&health, BH1750_RESULT_CODE_OK, &meas, latency_ms);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+static void record_io_err()
+{
+    uint8_t rc = bh1750_health_record(&health, BH1750_RESULT_CODE_IO_ERR, NULL, 20);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+static BH1750HealthStatus get_status()
+{
+    BH1750HealthStatus status;
+    uint8_t rc = bh1750_health_get_status(&health, &status);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return status;
+}
+
+TEST(BH1750Health, HealthyWithoutProblems)
+{
+    for (uint16_t i = 0; i < 20; i++) {
+        record_ok(i, 20);
+    }
+    BH1750HealthStatus status = get_status();
+    CHECK_EQUAL(BH1750_HEALTH_STATE_HEALTHY, status.state);
+    CHECK_EQUAL(0, status.reasons);
+    CHECK_EQUAL(0, status.error_rate_pct);
+    CHECK_EQUAL(0, status.backoff_ms);
+    CHECK_EQUAL(20, status.latency_ms);
+    CHECK_EQUAL(0, num_events);
+}
+
+TEST(BH1750Health, ErrorRateDegradesThenFails)
+{
+    /* 12.5 % */
+    record_io_err();
+    CHECK_EQUAL(1, num_events);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_DEGRADED, event_state);
+    CHECK_EQUAL(BH1750_HEALTH_REASON_ERROR_RATE, event_reasons);
+    CHECK_EQUAL(12, get_status().error_rate_pct);
+    CHECK_EQUAL(100, get_status().backoff_ms);
+
+    /* 23 %, 33 %, 41 %, 48 % */
+    for (uint8_t i = 0; i < 4; i++) {
+        record_io_err();
+    }
+    CHECK_EQUAL(1, num_events);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_DEGRADED, get_status().state);
+
+    /* 55 % */
+    record_io_err();
+    CHECK_EQUAL(2, num_events);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_FAILED, event_state);
+    CHECK_EQUAL(BH1750_HEALTH_REASON_ERROR_RATE, event_reasons);
+    CHECK_EQUAL(100, get_status().backoff_ms);
+
+    /* Backoff doubles while failed, up to the maximum */
+    record_io_err();
+    CHECK_EQUAL(200, get_status().backoff_ms);
+    record_io_err();
+    CHECK_EQUAL(300, get_status().backoff_ms);
+    record_io_err();
+    CHECK_EQUAL(300, get_status().backoff_ms);
+}
+
+TEST(BH1750Health, RecoversAfterSuccessfulReads)
+{
+    for (uint8_t i = 0; i < 6; i++) {
+        record_io_err();
+    }
+    CHECK_EQUAL(BH1750_HEALTH_STATE_FAILED, get_status().state);
+
+    for (uint16_t i = 0; i < 100; i++) {
+        record_ok(i, 20);
+    }
+    BH1750HealthStatus status = get_status();
+    CHECK_EQUAL(BH1750_HEALTH_STATE_HEALTHY, status.state);
+    CHECK_EQUAL(0, status.error_rate_pct);
+    CHECK_EQUAL(0, status.backoff_ms);
+    /* Healthy -> degraded -> failed -> degraded -> healthy */
+    CHECK_EQUAL(4, num_events);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_HEALTHY, event_state);
+    CHECK_EQUAL(0, event_reasons);
+}
+
+TEST(BH1750Health, StuckValueFails)
+{
+    for (uint8_t i = 0; i < 4; i++) {
+        record_ok(1234, 20);
+    }
+    CHECK_EQUAL(0, num_events);
+    record_ok(1234, 20);
+    CHECK_EQUAL(1, num_events);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_FAILED, event_state);
+    CHECK_EQUAL(BH1750_HEALTH_REASON_STUCK, event_reasons);
+
+    /* IO errors do not interrupt the run */
+    record_io_err();
+    CHECK_EQUAL(BH1750_HEALTH_STATE_FAILED, get_status().state);
+    CHECK_TRUE((get_status().reasons & BH1750_HEALTH_REASON_STUCK) != 0);
+
+    record_ok(1235, 20);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_DEGRADED, get_status().state);
+    CHECK_EQUAL(BH1750_HEALTH_REASON_ERROR_RATE, get_status().reasons);
+}
+
+TEST(BH1750Health, DarknessAndSaturationAreNotStuck)
+{
+    for (uint16_t i = 0; i < 1000; i++) {
+        record_ok(0, 20);
+    }
+    CHECK_EQUAL(BH1750_HEALTH_STATE_HEALTHY, get_status().state);
+    for (uint16_t i = 0; i < 1000; i++) {
+        record_ok(UINT16_MAX, 20);
+    }
+    CHECK_EQUAL(BH1750_HEALTH_STATE_HEALTHY, get_status().state);
+    CHECK_EQUAL(0, num_events);
+}
+
+TEST(BH1750Health, BackoffOnlyGrowsWithFailedReads)
+{
+    /* 12.5 %, degraded */
+    record_io_err();
+    CHECK_EQUAL(BH1750_HEALTH_STATE_DEGRADED, get_status().state);
+    CHECK_EQUAL(100, get_status().backoff_ms);
+    /* Backoff doubles while degraded too */
+    record_io_err();
+    CHECK_EQUAL(BH1750_HEALTH_STATE_DEGRADED, get_status().state);
+    CHECK_EQUAL(200, get_status().backoff_ms);
+
+    record_ok(1, 20);
+    record_ok(2, 20);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_DEGRADED, get_status().state);
+    CHECK_EQUAL(200, get_status().backoff_ms);
+
+    while (get_status().state != BH1750_HEALTH_STATE_FAILED) {
+        record_io_err();
+    }
+    CHECK_EQUAL(100, get_status().backoff_ms);
+    record_io_err();
+    CHECK_EQUAL(200, get_status().backoff_ms);
+    record_ok(3, 20);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_FAILED, get_status().state);
+    CHECK_EQUAL(200, get_status().backoff_ms);
+}
+
+TEST(BH1750Health, ConsecutiveLatencyOutliersDegrade)
+{
+    for (uint16_t i = 0; i < 8; i++) {
+        record_ok(i, 20);
+    }
+    /* One outlier is tolerated */
+    record_ok(100, 100);
+    CHECK_EQUAL(0, num_events);
+    record_ok(101, 200);
+    CHECK_EQUAL(1, num_events);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_DEGRADED, event_state);
+    CHECK_EQUAL(BH1750_HEALTH_REASON_LATENCY, event_reasons);
+
+    record_ok(102, 20);
+    CHECK_EQUAL(2, num_events);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_HEALTHY, event_state);
+}
+
+TEST(BH1750Health, NoLatencyOutliersDuringWarmup)
+{
+    record_ok(0, 20);
+    record_ok(1, 500);
+    record_ok(2, 1000);
+    CHECK_EQUAL(0, num_events);
+}
+
+TEST(BH1750Health, OtherResultCodesAreIgnored)
+{
+    uint8_t rc = bh1750_health_record(&health, BH1750_RESULT_CODE_BUSY, NULL, 0);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(0, get_status().error_rate_pct);
+    CHECK_EQUAL(0, num_events);
+}
+
+TEST(BH1750Health, SuppressedReadIsSuccessful)
+{
+    for (size_t i = 0; i < 2; i++) {
+        record_io_err();
+    }
+    CHECK_EQUAL(BH1750_HEALTH_STATE_DEGRADED, get_status().state);
+    /* Suppressed reads carry no measurement, they lower the error rate but do not feed the stuck detector */
+    for (size_t i = 0; i < 20; i++) {
+        uint8_t rc = bh1750_health_record(&health, BH1750_RESULT_CODE_SUPPRESSED, NULL, 20);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+    BH1750HealthStatus status = get_status();
+    CHECK_EQUAL(BH1750_HEALTH_STATE_HEALTHY, status.state);
+    CHECK_EQUAL(0, status.reasons);
+    CHECK_EQUAL(20, status.latency_ms);
+}
+
+static struct BH1750Struct instance_memory;
+static uint8_t cmds[MAX_NUM_CMDS];
+static size_t num_cmds;
+
+static void *get_instance_memory(void *user_data)
+{
+    (void)user_data;
+    return &instance_memory;
+}
+
+static void fake_write(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                       void *cb_user_data)
+{
+    (void)length;
+    (void)i2c_addr;
+    (void)user_data;
+    if (num_cmds < MAX_NUM_CMDS) {
+        cmds[num_cmds] = data[0];
+    }
+    num_cmds++;
+    cb(BH1750_I2C_RESULT_CODE_OK, cb_user_data);
+}
+
+static void fake_read(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                      void *cb_user_data)
+{
+    (void)length;
+    (void)i2c_addr;
+    (void)user_data;
+    data[0] = 0;
+    data[1] = 0;
+    cb(BH1750_I2C_RESULT_CODE_OK, cb_user_data);
+}
+
+static void fake_start_timer(uint32_t duration_ms, void *user_data, BH1750TimerExpiredCb cb, void *cb_user_data)
+{
+    (void)duration_ms;
+    (void)user_data;
+    cb(cb_user_data);
+}
+
+static BH1750 create_initialized_instance()
+{
+    memset(&instance_memory, 0, sizeof(instance_memory));
+    BH1750InitConfig init_cfg = {};
+    init_cfg.get_instance_memory = get_instance_memory;
+    init_cfg.i2c_write = fake_write;
+    init_cfg.i2c_read = fake_read;
+    init_cfg.start_timer = fake_start_timer;
+    init_cfg.i2c_addr = 0x23;
+    BH1750 inst;
+    uint8_t rc = bh1750_create(&inst, &init_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    rc = bh1750_init(inst, NULL, NULL, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    num_cmds = 0;
+    return inst;
+}
+
+TEST(BH1750Health, AutoRecoverOnFailure)
+{
+    cfg.auto_recover = true;
+    cfg.inst = create_initialized_instance();
+    uint8_t rc = bh1750_health_init(&health, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    for (uint8_t i = 0; i < 4; i++) {
+        record_ok(1234, 20);
+    }
+    CHECK_EQUAL(0, num_cmds);
+    record_ok(1234, 20);
+    CHECK_EQUAL(BH1750_HEALTH_STATE_FAILED, event_state);
+    CHECK_EQUAL(1, get_status().num_recoveries);
+    /* Power on, then both halves of the default measurement time 69 */
+    CHECK_EQUAL(3, num_cmds);
+    CHECK_EQUAL(0x01, cmds[0]);
+    CHECK_EQUAL(0x42, cmds[1]);
+    CHECK_EQUAL(0x65, cmds[2]);
+
+    /* Only the transition to failed starts a recovery */
+    record_ok(1234, 20);
+    CHECK_EQUAL(1, get_status().num_recoveries);
+    CHECK_EQUAL(3, num_cmds);
+}
+
+TEST(BH1750Health, NoRecoveryWithoutAutoRecover)
+{
+    cfg.inst = create_initialized_instance();
+    uint8_t rc = bh1750_health_init(&health, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    for (uint8_t i = 0; i < 5; i++) {
+        record_ok(1234, 20);
+    }
+    CHECK_EQUAL(BH1750_HEALTH_STATE_FAILED, event_state);
+    CHECK_EQUAL(0, get_status().num_recoveries);
+    CHECK_EQUAL(0, num_cmds);
+}
+
+TEST(BH1750Health, InvalidArgs)
+{
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_health_record(&health, BH1750_RESULT_CODE_OK, NULL, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_health_init(NULL, &cfg));
+
+    cfg.error_rate_shift = 0;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_health_init(&health, &cfg));
+    cfg.error_rate_shift = 3;
+    cfg.failed_error_rate_pct = 5;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_health_init(&health, &cfg));
+    cfg.failed_error_rate_pct = 101;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_health_init(&health, &cfg));
+    cfg.failed_error_rate_pct = 50;
+    cfg.backoff_max_ms = 50;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_health_init(&health, &cfg));
+    cfg.backoff_max_ms = 300;
+    /* Auto recovery without an instance */
+    cfg.auto_recover = true;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_health_init(&health, &cfg));
+}
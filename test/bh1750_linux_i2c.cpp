@@ -0,0 +1,289 @@
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_linux_i2c.h"
+/* Included to know the size of BH1750 instances to return from get_instance_memory */
+#include "bh1750_private.h"
+
+#define FAKE_FD 7
+#define FAKE_BUS_PATH "/dev/i2c-1"
+
+static BH1750LinuxI2CCompletion completions[2];
+static BH1750LinuxI2C i2c;
+static BH1750LinuxI2CBus bus;
+
+/* Fake i2c-dev device with one BH1750 at address 0x23 */
+static size_t num_opens;
+static size_t num_closes;
+static bool open_fails;
+static bool device_nacks;
+static bool adapter_removed;
+static uint8_t written[16];
+static size_t num_written;
+static uint8_t device_meas[2];
+static uint16_t last_msg_flags;
+
+static int fake_open(const char *path, int flags)
+{
+    (void)flags;
+    num_opens++;
+    return (!open_fails && (strcmp(path, FAKE_BUS_PATH) == 0)) ? FAKE_FD : -1;
+}
+
+static int fake_ioctl(int fd, unsigned long request, void *arg)
+{
+    CHECK_EQUAL(FAKE_FD, fd);
+    CHECK_EQUAL((unsigned long)I2C_RDWR, request);
+    struct i2c_rdwr_ioctl_data *rdwr = (struct i2c_rdwr_ioctl_data *)arg;
+    CHECK_EQUAL(1, rdwr->nmsgs);
+    struct i2c_msg *msg = &rdwr->msgs[0];
+    last_msg_flags = msg->flags;
+    if (adapter_removed) {
+        errno = ENODEV;
+        return -1;
+    }
+    if (device_nacks || (msg->addr != 0x23)) {
+        errno = ENXIO;
+        return -1;
+    }
+    if (msg->flags & I2C_M_RD) {
+        CHECK_EQUAL(2, msg->len);
+        memcpy(msg->buf, device_meas, 2);
+    } else {
+        CHECK_EQUAL(1, msg->len);
+        written[num_written++] = msg->buf[0];
+    }
+    return 1;
+}
+
+static int fake_close(int fd)
+{
+    CHECK_EQUAL(FAKE_FD, fd);
+    num_closes++;
+    return 0;
+}
+
+static BH1750LinuxSys fake_sys = {fake_open, fake_ioctl, fake_close};
+
+static size_t cb_call_count;
+static uint8_t cb_result_code;
+
+static void i2c_complete_cb(uint8_t result_code, void *user_data)
+{
+    (void)user_data;
+    cb_call_count++;
+    cb_result_code = result_code;
+}
+
+// clang-format off
+TEST_GROUP(BH1750LinuxI2C)
+{
+    void setup() {
+        num_opens = 0;
+        num_closes = 0;
+        open_fails = false;
+        device_nacks = false;
+        adapter_removed = false;
+        num_written = 0;
+        cb_call_count = 0;
+        uint8_t rc = bh1750_linux_i2c_init(&i2c, completions, 2, &fake_sys);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        rc = bh1750_linux_i2c_bus_init(&bus, &i2c, 1);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+static BH1750LinuxI2CStats get_stats()
+{
+    BH1750LinuxI2CStats stats;
+    uint8_t rc = bh1750_linux_i2c_get_stats(&i2c, &stats);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return stats;
+}
+
+TEST(BH1750LinuxI2C, CompletionIsDeferred)
+{
+    uint8_t cmd = 0x01;
+    bh1750_linux_i2c_write(&cmd, 1, 0x23, &bus, i2c_complete_cb, NULL);
+    CHECK_EQUAL(1, num_written);
+    CHECK_EQUAL(0x01, written[0]);
+    CHECK_EQUAL(0, last_msg_flags);
+    CHECK_EQUAL(0, cb_call_count);
+
+    CHECK_EQUAL(1, bh1750_linux_i2c_process(&i2c));
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_OK, cb_result_code);
+    CHECK_EQUAL(0, bh1750_linux_i2c_process(&i2c));
+}
+
+TEST(BH1750LinuxI2C, FdIsOpenedOnceAndCached)
+{
+    uint8_t cmd = 0x01;
+    uint8_t data[2];
+    bh1750_linux_i2c_write(&cmd, 1, 0x23, &bus, i2c_complete_cb, NULL);
+    bh1750_linux_i2c_read(data, 2, 0x23, &bus, i2c_complete_cb, NULL);
+    CHECK_EQUAL(I2C_M_RD, last_msg_flags);
+    CHECK_EQUAL(2, bh1750_linux_i2c_process(&i2c));
+    CHECK_EQUAL(1, num_opens);
+
+    /* One syscall per transaction, plus the open */
+    BH1750LinuxI2CStats stats = get_stats();
+    CHECK_EQUAL(2, stats.num_transactions);
+    CHECK_EQUAL(3, stats.num_syscalls);
+    CHECK_EQUAL(0, stats.num_errors);
+
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_linux_i2c_bus_close(&bus));
+    CHECK_EQUAL(1, num_closes);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_linux_i2c_bus_close(&bus));
+    CHECK_EQUAL(1, num_closes);
+}
+
+TEST(BH1750LinuxI2C, Errors)
+{
+    uint8_t cmd = 0x01;
+    open_fails = true;
+    bh1750_linux_i2c_write(&cmd, 1, 0x23, &bus, i2c_complete_cb, NULL);
+    bh1750_linux_i2c_process(&i2c);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_ERR, cb_result_code);
+
+    /* Opening is retried */
+    open_fails = false;
+    device_nacks = true;
+    bh1750_linux_i2c_write(&cmd, 1, 0x23, &bus, i2c_complete_cb, NULL);
+    bh1750_linux_i2c_process(&i2c);
+    CHECK_EQUAL(2, num_opens);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_ERR, cb_result_code);
+    CHECK_EQUAL(2, get_stats().num_errors);
+    /* A NACK does not make the device unusable */
+    CHECK_EQUAL(0, num_closes);
+}
+
+TEST(BH1750LinuxI2C, UnusableFdIsReopened)
+{
+    uint8_t cmd = 0x01;
+    adapter_removed = true;
+    bh1750_linux_i2c_write(&cmd, 1, 0x23, &bus, i2c_complete_cb, NULL);
+    bh1750_linux_i2c_process(&i2c);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_ERR, cb_result_code);
+    CHECK_EQUAL(1, num_closes);
+
+    adapter_removed = false;
+    bh1750_linux_i2c_write(&cmd, 1, 0x23, &bus, i2c_complete_cb, NULL);
+    bh1750_linux_i2c_process(&i2c);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_OK, cb_result_code);
+    CHECK_EQUAL(2, num_opens);
+}
+
+TEST(BH1750LinuxI2C, OversizedTransferFails)
+{
+    static uint8_t data[(size_t)UINT16_MAX + 1];
+    bh1750_linux_i2c_write(data, sizeof(data), 0x23, &bus, i2c_complete_cb, NULL);
+    bh1750_linux_i2c_process(&i2c);
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_ERR, cb_result_code);
+    CHECK_EQUAL(0, num_written);
+    CHECK_EQUAL(0, get_stats().num_syscalls);
+    CHECK_EQUAL(1, get_stats().num_errors);
+}
+
+TEST(BH1750LinuxI2C, NullBusCompletesWithError)
+{
+    uint8_t cmd = 0x01;
+    bh1750_linux_i2c_write(&cmd, 1, 0x23, NULL, i2c_complete_cb, NULL);
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_ERR, cb_result_code);
+}
+
+TEST(BH1750LinuxI2C, QueueFullExecutesRightAway)
+{
+    uint8_t cmd = 0x01;
+    for (size_t i = 0; i < 3; i++) {
+        bh1750_linux_i2c_write(&cmd, 1, 0x23, &bus, i2c_complete_cb, NULL);
+    }
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(2, bh1750_linux_i2c_process(&i2c));
+    CHECK_EQUAL(3, cb_call_count);
+}
+
+static struct BH1750Struct instance_memory;
+
+static void *get_instance_memory(void *user_data)
+{
+    (void)user_data;
+    return &instance_memory;
+}
+
+static void start_timer(uint32_t duration_ms, void *user_data, BH1750TimerExpiredCb cb, void *cb_user_data)
+{
+    (void)duration_ms;
+    (void)user_data;
+    (void)cb;
+    (void)cb_user_data;
+}
+
+static size_t read_cb_call_count;
+static BH1750Measurement read_cb_meas;
+
+static void read_cb(uint8_t result_code, const BH1750Measurement *meas, void *user_data)
+{
+    (void)user_data;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, result_code);
+    read_cb_call_count++;
+    read_cb_meas = *meas;
+}
+
+TEST(BH1750LinuxI2C, DriverOnFakeDevice)
+{
+    BH1750InitConfig cfg = {};
+    cfg.get_instance_memory = get_instance_memory;
+    cfg.i2c_write = bh1750_linux_i2c_write;
+    cfg.i2c_write_user_data = &bus;
+    cfg.i2c_read = bh1750_linux_i2c_read;
+    cfg.i2c_read_user_data = &bus;
+    cfg.start_timer = start_timer;
+    cfg.i2c_addr = 0x23;
+    BH1750 inst;
+    uint8_t rc = bh1750_create(&inst, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    BH1750StartupProfile profile = {138, true, BH1750_MEAS_MODE_H_RES};
+    rc = bh1750_init(inst, &profile, NULL, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    while (bh1750_linux_i2c_process(&i2c) > 0) {
+    }
+    const uint8_t expected_written[] = {0x01, 0x44, 0x6A, 0x10};
+    CHECK_EQUAL(4, num_written);
+    CHECK_EQUAL(0, memcmp(expected_written, written, 4));
+
+    /* Example from the datasheet, p. 7 */
+    device_meas[0] = 0x83;
+    device_meas[1] = 0x90;
+    read_cb_call_count = 0;
+    uint32_t num_syscalls_before = get_stats().num_syscalls;
+    for (size_t i = 0; i < 10; i++) {
+        rc = bh1750_read_continuous_measurement(inst, read_cb, NULL);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        while (bh1750_linux_i2c_process(&i2c) > 0) {
+        }
+    }
+    CHECK_EQUAL(10, read_cb_call_count);
+    CHECK_EQUAL(14033, read_cb_meas.meas_lx);
+    /* One syscall per sample */
+    CHECK_EQUAL(10, get_stats().num_syscalls - num_syscalls_before);
+}
+
+TEST(BH1750LinuxI2C, InvalidArgs)
+{
+    BH1750LinuxSys incomplete_sys = {fake_open, NULL, fake_close};
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_i2c_init(&i2c, completions, 2, &incomplete_sys));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_i2c_init(&i2c, completions, 0, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_i2c_init(NULL, completions, 2, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_i2c_bus_init(&bus, NULL, 1));
+    CHECK_EQUAL(0, bh1750_linux_i2c_process(NULL));
+}
@@ -0,0 +1,229 @@
+#include <string.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_linux_loop.h"
+/* Included to know the size of BH1750 instances to return from get_instance_memory */
+#include "bh1750_private.h"
+
+#define NUM_TIMERS 4
+
+static BH1750LinuxTimer timers[NUM_TIMERS];
+static BH1750LinuxLoop loop;
+
+static BH1750LinuxI2CCompletion completions[NUM_TIMERS];
+static BH1750LinuxI2C i2c;
+static BH1750LinuxI2CBus bus;
+
+/* Order in which timer callbacks were executed */
+static uintptr_t fired[8];
+static size_t num_fired;
+
+static void timer_cb(void *user_data)
+{
+    fired[num_fired++] = (uintptr_t)user_data;
+}
+
+/* Fake i2c-dev device that accepts every transfer and returns a constant measurement */
+static int fake_open(const char *path, int flags)
+{
+    (void)path;
+    (void)flags;
+    return 3;
+}
+
+static int fake_ioctl(int fd, unsigned long request, void *arg)
+{
+    (void)fd;
+    (void)request;
+    struct i2c_rdwr_ioctl_data *rdwr = (struct i2c_rdwr_ioctl_data *)arg;
+    if (rdwr->msgs[0].flags & I2C_M_RD) {
+        /* Example from the datasheet, p. 7 */
+        rdwr->msgs[0].buf[0] = 0x83;
+        rdwr->msgs[0].buf[1] = 0x90;
+    }
+    return 1;
+}
+
+static int fake_close(int fd)
+{
+    (void)fd;
+    return 0;
+}
+
+static BH1750LinuxSys fake_sys = {fake_open, fake_ioctl, fake_close};
+
+// clang-format off
+TEST_GROUP(BH1750LinuxLoop)
+{
+    void setup() {
+        num_fired = 0;
+        uint8_t rc = bh1750_linux_i2c_init(&i2c, completions, NUM_TIMERS, &fake_sys);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        rc = bh1750_linux_i2c_bus_init(&bus, &i2c, 1);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        rc = bh1750_linux_loop_init(&loop, timers, NUM_TIMERS, &i2c);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+
+    void teardown() {
+        bh1750_linux_loop_deinit(&loop);
+    }
+};
+// clang-format on
+
+static BH1750LinuxLoopStats get_stats()
+{
+    BH1750LinuxLoopStats stats;
+    uint8_t rc = bh1750_linux_loop_get_stats(&loop, &stats);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return stats;
+}
+
+/* Run the loop until num_expected timers fired, or give up after a second */
+static void run_until_fired(size_t num_expected)
+{
+    for (size_t i = 0; (i < 100) && (num_fired < num_expected); i++) {
+        uint8_t rc = bh1750_linux_loop_run_once(&loop, 10);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+    CHECK_EQUAL(num_expected, num_fired);
+}
+
+TEST(BH1750LinuxLoop, TimersFireInDeadlineOrder)
+{
+    uint32_t start_ms = bh1750_linux_loop_get_time(NULL);
+    bh1750_linux_loop_start_timer(30, &loop, timer_cb, (void *)3);
+    bh1750_linux_loop_start_timer(10, &loop, timer_cb, (void *)1);
+    bh1750_linux_loop_start_timer(20, &loop, timer_cb, (void *)2);
+    run_until_fired(3);
+    CHECK_EQUAL(1, fired[0]);
+    CHECK_EQUAL(2, fired[1]);
+    CHECK_EQUAL(3, fired[2]);
+    CHECK_TRUE((bh1750_linux_loop_get_time(NULL) - start_ms) >= 30);
+    CHECK_EQUAL(3, get_stats().num_timers_fired);
+}
+
+TEST(BH1750LinuxLoop, TimersWithTheSameDeadlineShareAWakeup)
+{
+    bh1750_linux_loop_start_timer(5, &loop, timer_cb, (void *)1);
+    bh1750_linux_loop_start_timer(5, &loop, timer_cb, (void *)2);
+    /* Both calls read the clock, so the second deadline can be 1 ms later. Make them equal, the heap order is kept. */
+    CHECK_EQUAL(2, loop.num_timers);
+    CHECK_TRUE(loop.timers[1].deadline_ms - loop.timers[0].deadline_ms <= 1);
+    loop.timers[1].deadline_ms = loop.timers[0].deadline_ms;
+    /* Block until the timerfd fires */
+    uint8_t rc = bh1750_linux_loop_run_once(&loop, -1);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(1, get_stats().num_wakeups);
+    CHECK_EQUAL(2, num_fired);
+    CHECK_EQUAL(2, get_stats().num_timers_fired);
+}
+
+TEST(BH1750LinuxLoop, TimerHeapFullIsFatal)
+{
+    for (size_t i = 0; i < NUM_TIMERS + 1; i++) {
+        bh1750_linux_loop_start_timer(1, &loop, timer_cb, (void *)i);
+    }
+    CHECK_EQUAL(1, get_stats().num_timers_dropped);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OUT_OF_MEMORY, bh1750_linux_loop_run_once(&loop, 10));
+    CHECK_EQUAL(BH1750_RESULT_CODE_OUT_OF_MEMORY, bh1750_linux_loop_run_once(&loop, 10));
+    CHECK_EQUAL(0, num_fired);
+}
+
+static size_t i2c_cb_call_count;
+
+static void i2c_complete_cb(uint8_t result_code, void *user_data)
+{
+    (void)user_data;
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_OK, result_code);
+    i2c_cb_call_count++;
+}
+
+TEST(BH1750LinuxLoop, I2cCompletionsWakeUpTheLoop)
+{
+    i2c_cb_call_count = 0;
+    uint8_t cmd = 0x01;
+    bh1750_linux_i2c_write(&cmd, 1, 0x23, &bus, i2c_complete_cb, NULL);
+    bh1750_linux_i2c_write(&cmd, 1, 0x5C, &bus, i2c_complete_cb, NULL);
+    CHECK_EQUAL(0, i2c_cb_call_count);
+
+    uint8_t rc = bh1750_linux_loop_run_once(&loop, 100);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(2, i2c_cb_call_count);
+    CHECK_EQUAL(1, get_stats().num_wakeups);
+
+    /* Nothing pending - times out without a wakeup */
+    rc = bh1750_linux_loop_run_once(&loop, 0);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(1, get_stats().num_wakeups);
+}
+
+static struct BH1750Struct instance_memory[2];
+static size_t num_instances_created;
+
+static void *get_instance_memory(void *user_data)
+{
+    (void)user_data;
+    return &instance_memory[num_instances_created++];
+}
+
+static size_t read_cb_call_count;
+
+static void read_cb(uint8_t result_code, const BH1750Measurement *meas, void *user_data)
+{
+    (void)user_data;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, result_code);
+    /* 0x8390 / 1.2, L-resolution counts are not divided by 2 */
+    CHECK_EQUAL(28067, meas->meas_lx);
+    read_cb_call_count++;
+}
+
+TEST(BH1750LinuxLoop, DrivesInstancesFromOneThread)
+{
+    num_instances_created = 0;
+    read_cb_call_count = 0;
+    BH1750 inst[2];
+    const uint8_t i2c_addr[2] = {0x23, 0x5C};
+    for (size_t i = 0; i < 2; i++) {
+        BH1750InitConfig cfg = {};
+        cfg.get_instance_memory = get_instance_memory;
+        cfg.i2c_write = bh1750_linux_i2c_write;
+        cfg.i2c_write_user_data = &bus;
+        cfg.i2c_read = bh1750_linux_i2c_read;
+        cfg.i2c_read_user_data = &bus;
+        cfg.start_timer = bh1750_linux_loop_start_timer;
+        cfg.start_timer_user_data = &loop;
+        cfg.i2c_addr = i2c_addr[i];
+        cfg.get_time = bh1750_linux_loop_get_time;
+        uint8_t rc = bh1750_create(&inst[i], &cfg);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        rc = bh1750_init(inst[i], NULL, NULL, NULL);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+    uint8_t rc = bh1750_linux_loop_run_once(&loop, 100);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    /* One time measurements in L-resolution mode take 24 ms */
+    for (size_t i = 0; i < 2; i++) {
+        rc = bh1750_read_one_time_measurement(inst[i], BH1750_MEAS_MODE_L_RES, read_cb, NULL);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+    for (size_t i = 0; (i < 100) && (read_cb_call_count < 2); i++) {
+        rc = bh1750_linux_loop_run_once(&loop, 10);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+    CHECK_EQUAL(2, read_cb_call_count);
+    CHECK_EQUAL(2, get_stats().num_timers_fired);
+}
+
+TEST(BH1750LinuxLoop, InvalidArgs)
+{
+    BH1750LinuxLoop other_loop;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_loop_init(&other_loop, timers, 0, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_loop_init(NULL, timers, NUM_TIMERS, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_loop_run_once(NULL, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_loop_get_stats(&loop, NULL));
+}
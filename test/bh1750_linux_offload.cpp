@@ -0,0 +1,301 @@
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_linux_offload.h"
+/* Included to know the size of BH1750 instances to return from get_instance_memory */
+#include "bh1750_private.h"
+
+#define NUM_WORKERS 2
+#define NUM_SLOTS 4
+
+static pthread_t workers[NUM_WORKERS];
+static BH1750LinuxOffloadRequest completions[NUM_SLOTS];
+static BH1750LinuxOffload offload;
+
+static BH1750LinuxOffloadRequest requests[2][NUM_SLOTS];
+static BH1750LinuxOffloadBus buses[2];
+
+/* Fake blocking transfer. user_data points to the index of the bus. */
+static std::atomic<bool> release;
+static std::atomic<int> num_in_transfer[2];
+static std::atomic<int> max_in_transfer[2];
+static std::atomic<int> max_in_transfer_total;
+static std::atomic<int> num_in_transfer_total;
+static uint8_t written[2][16];
+static std::atomic<size_t> num_written[2];
+
+static void update_max(std::atomic<int> &max, int value)
+{
+    int prev = max.load();
+    while ((value > prev) && !max.compare_exchange_weak(prev, value)) {
+    }
+}
+
+static uint8_t fake_transfer(bool is_read, uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data)
+{
+    size_t idx = *(size_t *)user_data;
+    update_max(max_in_transfer[idx], ++num_in_transfer[idx]);
+    update_max(max_in_transfer_total, ++num_in_transfer_total);
+    while (!release.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    uint8_t result_code = BH1750_I2C_RESULT_CODE_OK;
+    if (i2c_addr != 0x23) {
+        result_code = BH1750_I2C_RESULT_CODE_ERR;
+    } else if (is_read) {
+        /* Example from the datasheet, p. 7 */
+        const uint8_t meas[2] = {0x83, 0x90};
+        memcpy(data, meas, (length < 2) ? length : 2);
+    } else {
+        written[idx][num_written[idx]] = data[0];
+        num_written[idx]++;
+    }
+    num_in_transfer_total--;
+    num_in_transfer[idx]--;
+    return result_code;
+}
+
+static size_t bus_idx[2] = {0, 1};
+
+static size_t cb_call_count;
+static uint8_t cb_result_codes[8];
+
+static void i2c_complete_cb(uint8_t result_code, void *user_data)
+{
+    (void)user_data;
+    cb_result_codes[cb_call_count++] = result_code;
+}
+
+static std::atomic<size_t> notify_call_count;
+
+static void notify(void *user_data)
+{
+    (void)user_data;
+    notify_call_count++;
+}
+
+// clang-format off
+TEST_GROUP(BH1750LinuxOffload)
+{
+    void setup() {
+        release = true;
+        max_in_transfer_total = 0;
+        num_in_transfer_total = 0;
+        for (size_t i = 0; i < 2; i++) {
+            num_in_transfer[i] = 0;
+            max_in_transfer[i] = 0;
+            num_written[i] = 0;
+        }
+        cb_call_count = 0;
+        notify_call_count = 0;
+        uint8_t rc = bh1750_linux_offload_init(&offload, workers, NUM_WORKERS, completions, NUM_SLOTS);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        for (size_t i = 0; i < 2; i++) {
+            rc = bh1750_linux_offload_bus_init(&buses[i], &offload, requests[i], 2, fake_transfer, &bus_idx[i]);
+            CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        }
+    }
+
+    void teardown() {
+        release = true;
+        bh1750_linux_offload_deinit(&offload);
+    }
+};
+// clang-format on
+
+static BH1750LinuxOffloadStats get_stats()
+{
+    BH1750LinuxOffloadStats stats;
+    uint8_t rc = bh1750_linux_offload_get_stats(&offload, &stats);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return stats;
+}
+
+/* Wait up to a second for the workers to complete num_expected transactions in total */
+static void wait_for_transactions(uint32_t num_expected)
+{
+    for (size_t i = 0; (i < 1000) && (get_stats().num_transactions < num_expected); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK_EQUAL(num_expected, get_stats().num_transactions);
+}
+
+static void wait_for_in_transfer(int num_expected)
+{
+    for (size_t i = 0; (i < 1000) && (num_in_transfer_total.load() < num_expected); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK_EQUAL(num_expected, num_in_transfer_total.load());
+}
+
+TEST(BH1750LinuxOffload, CompletionIsDeferredToProcess)
+{
+    bh1750_linux_offload_set_notify(&offload, notify, NULL);
+    uint8_t cmd = 0x01;
+    bh1750_linux_offload_write(&cmd, 1, 0x23, &buses[0], i2c_complete_cb, NULL);
+    wait_for_transactions(1);
+    CHECK_EQUAL(1, num_written[0].load());
+    CHECK_EQUAL(0x01, written[0][0]);
+    CHECK_EQUAL(1, notify_call_count.load());
+    CHECK_EQUAL(0, cb_call_count);
+
+    CHECK_EQUAL(1, bh1750_linux_offload_process(&offload));
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_OK, cb_result_codes[0]);
+    CHECK_EQUAL(0, bh1750_linux_offload_process(&offload));
+}
+
+TEST(BH1750LinuxOffload, TransferError)
+{
+    uint8_t cmd = 0x01;
+    bh1750_linux_offload_write(&cmd, 1, 0x5C, &buses[0], i2c_complete_cb, NULL);
+    wait_for_transactions(1);
+    bh1750_linux_offload_process(&offload);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_ERR, cb_result_codes[0]);
+}
+
+TEST(BH1750LinuxOffload, BusesRunInParallel)
+{
+    release = false;
+    uint8_t cmd[2] = {0x01, 0x07};
+    bh1750_linux_offload_write(&cmd[0], 1, 0x23, &buses[0], i2c_complete_cb, NULL);
+    bh1750_linux_offload_write(&cmd[1], 1, 0x23, &buses[1], i2c_complete_cb, NULL);
+    /* Neither transfer can finish before both are in progress */
+    wait_for_in_transfer(2);
+    release = true;
+    wait_for_transactions(2);
+    CHECK_EQUAL(2, bh1750_linux_offload_process(&offload));
+    CHECK_EQUAL(2, cb_call_count);
+}
+
+TEST(BH1750LinuxOffload, OneTransferPerBusAtATime)
+{
+    uint8_t cmd[2] = {0x01, 0x07};
+    release = false;
+    bh1750_linux_offload_write(&cmd[0], 1, 0x23, &buses[0], i2c_complete_cb, NULL);
+    bh1750_linux_offload_write(&cmd[1], 1, 0x23, &buses[0], i2c_complete_cb, NULL);
+    wait_for_in_transfer(1);
+    /* The second worker is idle, but must not start the second transfer of the same bus */
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK_EQUAL(1, num_in_transfer_total.load());
+    release = true;
+    wait_for_transactions(2);
+    CHECK_EQUAL(1, max_in_transfer[0].load());
+    /* Requests of one bus are performed in order */
+    CHECK_EQUAL(0x01, written[0][0]);
+    CHECK_EQUAL(0x07, written[0][1]);
+    CHECK_EQUAL(2, get_stats().max_queue_depth);
+}
+
+TEST(BH1750LinuxOffload, QueueFullFailsRightAway)
+{
+    uint8_t cmd = 0x01;
+    release = false;
+    bh1750_linux_offload_write(&cmd, 1, 0x23, &buses[0], i2c_complete_cb, NULL);
+    wait_for_in_transfer(1);
+    /* Bus queue capacity is 2 */
+    for (size_t i = 0; i < 3; i++) {
+        bh1750_linux_offload_write(&cmd, 1, 0x23, &buses[0], i2c_complete_cb, NULL);
+    }
+    CHECK_EQUAL(1, cb_call_count);
+    CHECK_EQUAL(BH1750_I2C_RESULT_CODE_ERR, cb_result_codes[0]);
+    CHECK_EQUAL(1, get_stats().num_rejected);
+    release = true;
+    wait_for_transactions(3);
+    CHECK_EQUAL(3, bh1750_linux_offload_process(&offload));
+    CHECK_EQUAL(4, cb_call_count);
+}
+
+static struct BH1750Struct instance_memory;
+
+static void *get_instance_memory(void *user_data)
+{
+    (void)user_data;
+    return &instance_memory;
+}
+
+static void start_timer(uint32_t duration_ms, void *user_data, BH1750TimerExpiredCb cb, void *cb_user_data)
+{
+    (void)duration_ms;
+    (void)user_data;
+    (void)cb;
+    (void)cb_user_data;
+}
+
+static size_t read_cb_call_count;
+static BH1750Measurement read_cb_meas;
+
+static void read_cb(uint8_t result_code, const BH1750Measurement *meas, void *user_data)
+{
+    (void)user_data;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, result_code);
+    read_cb_call_count++;
+    read_cb_meas = *meas;
+}
+
+/* Execute completions until the driver stops starting new transactions */
+static void process_until_idle()
+{
+    uint32_t num_done = 0;
+    for (size_t i = 0; i < 1000; i++) {
+        size_t num_executed = bh1750_linux_offload_process(&offload);
+        num_done += num_executed;
+        BH1750LinuxOffloadStats stats = get_stats();
+        if ((num_executed == 0) && (stats.num_transactions == num_done) && (num_in_transfer_total.load() == 0) &&
+            (buses[0].count == 0)) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST(BH1750LinuxOffload, DriverOnBlockingTransfer)
+{
+    BH1750InitConfig cfg = {};
+    cfg.get_instance_memory = get_instance_memory;
+    cfg.i2c_write = bh1750_linux_offload_write;
+    cfg.i2c_write_user_data = &buses[0];
+    cfg.i2c_read = bh1750_linux_offload_read;
+    cfg.i2c_read_user_data = &buses[0];
+    cfg.start_timer = start_timer;
+    cfg.i2c_addr = 0x23;
+    BH1750 inst;
+    uint8_t rc = bh1750_create(&inst, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    BH1750StartupProfile profile = {138, true, BH1750_MEAS_MODE_H_RES};
+    rc = bh1750_init(inst, &profile, NULL, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    process_until_idle();
+    const uint8_t expected_written[] = {0x01, 0x44, 0x6A, 0x10};
+    CHECK_EQUAL(4, num_written[0].load());
+    CHECK_EQUAL(0, memcmp(expected_written, written[0], 4));
+
+    read_cb_call_count = 0;
+    rc = bh1750_read_continuous_measurement(inst, read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    process_until_idle();
+    CHECK_EQUAL(1, read_cb_call_count);
+    CHECK_EQUAL(14033, read_cb_meas.meas_lx);
+}
+
+TEST(BH1750LinuxOffload, InvalidArgs)
+{
+    BH1750LinuxOffload other;
+    BH1750LinuxOffloadBus other_bus;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_offload_init(&other, workers, 0, completions, NUM_SLOTS));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_linux_offload_init(&other, workers, NUM_WORKERS, completions, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_linux_offload_init(NULL, workers, NUM_WORKERS, completions, NUM_SLOTS));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_linux_offload_bus_init(&other_bus, &offload, requests[0], 2, NULL, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG,
+                bh1750_linux_offload_bus_init(&other_bus, &offload, requests[0], 0, fake_transfer, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_linux_offload_get_stats(&offload, NULL));
+    CHECK_EQUAL(0, bh1750_linux_offload_process(NULL));
+}
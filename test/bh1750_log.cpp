@@ -0,0 +1,336 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_log.h"
+
+#define LOG_BUF_SIZE 512
+
+static uint8_t chunk_buf[64];
+static BH1750LogEncoder enc;
+/* All chunks passed to the chunk callback, back to back */
+static uint8_t log_buf[LOG_BUF_SIZE];
+static size_t log_len;
+static size_t num_chunks;
+
+static void chunk_cb(const uint8_t *chunk, size_t len, void *user_data)
+{
+    (void)user_data;
+    CHECK_TRUE((log_len + len) <= LOG_BUF_SIZE);
+    memcpy(&log_buf[log_len], chunk, len);
+    log_len += len;
+    num_chunks++;
+}
+
+// clang-format off
+TEST_GROUP(BH1750Log)
+{
+    void setup() {
+        log_len = 0;
+        num_chunks = 0;
+        uint8_t rc = bh1750_log_encoder_init(&enc, chunk_buf, sizeof(chunk_buf), 0x23, chunk_cb, NULL);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+static void add(uint16_t raw_meas, uint8_t meas_mode, uint8_t meas_time, uint64_t time_ms)
+{
+    BH1750Measurement meas = {0, raw_meas, meas_mode, meas_time};
+    uint8_t rc = bh1750_log_encoder_add(&enc, &meas, time_ms);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+/* 2023-11-14 22:13:20 UTC in Unix ms */
+#define UNIX_MS 1700000000000ULL
+
+TEST(BH1750Log, RoundTrip)
+{
+    add(1000, BH1750_MEAS_MODE_H_RES, 69, UNIX_MS);
+    add(1003, BH1750_MEAS_MODE_H_RES, 69, UNIX_MS + 999);
+    add(997, BH1750_MEAS_MODE_H_RES, 69, UNIX_MS + 2000);
+    add(0, BH1750_MEAS_MODE_H_RES, 69, UNIX_MS + 3000);
+    add(0xFFFF, BH1750_MEAS_MODE_H_RES, 69, UNIX_MS + 4000);
+    bh1750_log_encoder_flush(&enc);
+    CHECK_EQUAL(1, num_chunks);
+
+    BH1750LogChunkHeader hdr;
+    BH1750LogSample samples[8];
+    size_t chunk_len;
+    uint8_t rc = bh1750_log_decode_chunk(log_buf, log_len, &hdr, samples, 8, &chunk_len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(log_len, chunk_len);
+    CHECK_EQUAL(0x23, hdr.i2c_addr);
+    CHECK_EQUAL(BH1750_MEAS_MODE_H_RES, hdr.meas_mode);
+    CHECK_EQUAL(69, hdr.meas_time);
+    CHECK_EQUAL(5, hdr.num_samples);
+
+    const uint16_t expected_raw[] = {1000, 1003, 997, 0, 0xFFFF};
+    const uint64_t expected_time_ms[] = {UNIX_MS, UNIX_MS + 999, UNIX_MS + 2000, UNIX_MS + 3000, UNIX_MS + 4000};
+    for (size_t i = 0; i < 5; i++) {
+        CHECK_EQUAL(expected_raw[i], samples[i].raw_meas);
+        CHECK_TRUE(expected_time_ms[i] == samples[i].time_ms);
+    }
+}
+
+TEST(BH1750Log, LongGapStartsNewChunk)
+{
+    add(1000, BH1750_MEAS_MODE_H_RES, 69, UNIX_MS);
+    add(1001, BH1750_MEAS_MODE_H_RES, 69, UNIX_MS + INT32_MAX);
+    /* Offset from the first sample of the chunk does not fit into 31 bits */
+    add(1002, BH1750_MEAS_MODE_H_RES, 69, UNIX_MS + INT32_MAX + 1ULL);
+    bh1750_log_encoder_flush(&enc);
+    CHECK_EQUAL(2, num_chunks);
+
+    BH1750LogChunkHeader hdr;
+    BH1750LogSample samples[2];
+    size_t chunk_len;
+    uint8_t rc = bh1750_log_decode_chunk(log_buf, log_len, &hdr, samples, 2, &chunk_len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(2, hdr.num_samples);
+    CHECK_TRUE((UNIX_MS + INT32_MAX) == hdr.last_time_ms);
+    rc = bh1750_log_decode_chunk(&log_buf[chunk_len], log_len - chunk_len, &hdr, samples, 2, &chunk_len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(1, hdr.num_samples);
+    CHECK_TRUE((UNIX_MS + INT32_MAX + 1ULL) == hdr.base_time_ms);
+}
+
+TEST(BH1750Log, AddEarlierThanPreviousSampleFails)
+{
+    add(1000, BH1750_MEAS_MODE_H_RES, 69, UNIX_MS);
+    BH1750Measurement meas = {0, 1001, BH1750_MEAS_MODE_H_RES, 69};
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_log_encoder_add(&enc, &meas, UNIX_MS - 1));
+}
+
+TEST(BH1750Log, ConfigChangeStartsNewChunk)
+{
+    add(1000, BH1750_MEAS_MODE_H_RES, 69, 0);
+    add(1001, BH1750_MEAS_MODE_H_RES, 69, 1000);
+    add(2002, BH1750_MEAS_MODE_H_RES, 138, 2000);
+    add(4004, BH1750_MEAS_MODE_H_RES2, 138, 3000);
+    CHECK_EQUAL(2, num_chunks);
+    bh1750_log_encoder_flush(&enc);
+    CHECK_EQUAL(3, num_chunks);
+
+    const uint8_t expected_mode[] = {BH1750_MEAS_MODE_H_RES, BH1750_MEAS_MODE_H_RES, BH1750_MEAS_MODE_H_RES2};
+    const uint8_t expected_time[] = {69, 138, 138};
+    const uint16_t expected_num_samples[] = {2, 1, 1};
+    size_t offset = 0;
+    for (size_t i = 0; i < 3; i++) {
+        BH1750LogChunkHeader hdr;
+        BH1750LogSample samples[2];
+        size_t chunk_len;
+        uint8_t rc = bh1750_log_decode_chunk(&log_buf[offset], log_len - offset, &hdr, samples, 2, &chunk_len);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        CHECK_EQUAL(expected_mode[i], hdr.meas_mode);
+        CHECK_EQUAL(expected_time[i], hdr.meas_time);
+        CHECK_EQUAL(expected_num_samples[i], hdr.num_samples);
+        offset += chunk_len;
+    }
+    CHECK_EQUAL(log_len, offset);
+}
+
+TEST(BH1750Log, FullChunkIsEmitted)
+{
+    /* 64 byte chunk: 32 byte header, room for at least 4 samples of up to 8 bytes after the first one */
+    for (uint32_t i = 0; i < 40; i++) {
+        add((uint16_t)(1000 + i), BH1750_MEAS_MODE_H_RES, 69, i * 1000);
+    }
+    bh1750_log_encoder_flush(&enc);
+    CHECK_TRUE(num_chunks > 1);
+
+    size_t offset = 0;
+    uint32_t total_samples = 0;
+    while (offset < log_len) {
+        BH1750LogChunkHeader hdr;
+        BH1750LogSample samples[40];
+        size_t chunk_len;
+        uint8_t rc = bh1750_log_decode_chunk(&log_buf[offset], log_len - offset, &hdr, samples, 40, &chunk_len);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        CHECK_TRUE(chunk_len <= sizeof(chunk_buf));
+        for (size_t i = 0; i < hdr.num_samples; i++) {
+            CHECK_EQUAL(1000 + total_samples, samples[i].raw_meas);
+            CHECK_EQUAL(total_samples * 1000, samples[i].time_ms);
+            total_samples++;
+        }
+        offset += chunk_len;
+    }
+    CHECK_EQUAL(40, total_samples);
+}
+
+TEST(BH1750Log, SlowlyChangingLightTakesThreeBytesPerSample)
+{
+    static uint8_t big_chunk_buf[LOG_BUF_SIZE];
+    uint8_t rc = bh1750_log_encoder_init(&enc, big_chunk_buf, sizeof(big_chunk_buf), 0x23, chunk_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* Raw count drifts by a few counts, sampled every second */
+    for (uint32_t i = 0; i < 101; i++) {
+        add((uint16_t)(20000 + (i % 7) * 5), BH1750_MEAS_MODE_H_RES, 69, i * 1000);
+    }
+    bh1750_log_encoder_flush(&enc);
+    CHECK_EQUAL(1, num_chunks);
+    /* 1 byte for the raw count delta, 2 bytes for the time delta */
+    CHECK_EQUAL(BH1750_LOG_HEADER_SIZE + 100 * 3, log_len);
+}
+
+TEST(BH1750Log, FlushEmptyEncoderEmitsNothing)
+{
+    uint8_t rc = bh1750_log_encoder_flush(&enc);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(0, num_chunks);
+}
+
+TEST(BH1750Log, EncoderInitInvalidArgs)
+{
+    uint8_t rc = bh1750_log_encoder_init(&enc, chunk_buf, BH1750_LOG_MIN_CHUNK_SIZE - 1, 0x23, chunk_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+    rc = bh1750_log_encoder_init(&enc, chunk_buf, sizeof(chunk_buf), 0x23, NULL, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+    rc = bh1750_log_encoder_init(&enc, NULL, sizeof(chunk_buf), 0x23, chunk_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+}
+
+TEST(BH1750Log, DecodeRejectsMalformedChunks)
+{
+    add(1000, BH1750_MEAS_MODE_H_RES, 69, 0);
+    add(1200, BH1750_MEAS_MODE_H_RES, 69, 1000);
+    bh1750_log_encoder_flush(&enc);
+
+    BH1750LogChunkHeader hdr;
+    BH1750LogSample samples[2];
+    size_t chunk_len;
+    /* Truncated */
+    uint8_t rc = bh1750_log_decode_chunk(log_buf, log_len - 1, &hdr, samples, 2, &chunk_len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+    /* Too many samples for the output array */
+    rc = bh1750_log_decode_chunk(log_buf, log_len, &hdr, samples, 1, &chunk_len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+    /* Version 1 chunk */
+    log_buf[2] = 1;
+    rc = bh1750_log_decode_chunk(log_buf, log_len, &hdr, samples, 2, &chunk_len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+    log_buf[2] = BH1750_LOG_VERSION;
+    /* Wrong magic */
+    log_buf[0] ^= 0xFF;
+    rc = bh1750_log_decode_chunk(log_buf, log_len, &hdr, samples, 2, &chunk_len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+}
+
+/* Three chunks: 0-9 s at 1000 lx, 10-19 s alternating 1000 and 2000 lx, 20-29 s at 3000 lx */
+static void add_three_chunks()
+{
+    static uint8_t big_chunk_buf[LOG_BUF_SIZE / 2];
+    uint8_t rc = bh1750_log_encoder_init(&enc, big_chunk_buf, sizeof(big_chunk_buf), 0x23, chunk_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    for (uint32_t i = 0; i < 10; i++) {
+        add(1200, BH1750_MEAS_MODE_H_RES, 69, i * 1000);
+    }
+    bh1750_log_encoder_flush(&enc);
+    for (uint32_t i = 0; i < 10; i++) {
+        add(((i % 2) == 0) ? 1200 : 2400, BH1750_MEAS_MODE_H_RES, 69, 10000 + i * 1000);
+    }
+    bh1750_log_encoder_flush(&enc);
+    for (uint32_t i = 0; i < 10; i++) {
+        add(3600, BH1750_MEAS_MODE_H_RES, 69, 20000 + i * 1000);
+    }
+    bh1750_log_encoder_flush(&enc);
+    CHECK_EQUAL(3, num_chunks);
+}
+
+TEST(BH1750Log, HeaderIndexesChunk)
+{
+    add(1200, BH1750_MEAS_MODE_H_RES, 69, 5000);
+    add(900, BH1750_MEAS_MODE_H_RES, 69, 6000);
+    add(2400, BH1750_MEAS_MODE_H_RES, 69, 7500);
+    bh1750_log_encoder_flush(&enc);
+
+    BH1750LogChunkHeader hdr;
+    uint8_t rc = bh1750_log_parse_header(log_buf, log_len, &hdr);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(5000, hdr.base_time_ms);
+    CHECK_EQUAL(7500, hdr.last_time_ms);
+    CHECK_EQUAL(900, hdr.min_raw);
+    CHECK_EQUAL(2400, hdr.max_raw);
+    CHECK_EQUAL(4500, hdr.sum_raw);
+}
+
+TEST(BH1750Log, AggregateUsesHeaderOfChunksInRange)
+{
+    add_three_chunks();
+
+    BH1750LogAggregate agg;
+    uint8_t rc = bh1750_log_aggregate(log_buf, log_len, 10000, 20000, &agg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(10, agg.num_samples);
+    CHECK_EQUAL(1000, agg.min_lx);
+    CHECK_EQUAL(2000, agg.max_lx);
+    CHECK_EQUAL(15000, agg.sum_lx);
+    CHECK_EQUAL(1, agg.num_chunks_indexed);
+    CHECK_EQUAL(0, agg.num_chunks_decoded);
+    /* Only the headers were read */
+    CHECK_EQUAL(3 * BH1750_LOG_HEADER_SIZE, agg.num_bytes_scanned);
+}
+
+TEST(BH1750Log, AggregateDecodesChunksOnRangeBoundary)
+{
+    add_three_chunks();
+
+    BH1750LogAggregate agg;
+    uint8_t rc = bh1750_log_aggregate(log_buf, log_len, 5000, 15000, &agg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* 5 samples at 1000 lx, then 1000, 2000, 1000, 2000, 1000 lx */
+    CHECK_EQUAL(10, agg.num_samples);
+    CHECK_EQUAL(1000, agg.min_lx);
+    CHECK_EQUAL(2000, agg.max_lx);
+    CHECK_EQUAL(12000, agg.sum_lx);
+    CHECK_EQUAL(0, agg.num_chunks_indexed);
+    CHECK_EQUAL(2, agg.num_chunks_decoded);
+}
+
+TEST(BH1750Log, AggregateEmptyRange)
+{
+    add_three_chunks();
+
+    BH1750LogAggregate agg;
+    uint8_t rc = bh1750_log_aggregate(log_buf, log_len, 30000, 40000, &agg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(0, agg.num_samples);
+    CHECK_EQUAL(0, agg.min_lx);
+    CHECK_EQUAL(0, agg.max_lx);
+    CHECK_EQUAL(0, agg.sum_lx);
+}
+
+TEST(BH1750Log, AggregateRangeBeyond32BitMs)
+{
+    /* Chunks on both sides of the point where a 32-bit ms counter would wrap around */
+    static uint8_t big_chunk_buf[LOG_BUF_SIZE / 2];
+    uint8_t rc = bh1750_log_encoder_init(&enc, big_chunk_buf, sizeof(big_chunk_buf), 0x23, chunk_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    const uint64_t wrap_ms = 0x100000000ULL;
+    for (uint64_t i = 0; i < 10; i++) {
+        add(1200, BH1750_MEAS_MODE_H_RES, 69, wrap_ms - 5000 + (i * 1000));
+    }
+    bh1750_log_encoder_flush(&enc);
+    for (uint64_t i = 0; i < 10; i++) {
+        add(2400, BH1750_MEAS_MODE_H_RES, 69, wrap_ms + 5000 + (i * 1000));
+    }
+    bh1750_log_encoder_flush(&enc);
+
+    BH1750LogAggregate agg;
+    rc = bh1750_log_aggregate(log_buf, log_len, wrap_ms, wrap_ms + 20000, &agg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* Last 5 samples of the first chunk, all of the second one */
+    CHECK_EQUAL(15, agg.num_samples);
+    CHECK_EQUAL(5 * 1000 + 10 * 2000, agg.sum_lx);
+    CHECK_EQUAL(1, agg.num_chunks_indexed);
+    CHECK_EQUAL(1, agg.num_chunks_decoded);
+}
+
+TEST(BH1750Log, AggregateRejectsTruncatedLog)
+{
+    add_three_chunks();
+
+    BH1750LogAggregate agg;
+    uint8_t rc = bh1750_log_aggregate(log_buf, log_len - 1, 0, 40000, &agg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+}
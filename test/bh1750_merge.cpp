@@ -0,0 +1,177 @@
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_merge.h"
+
+#define NUM_SOURCES 3
+#define QUEUE_CAPACITY 4
+#define NUM_SOURCES_LARGE 1000
+#define QUEUE_CAPACITY_LARGE 4
+
+static BH1750MergeEntry entries[NUM_SOURCES][QUEUE_CAPACITY];
+static BH1750MergeSource sources[NUM_SOURCES];
+static size_t heap[NUM_SOURCES];
+static BH1750Merge merge;
+
+// clang-format off
+TEST_GROUP(BH1750Merge)
+{
+    void setup() {
+        for (size_t i = 0; i < NUM_SOURCES; i++) {
+            sources[i].entries = entries[i];
+            sources[i].capacity = QUEUE_CAPACITY;
+        }
+        uint8_t rc = bh1750_merge_init(&merge, sources, heap, NUM_SOURCES);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+static void push(size_t source, uint32_t meas_lx, uint32_t time_ms)
+{
+    BH1750Measurement meas = {meas_lx, 0, BH1750_MEAS_MODE_H_RES, 69};
+    uint8_t rc = bh1750_merge_push(&merge, source, &meas, time_ms);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+static size_t pop(BH1750MergeItem *items, size_t max_items)
+{
+    size_t num_items;
+    uint8_t rc = bh1750_merge_pop(&merge, items, max_items, &num_items);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return num_items;
+}
+
+TEST(BH1750Merge, LiveSourcesAreHeldBackByWatermark)
+{
+    BH1750MergeItem items[8];
+    push(0, 10, 100);
+    push(1, 20, 50);
+    /* Source 2 could still produce a measurement at 0 ms */
+    CHECK_EQUAL(0, pop(items, 8));
+
+    bh1750_merge_advance_watermark(&merge, 2, 200);
+    /* Source 1 could still produce a measurement between 50 and 100 ms */
+    CHECK_EQUAL(1, pop(items, 8));
+    CHECK_EQUAL(1, items[0].source);
+    CHECK_EQUAL(50, items[0].time_ms);
+    CHECK_EQUAL(20, items[0].meas.meas_lx);
+
+    push(1, 30, 150);
+    CHECK_EQUAL(1, pop(items, 8));
+    CHECK_EQUAL(0, items[0].source);
+    CHECK_EQUAL(100, items[0].time_ms);
+    CHECK_EQUAL(10, items[0].meas.meas_lx);
+
+    bh1750_merge_advance_watermark(&merge, 0, 300);
+    CHECK_EQUAL(1, pop(items, 8));
+    CHECK_EQUAL(1, items[0].source);
+    CHECK_EQUAL(150, items[0].time_ms);
+}
+
+TEST(BH1750Merge, RecordedSourcesAreMergedInTimeOrder)
+{
+    push(0, 0, 10);
+    push(0, 0, 40);
+    push(0, 0, 70);
+    push(1, 1, 20);
+    push(1, 1, 30);
+    push(1, 1, 80);
+    push(2, 2, 50);
+    push(2, 2, 60);
+    for (size_t i = 0; i < NUM_SOURCES; i++) {
+        bh1750_merge_finish_source(&merge, i);
+    }
+
+    BH1750MergeItem items[8];
+    /* Pop in two batches */
+    CHECK_EQUAL(3, pop(items, 3));
+    CHECK_EQUAL(5, pop(&items[3], 8));
+    const uint32_t expected_time_ms[] = {10, 20, 30, 40, 50, 60, 70, 80};
+    const size_t expected_source[] = {0, 1, 1, 0, 2, 2, 0, 1};
+    for (size_t i = 0; i < 8; i++) {
+        CHECK_EQUAL(expected_time_ms[i], items[i].time_ms);
+        CHECK_EQUAL(expected_source[i], items[i].source);
+        CHECK_EQUAL(expected_source[i], items[i].meas.meas_lx);
+    }
+    CHECK_EQUAL(0, pop(items, 8));
+}
+
+TEST(BH1750Merge, FinishedSourceDoesNotHoldBack)
+{
+    BH1750MergeItem items[2];
+    push(0, 10, 100);
+    bh1750_merge_finish_source(&merge, 1);
+    CHECK_EQUAL(0, pop(items, 2));
+    bh1750_merge_finish_source(&merge, 2);
+    CHECK_EQUAL(1, pop(items, 2));
+    CHECK_EQUAL(100, items[0].time_ms);
+}
+
+TEST(BH1750Merge, PushErrors)
+{
+    BH1750Measurement meas = {0, 0, BH1750_MEAS_MODE_H_RES, 69};
+    push(0, 0, 100);
+    uint8_t rc = bh1750_merge_push(&merge, 0, &meas, 99);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+    rc = bh1750_merge_push(&merge, NUM_SOURCES, &meas, 100);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+
+    bh1750_merge_advance_watermark(&merge, 1, 500);
+    rc = bh1750_merge_push(&merge, 1, &meas, 400);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+
+    for (uint32_t i = 1; i < QUEUE_CAPACITY; i++) {
+        push(0, 0, 100 + i);
+    }
+    rc = bh1750_merge_push(&merge, 0, &meas, 200);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OUT_OF_MEMORY, rc);
+
+    bh1750_merge_finish_source(&merge, 2);
+    rc = bh1750_merge_push(&merge, 2, &meas, 200);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_USAGE, rc);
+}
+
+TEST(BH1750Merge, InitInvalidArgs)
+{
+    uint8_t rc = bh1750_merge_init(&merge, sources, heap, 0);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+    sources[1].capacity = 0;
+    rc = bh1750_merge_init(&merge, sources, heap, NUM_SOURCES);
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, rc);
+}
+
+TEST(BH1750Merge, ThousandSources)
+{
+    static BH1750MergeEntry entries_large[NUM_SOURCES_LARGE][QUEUE_CAPACITY_LARGE];
+    static BH1750MergeSource sources_large[NUM_SOURCES_LARGE];
+    static size_t heap_large[NUM_SOURCES_LARGE];
+    for (size_t i = 0; i < NUM_SOURCES_LARGE; i++) {
+        sources_large[i].entries = entries_large[i];
+        sources_large[i].capacity = QUEUE_CAPACITY_LARGE;
+    }
+    uint8_t rc = bh1750_merge_init(&merge, sources_large, heap_large, NUM_SOURCES_LARGE);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    /* Every sensor samples once per second, with a different phase. After a sample, it promises that the next one is at
+     * least a second later, so that every round can be output completely. */
+    uint32_t num_popped = 0;
+    uint32_t last_time_ms = 0;
+    for (uint32_t round = 0; round < 10; round++) {
+        for (size_t i = 0; i < NUM_SOURCES_LARGE; i++) {
+            uint32_t time_ms = (round * 1000) + (uint32_t)((i * 7) % 1000);
+            push(i, (uint32_t)i, time_ms);
+            bh1750_merge_advance_watermark(&merge, i, time_ms + 1000);
+        }
+        BH1750MergeItem items[64];
+        size_t n;
+        do {
+            n = pop(items, 64);
+            for (size_t j = 0; j < n; j++) {
+                CHECK_TRUE(items[j].time_ms >= last_time_ms);
+                last_time_ms = items[j].time_ms;
+            }
+            num_popped += n;
+        } while (n > 0);
+        CHECK_EQUAL((round + 1) * NUM_SOURCES_LARGE, num_popped);
+    }
+}
@@ -0,0 +1,250 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_metrics.h"
+/* Included to know the size of BH1750 instances to return from get_instance_memory */
+#include "bh1750_private.h"
+
+#define NUM_INSTANCES 2
+
+static struct BH1750Struct instance_memory[NUM_INSTANCES];
+static size_t num_instances_created;
+static BH1750 inst[NUM_INSTANCES];
+static BH1750MetricsTarget targets[NUM_INSTANCES];
+static uint32_t fake_time_ms;
+
+/* I2C transactions are completed by the test, after the driver started them */
+static BH1750_I2CCompleteCb i2c_cb;
+static void *i2c_cb_user_data;
+static uint8_t i2c_read_data[2];
+
+static void *get_instance_memory(void *user_data)
+{
+    (void)user_data;
+    return &instance_memory[num_instances_created++];
+}
+
+static void i2c_write(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                      void *cb_user_data)
+{
+    (void)data;
+    (void)length;
+    (void)i2c_addr;
+    (void)user_data;
+    i2c_cb = cb;
+    i2c_cb_user_data = cb_user_data;
+}
+
+static void i2c_read(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                     void *cb_user_data)
+{
+    (void)i2c_addr;
+    (void)user_data;
+    memcpy(data, i2c_read_data, length);
+    i2c_cb = cb;
+    i2c_cb_user_data = cb_user_data;
+}
+
+static void start_timer(uint32_t duration_ms, void *user_data, BH1750TimerExpiredCb cb, void *cb_user_data)
+{
+    (void)duration_ms;
+    (void)user_data;
+    (void)cb;
+    (void)cb_user_data;
+}
+
+static uint32_t get_time(void *user_data)
+{
+    (void)user_data;
+    return fake_time_ms;
+}
+
+static void complete_i2c(uint8_t result_code, uint32_t latency_ms)
+{
+    fake_time_ms += latency_ms;
+    i2c_cb(result_code, i2c_cb_user_data);
+}
+
+// clang-format off
+TEST_GROUP(BH1750Metrics)
+{
+    void setup() {
+        num_instances_created = 0;
+        fake_time_ms = 0;
+        const uint8_t i2c_addr[NUM_INSTANCES] = {0x23, 0x5C};
+        for (size_t i = 0; i < NUM_INSTANCES; i++) {
+            BH1750InitConfig cfg = {};
+            cfg.get_instance_memory = get_instance_memory;
+            cfg.i2c_write = i2c_write;
+            cfg.i2c_read = i2c_read;
+            cfg.start_timer = start_timer;
+            cfg.i2c_addr = i2c_addr[i];
+            cfg.get_time = get_time;
+            uint8_t rc = bh1750_create(&inst[i], &cfg);
+            CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+            targets[i].inst = inst[i];
+            targets[i].bus = "i2c-1";
+            targets[i].i2c_addr = i2c_addr[i];
+        }
+    }
+};
+// clang-format on
+
+static void init_instances()
+{
+    /* Instance 0: init with a startup profile that starts continuous measurement - 4 writes */
+    BH1750StartupProfile profile = {69, true, BH1750_MEAS_MODE_H_RES};
+    uint8_t rc = bh1750_init(inst[0], &profile, NULL, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    complete_i2c(BH1750_I2C_RESULT_CODE_OK, 1);
+    complete_i2c(BH1750_I2C_RESULT_CODE_OK, 3);
+    complete_i2c(BH1750_I2C_RESULT_CODE_OK, 7);
+    complete_i2c(BH1750_I2C_RESULT_CODE_OK, 150);
+
+    /* One read, and one call rejected while the read is in progress */
+    i2c_read_data[0] = 0x00;
+    i2c_read_data[1] = 0x64;
+    rc = bh1750_read_continuous_measurement(inst[0], NULL, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    rc = bh1750_read_continuous_measurement(inst[0], NULL, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_BUSY, rc);
+    complete_i2c(BH1750_I2C_RESULT_CODE_OK, 0);
+
+    /* Instance 1: power on command fails */
+    rc = bh1750_init(inst[1], NULL, NULL, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    complete_i2c(BH1750_I2C_RESULT_CODE_ERR, 200);
+}
+
+TEST(BH1750Metrics, WritesAllFamilies)
+{
+    init_instances();
+
+    static char buf[4096];
+    size_t len;
+    uint8_t rc = bh1750_metrics_write(targets, NUM_INSTANCES, buf, sizeof(buf), &len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    const char *expected = "# TYPE bh1750_i2c_transactions counter\n"
+                           "# HELP bh1750_i2c_transactions Started I2C transactions.\n"
+                           "bh1750_i2c_transactions_total{bus=\"i2c-1\",addr=\"0x23\",op=\"write\"} 4\n"
+                           "bh1750_i2c_transactions_total{bus=\"i2c-1\",addr=\"0x23\",op=\"read\"} 1\n"
+                           "bh1750_i2c_transactions_total{bus=\"i2c-1\",addr=\"0x5c\",op=\"write\"} 1\n"
+                           "bh1750_i2c_transactions_total{bus=\"i2c-1\",addr=\"0x5c\",op=\"read\"} 0\n"
+                           "# TYPE bh1750_i2c_errors counter\n"
+                           "# HELP bh1750_i2c_errors Failed I2C transactions.\n"
+                           "bh1750_i2c_errors_total{bus=\"i2c-1\",addr=\"0x23\"} 0\n"
+                           "bh1750_i2c_errors_total{bus=\"i2c-1\",addr=\"0x5c\"} 1\n"
+                           "# TYPE bh1750_busy_rejections counter\n"
+                           "# HELP bh1750_busy_rejections Calls rejected because another sequence was in progress.\n"
+                           "bh1750_busy_rejections_total{bus=\"i2c-1\",addr=\"0x23\"} 1\n"
+                           "bh1750_busy_rejections_total{bus=\"i2c-1\",addr=\"0x5c\"} 0\n"
+                           "# TYPE bh1750_samples counter\n"
+                           "# HELP bh1750_samples Raw measurements read out.\n"
+                           "bh1750_samples_total{bus=\"i2c-1\",addr=\"0x23\"} 1\n"
+                           "bh1750_samples_total{bus=\"i2c-1\",addr=\"0x5c\"} 0\n"
+                           "# TYPE bh1750_suppressed_measurements counter\n"
+                           "# HELP bh1750_suppressed_measurements Measurements not passed to the read callback.\n"
+                           "bh1750_suppressed_measurements_total{bus=\"i2c-1\",addr=\"0x23\"} 0\n"
+                           "bh1750_suppressed_measurements_total{bus=\"i2c-1\",addr=\"0x5c\"} 0\n"
+                           "# TYPE bh1750_i2c_latency_milliseconds histogram\n"
+                           "# HELP bh1750_i2c_latency_milliseconds Latency of completed I2C transactions.\n"
+                           "# UNIT bh1750_i2c_latency_milliseconds milliseconds\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x23\",le=\"1\"} 2\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x23\",le=\"2\"} 2\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x23\",le=\"5\"} 3\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x23\",le=\"10\"} 4\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x23\",le=\"20\"} 4\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x23\",le=\"50\"} 4\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x23\",le=\"100\"} 4\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x23\",le=\"+Inf\"} 5\n"
+                           "bh1750_i2c_latency_milliseconds_count{bus=\"i2c-1\",addr=\"0x23\"} 5\n"
+                           "bh1750_i2c_latency_milliseconds_sum{bus=\"i2c-1\",addr=\"0x23\"} 161\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x5c\",le=\"1\"} 0\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x5c\",le=\"2\"} 0\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x5c\",le=\"5\"} 0\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x5c\",le=\"10\"} 0\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x5c\",le=\"20\"} 0\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x5c\",le=\"50\"} 0\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x5c\",le=\"100\"} 0\n"
+                           "bh1750_i2c_latency_milliseconds_bucket{bus=\"i2c-1\",addr=\"0x5c\",le=\"+Inf\"} 1\n"
+                           "bh1750_i2c_latency_milliseconds_count{bus=\"i2c-1\",addr=\"0x5c\"} 1\n"
+                           "bh1750_i2c_latency_milliseconds_sum{bus=\"i2c-1\",addr=\"0x5c\"} 200\n"
+                           "# EOF\n";
+    STRCMP_EQUAL(expected, buf);
+    CHECK_EQUAL(strlen(expected), len);
+}
+
+TEST(BH1750Metrics, EscapesBusLabel)
+{
+    targets[0].bus = "a\"b\\c\nd";
+    static char buf[4096];
+    size_t len;
+    uint8_t rc = bh1750_metrics_write(targets, 1, buf, sizeof(buf), &len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_TRUE(strstr(buf, "bh1750_samples_total{bus=\"a\\\"b\\\\c\\nd\",addr=\"0x23\"} 0\n") != NULL);
+}
+
+TEST(BH1750Metrics, BufferTooSmall)
+{
+    init_instances();
+    static char buf[4096];
+    size_t len;
+    uint8_t rc = bh1750_metrics_write(targets, NUM_INSTANCES, buf, sizeof(buf), &len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    /* No space for the terminating null character */
+    size_t len_2 = 0xFF;
+    rc = bh1750_metrics_write(targets, NUM_INSTANCES, buf, len, &len_2);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OUT_OF_MEMORY, rc);
+    CHECK_EQUAL(0xFF, len_2);
+    rc = bh1750_metrics_write(targets, NUM_INSTANCES, buf, 0, &len_2);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OUT_OF_MEMORY, rc);
+
+    rc = bh1750_metrics_write(targets, NUM_INSTANCES, buf, len + 1, &len_2);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(len, len_2);
+}
+
+TEST(BH1750Metrics, NoTargets)
+{
+    static char buf[4096];
+    size_t len;
+    uint8_t rc = bh1750_metrics_write(NULL, 0, buf, sizeof(buf), &len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    /* Only the family metadata */
+    CHECK_TRUE(strstr(buf, "_total") == NULL);
+    STRCMP_EQUAL("# EOF\n", &buf[len - 6]);
+}
+
+TEST(BH1750Metrics, CountersAreSnapshotOncePerTarget)
+{
+    init_instances();
+    static char buf[4096];
+    size_t len;
+    uint8_t rc = bh1750_metrics_write(targets, NUM_INSTANCES, buf, sizeof(buf), &len);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+    for (size_t i = 0; i < NUM_INSTANCES; i++) {
+        BH1750Counters counters;
+        rc = bh1750_get_counters(inst[i], &counters);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        MEMCMP_EQUAL(&counters, &targets[i].counters, sizeof(counters));
+    }
+}
+
+TEST(BH1750Metrics, InvalidArgs)
+{
+    char buf[16];
+    size_t len;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_metrics_write(NULL, 1, buf, sizeof(buf), &len));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_metrics_write(targets, 1, NULL, sizeof(buf), &len));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_metrics_write(targets, 1, buf, sizeof(buf), NULL));
+    targets[1].bus = NULL;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_metrics_write(targets, 2, buf, sizeof(buf), &len));
+
+    BH1750Counters counters;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_counters(NULL, &counters));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_get_counters(inst[0], NULL));
+}
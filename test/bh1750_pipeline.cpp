@@ -0,0 +1,175 @@
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_pipeline.h"
+
+/* State of scale_stage: multiplier applied to meas_lx, and number of times the stage was executed */
+typedef struct {
+    uint32_t multiplier;
+    size_t call_count;
+} ScaleState;
+
+/* State of threshold_stage: measurements with meas_lx below min_lx are dropped */
+typedef struct {
+    uint32_t min_lx;
+    size_t call_count;
+} ThresholdState;
+
+static bool scale_stage(BH1750Measurement *meas, void *state)
+{
+    ScaleState *s = (ScaleState *)state;
+    s->call_count++;
+    meas->meas_lx *= s->multiplier;
+    return true;
+}
+
+static bool threshold_stage(BH1750Measurement *meas, void *state)
+{
+    ThresholdState *s = (ThresholdState *)state;
+    s->call_count++;
+    return meas->meas_lx >= s->min_lx;
+}
+
+static ScaleState scale_state;
+static ThresholdState threshold_state;
+static ScaleState scale_state_2;
+static BH1750PipelineStage stages[3];
+static BH1750Pipeline pipeline;
+
+// clang-format off
+TEST_GROUP(BH1750Pipeline)
+{
+    void setup() {
+        scale_state.multiplier = 2;
+        scale_state.call_count = 0;
+        threshold_state.min_lx = 100;
+        threshold_state.call_count = 0;
+        scale_state_2.multiplier = 3;
+        scale_state_2.call_count = 0;
+
+        /* Scale by 2, drop below 100 lx, scale by 3 */
+        stages[0].fn = scale_stage;
+        stages[0].state = &scale_state;
+        stages[1].fn = threshold_stage;
+        stages[1].state = &threshold_state;
+        stages[2].fn = scale_stage;
+        stages[2].state = &scale_state_2;
+        uint8_t rc = bh1750_pipeline_init(&pipeline, stages, 3);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+static BH1750Measurement make_meas(uint32_t meas_lx)
+{
+    BH1750Measurement meas;
+    meas.meas_lx = meas_lx;
+    meas.raw_meas = (uint16_t)meas_lx;
+    meas.meas_mode = BH1750_MEAS_MODE_H_RES;
+    meas.meas_time = 69;
+    return meas;
+}
+
+TEST(BH1750Pipeline, InitInvalidArgs)
+{
+    BH1750Pipeline other_pipeline;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_pipeline_init(NULL, stages, 3));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_pipeline_init(&other_pipeline, NULL, 3));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_pipeline_init(&other_pipeline, stages, 0));
+
+    BH1750PipelineStage stages_with_null_fn[2] = {{scale_stage, &scale_state}, {NULL, NULL}};
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_pipeline_init(&other_pipeline, stages_with_null_fn, 2));
+}
+
+TEST(BH1750Pipeline, ProcessRunsAllStagesInOrder)
+{
+    BH1750Measurement meas = make_meas(50);
+    CHECK_TRUE(bh1750_pipeline_process(&meas, &pipeline));
+    /* 50 * 2 = 100 passes the threshold, then 100 * 3 */
+    CHECK_EQUAL(300, meas.meas_lx);
+    CHECK_EQUAL(1, scale_state.call_count);
+    CHECK_EQUAL(1, threshold_state.call_count);
+    CHECK_EQUAL(1, scale_state_2.call_count);
+}
+
+TEST(BH1750Pipeline, ProcessDropExitsEarly)
+{
+    BH1750Measurement meas = make_meas(49);
+    CHECK_FALSE(bh1750_pipeline_process(&meas, &pipeline));
+    CHECK_EQUAL(98, meas.meas_lx);
+    /* Stage after the dropping stage is not executed */
+    CHECK_EQUAL(0, scale_state_2.call_count);
+}
+
+TEST(BH1750Pipeline, ProcessInvalidArgs)
+{
+    BH1750Measurement meas = make_meas(50);
+    CHECK_FALSE(bh1750_pipeline_process(NULL, &pipeline));
+    CHECK_FALSE(bh1750_pipeline_process(&meas, NULL));
+    CHECK_EQUAL(0, scale_state.call_count);
+}
+
+TEST(BH1750Pipeline, ProcessBatchReturnsKeptIndices)
+{
+    BH1750Measurement meas[] = {make_meas(10), make_meas(60), make_meas(49), make_meas(50), make_meas(1)};
+    size_t kept_idx[5];
+    size_t num_kept = 0xFF;
+    uint8_t rc = bh1750_pipeline_process_batch(&pipeline, meas, 5, kept_idx, &num_kept);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    CHECK_EQUAL(2, num_kept);
+    CHECK_EQUAL(1, kept_idx[0]);
+    CHECK_EQUAL(3, kept_idx[1]);
+    /* Kept measurements are processed in place */
+    CHECK_EQUAL(360, meas[1].meas_lx);
+    CHECK_EQUAL(60, meas[1].raw_meas);
+    CHECK_EQUAL(300, meas[3].meas_lx);
+    CHECK_EQUAL(50, meas[3].raw_meas);
+    /* Every stage is only executed for measurements that passed the previous stages */
+    CHECK_EQUAL(5, scale_state.call_count);
+    CHECK_EQUAL(5, threshold_state.call_count);
+    CHECK_EQUAL(2, scale_state_2.call_count);
+}
+
+TEST(BH1750Pipeline, ProcessBatchMatchesProcess)
+{
+    const uint32_t meas_lx[] = {0, 49, 50, 51, 1000, 7, 100};
+    const size_t num_meas = sizeof(meas_lx) / sizeof(meas_lx[0]);
+    BH1750Measurement batch[sizeof(meas_lx) / sizeof(meas_lx[0])];
+    for (size_t i = 0; i < num_meas; i++) {
+        batch[i] = make_meas(meas_lx[i]);
+    }
+    size_t kept_idx[sizeof(meas_lx) / sizeof(meas_lx[0])];
+    size_t num_kept;
+    bh1750_pipeline_process_batch(&pipeline, batch, num_meas, kept_idx, &num_kept);
+
+    size_t num_kept_single = 0;
+    for (size_t i = 0; i < num_meas; i++) {
+        BH1750Measurement meas = make_meas(meas_lx[i]);
+        if (bh1750_pipeline_process(&meas, &pipeline)) {
+            CHECK_EQUAL(i, kept_idx[num_kept_single]);
+            CHECK_EQUAL(meas.meas_lx, batch[i].meas_lx);
+            num_kept_single++;
+        }
+    }
+    CHECK_EQUAL(num_kept_single, num_kept);
+}
+
+TEST(BH1750Pipeline, ProcessBatchEmpty)
+{
+    size_t num_kept = 0xFF;
+    BH1750Measurement meas[1];
+    size_t kept_idx[1];
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_pipeline_process_batch(&pipeline, meas, 0, kept_idx, &num_kept));
+    CHECK_EQUAL(0, num_kept);
+    CHECK_EQUAL(0, scale_state.call_count);
+}
+
+TEST(BH1750Pipeline, ProcessBatchInvalidArgs)
+{
+    BH1750Measurement meas[1];
+    size_t kept_idx[1];
+    size_t num_kept;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_pipeline_process_batch(NULL, meas, 1, kept_idx, &num_kept));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_pipeline_process_batch(&pipeline, NULL, 1, kept_idx, &num_kept));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_pipeline_process_batch(&pipeline, meas, 1, NULL, &num_kept));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_pipeline_process_batch(&pipeline, meas, 1, kept_idx, NULL));
+}
@@ -0,0 +1,330 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_prefetch.h"
+/* Included to know the size of BH1750 instances to return from get_instance_memory */
+#include "bh1750_private.h"
+
+/* H-resolution mode with default measurement time */
+#define MEAS_DURATION_MS 180
+#define PERIOD_MS 1000
+#define MAX_NUM_TIMERS 4
+
+static struct BH1750Struct instance_memory;
+static BH1750 inst;
+static BH1750Prefetch prefetch;
+static BH1750PrefetchConfig cfg;
+
+static uint32_t now_ms;
+static uint16_t sensor_raw;
+static bool fail_reads;
+static size_t num_one_time_cmds;
+
+typedef struct {
+    bool is_active;
+    uint32_t deadline_ms;
+    BH1750TimerExpiredCb cb;
+    void *cb_user_data;
+} FakeTimer;
+static FakeTimer timers[MAX_NUM_TIMERS];
+
+static size_t num_read_cbs;
+static uint8_t read_cb_rc;
+static BH1750Measurement read_cb_meas;
+static uint32_t read_cb_time_ms;
+
+static void *get_instance_memory(void *user_data)
+{
+    (void)user_data;
+    return &instance_memory;
+}
+
+static void fake_write(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                       void *cb_user_data)
+{
+    (void)length;
+    (void)i2c_addr;
+    (void)user_data;
+    if (data[0] == 0x20) {
+        num_one_time_cmds++;
+    }
+    cb(BH1750_I2C_RESULT_CODE_OK, cb_user_data);
+}
+
+static void fake_read(uint8_t *data, size_t length, uint8_t i2c_addr, void *user_data, BH1750_I2CCompleteCb cb,
+                      void *cb_user_data)
+{
+    (void)length;
+    (void)i2c_addr;
+    (void)user_data;
+    data[0] = (uint8_t)(sensor_raw >> 8);
+    data[1] = (uint8_t)sensor_raw;
+    cb(fail_reads ? BH1750_I2C_RESULT_CODE_ERR : BH1750_I2C_RESULT_CODE_OK, cb_user_data);
+}
+
+static void fake_start_timer(uint32_t duration_ms, void *user_data, BH1750TimerExpiredCb cb, void *cb_user_data)
+{
+    (void)user_data;
+    for (size_t i = 0; i < MAX_NUM_TIMERS; i++) {
+        if (!timers[i].is_active) {
+            timers[i].is_active = true;
+            timers[i].deadline_ms = now_ms + duration_ms;
+            timers[i].cb = cb;
+            timers[i].cb_user_data = cb_user_data;
+            return;
+        }
+    }
+    FAIL("Too many timers");
+}
+
+static uint32_t fake_get_time(void *user_data)
+{
+    (void)user_data;
+    return now_ms;
+}
+
+/* Fire all timers that expire until time_ms, in order of their deadlines */
+static void advance_to(uint32_t time_ms)
+{
+    for (;;) {
+        FakeTimer *next = NULL;
+        for (size_t i = 0; i < MAX_NUM_TIMERS; i++) {
+            if (timers[i].is_active && (timers[i].deadline_ms <= time_ms) &&
+                (!next || (timers[i].deadline_ms < next->deadline_ms))) {
+                next = &timers[i];
+            }
+        }
+        if (!next) {
+            break;
+        }
+        now_ms = next->deadline_ms;
+        next->is_active = false;
+        next->cb(next->cb_user_data);
+    }
+    now_ms = time_ms;
+}
+
+static void read_cb(uint8_t result_code, const BH1750Measurement *meas, void *user_data)
+{
+    (void)user_data;
+    num_read_cbs++;
+    read_cb_rc = result_code;
+    if (meas) {
+        read_cb_meas = *meas;
+    }
+    read_cb_time_ms = now_ms;
+}
+
+static BH1750PrefetchStats get_stats()
+{
+    BH1750PrefetchStats stats;
+    uint8_t rc = bh1750_prefetch_get_stats(&prefetch, &stats);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return stats;
+}
+
+/* Request at time_ms and wait until the read cb is executed. Returns the latency of the request. */
+static uint32_t request_at(uint32_t time_ms)
+{
+    advance_to(time_ms);
+    size_t num_read_cbs_before = num_read_cbs;
+    uint8_t rc = bh1750_prefetch_request(&prefetch, read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    while (num_read_cbs == num_read_cbs_before) {
+        advance_to(now_ms + 1);
+    }
+    return read_cb_time_ms - time_ms;
+}
+
+// clang-format off
+TEST_GROUP(BH1750Prefetch)
+{
+    void setup() {
+        memset(&instance_memory, 0, sizeof(instance_memory));
+        memset(timers, 0, sizeof(timers));
+        now_ms = 0;
+        sensor_raw = 0x78;
+        fail_reads = false;
+        num_one_time_cmds = 0;
+        num_read_cbs = 0;
+        read_cb_rc = 0xFF;
+
+        BH1750InitConfig init_cfg = {};
+        init_cfg.get_instance_memory = get_instance_memory;
+        init_cfg.i2c_write = fake_write;
+        init_cfg.i2c_read = fake_read;
+        init_cfg.start_timer = fake_start_timer;
+        init_cfg.i2c_addr = 0x23;
+        init_cfg.get_time = fake_get_time;
+        uint8_t rc = bh1750_create(&inst, &init_cfg);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        rc = bh1750_init(inst, NULL, NULL, NULL);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+
+        cfg = {};
+        cfg.inst = inst;
+        cfg.meas_mode = BH1750_MEAS_MODE_H_RES;
+        cfg.start_timer = fake_start_timer;
+        cfg.get_time = fake_get_time;
+        cfg.period_shift = 2;
+        cfg.lead_ms = 10;
+        cfg.max_age_ms = 100;
+        rc = bh1750_prefetch_init(&prefetch, &cfg);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+TEST(BH1750Prefetch, PeriodicRequestsHitCache)
+{
+    /* The first two requests have to wait for the measurement, the period is known after the second one */
+    CHECK_EQUAL(MEAS_DURATION_MS, request_at(0));
+    CHECK_EQUAL(MEAS_DURATION_MS, request_at(PERIOD_MS));
+    for (uint32_t i = 2; i < 10; i++) {
+        CHECK_EQUAL(0, request_at(i * PERIOD_MS));
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, read_cb_rc);
+        CHECK_EQUAL(0x78, read_cb_meas.raw_meas);
+    }
+
+    BH1750PrefetchStats stats = get_stats();
+    CHECK_EQUAL(10, stats.num_requests);
+    CHECK_EQUAL(8, stats.num_hits);
+    CHECK_EQUAL(2, stats.num_misses);
+    CHECK_EQUAL(0, stats.num_late);
+    CHECK_EQUAL(0, stats.num_wasted);
+    CHECK_EQUAL(80, stats.hit_rate_pct);
+    CHECK_EQUAL(PERIOD_MS, stats.period_ms);
+    /* No measurement is taken that is not returned */
+    CHECK_EQUAL(10, num_one_time_cmds);
+}
+
+TEST(BH1750Prefetch, CachedMeasurementIsFresh)
+{
+    request_at(0);
+    request_at(PERIOD_MS);
+    /* The prefetch completes lead_ms before the predicted request */
+    sensor_raw = 0x100;
+    advance_to((2 * PERIOD_MS) - cfg.lead_ms);
+    CHECK_EQUAL(2, num_read_cbs);
+    CHECK_EQUAL(0, request_at(2 * PERIOD_MS));
+    CHECK_EQUAL(0x100, read_cb_meas.raw_meas);
+}
+
+TEST(BH1750Prefetch, EarlyRequestWaitsForPrefetch)
+{
+    request_at(0);
+    request_at(PERIOD_MS);
+    /* The prefetch starts at 1810 ms and completes at 1990 ms */
+    CHECK_EQUAL(90, request_at(1900));
+    BH1750PrefetchStats stats = get_stats();
+    CHECK_EQUAL(1, stats.num_late);
+    CHECK_EQUAL(0, stats.num_hits);
+    CHECK_EQUAL(3, num_one_time_cmds);
+}
+
+TEST(BH1750Prefetch, ExpiredPrefetchIsWasted)
+{
+    request_at(0);
+    request_at(PERIOD_MS);
+    /* The consumer stops requesting - the prefetched measurement expires */
+    advance_to(3 * PERIOD_MS);
+    CHECK_EQUAL(MEAS_DURATION_MS, request_at(3 * PERIOD_MS));
+    BH1750PrefetchStats stats = get_stats();
+    CHECK_EQUAL(1, stats.num_wasted);
+    CHECK_EQUAL(3, stats.num_misses);
+    CHECK_EQUAL(0, stats.num_hits);
+}
+
+TEST(BH1750Prefetch, LearnsChangedPeriod)
+{
+    uint32_t time_ms = 0;
+    for (size_t i = 0; i < 3; i++) {
+        request_at(time_ms);
+        time_ms += PERIOD_MS;
+    }
+    for (size_t i = 0; i < 20; i++) {
+        request_at(time_ms);
+        time_ms += 500;
+    }
+    CHECK_TRUE(get_stats().period_ms < 510);
+    CHECK_EQUAL(0, request_at(time_ms));
+}
+
+TEST(BH1750Prefetch, LearnsPeriodChangeSmallerThanWeight)
+{
+    /* period_shift is 2, the new interval differs from the learned period by less than 2^2 ms */
+    uint32_t time_ms = 0;
+    for (size_t i = 0; i < 3; i++) {
+        request_at(time_ms);
+        time_ms += PERIOD_MS;
+    }
+    CHECK_EQUAL(PERIOD_MS, get_stats().period_ms);
+    for (size_t i = 0; i < 20; i++) {
+        request_at(time_ms);
+        time_ms += PERIOD_MS + 3;
+    }
+    CHECK_EQUAL(PERIOD_MS + 3, get_stats().period_ms);
+}
+
+TEST(BH1750Prefetch, FailedReadIsReported)
+{
+    fail_reads = true;
+    request_at(0);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, read_cb_rc);
+    request_at(PERIOD_MS);
+    CHECK_EQUAL(BH1750_RESULT_CODE_IO_ERR, read_cb_rc);
+    /* Failed prefetch is not cached */
+    advance_to((2 * PERIOD_MS) + 200);
+    fail_reads = false;
+    CHECK_EQUAL(MEAS_DURATION_MS, request_at((2 * PERIOD_MS) + 200));
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, read_cb_rc);
+    CHECK_EQUAL(0, get_stats().num_hits);
+}
+
+TEST(BH1750Prefetch, SuppressedReadCompletesRequest)
+{
+    /* Every measurement after the first one is inside the deadband */
+    BH1750ChangeNotifyConfig notify_cfg = {0, UINT32_MAX, 1000};
+    uint8_t rc = bh1750_set_change_notify(inst, &notify_cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    request_at(0);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, read_cb_rc);
+    request_at(PERIOD_MS);
+    CHECK_EQUAL(BH1750_RESULT_CODE_SUPPRESSED, read_cb_rc);
+    /* The suppressed prefetch is not cached, and the request after it is not rejected as busy */
+    CHECK_EQUAL(MEAS_DURATION_MS, request_at(2 * PERIOD_MS));
+    CHECK_EQUAL(BH1750_RESULT_CODE_SUPPRESSED, read_cb_rc);
+    CHECK_EQUAL(0, get_stats().num_hits);
+}
+
+TEST(BH1750Prefetch, RequestWhileWaitingIsBusy)
+{
+    uint8_t rc = bh1750_prefetch_request(&prefetch, read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    rc = bh1750_prefetch_request(&prefetch, read_cb, NULL);
+    CHECK_EQUAL(BH1750_RESULT_CODE_BUSY, rc);
+    CHECK_EQUAL(1, get_stats().num_requests);
+}
+
+TEST(BH1750Prefetch, InvalidArgs)
+{
+    BH1750PrefetchStats stats;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_prefetch_init(NULL, &cfg));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_prefetch_init(&prefetch, NULL));
+    BH1750PrefetchConfig invalid_cfg = cfg;
+    invalid_cfg.inst = NULL;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_prefetch_init(&prefetch, &invalid_cfg));
+    invalid_cfg = cfg;
+    invalid_cfg.get_time = NULL;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_prefetch_init(&prefetch, &invalid_cfg));
+    invalid_cfg = cfg;
+    invalid_cfg.period_shift = 9;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_prefetch_init(&prefetch, &invalid_cfg));
+    invalid_cfg = cfg;
+    invalid_cfg.max_age_ms = 0;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_prefetch_init(&prefetch, &invalid_cfg));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_prefetch_request(NULL, read_cb, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_prefetch_get_stats(NULL, &stats));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_prefetch_get_stats(&prefetch, NULL));
+}
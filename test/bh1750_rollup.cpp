@@ -0,0 +1,196 @@
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_rollup.h"
+
+/* Three levels: 1 s, 4 s and 16 s buckets */
+static BH1750RollupEntry entries_0[4];
+static BH1750RollupEntry entries_1[4];
+static BH1750RollupEntry entries_2[2];
+static BH1750RollupLevel levels[3];
+static BH1750Rollup rollup;
+
+// clang-format off
+TEST_GROUP(BH1750Rollup)
+{
+    void setup() {
+        levels[0].entries = entries_0;
+        levels[0].capacity = 4;
+        levels[0].resolution_s = 1;
+        levels[1].entries = entries_1;
+        levels[1].capacity = 4;
+        levels[1].resolution_s = 4;
+        levels[2].entries = entries_2;
+        levels[2].capacity = 2;
+        levels[2].resolution_s = 16;
+        uint8_t rc = bh1750_rollup_init(&rollup, levels, 3);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+static void add(uint32_t meas_lx, uint32_t time_s)
+{
+    BH1750Measurement meas = {meas_lx, 0, BH1750_MEAS_MODE_H_RES, 69};
+    uint8_t rc = bh1750_rollup_add(&rollup, &meas, time_s);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+static BH1750RollupEntry get_entry(size_t level, size_t age)
+{
+    BH1750RollupEntry entry;
+    uint8_t rc = bh1750_rollup_get_entry(&rollup, level, age, &entry);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return entry;
+}
+
+TEST(BH1750Rollup, SamplesInSameBucketAreAggregated)
+{
+    add(100, 10);
+    add(300, 10);
+    add(200, 10);
+
+    BH1750RollupEntry entry = get_entry(0, 0);
+    CHECK_EQUAL(10, entry.start_s);
+    CHECK_EQUAL(3, entry.num_samples);
+    CHECK_EQUAL(100, entry.min_lx);
+    CHECK_EQUAL(300, entry.max_lx);
+    CHECK_EQUAL(600, entry.sum_lx);
+    /* Bucket is still open, so it has not been merged into the coarser level */
+    BH1750RollupEntry coarse;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_get_entry(&rollup, 1, 0, &coarse));
+}
+
+TEST(BH1750Rollup, ClosedBucketsPropagateToCoarserLevels)
+{
+    for (uint32_t t = 0; t < 17; t++) {
+        add(t, t);
+    }
+
+    /* Finest level keeps the last 4 seconds */
+    CHECK_EQUAL(16, get_entry(0, 0).start_s);
+    CHECK_EQUAL(13, get_entry(0, 3).start_s);
+    /* 4 s level: buckets 0, 4, 8 and 12. Bucket 12 contains seconds 12 to 15, since second 15 was closed by 16. */
+    CHECK_EQUAL(12, get_entry(1, 0).start_s);
+    CHECK_EQUAL(4, get_entry(1, 0).num_samples);
+    CHECK_EQUAL(12 + 13 + 14 + 15, get_entry(1, 0).sum_lx);
+    CHECK_EQUAL(0, get_entry(1, 3).start_s);
+    /* 16 s level: bucket 0 contains buckets 0, 4 and 8 of the 4 s level. Bucket 12 is still open. */
+    CHECK_EQUAL(0, get_entry(2, 0).start_s);
+    CHECK_EQUAL(12, get_entry(2, 0).num_samples);
+    CHECK_EQUAL(0, get_entry(2, 0).min_lx);
+    CHECK_EQUAL(11, get_entry(2, 0).max_lx);
+}
+
+TEST(BH1750Rollup, RingBufferOverwritesOldestEntries)
+{
+    for (uint32_t t = 0; t < 6; t++) {
+        add(t, t);
+    }
+    CHECK_EQUAL(5, get_entry(0, 0).start_s);
+    CHECK_EQUAL(2, get_entry(0, 3).start_s);
+    BH1750RollupEntry entry;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_get_entry(&rollup, 0, 4, &entry));
+}
+
+TEST(BH1750Rollup, GapsSkipBuckets)
+{
+    add(100, 0);
+    add(200, 100);
+    CHECK_EQUAL(100, get_entry(0, 0).start_s);
+    CHECK_EQUAL(0, get_entry(0, 1).start_s);
+    /* Second 0 propagated to the 4 s level */
+    CHECK_EQUAL(0, get_entry(1, 0).start_s);
+    CHECK_EQUAL(100, get_entry(1, 0).sum_lx);
+}
+
+TEST(BH1750Rollup, Query)
+{
+    for (uint32_t t = 0; t < 17; t++) {
+        add(t * 10, t);
+    }
+
+    BH1750RollupEntry result;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_rollup_query(&rollup, 1, 4, 12, &result));
+    /* Buckets 4 and 8 */
+    CHECK_EQUAL(4, result.start_s);
+    CHECK_EQUAL(8, result.num_samples);
+    CHECK_EQUAL(40, result.min_lx);
+    CHECK_EQUAL(110, result.max_lx);
+    CHECK_EQUAL(600, result.sum_lx);
+
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_rollup_query(&rollup, 0, 14, 17, &result));
+    CHECK_EQUAL(3, result.num_samples);
+    CHECK_EQUAL(140 + 150 + 160, result.sum_lx);
+
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_rollup_query(&rollup, 0, 100, 200, &result));
+    CHECK_EQUAL(0, result.num_samples);
+}
+
+TEST(BH1750Rollup, QueryOfOlderRangeInWrappedRingBuffer)
+{
+    /* Level 0 keeps seconds 6 to 9, and the ring buffer has wrapped around */
+    for (uint32_t t = 0; t < 10; t++) {
+        add(t * 10, t);
+    }
+
+    BH1750RollupEntry result;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_rollup_query(&rollup, 0, 7, 9, &result));
+    CHECK_EQUAL(7, result.start_s);
+    CHECK_EQUAL(2, result.num_samples);
+    CHECK_EQUAL(70 + 80, result.sum_lx);
+
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_rollup_query(&rollup, 0, 0, 7, &result));
+    CHECK_EQUAL(6, result.start_s);
+    CHECK_EQUAL(1, result.num_samples);
+
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_rollup_query(&rollup, 0, 0, 6, &result));
+    CHECK_EQUAL(0, result.num_samples);
+}
+
+TEST(BH1750Rollup, CapacityOfOne)
+{
+    BH1750RollupEntry fine[1];
+    BH1750RollupEntry coarse[1];
+    BH1750RollupLevel small_levels[2] = {{fine, 1, 1, 0, 0}, {coarse, 1, 2, 0, 0}};
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_rollup_init(&rollup, small_levels, 2));
+    add(5, 0);
+    add(7, 1);
+    add(9, 2);
+    CHECK_EQUAL(2, get_entry(0, 0).start_s);
+    CHECK_EQUAL(0, get_entry(1, 0).start_s);
+    CHECK_EQUAL(12, get_entry(1, 0).sum_lx);
+}
+
+TEST(BH1750Rollup, AddOlderThanNewestBucketFails)
+{
+    add(100, 10);
+    BH1750Measurement meas = {100, 0, BH1750_MEAS_MODE_H_RES, 69};
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_add(&rollup, &meas, 9));
+    CHECK_EQUAL(1, get_entry(0, 0).num_samples);
+}
+
+TEST(BH1750Rollup, InitInvalidArgs)
+{
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_init(NULL, levels, 3));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_init(&rollup, NULL, 3));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_init(&rollup, levels, 0));
+
+    levels[1].resolution_s = 3;
+    /* 16 is not a multiple of 3 */
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_init(&rollup, levels, 3));
+    levels[1].resolution_s = 4;
+    levels[2].capacity = 0;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_init(&rollup, levels, 3));
+}
+
+TEST(BH1750Rollup, InvalidArgs)
+{
+    BH1750Measurement meas = {100, 0, BH1750_MEAS_MODE_H_RES, 69};
+    BH1750RollupEntry entry;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_add(NULL, &meas, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_add(&rollup, NULL, 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_get_entry(&rollup, 3, 0, &entry));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_get_entry(&rollup, 0, 0, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_query(&rollup, 3, 0, 10, &entry));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_rollup_query(&rollup, 0, 0, 10, NULL));
+}
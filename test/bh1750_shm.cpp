@@ -0,0 +1,119 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_shm.h"
+
+#define NUM_SLOTS 2
+
+static uint32_t region[1024];
+static BH1750ShmWriter writer;
+static BH1750ShmReader reader;
+
+// clang-format off
+TEST_GROUP(BH1750Shm)
+{
+    void setup() {
+        memset(region, 0xA5, sizeof(region));
+        CHECK_TRUE(bh1750_shm_get_region_size(NUM_SLOTS) <= sizeof(region));
+        uint8_t rc = bh1750_shm_writer_init(&writer, region, sizeof(region), NUM_SLOTS);
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+        rc = bh1750_shm_reader_init(&reader, region, bh1750_shm_get_region_size(NUM_SLOTS));
+        CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    }
+};
+// clang-format on
+
+static void publish(uint16_t slot, uint32_t meas_lx, uint32_t time_ms)
+{
+    BH1750Measurement meas = {meas_lx, 0, BH1750_MEAS_MODE_H_RES, 69, time_ms, time_ms};
+    uint8_t rc = bh1750_shm_publish(&writer, slot, &meas);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+static BH1750ShmSnapshot read_slot(uint16_t slot)
+{
+    BH1750ShmSnapshot snapshot;
+    uint8_t rc = bh1750_shm_read(&reader, slot, &snapshot);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+    return snapshot;
+}
+
+TEST(BH1750Shm, EmptySlots)
+{
+    CHECK_EQUAL(NUM_SLOTS, bh1750_shm_get_num_slots(&reader));
+    BH1750ShmSnapshot snapshot = read_slot(1);
+    CHECK_EQUAL(0, snapshot.num_published);
+    CHECK_EQUAL(0, snapshot.num_history);
+}
+
+TEST(BH1750Shm, LatestFirst)
+{
+    publish(0, 10, 100);
+    publish(0, 20, 200);
+    publish(1, 30, 300);
+
+    BH1750ShmSnapshot snapshot = read_slot(0);
+    CHECK_EQUAL(2, snapshot.num_published);
+    CHECK_EQUAL(2, snapshot.num_history);
+    CHECK_EQUAL(20, snapshot.history[0].meas_lx);
+    CHECK_EQUAL(200, snapshot.history[0].read_time_ms);
+    CHECK_EQUAL(10, snapshot.history[1].meas_lx);
+
+    snapshot = read_slot(1);
+    CHECK_EQUAL(1, snapshot.num_history);
+    CHECK_EQUAL(30, snapshot.history[0].meas_lx);
+}
+
+TEST(BH1750Shm, HistoryWrapsAround)
+{
+    for (uint32_t i = 0; i < BH1750_SHM_HISTORY_LEN + 5; i++) {
+        publish(0, i, i * 100);
+    }
+    BH1750ShmSnapshot snapshot = read_slot(0);
+    CHECK_EQUAL(BH1750_SHM_HISTORY_LEN + 5, snapshot.num_published);
+    CHECK_EQUAL(BH1750_SHM_HISTORY_LEN, snapshot.num_history);
+    for (uint32_t i = 0; i < BH1750_SHM_HISTORY_LEN; i++) {
+        CHECK_EQUAL(BH1750_SHM_HISTORY_LEN + 4 - i, snapshot.history[i].meas_lx);
+    }
+}
+
+TEST(BH1750Shm, ReadDuringUpdateIsBusy)
+{
+    publish(0, 10, 100);
+    /* Writer stopped in the middle of an update */
+    BH1750ShmSlot *slot = (BH1750ShmSlot *)(void *)((uint8_t *)region + sizeof(BH1750ShmHeader));
+    slot->seq++;
+    BH1750ShmSnapshot snapshot;
+    CHECK_EQUAL(BH1750_RESULT_CODE_BUSY, bh1750_shm_read(&reader, 0, &snapshot));
+    /* Other slots are not affected */
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_shm_read(&reader, 1, &snapshot));
+}
+
+TEST(BH1750Shm, ReaderRejectsInvalidRegion)
+{
+    static uint32_t other_region[1024];
+    BH1750ShmReader other_reader;
+    /* Not initialized */
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_shm_reader_init(&other_reader, other_region, 4096));
+
+    BH1750ShmHeader *hdr = (BH1750ShmHeader *)(void *)region;
+    CHECK_EQUAL(BH1750_RESULT_CODE_OUT_OF_MEMORY,
+                bh1750_shm_reader_init(&other_reader, region, bh1750_shm_get_region_size(NUM_SLOTS) - 1));
+    hdr->slot_size++;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_shm_reader_init(&other_reader, region, sizeof(region)));
+    hdr->slot_size--;
+    hdr->version++;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_shm_reader_init(&other_reader, region, sizeof(region)));
+}
+
+TEST(BH1750Shm, InvalidArgs)
+{
+    BH1750Measurement meas = {0, 0, BH1750_MEAS_MODE_H_RES, 69, 0, 0};
+    BH1750ShmSnapshot snapshot;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_shm_publish(&writer, NUM_SLOTS, &meas));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_shm_publish(&writer, 0, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_shm_read(&reader, NUM_SLOTS, &snapshot));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_shm_writer_init(&writer, region, sizeof(region), 0));
+    CHECK_EQUAL(BH1750_RESULT_CODE_OUT_OF_MEMORY, bh1750_shm_writer_init(&writer, region, 16, NUM_SLOTS));
+}
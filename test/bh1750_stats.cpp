@@ -0,0 +1,259 @@
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+
+#include "bh1750_stats.h"
+
+#define BH1750_TEST_STATS_MAX_PANES 4
+#define BH1750_TEST_STATS_MAX_SUMMARIES 8
+
+static BH1750StatsPane panes[BH1750_TEST_STATS_MAX_PANES];
+static BH1750Stats stats;
+
+/* Populated from inside window_cb */
+static size_t num_summaries;
+static BH1750StatsSummary summaries[BH1750_TEST_STATS_MAX_SUMMARIES];
+static void *window_cb_user_data;
+
+static void window_cb(const BH1750StatsSummary *summary, void *user_data)
+{
+    if (num_summaries < BH1750_TEST_STATS_MAX_SUMMARIES) {
+        summaries[num_summaries] = *summary;
+    }
+    num_summaries++;
+    window_cb_user_data = user_data;
+}
+
+// clang-format off
+TEST_GROUP(BH1750Stats)
+{
+    void setup() {
+        num_summaries = 0;
+        memset(summaries, 0, sizeof(summaries));
+        window_cb_user_data = NULL;
+    }
+};
+// clang-format on
+
+static void init_stats(size_t num_panes, uint16_t samples_per_pane)
+{
+    BH1750StatsConfig cfg;
+    cfg.panes = panes;
+    cfg.num_panes = num_panes;
+    cfg.samples_per_pane = samples_per_pane;
+    cfg.cb = window_cb;
+    cfg.user_data = (void *)0x5A;
+    uint8_t rc = bh1750_stats_init(&stats, &cfg);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+static void add(uint16_t raw_meas, uint8_t meas_mode = BH1750_MEAS_MODE_H_RES, uint8_t meas_time = 69)
+{
+    BH1750Measurement meas;
+    meas.meas_lx = 0;
+    meas.raw_meas = raw_meas;
+    meas.meas_mode = meas_mode;
+    meas.meas_time = meas_time;
+    uint8_t rc = bh1750_stats_add(&stats, &meas);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, rc);
+}
+
+TEST(BH1750Stats, TumblingWindow)
+{
+    init_stats(1, 4);
+    add(100);
+    add(200);
+    add(300);
+    CHECK_EQUAL(0, num_summaries);
+    add(400);
+
+    CHECK_EQUAL(1, num_summaries);
+    POINTERS_EQUAL((void *)0x5A, window_cb_user_data);
+    CHECK_EQUAL(4, summaries[0].num_samples);
+    CHECK_EQUAL(100, summaries[0].min_raw);
+    CHECK_EQUAL(400, summaries[0].max_raw);
+    CHECK_EQUAL(250 * 256, summaries[0].mean_raw_q8);
+    /* Population variance of 100, 200, 300, 400 is 12500 */
+    CHECK_EQUAL(12500 * 256, summaries[0].variance_raw_q8);
+    CHECK_EQUAL(83, summaries[0].min_lx);  /* 100 / 1.2 */
+    CHECK_EQUAL(333, summaries[0].max_lx); /* 400 / 1.2 */
+    DOUBLES_EQUAL(208.33, summaries[0].mean_lx, 0.01);
+    DOUBLES_EQUAL(93.17, summaries[0].stddev_lx, 0.01); /* sqrt(12500) / 1.2 */
+    CHECK_EQUAL(BH1750_MEAS_MODE_H_RES, summaries[0].meas_mode);
+    CHECK_EQUAL(69, summaries[0].meas_time);
+
+    /* Windows do not overlap */
+    add(1000);
+    add(1000);
+    add(1000);
+    CHECK_EQUAL(1, num_summaries);
+    add(1000);
+    CHECK_EQUAL(2, num_summaries);
+    CHECK_EQUAL(1000 * 256, summaries[1].mean_raw_q8);
+    CHECK_EQUAL(0, summaries[1].variance_raw_q8);
+}
+
+TEST(BH1750Stats, SlidingWindow)
+{
+    /* Window of 3 panes, 2 samples each */
+    init_stats(3, 2);
+    const uint16_t samples[] = {10, 20, 30, 40, 50, 60, 70, 80, 90, 100};
+    for (size_t i = 0; i < 5; i++) {
+        add(samples[i]);
+    }
+    CHECK_EQUAL(0, num_summaries);
+    add(samples[5]);
+    /* 10..60 */
+    CHECK_EQUAL(1, num_summaries);
+    CHECK_EQUAL(6, summaries[0].num_samples);
+    CHECK_EQUAL(10, summaries[0].min_raw);
+    CHECK_EQUAL(60, summaries[0].max_raw);
+    CHECK_EQUAL(35 * 256, summaries[0].mean_raw_q8);
+
+    add(samples[6]);
+    CHECK_EQUAL(1, num_summaries);
+    add(samples[7]);
+    /* 30..80 */
+    CHECK_EQUAL(2, num_summaries);
+    CHECK_EQUAL(6, summaries[1].num_samples);
+    CHECK_EQUAL(30, summaries[1].min_raw);
+    CHECK_EQUAL(80, summaries[1].max_raw);
+    CHECK_EQUAL(55 * 256, summaries[1].mean_raw_q8);
+    /* Population variance of 6 equally spaced values 10 apart is 291.67 */
+    DOUBLES_EQUAL(291.67 * 256, (double)summaries[1].variance_raw_q8, 256);
+
+    add(samples[8]);
+    add(samples[9]);
+    /* 50..100 */
+    CHECK_EQUAL(3, num_summaries);
+    CHECK_EQUAL(50, summaries[2].min_raw);
+    CHECK_EQUAL(100, summaries[2].max_raw);
+}
+
+TEST(BH1750Stats, MatchesTwoPassComputation)
+{
+    init_stats(4, 16);
+    uint32_t seed = 12345;
+    uint16_t samples[64];
+    for (size_t i = 0; i < 64; i++) {
+        /* Simple LCG to get noisy, but reproducible samples around 30000 */
+        seed = seed * 1103515245U + 12345U;
+        samples[i] = (uint16_t)(30000 + ((seed >> 16) % 2001) - 1000);
+        add(samples[i]);
+    }
+    CHECK_EQUAL(1, num_summaries);
+
+    double mean = 0;
+    for (size_t i = 0; i < 64; i++) {
+        mean += samples[i];
+    }
+    mean /= 64;
+    double variance = 0;
+    for (size_t i = 0; i < 64; i++) {
+        variance += (samples[i] - mean) * (samples[i] - mean);
+    }
+    variance /= 64;
+
+    DOUBLES_EQUAL(mean, summaries[0].mean_raw_q8 / 256.0, 0.01);
+    /* Relative error below 0.1% */
+    DOUBLES_EQUAL(variance, summaries[0].variance_raw_q8 / 256.0, variance * 0.001);
+}
+
+TEST(BH1750Stats, MergeOfUnevenPanesMatchesTwoPassComputation)
+{
+    /* The last merge combines an accumulator of 6 samples with a pane of 3 samples */
+    init_stats(3, 3);
+    const uint16_t samples[] = {7, 5, 0, 6, 7, 0, 8, 7, 5};
+    const size_t num_samples = sizeof(samples) / sizeof(samples[0]);
+    for (size_t i = 0; i < num_samples; i++) {
+        add(samples[i]);
+    }
+    CHECK_EQUAL(1, num_summaries);
+
+    double mean = 0;
+    for (size_t i = 0; i < num_samples; i++) {
+        mean += samples[i];
+    }
+    mean /= num_samples;
+    double variance = 0;
+    for (size_t i = 0; i < num_samples; i++) {
+        variance += (samples[i] - mean) * (samples[i] - mean);
+    }
+    variance /= num_samples;
+
+    /* Mean 5 and variance 8 are exact in fixed point, so no rounding error is allowed */
+    CHECK_EQUAL((uint32_t)(mean * 256), summaries[0].mean_raw_q8);
+    CHECK_EQUAL((uint32_t)(variance * 256), summaries[0].variance_raw_q8);
+}
+
+TEST(BH1750Stats, ConfigChangeStartsNewWindow)
+{
+    init_stats(1, 3);
+    add(100);
+    add(100);
+    /* Different measurement time - previous samples are discarded */
+    add(500, BH1750_MEAS_MODE_H_RES, 138);
+    add(500, BH1750_MEAS_MODE_H_RES, 138);
+    CHECK_EQUAL(0, num_summaries);
+    add(500, BH1750_MEAS_MODE_H_RES, 138);
+    CHECK_EQUAL(1, num_summaries);
+    CHECK_EQUAL(3, summaries[0].num_samples);
+    CHECK_EQUAL(500, summaries[0].min_raw);
+    CHECK_EQUAL(138, summaries[0].meas_time);
+    CHECK_EQUAL(208, summaries[0].min_lx); /* 500 * ((1 / 1.2) * (69 / 138)) */
+}
+
+TEST(BH1750Stats, Reset)
+{
+    init_stats(1, 2);
+    add(100);
+    CHECK_EQUAL(BH1750_RESULT_CODE_OK, bh1750_stats_reset(&stats));
+    add(200);
+    CHECK_EQUAL(0, num_summaries);
+    add(200);
+    CHECK_EQUAL(1, num_summaries);
+    CHECK_EQUAL(200, summaries[0].min_raw);
+}
+
+TEST(BH1750Stats, ProcessAddsMeasAndKeepsIt)
+{
+    init_stats(1, 1);
+    BH1750Measurement meas = {83, 100, BH1750_MEAS_MODE_H_RES, 69};
+    CHECK_TRUE(bh1750_stats_process(&meas, &stats));
+    CHECK_EQUAL(1, num_summaries);
+    CHECK_EQUAL(100, summaries[0].max_raw);
+}
+
+TEST(BH1750Stats, InitInvalidArgs)
+{
+    BH1750StatsConfig cfg = {panes, 2, 10, window_cb, NULL};
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_init(NULL, &cfg));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_init(&stats, NULL));
+
+    BH1750StatsConfig invalid_cfg = cfg;
+    invalid_cfg.panes = NULL;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_init(&stats, &invalid_cfg));
+    invalid_cfg = cfg;
+    invalid_cfg.cb = NULL;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_init(&stats, &invalid_cfg));
+    invalid_cfg = cfg;
+    invalid_cfg.num_panes = 0;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_init(&stats, &invalid_cfg));
+    invalid_cfg = cfg;
+    invalid_cfg.samples_per_pane = 0;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_init(&stats, &invalid_cfg));
+    invalid_cfg = cfg;
+    invalid_cfg.samples_per_pane = 32768;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_init(&stats, &invalid_cfg));
+}
+
+TEST(BH1750Stats, AddInvalidArgs)
+{
+    init_stats(1, 2);
+    BH1750Measurement meas = {0, 100, BH1750_MEAS_MODE_H_RES, 30};
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_add(&stats, &meas));
+    meas.meas_time = 69;
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_add(NULL, &meas));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_add(&stats, NULL));
+    CHECK_EQUAL(BH1750_RESULT_CODE_INVALID_ARG, bh1750_stats_reset(NULL));
+}